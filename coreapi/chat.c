@@ -57,6 +57,10 @@ const bctbx_list_t *linphone_core_get_chat_rooms(LinphoneCore *lc) {
 	return L_GET_CPP_PTR_FROM_C_OBJECT(lc)->getChatRoomsCList();
 }
 
+unsigned int linphone_core_get_chat_rooms_version(LinphoneCore *lc) {
+	return L_GET_CPP_PTR_FROM_C_OBJECT(lc)->getChatRoomListVersion();
+}
+
 LinphoneChatRoom *linphone_core_create_client_group_chat_room(LinphoneCore *lc, const char *subject, bool_t fallback) {
 	return linphone_core_create_client_group_chat_room_2(lc, subject, fallback, FALSE);
 }
@@ -4660,6 +4660,59 @@ void linphone_core_iterate(LinphoneCore *lc) {
 	}
 }
 
+int linphone_core_get_next_iterate_delay(LinphoneCore *lc) {
+	/* Longest delay between two iterations of an idle core: SIP and timers are served while waiting, this only bounds
+	the tasks that linphone_core_iterate() polls for. */
+	const int idleDelay = 1000;
+	int activeDelay = linphone_core_get_auto_iterate_foreground_schedule(lc);
+	int delay = idleDelay;
+
+	/* Media, calibration, ringtone preview and the core state changes are polled by linphone_core_iterate(). */
+	if (L_GET_PRIVATE_FROM_C_OBJECT(lc)->hasCalls() || lc->previewstream || linphone_core_video_preview_enabled(lc) ||
+	    lc->ecc || lc->preview_finished ||
+	    (lc->ringtoneplayer && linphone_ringtoneplayer_is_started(lc->ringtoneplayer)) ||
+	    (lc->state == LinphoneGlobalConfiguring) || (lc->state == LinphoneGlobalShutdown) ||
+	    (liblinphone_serialize_logs == TRUE)) {
+		return activeDelay;
+	}
+
+	if (lc->sip_network_state.global_state && (lc->netup_time != 0) && !lc->initial_subscribes_sent) {
+		int64_t remaining = ((int64_t)lc->netup_time + 2 - (int64_t)ms_time(NULL)) * 1000;
+		delay = (int)MAX(0, MIN(remaining, (int64_t)delay));
+	}
+
+	bool_t needsOneSecondTasks = linphone_config_needs_commit(lc->config);
+	for (bctbx_list_t *elem = lc->friends_lists; elem != NULL && !needsOneSecondTasks; elem = bctbx_list_next(elem)) {
+		std::shared_ptr<FriendList> friendList = FriendList::getSharedFromThis((LinphoneFriendList *)elem->data);
+		needsOneSecondTasks = (friendList->getType() == LinphoneFriendListTypeCardDAV) &&
+		                      !friendList->getDirtyFriendsToUpdate().empty();
+	}
+	if (needsOneSecondTasks && (lc->prevtime_ms != 0)) {
+		int64_t remaining = (int64_t)(lc->prevtime_ms + 1000) - (int64_t)ms_get_cur_time_ms();
+		delay = (int)MAX(0, MIN(remaining, (int64_t)delay));
+	}
+
+	return delay;
+}
+
+void linphone_core_wait(LinphoneCore *lc, int timeout_ms) {
+	CoreLogContextualizer logContextualizer(lc);
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->waitForEvents(timeout_ms);
+}
+
+void linphone_core_wake_up(LinphoneCore *lc) {
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->wakeUp();
+}
+
+void linphone_core_run(LinphoneCore *lc) {
+	CoreLogContextualizer logContextualizer(lc);
+	while (linphone_core_get_global_state(lc) != LinphoneGlobalOff) {
+		linphone_core_iterate(lc);
+		if (linphone_core_get_global_state(lc) == LinphoneGlobalOff) break;
+		linphone_core_wait(lc, linphone_core_get_next_iterate_delay(lc));
+	}
+}
+
 LinphoneAddress *linphone_core_interpret_url(LinphoneCore *lc, const char *url) {
 	CoreLogContextualizer logContextualizer(lc);
 	return linphone_core_interpret_url_2(lc, url, TRUE);
@@ -46,6 +46,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string_view>
+#include <unordered_map>
 #if !defined(_WIN32_WCE)
 #include <errno.h>
 #include <sys/stat.h>
@@ -77,12 +79,25 @@
 #include "lpc2xml.h"
 #include "private_functions.h"
 
+enum {
+	LP_ITEM_PARSED_INT = 1,
+	LP_ITEM_PARSED_BOOL = 1 << 1,
+	LP_ITEM_PARSED_INT64 = 1 << 2,
+	LP_ITEM_PARSED_FLOAT = 1 << 3
+};
+
 typedef struct _LpItem {
 	char *key;
 	char *value;
 	int is_comment;
 	bool_t overwrite; // If set to true, will add overwrite=true when converted to xml
 	bool_t skip;      // If set to true, won't be dumped when converted to xml
+	/* Value parsed by the typed getters, kept until the value is changed. */
+	int parsed; // LP_ITEM_PARSED_* flags
+	bool_t bool_value;
+	int int_value;
+	int64_t int64_value;
+	float float_value;
 } LpItem;
 
 typedef struct _LpSectionParam {
@@ -90,14 +105,20 @@ typedef struct _LpSectionParam {
 	char *value;
 } LpSectionParam;
 
+/* The keys are owned by the indexed items and sections, the lists keep the file order. */
+typedef std::unordered_map<std::string_view, LpItem *> LpItemIndex;
+
 typedef struct _LpSection {
 	char *name;
 	bctbx_list_t *items;
+	LpItemIndex *items_index; // Items that are not comments, by key.
 	bctbx_list_t *params;
 	bool_t overwrite; // If set to true, will add overwrite=true to all items of this section when converted to xml
 	bool_t skip;      // If set to true, won't be dumped when converted to xml
 } LpSection;
 
+typedef std::unordered_map<std::string_view, LpSection *> LpSectionIndex;
+
 struct _LpConfig {
 	belle_sip_object_t base;
 	bctbx_vfs_file_t *pFile;
@@ -105,6 +126,7 @@ struct _LpConfig {
 	char *tmpfilename;
 	char *factory_filename;
 	bctbx_list_t *sections;
+	LpSectionIndex *sections_index;
 	bctbx_vfs_t *g_bctbx_vfs;
 	bool_t modified;
 	bool_t readonly;
@@ -186,15 +208,22 @@ void lp_section_destroy(LpSection *sec) {
 	bctbx_list_for_each(sec->items, lp_item_destroy);
 	bctbx_list_for_each(sec->params, lp_section_param_destroy);
 	bctbx_list_free(sec->items);
+	delete sec->items_index;
 	free(sec);
 }
 
 void lp_section_add_item(LpSection *sec, LpItem *item) {
 	sec->items = bctbx_list_append(sec->items, (void *)item);
+	if (!item->is_comment) {
+		if (sec->items_index == NULL) sec->items_index = new LpItemIndex();
+		sec->items_index->emplace(item->key, item);
+	}
 }
 
 void linphone_config_add_section(LpConfig *lpconfig, LpSection *section) {
 	lpconfig->sections = bctbx_list_append(lpconfig->sections, (void *)section);
+	if (lpconfig->sections_index == NULL) lpconfig->sections_index = new LpSectionIndex();
+	lpconfig->sections_index->emplace(section->name, section);
 }
 
 void linphone_config_add_section_param(LpSection *section, LpSectionParam *param) {
@@ -202,11 +231,19 @@ void linphone_config_add_section_param(LpSection *section, LpSectionParam *param
 }
 
 void linphone_config_remove_section(LpConfig *lpconfig, LpSection *section) {
+	if (lpconfig->sections_index) {
+		auto it = lpconfig->sections_index->find(section->name);
+		if ((it != lpconfig->sections_index->end()) && (it->second == section)) lpconfig->sections_index->erase(it);
+	}
 	lpconfig->sections = bctbx_list_remove(lpconfig->sections, (void *)section);
 	lp_section_destroy(section);
 }
 
 void lp_section_remove_item(LpSection *sec, LpItem *item) {
+	if (!item->is_comment && sec->items_index) {
+		auto it = sec->items_index->find(item->key);
+		if ((it != sec->items_index->end()) && (it->second == item)) sec->items_index->erase(it);
+	}
 	sec->items = bctbx_list_remove(sec->items, (void *)item);
 	lp_item_destroy(item);
 }
@@ -228,17 +265,9 @@ static int is_a_comment(const char *str) {
 }
 
 LpSection *linphone_config_find_section(const LpConfig *lpconfig, const char *name) {
-	LpSection *sec;
-	bctbx_list_t *elem = lpconfig->sections;
-	/*printf("Looking for section %s\n",name);*/
-	for (; elem != NULL; elem = bctbx_list_next(elem)) {
-		sec = (LpSection *)elem->data;
-		if (strcmp(sec->name, name) == 0) {
-			/*printf("Section %s found\n",name);*/
-			return sec;
-		}
-	}
-	return NULL;
+	if (lpconfig->sections_index == NULL) return NULL;
+	auto it = lpconfig->sections_index->find(name);
+	return (it != lpconfig->sections_index->end()) ? it->second : NULL;
 }
 
 LpSectionParam *lp_section_find_param(const LpSection *sec, const char *key) {
@@ -268,17 +297,9 @@ LpItem *lp_section_find_comment(const LpSection *sec, const char *comment) {
 }
 
 LpItem *lp_section_find_item(const LpSection *sec, const char *name) {
-	bctbx_list_t *elem;
-	LpItem *item;
-	/*printf("Looking for item %s\n",name);*/
-	for (elem = sec->items; elem != NULL; elem = bctbx_list_next(elem)) {
-		item = (LpItem *)elem->data;
-		if (!item->is_comment && strcmp(item->key, name) == 0) {
-			/*printf("Item %s found\n",name);*/
-			return item;
-		}
-	}
-	return NULL;
+	if (sec->items_index == NULL) return NULL;
+	auto it = sec->items_index->find(name);
+	return (it != sec->items_index->end()) ? it->second : NULL;
 }
 
 bctbx_list_t *lp_section_get_items(const LpSection *sec) {
@@ -386,8 +407,7 @@ static LpSection *linphone_config_parse_line(LpConfig *lpconfig, char *line, LpS
 							if (item == NULL) {
 								lp_section_add_item(cur, lp_item_new(key, pos1));
 							} else {
-								ortp_free(item->value);
-								item->value = ortp_strdup(pos1);
+								lp_item_set_value(item, pos1);
 							}
 							/*ms_message("Found %s=%s",key,pos1);*/
 						} else {
@@ -669,6 +689,7 @@ void lp_item_set_value(LpItem *item, const char *value) {
 		char *prev_value = item->value;
 		item->value = ortp_strdup(value);
 		ortp_free(prev_value);
+		item->parsed = 0;
 	}
 }
 
@@ -677,6 +698,7 @@ static void _linphone_config_uninit(LpConfig *lpconfig) {
 	if (lpconfig->tmpfilename) ortp_free(lpconfig->tmpfilename);
 	if (lpconfig->factory_filename) bctbx_free(lpconfig->factory_filename);
 	if (lpconfig->sections) bctbx_list_free_with_data(lpconfig->sections, (bctbx_list_free_func)lp_section_destroy);
+	delete lpconfig->sections_index;
 }
 
 LpConfig *linphone_config_ref(LpConfig *lpconfig) {
@@ -774,46 +796,63 @@ bool_t linphone_config_get_range(const LpConfig *lpconfig,
 	}
 }
 
+static LpItem *linphone_config_find_item(const LpConfig *lpconfig, const char *section, const char *key) {
+	LpSection *sec = linphone_config_find_section(lpconfig, section);
+	return (sec != NULL) ? lp_section_find_item(sec, key) : NULL;
+}
+
 int linphone_config_get_int(const LpConfig *lpconfig, const char *section, const char *key, int default_value) {
-	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
+	LpItem *item = linphone_config_find_item(lpconfig, section, key);
+	if (item == NULL) return default_value;
+	if (!(item->parsed & LP_ITEM_PARSED_INT)) {
+		const char *str = item->value;
 		int ret = 0;
 
 		if (strstr(str, "0x") == str) {
 			sscanf(str, "%x", &ret);
 		} else sscanf(str, "%i", &ret);
-		return ret;
-	} else return default_value;
+		item->int_value = ret;
+		item->parsed |= LP_ITEM_PARSED_INT;
+	}
+	return item->int_value;
 }
 
 bool_t linphone_config_get_bool(const LpConfig *lpconfig, const char *section, const char *key, bool_t default_value) {
-	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
+	LpItem *item = linphone_config_find_item(lpconfig, section, key);
+	if (item == NULL) return default_value;
+	if (!(item->parsed & LP_ITEM_PARSED_BOOL)) {
 		int ret = 0;
-		sscanf(str, "%i", &ret);
-		return ret != 0;
+		sscanf(item->value, "%i", &ret);
+		item->bool_value = ret != 0;
+		item->parsed |= LP_ITEM_PARSED_BOOL;
 	}
-	return default_value;
+	return item->bool_value;
 }
 
 int64_t
 linphone_config_get_int64(const LpConfig *lpconfig, const char *section, const char *key, int64_t default_value) {
-	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
+	LpItem *item = linphone_config_find_item(lpconfig, section, key);
+	if (item == NULL) return default_value;
+	if (!(item->parsed & LP_ITEM_PARSED_INT64)) {
 #ifdef _WIN32
-		return (int64_t)_atoi64(str);
+		item->int64_value = (int64_t)_atoi64(item->value);
 #else
-		return atoll(str);
+		item->int64_value = atoll(item->value);
 #endif
-	} else return default_value;
+		item->parsed |= LP_ITEM_PARSED_INT64;
+	}
+	return item->int64_value;
 }
 
 float linphone_config_get_float(const LpConfig *lpconfig, const char *section, const char *key, float default_value) {
-	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	float ret = default_value;
-	if (str == NULL) return default_value;
-	sscanf(str, "%f", &ret);
-	return ret;
+	LpItem *item = linphone_config_find_item(lpconfig, section, key);
+	if (item == NULL) return default_value;
+	if (!(item->parsed & LP_ITEM_PARSED_FLOAT)) {
+		/* A value that is not a number gives the default value, which may change from one call to another. */
+		if (sscanf(item->value, "%f", &item->float_value) != 1) return default_value;
+		item->parsed |= LP_ITEM_PARSED_FLOAT;
+	}
+	return item->float_value;
 }
 
 bool_t linphone_config_get_overwrite_flag_for_entry(const LpConfig *lpconfig, const char *section, const char *key) {
@@ -1063,6 +1102,8 @@ void linphone_config_reload(LinphoneConfig *lpconfig) {
 	bctbx_list_for_each(lpconfig->sections, (void (*)(void *))lp_section_destroy);
 	bctbx_list_free(lpconfig->sections);
 	lpconfig->sections = NULL;
+	delete lpconfig->sections_index;
+	lpconfig->sections_index = NULL;
 	linphone_config_read_file(lpconfig, lpconfig->filename);
 }
 
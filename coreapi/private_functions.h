@@ -218,9 +218,6 @@ LinphonePrivate::SalRegisterOp *linphone_proxy_config_get_op(const LinphoneProxy
 /* Returns as a LinphoneAddress the Contact header sent in a register, fixed thanks to nat helper.*/
 LINPHONE_PUBLIC LinphoneAddress *linphone_proxy_config_get_transport_contact(LinphoneProxyConfig *cfg);
 
-void linphone_friend_list_notify_presence_received(LinphoneFriendList *list,
-                                                   LinphoneEvent *lev,
-                                                   const LinphoneContent *body);
 void linphone_friend_list_subscription_state_changed(LinphoneCore *lc,
                                                      LinphoneEvent *lev,
                                                      LinphoneSubscriptionState state);
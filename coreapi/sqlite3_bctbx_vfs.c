@@ -256,7 +256,9 @@ sqlite3bctbx_Open(BCTBX_UNUSED(sqlite3_vfs *pVfs), const char *fName, sqlite3_fi
 	    sqlite3bctbx_FileControl,
 	    NULL, /* xSectorSize */
 	    sqlite3bctbx_DeviceCharacteristics
-	    /*other function points follows, all NULL but not present in all sqlite3 versions.*/
+	    /*other function points follows, all NULL but not present in all sqlite3 versions.
+	     * Without the xShm* methods, a database can only be used in WAL mode with locking_mode=EXCLUSIVE: SQLite then
+	     * keeps the wal-index in heap memory. Without xFetch, mmap_size has no effect.*/
 	};
 
 	sqlite3_bctbx_file_t *pFile = (sqlite3_bctbx_file_t *)p; /*File handle sqlite3_bctbx_file_t*/
@@ -115,6 +115,10 @@ const char *linphone_friend_list_get_revision(const LinphoneFriendList *lfl) {
 	return FriendList::toCpp(lfl)->mRevision.c_str();
 }
 
+const char *linphone_friend_list_get_sync_token(const LinphoneFriendList *lfl) {
+	return FriendList::toCpp(lfl)->mSyncToken.c_str();
+}
+
 unsigned int _linphone_call_get_nb_audio_starts(const LinphoneCall *call) {
 	const LinphoneStreamInternalStats *st = _linphone_call_get_stream_internal_stats(call, LinphoneStreamTypeAudio);
 	return st ? st->number_of_starts : 0;
@@ -202,6 +202,10 @@ LINPHONE_PUBLIC long long linphone_friend_list_get_storage_id(const LinphoneFrie
 LINPHONE_PUBLIC long long linphone_friend_get_storage_id(const LinphoneFriend *lf);
 LINPHONE_PUBLIC const bctbx_list_t *linphone_friend_list_get_dirty_friends_to_update(const LinphoneFriendList *lfl);
 LINPHONE_PUBLIC const char *linphone_friend_list_get_revision(const LinphoneFriendList *lfl);
+LINPHONE_PUBLIC const char *linphone_friend_list_get_sync_token(const LinphoneFriendList *lfl);
+LINPHONE_PUBLIC void linphone_friend_list_notify_presence_received(LinphoneFriendList *list,
+                                                                   LinphoneEvent *lev,
+                                                                   const LinphoneContent *body);
 
 LINPHONE_PUBLIC int linphone_remote_provisioning_load_file(LinphoneCore *lc, const char *file_path);
 
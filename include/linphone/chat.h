@@ -47,6 +47,15 @@ extern "C" {
  **/
 LINPHONE_PUBLIC const bctbx_list_t *linphone_core_get_chat_rooms(LinphoneCore *core);
 
+/**
+ * Returns the version of the list of chat rooms returned by linphone_core_get_chat_rooms().
+ * The version changes each time the content or the order of the list may have changed, so that applications can
+ * avoid fetching and redrawing an unchanged list.
+ * @param core #LinphoneCore object @notnil
+ * @return The version of the list of chat rooms.
+ **/
+LINPHONE_PUBLIC unsigned int linphone_core_get_chat_rooms_version(LinphoneCore *core);
+
 /**
  * Creates and returns the default chat room parameters.
  * @param core #LinphoneCore object @notnil
@@ -1605,12 +1605,57 @@ LINPHONE_PUBLIC void linphone_core_unref(LinphoneCore *core);
  * Be careful that this function must be called from the same thread as
  * other liblinphone methods. If it is not the case make sure all liblinphone calls are
  * serialized with a mutex.
- * A recommanded timer value is 20 ms for calling this function.
+ * A recommanded timer value is 20 ms for calling this function, idle cores can use
+ * linphone_core_get_next_iterate_delay() and linphone_core_wait() instead.
  * @param core #LinphoneCore object @notnil
  * @ingroup initializing
  **/
 LINPHONE_PUBLIC void linphone_core_iterate(LinphoneCore *core);
 
+/**
+ * Gets the delay after which linphone_core_iterate() needs to be called again.
+ * While the core is idle, i.e. without calls, video preview or pending asynchronous stop, it is much longer than the
+ * recommended 20 ms: SIP messages and timers are served by linphone_core_wait(), so the application can sleep until
+ * this delay expires instead of polling the core.
+ * While the core is active, the auto-iterate foreground schedule is returned, see
+ * linphone_core_get_auto_iterate_foreground_schedule().
+ * The delay is only valid until the next call to a liblinphone function.
+ * @param core #LinphoneCore object @notnil
+ * @return the delay in milliseconds before the next call to linphone_core_iterate().
+ * @ingroup initializing
+ **/
+LINPHONE_PUBLIC int linphone_core_get_next_iterate_delay(LinphoneCore *core);
+
+/**
+ * Blocks on the SIP sockets and timers of the core until the timeout expires or linphone_core_wake_up() is called.
+ * Incoming SIP messages and timers are processed while waiting, and the wait ends early when a call is created.
+ * It must be called from the thread that calls linphone_core_iterate(), and never from a callback.
+ * @param core #LinphoneCore object @notnil
+ * @param timeout_ms the maximum time to wait, in milliseconds, usually linphone_core_get_next_iterate_delay().
+ * @ingroup initializing
+ **/
+LINPHONE_PUBLIC void linphone_core_wait(LinphoneCore *core, int timeout_ms);
+
+/**
+ * Ends the current or next linphone_core_wait() as soon as possible.
+ * This function can be called from any thread, for example after an application event that requires the core to be
+ * iterated.
+ * @param core #LinphoneCore object @notnil
+ * @ingroup initializing
+ **/
+LINPHONE_PUBLIC void linphone_core_wake_up(LinphoneCore *core);
+
+/**
+ * Runs the core until it is stopped.
+ * It calls linphone_core_iterate(), then waits with linphone_core_wait() for the delay given by
+ * linphone_core_get_next_iterate_delay(), until the global state of the core is #LinphoneGlobalOff. It is meant for
+ * applications that dedicate a thread to the core and don't have a main loop of their own. Call
+ * linphone_core_stop_async() from a callback of the core to make it return.
+ * @param core #LinphoneCore object @notnil
+ * @ingroup initializing
+ **/
+LINPHONE_PUBLIC void linphone_core_run(LinphoneCore *core);
+
 /**
  * @ingroup initializing
  * Add a listener in order to be notified of #LinphoneCore events. Once an event is received, registred #LinphoneCoreCbs
@@ -955,6 +955,7 @@ void Account::unsubscribeFromChatRooms() {
 		}
 	}
 	mChatRoomList.mList.clear();
+	mChatRoomListIdentityAddress = nullptr;
 }
 
 void Account::updateChatRoomList() const {
@@ -962,17 +963,26 @@ void Account::updateChatRoomList() const {
 	if (!mParams) {
 		lWarning() << "getChatRooms is called but no AccountParams is set on " << *this;
 		mChatRoomList.mList.clear();
+		mChatRoomListIdentityAddress = nullptr;
 		return;
 	}
 
 	auto localAddress = mParams->mIdentityAddress;
-	const list<shared_ptr<AbstractChatRoom>> chatRooms = getCore()->getChatRooms();
+	const auto core = getCore();
+	const unsigned int chatRoomListVersion = core->getChatRoomListVersion();
+	if (mChatRoomListIdentityAddress && (mChatRoomListIdentityAddress == localAddress) &&
+	    (mChatRoomListVersion == chatRoomListVersion))
+		return;
+
+	const list<shared_ptr<AbstractChatRoom>> &chatRooms = core->getChatRooms();
 	for (const auto &chatRoom : chatRooms) {
 		if (localAddress->weakEqual(chatRoom->getLocalAddress())) {
 			results.push_back(chatRoom);
 		}
 	}
 	mChatRoomList.mList = results;
+	mChatRoomListIdentityAddress = localAddress;
+	mChatRoomListVersion = chatRoomListVersion;
 }
 
 const list<shared_ptr<AbstractChatRoom>> &Account::getChatRooms() const {
@@ -251,6 +251,9 @@ private:
 
 	mutable std::list<std::shared_ptr<ConferenceInfo>> mConferenceInfos;
 	mutable ListHolder<AbstractChatRoom> mChatRoomList;
+	// Core chat room list version and identity address mChatRoomList was computed from.
+	mutable unsigned int mChatRoomListVersion = 0;
+	mutable std::shared_ptr<const Address> mChatRoomListIdentityAddress;
 
 	// This is a back pointer intended to keep both LinphoneProxyConfig and Account
 	// api to be usable at the same time. This should be removed as soon as
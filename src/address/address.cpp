@@ -25,6 +25,7 @@
 
 #include "address.h"
 #include "c-wrapper/c-wrapper.h"
+#include "containers/lru-cache.h"
 #include "logger/logger.h"
 
 // =============================================================================
@@ -33,11 +34,26 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
-std::unordered_map<std::string, std::unique_ptr<SalAddress, Address::SalAddressDeleter>> Address::sAddressCache;
+struct Address::SalAddressCache {
+	static constexpr int Capacity = 10000;
+	// Strings that failed to parse, so that peers sending garbage don't get it parsed again on each message.
+	static constexpr int NegativeCapacity = 256;
+
+	LruCache<string, unique_ptr<SalAddress, SalAddressDeleter>> addresses{Capacity};
+	LruCache<string, bool> invalidAddresses{NegativeCapacity};
+};
+
+Address::SalAddressCache &Address::getSalAddressCache() {
+	// belle-sip objects are not thread safe: each thread gets its own cache instead of sharing a locked one.
+	static thread_local SalAddressCache cache;
+	return cache;
+}
 
 SalAddress *Address::getSalAddressFromCache(const string &address, bool assumeGrUri) {
-	auto &ptr = sAddressCache[address];
-	if (ptr) return sal_address_clone(ptr.get());
+	auto &cache = getSalAddressCache();
+	auto ptr = cache.addresses[address];
+	if (ptr) return sal_address_clone(ptr->get());
+	if (cache.invalidAddresses[address]) return nullptr;
 
 	// lInfo() << "Creating SalAddress for " << address;
 	/* To optimize, use the fast uri parser from AddressParser when we can assume that it is a simple URI with
@@ -50,9 +66,10 @@ SalAddress *Address::getSalAddressFromCache(const string &address, bool assumeGr
 	if (!parsedAddress) parsedAddress = sal_address_new(L_STRING_TO_C(address));
 	if (parsedAddress) {
 		removeFromLeakDetector(parsedAddress);
-		ptr = (unique_ptr<SalAddress, SalAddressDeleter>(parsedAddress, SalAddressDeleter()));
+		cache.addresses.insert(address, unique_ptr<SalAddress, SalAddressDeleter>(parsedAddress, SalAddressDeleter()));
 		return sal_address_clone(parsedAddress);
 	}
+	cache.invalidAddresses.insert(address, true);
 	return nullptr;
 }
 
@@ -152,7 +169,25 @@ void Address::setImpl(SalAddress *addr) {
 }
 
 void Address::clearSipAddressesCache() {
-	sAddressCache.clear();
+	auto &cache = getSalAddressCache();
+	cache.addresses.clear();
+	cache.addresses.resetCounters();
+	cache.invalidAddresses.clear();
+	cache.invalidAddresses.resetCounters();
+}
+
+Address::SipAddressesCacheStats Address::getSipAddressesCacheStats() {
+	const auto &cache = getSalAddressCache();
+	SipAddressesCacheStats stats;
+	stats.size = cache.addresses.getSize();
+	stats.capacity = cache.addresses.getCapacity();
+	stats.negativeSize = cache.invalidAddresses.getSize();
+	stats.hits = cache.addresses.getHits();
+	// Lookups answered by the negative cache missed the positive one first.
+	stats.negativeHits = cache.invalidAddresses.getHits();
+	stats.misses = cache.addresses.getMisses() - stats.negativeHits;
+	stats.evictions = cache.addresses.getEvictions();
+	return stats;
 }
 
 bool Address::isValid() const {
@@ -152,7 +152,18 @@ public:
 	}
 	void setImpl(SalAddress *value);
 	void setImpl(const SalAddress *value);
+	// Parsed addresses are cached per thread: these only apply to the cache of the calling thread.
+	struct SipAddressesCacheStats {
+		int size = 0;
+		int capacity = 0;
+		int negativeSize = 0;
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;
+		unsigned long long negativeHits = 0;
+		unsigned long long evictions = 0;
+	};
 	static void clearSipAddressesCache();
+	static SipAddressesCacheStats getSipAddressesCacheStats();
 	struct WeakLess {
 		bool operator()(const Address &address1, const Address &address2) const {
 			return address1 < address2;
@@ -176,7 +187,8 @@ private:
 	};
 	static void removeFromLeakDetector(SalAddress *addr);
 
-	static std::unordered_map<std::string, std::unique_ptr<SalAddress, SalAddressDeleter>> sAddressCache;
+	struct SalAddressCache;
+	static SalAddressCache &getSalAddressCache();
 };
 
 inline std::ostream &operator<<(std::ostream &os, const Address &address) {
@@ -54,34 +54,68 @@ void Buffer::setUserData(void *ud) {
 }
 
 const vector<uint8_t> &Buffer::getContent() const {
+	detachView();
 	return mContent;
 }
 
 void Buffer::setContent(const vector<uint8_t> &content) {
+	mViewData = nullptr;
+	mViewSize = 0;
 	if (!mContent.empty()) mContent.clear();
 	mContent = content;
 }
 
 const string &Buffer::getStringContent() const {
-	mStringContent = string(mContent.begin(), mContent.end());
+	const uint8_t *data = getData();
+	mStringContent = string(data, data + getSize());
 	return mStringContent;
 }
 
 void Buffer::setStringContent(const string &content) {
+	mViewData = nullptr;
+	mViewSize = 0;
 	if (!mContent.empty()) mContent.clear();
 	mContent = vector<uint8_t>(content.begin(), content.end());
 }
 
 size_t Buffer::getSize() const {
-	return mContent.size();
+	return mViewData ? mViewSize : mContent.size();
 }
 
 void Buffer::setSize(size_t size) {
+	detachView();
 	mContent.resize(size);
 }
 
 bool_t Buffer::isEmpty() const {
-	return mContent.empty();
+	return getSize() == 0;
+}
+
+const uint8_t *Buffer::getData() const {
+	return mViewData ? mViewData : mContent.data();
+}
+
+void Buffer::setView(const uint8_t *data, size_t size) {
+	mContent.clear();
+	mViewData = data;
+	mViewSize = size;
+}
+
+void Buffer::releaseView() {
+	if (!mViewData) return;
+	if (getRefCount() > 1) {
+		detachView();
+	} else {
+		mViewData = nullptr;
+		mViewSize = 0;
+	}
+}
+
+void Buffer::detachView() const {
+	if (!mViewData) return;
+	mContent.assign(mViewData, mViewData + mViewSize);
+	mViewData = nullptr;
+	mViewSize = 0;
 }
 
 LINPHONE_END_NAMESPACE
\ No newline at end of file
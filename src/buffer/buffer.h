@@ -54,10 +54,25 @@ public:
 
 	bool_t isEmpty() const;
 
+	// Raw data of the buffer, whether it is owned or viewed.
+	const uint8_t *getData() const;
+
+	/*
+	 * Make the buffer a non-owning view of some data instead of copying it. The data must stay valid until
+	 * releaseView() is called, or until the content of the buffer is changed.
+	 */
+	void setView(const uint8_t *data, size_t size);
+	// Stop viewing the data, copying it only if someone else still holds a reference to the buffer.
+	void releaseView();
+
 private:
+	void detachView() const;
+
 	void *mUserData;
-	std::vector<uint8_t> mContent;
+	mutable std::vector<uint8_t> mContent;
 	mutable std::string mStringContent;
+	mutable const uint8_t *mViewData = nullptr;
+	mutable size_t mViewSize = 0;
 };
 
 LINPHONE_END_NAMESPACE
@@ -57,7 +57,7 @@ void linphone_buffer_set_user_data(LinphoneBuffer *buffer, void *user_data) {
 }
 
 const uint8_t *linphone_buffer_get_content(const LinphoneBuffer *buffer) {
-	return Buffer::toCpp(buffer)->getContent().data();
+	return Buffer::toCpp(buffer)->getData();
 }
 
 void linphone_buffer_set_content(LinphoneBuffer *buffer, const uint8_t *content, size_t size) {
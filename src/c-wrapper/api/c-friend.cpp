@@ -808,6 +808,7 @@ LinphoneFriend *linphone_core_find_friend_by_phone_number(const LinphoneCore *lc
 	for (elem = accounts; elem != NULL; elem = bctbx_list_next(elem)) {
 		account = (LinphoneAccount *)bctbx_list_get_data(elem);
 		char *normalized_phone_number = linphone_account_normalize_phone_number(account, phoneNumber);
+		if (!normalized_phone_number) continue;
 
 		bctbx_list_t *lists = lc->friends_lists;
 		LinphoneFriend *lf = NULL;
@@ -21,6 +21,8 @@
 #ifndef _L_CHAT_MESSAGE_P_H_
 #define _L_CHAT_MESSAGE_P_H_
 
+#include <vector>
+
 #include <belle-sip/types.h>
 
 #include "chat/chat-message/chat-message.h"
@@ -39,6 +41,7 @@
 LINPHONE_BEGIN_NAMESPACE
 
 class AbstractChatRoom;
+class Participant;
 
 class ChatMessagePrivate : public ObjectPrivate {
 	friend class CpimChatMessageModifier;
@@ -74,6 +77,27 @@ public:
 	                         time_t stateChangeTime,
 	                         LinphoneReason reason = LinphoneReasonNone);
 
+	// A participant state change split in the steps around its database update, so that the updates of several
+	// messages can be stored in a single transaction (see Imdn::parse()).
+	struct ParticipantStateChange {
+		std::shared_ptr<Address> participantAddress;
+		ChatMessage::State newState = ChatMessage::State::Idle;
+		time_t stateChangeTime = 0;
+		LinphoneReason reason = LinphoneReasonNone;
+		std::shared_ptr<EventLog> eventLog;
+		bool isMe = false;
+		// Whether the participant state is stored and the message state computed from the participant states.
+		bool isStored = false;
+	};
+	// Returns false if the change is rejected or already fully applied.
+	bool beginParticipantStateChange(const std::shared_ptr<Address> &participantAddress,
+	                                 ChatMessage::State newState,
+	                                 time_t stateChangeTime,
+	                                 LinphoneReason reason,
+	                                 ParticipantStateChange &change);
+	// To be called once the participant state of a stored change is in the database.
+	void endParticipantStateChange(const ParticipantStateChange &change);
+
 	void forceState(ChatMessage::State newState) {
 		state = newState;
 	}
@@ -250,6 +274,17 @@ public:
 
 	static bool isImdnControlledState(ChatMessage::State state);
 
+	// Number of participants in each IMDN controlled state, the sender being left out of the recipients.
+	struct ImdnStateCounts {
+		size_t nbRecipients = 0;
+		size_t nbDisplayedStates = 0;
+		size_t nbDeliveredStates = 0;
+		size_t nbDeliveredToUserStates = 0;
+		size_t nbNotDeliveredStates = 0;
+	};
+	ImdnStateCounts getImdnStateCounts(const std::shared_ptr<EventLog> &eventLog) const;
+	bool getImdnStateCountsFromDbCounters(const std::shared_ptr<EventLog> &eventLog, ImdnStateCounts &counts) const;
+
 	void restoreFileTransferContentAsFileContent();
 
 	void setAutomaticallyResent(bool enable);
@@ -328,6 +363,10 @@ private:
 	mutable bool contentsNotLoadedFromDatabase = false;
 	bool isInAggregationQueue = false;
 
+	// Participants of the chat room, as they were when they were all found to have a state in database. The state
+	// counters of the message can't be trusted for another participant set.
+	mutable std::vector<std::weak_ptr<Participant>> participantsWithDbState;
+
 	std::list<std::shared_ptr<ChatMessageListener>> listeners;
 
 	L_DECLARE_PUBLIC(ChatMessage);
@@ -18,6 +18,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "address/address.h"
 #include "c-wrapper/c-wrapper.h"
 #include "call/call.h"
@@ -155,14 +157,145 @@ bool ChatMessagePrivate::isMarkedAsRead() const {
 	return markedAsRead;
 }
 
+ChatMessagePrivate::ImdnStateCounts ChatMessagePrivate::getImdnStateCounts(const shared_ptr<EventLog> &eventLog) const {
+	L_Q();
+	ImdnStateCounts counts;
+	if (getImdnStateCountsFromDbCounters(eventLog, counts)) return counts;
+
+	const auto imdnStates = q->getParticipantsState();
+	for (const auto &imdnState : imdnStates) {
+		const auto &participantState = imdnState.getState();
+		const auto &imdnParticipant = imdnState.getParticipant();
+		if (fromAddress->weakEqual(*(imdnParticipant->getAddress()))) {
+			if (participantState == ChatMessage::State::NotDelivered) {
+				counts.nbNotDeliveredStates++;
+			}
+		} else {
+			counts.nbRecipients++;
+			switch (participantState) {
+				case ChatMessage::State::Displayed:
+					counts.nbDisplayedStates++;
+					break;
+				case ChatMessage::State::DeliveredToUser:
+					counts.nbDeliveredToUserStates++;
+					break;
+				case ChatMessage::State::Delivered:
+					counts.nbDeliveredStates++;
+					break;
+				case ChatMessage::State::NotDelivered:
+					counts.nbNotDeliveredStates++;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	return counts;
+}
+
+bool ChatMessagePrivate::getImdnStateCountsFromDbCounters(const shared_ptr<EventLog> &eventLog,
+                                                          ImdnStateCounts &counts) const {
+	L_Q();
+	if (!eventLog) return false;
+	const auto &chatRoom = q->getChatRoom();
+	if (!chatRoom) return false;
+
+	unique_ptr<MainDb> &mainDb = chatRoom->getCore()->getPrivate()->mainDb;
+	const auto stateCounts = mainDb->getChatMessageParticipantStateCounts(eventLog);
+	size_t nbStates = 0;
+	for (const auto &stateCount : stateCounts)
+		nbStates += size_t(max(stateCount.second, 0));
+
+	// getParticipantsState() ignores the states of the participants that have left the chat room. The counters can
+	// only be used as long as the states are those of the current participants, otherwise all the states have to be
+	// read.
+	const auto &me = chatRoom->getMe();
+	ChatMessage::State meState = ChatMessage::State::Idle;
+	const auto meAddress = Address::create(me->getAddress()->getUriWithoutGruu());
+	const bool hasMeState = mainDb->findChatMessageParticipantState(eventLog, meAddress, meState);
+	const auto &participants = chatRoom->getParticipants();
+	if (nbStates != participants.size() + (hasMeState ? 1 : 0)) return false;
+
+	// Equal counts don't mean equal sets, e.g. after a participant has been replaced. Once every participant is known
+	// to have a state, states are only ever added, so the check above is enough until the participants change.
+	auto sameParticipant = [](const weak_ptr<Participant> &checked, const shared_ptr<Participant> &participant) {
+		return !checked.owner_before(participant) && !participant.owner_before(checked);
+	};
+	if ((participantsWithDbState.size() != participants.size()) ||
+	    !equal(participantsWithDbState.cbegin(), participantsWithDbState.cend(), participants.cbegin(),
+	           sameParticipant)) {
+		participantsWithDbState.clear();
+		list<shared_ptr<Address>> participantAddresses;
+		for (const auto &participant : participants)
+			participantAddresses.push_back(Address::create(participant->getAddress()->getUriWithoutGruu()));
+		if (mainDb->countChatMessageParticipantStates(eventLog, participantAddresses) != participants.size())
+			return false;
+		participantsWithDbState.assign(participants.cbegin(), participants.cend());
+	}
+
+	auto getCount = [&stateCounts](ChatMessage::State state) -> size_t {
+		const auto it = stateCounts.find(state);
+		return (it == stateCounts.cend()) ? 0 : size_t(max(it->second, 0));
+	};
+	counts.nbRecipients = nbStates;
+	counts.nbDisplayedStates = getCount(ChatMessage::State::Displayed);
+	counts.nbDeliveredStates = getCount(ChatMessage::State::Delivered);
+	counts.nbDeliveredToUserStates = getCount(ChatMessage::State::DeliveredToUser);
+	counts.nbNotDeliveredStates = getCount(ChatMessage::State::NotDelivered);
+
+	// The sender isn't a recipient, only its NotDelivered state matters.
+	ChatMessage::State senderState = ChatMessage::State::Idle;
+	bool hasSenderState;
+	if (fromAddress->weakEqual(*me->getAddress())) {
+		hasSenderState = hasMeState;
+		senderState = meState;
+	} else {
+		const auto senderAddress = Address::create(fromAddress->getUriWithoutGruu());
+		hasSenderState = mainDb->findChatMessageParticipantState(eventLog, senderAddress, senderState);
+	}
+	if (hasSenderState) {
+		counts.nbRecipients--;
+		switch (senderState) {
+			case ChatMessage::State::Displayed:
+				counts.nbDisplayedStates--;
+				break;
+			case ChatMessage::State::DeliveredToUser:
+				counts.nbDeliveredToUserStates--;
+				break;
+			case ChatMessage::State::Delivered:
+				counts.nbDeliveredStates--;
+				break;
+			default:
+				break;
+		}
+	}
+	return true;
+}
+
 void ChatMessagePrivate::setParticipantState(const std::shared_ptr<Address> &participantAddress,
                                              ChatMessage::State newState,
                                              time_t stateChangeTime,
                                              LinphoneReason reason) {
+	ParticipantStateChange change;
+	if (!beginParticipantStateChange(participantAddress, newState, stateChangeTime, reason, change)) return;
+
+	if (change.isStored && change.eventLog) {
+		L_Q();
+		q->getCore()->getPrivate()->mainDb->setChatMessageParticipantState(change.eventLog, participantAddress,
+		                                                                   newState, stateChangeTime);
+	}
+	endParticipantStateChange(change);
+}
+
+bool ChatMessagePrivate::beginParticipantStateChange(const std::shared_ptr<Address> &participantAddress,
+                                                     ChatMessage::State newState,
+                                                     time_t stateChangeTime,
+                                                     LinphoneReason reason,
+                                                     ParticipantStateChange &change) {
 	L_Q();
 
 	const auto &chatRoom = dynamic_pointer_cast<ChatRoom>(q->getChatRoom());
-	if (!chatRoom) return;
+	if (!chatRoom) return false;
 
 	const shared_ptr<ChatMessage> &sharedMessage = q->getSharedFromThis();
 	const bool isBasicChatRoom =
@@ -181,7 +314,7 @@ void ChatMessagePrivate::setParticipantState(const std::shared_ptr<Address> &par
 			           << *participantAddress << " from state " << Utils::toString(currentState) << " to state "
 			           << Utils::toString(newState);
 		}
-		return;
+		return false;
 	}
 
 	lDebug() << "Chat message " << sharedMessage << " of chat room " << chatRoom << " (" << conferenceAddressStr
@@ -215,66 +348,58 @@ void ChatMessagePrivate::setParticipantState(const std::shared_ptr<Address> &par
 		if (newState == ChatMessage::State::NotDelivered) {
 			setState(newState);
 		}
-		return;
+		return false;
 	}
 
 	// Participant states are not supported
 	if (isBasicChatRoom) {
 		setState(newState);
-		return;
+		return false;
 	}
 
+	change.participantAddress = participantAddress;
+	change.newState = newState;
+	change.stateChangeTime = stateChangeTime;
+	change.reason = reason;
+	change.eventLog = eventLog;
+	change.isMe = isMe;
+
 	if (linphone_config_get_bool(linphone_core_get_config(chatRoom->getCore()->getCCore()), "misc",
 	                             "enable_simple_group_chat_message_state", FALSE)) {
 		setState(newState);
+		change.isStored = false;
 	} else {
 		lInfo() << "Chat message " << sharedMessage << ": moving participant '" << *participantAddress << "' state to "
 		        << Utils::toString(newState);
-		if (eventLog) {
-			mainDb->setChatMessageParticipantState(eventLog, participantAddress, newState, stateChangeTime);
-		}
+		change.isStored = true;
+	}
+	return true;
+}
+
+void ChatMessagePrivate::endParticipantStateChange(const ParticipantStateChange &change) {
+	L_Q();
+
+	const auto &chatRoom = dynamic_pointer_cast<ChatRoom>(q->getChatRoom());
+	if (!chatRoom) return;
 
+	const shared_ptr<ChatMessage> &sharedMessage = q->getSharedFromThis();
+	const auto &participantAddress = change.participantAddress;
+	const ChatMessage::State newState = change.newState;
+	const bool isMe = change.isMe;
+
+	if (change.isStored) {
 		// Update chat message state if it doesn't depend on IMDN
 		if (isMe && !isImdnControlledState(newState)) {
 			setState(newState);
 		}
 
 		if (isImdnControlledState(newState)) {
-			const auto imdnStates = q->getParticipantsState();
-			size_t nbRecipients = 0;
-			size_t nbDisplayedStates = 0;
-			size_t nbDeliveredStates = 0;
-			size_t nbDeliveredToUserStates = 0;
-			size_t nbNotDeliveredStates = 0;
-			for (const auto &imdnState : imdnStates) {
-				const auto &participantState = imdnState.getState();
-				const auto &imdnParticipant = imdnState.getParticipant();
-				if (fromAddress->weakEqual(*(imdnParticipant->getAddress()))) {
-					if (participantState == ChatMessage::State::NotDelivered) {
-						nbNotDeliveredStates++;
-					}
-				} else {
-					nbRecipients++;
-					switch (participantState) {
-						case ChatMessage::State::Displayed:
-							nbDisplayedStates++;
-							break;
-						case ChatMessage::State::DeliveredToUser:
-							nbDeliveredToUserStates++;
-							break;
-						case ChatMessage::State::Delivered:
-							nbDeliveredStates++;
-							break;
-						case ChatMessage::State::NotDelivered:
-							nbNotDeliveredStates++;
-							break;
-						default:
-							break;
-					}
-				}
-			}
-
-			if (nbNotDeliveredStates > 0) {
+			const auto counts = getImdnStateCounts(change.eventLog);
+			const size_t nbRecipients = counts.nbRecipients;
+			const size_t nbDisplayedStates = counts.nbDisplayedStates;
+			const size_t nbDeliveredToUserStates = counts.nbDeliveredToUserStates;
+			const size_t nbDeliveredStates = counts.nbDeliveredStates;
+			if (counts.nbNotDeliveredStates > 0) {
 				setState(ChatMessage::State::NotDelivered);
 			} else if ((nbRecipients > 0) && (nbDisplayedStates == nbRecipients)) {
 				setState(ChatMessage::State::Displayed);
@@ -292,7 +417,7 @@ void ChatMessagePrivate::setParticipantState(const std::shared_ptr<Address> &par
 			if (fromAddress->weakEqual(*participantAddress) && (newState == ChatMessage::State::DeliveredToUser)) {
 				setParticipantState(participantAddress, ChatMessage::State::Displayed, ::ms_time(nullptr));
 			}
-			if ((newState == ChatMessage::State::NotDelivered) && (reason == LinphoneReasonForbidden)) {
+			if ((newState == ChatMessage::State::NotDelivered) && (change.reason == LinphoneReasonForbidden)) {
 				// Try to recover from a situation where the server replied 403 to an outgoing message
 				chatRoom->handleMessageRejected(sharedMessage);
 			}
@@ -302,8 +427,8 @@ void ChatMessagePrivate::setParticipantState(const std::shared_ptr<Address> &par
 	// Once the participant and IMDN state are updated, it is possible to notify the application
 	LinphoneChatMessage *msg = L_GET_C_BACK_PTR(q);
 	LinphoneChatRoom *cr = chatRoom->toC();
-	auto participant = isMe ? me : chatRoom->findParticipant(participantAddress);
-	ParticipantImdnState imdnState(participant, newState, stateChangeTime);
+	auto participant = isMe ? chatRoom->getMe() : chatRoom->findParticipant(participantAddress);
+	ParticipantImdnState imdnState(participant, newState, change.stateChangeTime);
 
 	// Legacy callbacks, deprecated !
 	LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
@@ -2107,6 +2232,8 @@ bool ChatMessage::downloadTerminated() {
 	L_D();
 	bool ret = false;
 	if (contentsToDownload.empty()) {
+		// Wait for the downloads running alongside the one that just ended.
+		if (d->fileTransferChatMessageModifier.isAnyFileTransferInProgress()) return ret;
 		if (d->isAutoFileTransferDownloadInProgress()) {
 			d->doNotRetryAutoDownload();
 			d->endMessageReception();
@@ -2122,14 +2249,14 @@ bool ChatMessage::downloadTerminated() {
 
 bool ChatMessage::isFileTransferInProgress() const {
 	L_D();
-	return d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid();
+	return d->fileTransferChatMessageModifier.isAnyFileTransferInProgress();
 }
 
 void ChatMessage::cancelFileTransfer() {
 	L_D();
-	if (d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid()) {
+	if (d->fileTransferChatMessageModifier.isAnyFileTransferInProgress()) {
 		lWarning() << "Canceling file transfer on message [" << getSharedFromThis() << "]";
-		d->fileTransferChatMessageModifier.cancelFileTransfer();
+		d->fileTransferChatMessageModifier.cancelFileTransfers();
 		lInfo() << "File transfer on message [" << getSharedFromThis() << "] has been cancelled";
 
 		if (d->state == State::FileTransferInProgress) {
@@ -2201,7 +2328,7 @@ int ChatMessage::putCharacter(uint32_t character) {
 
 void ChatMessage::fileUploadEndBackgroundTask() {
 	L_D();
-	d->fileTransferChatMessageModifier.fileUploadEndBackgroundTask();
+	d->fileTransferChatMessageModifier.fileUploadEndBackgroundTasks();
 }
 
 void ChatMessage::addListener(shared_ptr<ChatMessageListener> listener) {
@@ -233,7 +233,15 @@ std::list<std::shared_ptr<ChatMessage>> ChatRoom::getTransientChatMessages() {
 }
 
 void ChatRoom::setIsEmpty(const bool empty) {
+	if (mEmpty == empty) return;
 	mEmpty = empty;
+	getCore()->updateChatRoomListPosition(getSharedFromThis());
+}
+
+void ChatRoom::setLastUpdateTime(time_t lastUpdateTime) {
+	if (this->lastUpdateTime == lastUpdateTime) return;
+	this->lastUpdateTime = lastUpdateTime;
+	getCore()->updateChatRoomListPosition(getSharedFromThis());
 }
 
 void ChatRoom::realtimeTextReceived(uint32_t character, const shared_ptr<Call> &call) {
@@ -157,9 +157,7 @@ public:
 		this->creationTime = creationTime;
 	}
 
-	inline void setLastUpdateTime(time_t lastUpdateTime) override {
-		this->lastUpdateTime = lastUpdateTime;
-	}
+	void setLastUpdateTime(time_t lastUpdateTime) override;
 
 	void sendChatMessage(const std::shared_ptr<ChatMessage> &chatMessage) override;
 	void onChatMessageSent(const std::shared_ptr<ChatMessage> &chatMessage) override;
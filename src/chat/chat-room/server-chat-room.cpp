@@ -22,6 +22,8 @@
 
 #include <bctoolbox/defs.h>
 
+#include "bctoolbox/utils.hh"
+
 #include "address/address.h"
 #include "c-wrapper/c-wrapper.h"
 #include "c-wrapper/internal/c-tools.h"
@@ -42,8 +44,11 @@
 #include "linphone/api/c-chat-room-cbs.h"
 #include "linphone/api/c-chat-room.h"
 #include "linphone/api/c-types.h"
+#include "linphone/utils/utils.h"
 #include "linphone/wrapper_utils.h"
 #include "logger/logger.h"
+#include "private.h"
+#include "sal/message-op.h"
 #include "sal/refer-op.h"
 #include "server-chat-room.h"
 #include "sip-tools/sip-headers.h"
@@ -324,38 +329,156 @@ bool ServerChatRoom::isReadOnly() const {
 	return false;
 }
 
+void ServerChatRoom::loadQueuedMessages() {
+	if (mQueuedMessagesLoaded) return;
+	mQueuedMessagesLoaded = true;
+
+	const auto &mainDb = getCore()->getPrivate()->mainDb;
+	if (!mainDb || !mainDb->isInitialized()) return;
+	const auto &chatRoomAddress = getConference()->getConferenceAddress();
+	mQueueCursors = mainDb->getServerChatRoomQueueCursors(chatRoomAddress);
+	mStoredQueueCursors = mQueueCursors;
+	if (mQueueCursors.empty()) return;
+
+	// Only the messages that are not yet dispatched to all the devices are needed.
+	long long firstCursor = mQueueCursors.cbegin()->second;
+	for (const auto &cursor : mQueueCursors)
+		firstCursor = min(firstCursor, cursor.second);
+	for (const auto &queuedMessage : mainDb->getServerChatRoomQueuedMessages(chatRoomAddress, firstCursor)) {
+		SalCustomHeader *headers = nullptr;
+		for (const auto &line : bctoolbox::Utils::split(queuedMessage.headers, "\r\n")) {
+			size_t colon = line.find(':');
+			if (colon == string::npos) continue;
+			headers = sal_custom_header_append(headers, line.substr(0, colon).c_str(),
+			                                   Utils::trim(line.substr(colon + 1)).c_str());
+		}
+		auto msg = createMessage(queuedMessage.fromAddress, ContentType(queuedMessage.contentType), queuedMessage.body,
+		                         headers);
+		if (headers) sal_custom_header_free(headers);
+		msg->timestamp = chrono::system_clock::from_time_t(queuedMessage.creationTime);
+		mQueuedMessages.emplace(queuedMessage.id, msg);
+		mLastQueuedMessageId = max(mLastQueuedMessageId, queuedMessage.id);
+	}
+	lInfo() << this << ": restored " << mQueuedMessages.size() << " queued message(s) for " << mQueueCursors.size()
+	        << " device(s)";
+}
+
 void ServerChatRoom::queueMessage(const shared_ptr<ServerChatRoom::Message> &msg) {
+	loadQueuedMessages();
+
+	// Queue the message for all devices except the one that sent it. The devices that are already waiting for
+	// messages will get it from their cursor.
+	bool hasRecipients = false;
+	list<shared_ptr<Address>> newRecipients;
 	for (const auto &participant : getParticipants()) {
 		for (const auto &device : participant->getDevices()) {
-			// Queue the message for all devices except the one that sent it
-			if (*msg->fromAddr != *device->getAddress()) {
-				queueMessage(msg, device->getAddress());
-			}
+			const auto &deviceAddress = device->getAddress();
+			if (*msg->fromAddr == *deviceAddress) continue;
+			hasRecipients = true;
+			if (mQueueCursors.find(deviceAddress->toStringUriOnlyOrdered()) == mQueueCursors.cend())
+				newRecipients.push_back(deviceAddress);
 		}
 	}
+	if (!hasRecipients) return;
+
+	long long messageId = -1;
+	const auto &mainDb = getCore()->getPrivate()->mainDb;
+	if (mainDb && mainDb->isInitialized()) {
+		MainDb::ServerChatRoomQueuedMessage queuedMessage;
+		queuedMessage.fromAddress = msg->fromAddr->toString();
+		queuedMessage.contentType = msg->content.getContentType().getMediaType();
+		queuedMessage.body = msg->content.getBodyAsUtf8String();
+		queuedMessage.headers = serializeMessageHeaders(msg);
+		queuedMessage.creationTime = chrono::system_clock::to_time_t(msg->timestamp);
+		const auto &chatRoomAddress = getConference()->getConferenceAddress();
+		messageId = mainDb->insertServerChatRoomQueuedMessage(chatRoomAddress, queuedMessage, newRecipients);
+		if (messageId < 0) lError() << this << ": unable to store queued message, it will not survive a restart";
+		else {
+			for (const auto &recipient : newRecipients)
+				mStoredQueueCursors[recipient->toStringUriOnlyOrdered()] = messageId - 1;
+		}
+	}
+	// Without database, the messages are only queued in memory.
+	if (messageId <= mLastQueuedMessageId) messageId = mLastQueuedMessageId + 1;
+	mLastQueuedMessageId = messageId;
+
+	mQueuedMessages.emplace(messageId, msg);
+	for (const auto &recipient : newRecipients)
+		mQueueCursors.emplace(recipient->toStringUriOnlyOrdered(), messageId - 1);
 }
 
-void ServerChatRoom::queueMessage(const shared_ptr<ServerChatRoom::Message> &msg,
-                                  const std::shared_ptr<Address> &deviceAddress) {
-	chrono::system_clock::time_point timestamp = chrono::system_clock::now();
-	string uri(deviceAddress->toString());
-	// Remove queued messages older than one week
-	while (!mQueuedMessages[uri].empty()) {
-		shared_ptr<ServerChatRoom::Message> m = mQueuedMessages[uri].front();
-		chrono::hours age = chrono::duration_cast<chrono::hours>(timestamp - m->timestamp);
-		chrono::hours oneWeek(168);
-		if (age < oneWeek) break;
-		mQueuedMessages[uri].pop();
+void ServerChatRoom::saveQueueCursors() {
+	const auto &mainDb = getCore()->getPrivate()->mainDb;
+	if (!mainDb || !mainDb->isInitialized()) return;
+
+	map<string, long long> movedCursors;
+	for (const auto &cursor : mQueueCursors) {
+		auto storedIt = mStoredQueueCursors.find(cursor.first);
+		if ((storedIt == mStoredQueueCursors.cend()) || (storedIt->second != cursor.second))
+			movedCursors.insert(cursor);
+	}
+	list<string> removedDevices;
+	for (const auto &cursor : mStoredQueueCursors) {
+		if (mQueueCursors.find(cursor.first) == mQueueCursors.cend()) removedDevices.push_back(cursor.first);
 	}
-	mQueuedMessages[uri].push(msg);
+	if (movedCursors.empty() && removedDevices.empty()) return;
+
+	// All the cursors of a dispatch are written at once.
+	if (mainDb->updateServerChatRoomQueueCursors(getConference()->getConferenceAddress(), movedCursors, removedDevices))
+		mStoredQueueCursors = mQueueCursors;
 }
 
 void ServerChatRoom::removeQueuedParticipantMessages(const shared_ptr<Participant> &participant) {
-	if (participant) mQueuedMessages.erase(participant->getAddress()->toString());
+	if (!participant) return;
+	loadQueuedMessages();
+	// The cursors are kept by device, and the devices of the participant may already be gone.
+	const auto &address = participant->getAddress();
+	bool removed = false;
+	for (auto it = mQueueCursors.begin(); it != mQueueCursors.end();) {
+		if (Address(it->first).getUriWithoutGruu().weakEqual(*address)) {
+			it = mQueueCursors.erase(it);
+			removed = true;
+		} else ++it;
+	}
+	if (!removed) return;
+	saveQueueCursors();
+	forgetDispatchedQueuedMessages();
+}
+
+void ServerChatRoom::forgetDispatchedQueuedMessages() {
+	long long firstCursor = mLastQueuedMessageId;
+	for (const auto &cursor : mQueueCursors)
+		firstCursor = min(firstCursor, cursor.second);
+	mQueuedMessages.erase(mQueuedMessages.begin(), mQueuedMessages.upper_bound(firstCursor));
+}
+
+void ServerChatRoom::sweepQueuedMessages(time_t createdBeforeThisTime) {
+	// Messages that were never loaded are swept from the database by the core.
+	if (!mQueuedMessagesLoaded) return;
+
+	size_t nbMessages = mQueuedMessages.size();
+	forgetDispatchedQueuedMessages();
+	for (auto it = mQueuedMessages.begin(); it != mQueuedMessages.end();) {
+		const time_t creationTime = chrono::system_clock::to_time_t(it->second->timestamp);
+		if (creationTime < createdBeforeThisTime) it = mQueuedMessages.erase(it);
+		else ++it;
+	}
+	if (mQueuedMessages.empty()) {
+		// The core removes the cursors of the chat rooms without messages from the database.
+		mQueueCursors.clear();
+		mStoredQueueCursors.clear();
+	}
+	if (nbMessages != mQueuedMessages.size())
+		lInfo() << this << ": swept " << (nbMessages - mQueuedMessages.size()) << " queued message(s)";
 }
 
 void ServerChatRoom::sendMessage(BCTBX_UNUSED(const shared_ptr<ServerChatRoom::Message> &message),
                                  BCTBX_UNUSED(const std::shared_ptr<Address> &deviceAddr)) {
+	if (canRelayMessage(message)) {
+		relayMessage(message, deviceAddr);
+		return;
+	}
+
 	shared_ptr<ChatMessage> msg = createChatMessage();
 	copyMessageHeaders(message, msg);
 	// Special custom header to identify MESSAGE that belong to server group chatroom
@@ -378,6 +501,39 @@ void ServerChatRoom::sendMessage(BCTBX_UNUSED(const shared_ptr<ServerChatRoom::M
 	msg->send();
 }
 
+bool ServerChatRoom::canRelayMessage(const shared_ptr<ServerChatRoom::Message> &message) const {
+	// Encrypted messages get a different body for each device from the LIME engine, and the messages sent before the
+	// chat room is created must be postponed by the chat message machinery.
+	return message->contentsList.empty() && !message->content.isEmpty() &&
+	       (getState() == ConferenceInterface::State::Created);
+}
+
+void ServerChatRoom::relayMessage(const shared_ptr<ServerChatRoom::Message> &message,
+                                  const shared_ptr<Address> &deviceAddr) {
+	if (!message->relayBody) {
+		// A new body handler is owned by nobody until referenced, while the one kept by a clean content is returned
+		// with a reference.
+		const bool isNew = message->content.isDirty() || !message->content.getBodyHandler();
+		SalBodyHandler *body = Content::getBodyHandlerFromContent(message->content, false);
+		message->relayBody = isNew ? sal_body_handler_ref(body) : body;
+	}
+	const bool toSameUser = (message->fromAddr->getUsername() == deviceAddr->getUsername()) &&
+	                        (message->fromAddr->getDomain() == deviceAddr->getDomain());
+	SalCustomHeader *&headers = toSameUser ? message->relayChatServiceHeaders : message->relayHeaders;
+	if (!headers) headers = createRelayHeaders(message, toSameUser);
+
+	LinphoneCore *lc = getCore()->getCCore();
+	const auto &conferenceAddress = getConference()->getConferenceAddress();
+	auto op = new SalMessageOp(lc->sal.get());
+	linphone_configure_op_2(lc, op, conferenceAddress->toC(), deviceAddr->toC(), headers,
+	                        !!linphone_config_get_int(lc->config, "sip", "chat_msg_with_contact", 0));
+	op->setFromAddress(conferenceAddress->getImpl());
+	op->setToAddress(deviceAddr->getImpl());
+	if (op->sendMessage(message->relayBody) < 0) lError() << this << ": unable to relay message to " << *deviceAddr;
+	// The response is not waited for: the transaction keeps the op alive until it terminates.
+	op->release();
+}
+
 bool ServerChatRoom::dispatchMessagesAfterFullState(BCTBX_UNUSED(const shared_ptr<CallSession> &session)) const {
 #ifdef HAVE_ADVANCED_IM
 	const auto &conference = getConference();
@@ -401,35 +557,53 @@ bool ServerChatRoom::dispatchMessagesAfterFullState(const shared_ptr<Participant
 }
 
 void ServerChatRoom::dispatchQueuedMessages() {
+	loadQueuedMessages();
+	if (mQueuedMessages.empty()) return;
+
 	for (const auto &participant : getParticipants()) {
 		/*
 		 * Dispatch messages for each device in Present state. In a one to one chatroom, if a device
 		 * is found is Left state, it must be invited first.
 		 */
 		for (const auto &device : participant->getDevices()) {
-			string uri(device->getAddress()->toString());
-			auto &msgQueue = mQueuedMessages[uri];
-
-			if (!msgQueue.empty()) {
-				if (!getCurrentParams()->isGroup() && (device->getState() == ParticipantDevice::State::Left)) {
-					// Happens only with protocol < 1.1
-					lInfo() << "There is a message to transmit to a participant in left state in a one to one "
-					           "chatroom, so inviting first.";
-					static_pointer_cast<ServerConference>(getConference())->inviteDevice(device);
-					continue;
-				}
-				if (device->getState() != ParticipantDevice::State::Present) continue;
-				size_t nbMessages = msgQueue.size();
-				lInfo() << "Conference " << *getConference()->getConferenceAddress() << ": Dispatching " << nbMessages
-				        << " queued message(s) for '" << uri << "'";
-				while (!msgQueue.empty()) {
-					shared_ptr<ServerChatRoom::Message> msg = msgQueue.front();
-					sendMessage(msg, device->getAddress());
-					msgQueue.pop();
-				}
+			const auto &deviceAddress = device->getAddress();
+			auto cursorIt = mQueueCursors.find(deviceAddress->toStringUriOnlyOrdered());
+			if (cursorIt == mQueueCursors.end()) continue;
+
+			// The messages sent by the device itself are not relayed to it.
+			auto isFromDevice = [&deviceAddress](const pair<const long long, shared_ptr<Message>> &queued) {
+				return *queued.second->fromAddr == *deviceAddress;
+			};
+			auto msgIt =
+			    find_if_not(mQueuedMessages.upper_bound(cursorIt->second), mQueuedMessages.end(), isFromDevice);
+			if (msgIt == mQueuedMessages.end()) {
+				// Nothing to send, the database cursor is moved with the other cursors of this dispatch.
+				cursorIt->second = mQueuedMessages.rbegin()->first;
+				continue;
 			}
+
+			if (!getCurrentParams()->isGroup() && (device->getState() == ParticipantDevice::State::Left)) {
+				// Happens only with protocol < 1.1
+				lInfo() << "There is a message to transmit to a participant in left state in a one to one "
+				           "chatroom, so inviting first.";
+				static_pointer_cast<ServerConference>(getConference())->inviteDevice(device);
+				continue;
+			}
+			if (device->getState() != ParticipantDevice::State::Present) continue;
+			size_t nbMessages = size_t(count_if(msgIt, mQueuedMessages.end(), [&isFromDevice](const auto &queued) {
+				return !isFromDevice(queued);
+			}));
+			lInfo() << "Conference " << *getConference()->getConferenceAddress() << ": Dispatching " << nbMessages
+			        << " queued message(s) for '" << *deviceAddress << "'";
+			long long lastMessageId = mQueuedMessages.rbegin()->first;
+			for (; msgIt != mQueuedMessages.end(); ++msgIt) {
+				if (!isFromDevice(*msgIt)) sendMessage(msgIt->second, deviceAddress);
+			}
+			cursorIt->second = lastMessageId;
 		}
 	}
+	saveQueueCursors();
+	forgetDispatchedQueuedMessages();
 }
 
 std::shared_ptr<ServerChatRoom::Message> ServerChatRoom::createMessage(const std::string &from,
@@ -439,10 +613,38 @@ std::shared_ptr<ServerChatRoom::Message> ServerChatRoom::createMessage(const std
 	return std::make_shared<ServerChatRoom::Message>(from, contentType, text, salCustomHeaders);
 }
 
+// The headers of a received message that are relayed to the devices.
+static const string RelayedHeaders[] = {"Content-Encoding", "Expires", "Priority", XFsEventIdHeader::HeaderName};
+
+SalCustomHeader *ServerChatRoom::createRelayHeaders(const shared_ptr<ServerChatRoom::Message> &message,
+                                                    bool toSameUser) {
+	SalCustomHeader *headers = nullptr;
+	for (const auto &headerName : RelayedHeaders) {
+		const char *headerValue = sal_custom_header_find(message->customHeaders, headerName.c_str());
+		if (headerValue) headers = sal_custom_header_append(headers, headerName.c_str(), headerValue);
+	}
+	// Special custom header to identify MESSAGE that belong to server group chatroom
+	headers = sal_custom_header_append(headers, "Session-mode", "true");
+	// If FROM and TO are the same user (with a different device for example, gruu is not checked), set the
+	// X-fs-message-type header to "chat-service". This lead to disabling push notification for this message.
+	if (toSameUser)
+		headers =
+		    sal_custom_header_append(headers, XFsMessageTypeHeader::HeaderName, XFsMessageTypeHeader::ChatService);
+	return headers;
+}
+
+string ServerChatRoom::serializeMessageHeaders(const shared_ptr<ServerChatRoom::Message> &message) {
+	string headers;
+	for (const auto &headerName : RelayedHeaders) {
+		const char *headerValue = sal_custom_header_find(message->customHeaders, headerName.c_str());
+		if (headerValue) headers += headerName + ": " + headerValue + "\r\n";
+	}
+	return headers;
+}
+
 void ServerChatRoom::copyMessageHeaders(const shared_ptr<ServerChatRoom::Message> &fromMessage,
                                         const shared_ptr<ChatMessage> &toMessage) {
-	static const string headersToCopy[] = {"Content-Encoding", "Expires", "Priority", XFsEventIdHeader::HeaderName};
-	for (const auto &headerName : headersToCopy) {
+	for (const auto &headerName : RelayedHeaders) {
 		const char *headerValue = sal_custom_header_find(fromMessage->customHeaders, headerName.c_str());
 		if (headerValue) toMessage->getPrivate()->addSalCustomHeader(headerName, headerValue);
 	}
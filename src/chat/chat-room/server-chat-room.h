@@ -24,12 +24,17 @@
 #include "chat/chat-room/chat-room.h"
 #include "conference/server-conference.h"
 
+namespace LinphoneTest {
+class ServerChatRoomTester;
+} // namespace LinphoneTest
+
 LINPHONE_BEGIN_NAMESPACE
 
 class SalCallOp;
 
-class ServerChatRoom : public ChatRoom {
+class LINPHONE_PUBLIC ServerChatRoom : public ChatRoom {
 	friend ServerConference;
+	friend class LinphoneTest::ServerChatRoomTester;
 
 public:
 	struct RegistrationSubscriptionContext {
@@ -65,6 +70,9 @@ public:
 
 		~Message() {
 			if (customHeaders) sal_custom_header_free(customHeaders);
+			if (relayBody) sal_body_handler_unref(relayBody);
+			if (relayHeaders) sal_custom_header_free(relayHeaders);
+			if (relayChatServiceHeaders) sal_custom_header_free(relayChatServiceHeaders);
 		}
 
 		std::shared_ptr<Address> fromAddr;
@@ -72,6 +80,12 @@ public:
 		std::list<Content> contentsList;
 		std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
 		SalCustomHeader *customHeaders = nullptr;
+
+		// Template of the requests relaying the message to the devices, built on the first relay and shared by all
+		// the following ones.
+		SalBodyHandler *relayBody = nullptr;
+		SalCustomHeader *relayHeaders = nullptr;
+		SalCustomHeader *relayChatServiceHeaders = nullptr;
 	};
 
 	ServerChatRoom(const std::shared_ptr<Core> &core, const std::shared_ptr<Conference> &conf);
@@ -110,6 +124,8 @@ public:
 	bool dispatchMessagesAfterFullState(const std::shared_ptr<ParticipantDevice> &device) const;
 	bool dispatchMessagesAfterFullState(const std::shared_ptr<CallSession> &session) const;
 	void dispatchQueuedMessages();
+	// Forget the queued messages created before the given time and those dispatched to all the devices.
+	void sweepQueuedMessages(time_t createdBeforeThisTime);
 	static std::shared_ptr<Message> createMessage(const std::string &from,
 	                                              const ContentType &contentType,
 	                                              const std::string &text,
@@ -148,7 +164,15 @@ public:
 	void setConferenceAddress(const std::shared_ptr<Address> &conferenceAddress);
 
 private:
-	std::unordered_map<std::string, std::queue<std::shared_ptr<Message>>> mQueuedMessages;
+	// Messages waiting to be dispatched, by queue id. They are stored in the database so that they survive a restart
+	// of the server, and each message is kept once for all the devices it is queued for.
+	std::map<long long, std::shared_ptr<Message>> mQueuedMessages;
+	// Id of the last queued message dispatched to each device, by device address.
+	std::map<std::string, long long> mQueueCursors;
+	// Cursors as they are stored in the database, to write only those that moved.
+	std::map<std::string, long long> mStoredQueueCursors;
+	long long mLastQueuedMessageId = 0;
+	bool mQueuedMessagesLoaded = false;
 	int mUnnotifiedRegistrationSubscriptions = 0; /*count of not-yet notified registration subscriptions*/
 
 	std::map<std::string, RegistrationSubscriptionContext>
@@ -167,13 +191,19 @@ private:
 	void updateProtocolVersionFromDevice(const std::shared_ptr<ParticipantDevice> &device);
 
 	void sendMessage(const std::shared_ptr<Message> &message, const std::shared_ptr<Address> &deviceAddr);
+	bool canRelayMessage(const std::shared_ptr<Message> &message) const;
+	void relayMessage(const std::shared_ptr<Message> &message, const std::shared_ptr<Address> &deviceAddr);
+	void loadQueuedMessages();
 	void queueMessage(const std::shared_ptr<Message> &message);
-	void queueMessage(const std::shared_ptr<Message> &msg, const std::shared_ptr<Address> &deviceAddress);
+	void saveQueueCursors();
+	void forgetDispatchedQueuedMessages();
 	void removeQueuedParticipantMessages(const std::shared_ptr<Participant> &participant);
 
 	void setEphemeralLifetimeForDevice(long time, const std::shared_ptr<CallSession> &session);
 	void setEphemeralModeForDevice(AbstractChatRoom::EphemeralMode mode, const std::shared_ptr<CallSession> &session);
 
+	static SalCustomHeader *createRelayHeaders(const std::shared_ptr<Message> &message, bool toSameUser);
+	static std::string serializeMessageHeaders(const std::shared_ptr<Message> &message);
 	static void copyMessageHeaders(const std::shared_ptr<Message> &fromMessage,
 	                               const std::shared_ptr<ChatMessage> &toMessage);
 
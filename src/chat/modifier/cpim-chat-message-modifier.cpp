@@ -160,7 +160,7 @@ ChatMessageModifier::Result CpimChatMessageModifier::encode(const shared_ptr<Cha
 		content = message->getContents().front().get();
 	}
 
-	const string contentBody = content->getBodyAsUtf8String();
+	const string &contentBody = content->getBodyAsUtf8String();
 	if (reactionToMessageId.empty()) {
 		if (content->getContentDisposition().isValid()) {
 			cpimMessage.addContentHeader(
@@ -195,7 +195,7 @@ ChatMessageModifier::Result CpimChatMessageModifier::decode(const shared_ptr<Cha
 		return ChatMessageModifier::Result::Skipped;
 	}
 
-	const string contentBody = content->getBodyAsUtf8String();
+	const string &contentBody = content->getBodyAsUtf8String();
 	const shared_ptr<const Cpim::Message> cpimMessage = Cpim::Message::createFromString(contentBody);
 	if (!cpimMessage || !cpimMessage->getMessageHeader("From") || !cpimMessage->getMessageHeader("To")) {
 		lError() << "[CPIM] Message is invalid: " << contentBody;
@@ -18,7 +18,10 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <sstream>
 
 #include <bctoolbox/defs.h>
 
@@ -28,6 +31,7 @@
 #include "bctoolbox/charconv.h"
 #include "bctoolbox/crypto.h"
 #include "bctoolbox/parser.h"
+#include "buffer/buffer.h"
 #include "c-wrapper/c-wrapper.h"
 #include "chat/chat-message/chat-message-p.h"
 #include "chat/chat-room/chat-room.h"
@@ -46,6 +50,68 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+// State of an interrupted download, saved in a file next to the partial one: its URL, validator and offset, one per
+// line. It goes through the same VFS as the partial file so that the URL is not written in clear when the files are
+// encrypted.
+struct DownloadResumeState {
+	string url;
+	string validator;
+	size_t offset = 0;
+};
+
+static string getDownloadResumeStatePath(const string &filePath) {
+	return filePath + ".resume";
+}
+
+static bool readDownloadResumeState(const string &filePath, DownloadResumeState &state) {
+	bctbx_vfs_file_t *file =
+	    bctbx_file_open(bctbx_vfs_get_default(), getDownloadResumeStatePath(filePath).c_str(), "r");
+	if (!file) return false;
+	int64_t size = bctbx_file_size(file);
+	string content((size > 0) ? (size_t)size : 0, '\0');
+	ssize_t read = content.empty() ? 0 : bctbx_file_read(file, &content[0], content.size(), 0);
+	bctbx_file_close(file);
+	if (read <= 0) return false;
+	content.resize((size_t)read);
+
+	istringstream lines(content);
+	string offset;
+	if (!getline(lines, state.url) || !getline(lines, state.validator) || !getline(lines, offset)) return false;
+	state.offset = (size_t)strtoull(offset.c_str(), nullptr, 10);
+	return true;
+}
+
+static void writeDownloadResumeState(const string &filePath, const DownloadResumeState &state) {
+	const string content = state.url + "\n" + state.validator + "\n" + to_string(state.offset) + "\n";
+	bctbx_vfs_file_t *file =
+	    bctbx_file_open(bctbx_vfs_get_default(), getDownloadResumeStatePath(filePath).c_str(), "w");
+	if (!file || (bctbx_file_write(file, content.data(), content.size(), 0) != (ssize_t)content.size()))
+		lWarning() << "Unable to save the state of the download to " << filePath;
+	if (file) bctbx_file_close(file);
+}
+
+static void removeDownloadResumeState(const string &filePath) {
+	remove(getDownloadResumeStatePath(filePath).c_str());
+}
+
+// A strong ETag, or else the modification date, identifies the version of the file the partial download belongs to.
+static string getResponseValidator(belle_sip_message_t *response) {
+	belle_sip_header_t *header = belle_sip_message_get_header(response, "ETag");
+	const char *value = header ? belle_sip_header_get_unparsed_value(header) : nullptr;
+	if (value && (strncmp(value, "W/", 2) != 0)) return value;
+	header = belle_sip_message_get_header(response, "Last-Modified");
+	value = header ? belle_sip_header_get_unparsed_value(header) : nullptr;
+	return value ? value : "";
+}
+
+// Start of the range of a partial response, from its "Content-Range: bytes <start>-<end>/<size>" header.
+static size_t getContentRangeStart(belle_sip_message_t *response) {
+	belle_sip_header_t *header = belle_sip_message_get_header(response, "Content-Range");
+	const char *value = header ? belle_sip_header_get_unparsed_value(header) : nullptr;
+	if (!value || (strncmp(value, "bytes ", 6) != 0)) return 0;
+	return (size_t)strtoull(value + 6, nullptr, 10);
+}
+
 FileTransferChatMessageModifier::FileTransferChatMessageModifier(belle_http_provider_t *prov) : provider(prov) {
 	bgTask.setName("File transfer upload");
 }
@@ -69,23 +135,84 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::encode(const shared
                                                                     BCTBX_UNUSED(int &errorCode)) {
 	chatMessage = message;
 
-	currentFileContentToTransfer = nullptr;
-	currentFileTransferContent = nullptr;
 	// For each FileContent, upload it and create a FileTransferContent
+	list<shared_ptr<FileContent>> fileContents;
 	for (auto &content : message->getContents()) {
 		if (content->isFile()) {
-			lInfo() << "Found file content [" << content << "], set it for file upload";
 			auto fileContent = static_pointer_cast<FileContent>(content);
-			currentFileContentToTransfer = fileContent;
-			break;
+			if (!isUploading(fileContent)) fileContents.push_back(fileContent);
 		}
 	}
-	if (!currentFileContentToTransfer) return ChatMessageModifier::Result::Skipped;
+	if (fileContents.empty()) {
+		// The message is sent when the last of its files is uploaded.
+		return isAnyFileTransferInProgress() ? ChatMessageModifier::Result::Suspended
+		                                     : ChatMessageModifier::Result::Skipped;
+	}
+
+	// The first file is always uploaded. The other ones are uploaded alongside it while the active transfers of the
+	// core stay below [misc] max_parallel_file_transfers, the remaining ones when a running upload ends.
+	for (const auto &fileContent : fileContents) {
+		FileTransferChatMessageModifier *transfer = isFileTransferInProgressAndValid() ? getParallelTransfer() : this;
+		if (!transfer) break;
+		if (transfer->startUpload(message, fileContent) != 0) {
+			cancelFileTransfers();
+			return ChatMessageModifier::Result::Error;
+		}
+	}
+	return ChatMessageModifier::Result::Suspended;
+}
+
+int FileTransferChatMessageModifier::startUpload(const shared_ptr<ChatMessage> &message,
+                                                 const shared_ptr<FileContent> &fileContent) {
+	chatMessage = message;
+	lInfo() << "Found file content [" << fileContent << "], set it for file upload";
+	currentFileContentToTransfer = fileContent;
+	currentFileTransferContent = nullptr;
+	resumeOffset = 0;
 
 	/* Open a transaction with the server and send an empty request(RCS5.1 section 3.5.4.8.3.1) */
-	if (uploadFile(nullptr) == 0) return ChatMessageModifier::Result::Suspended;
+	return uploadFile(nullptr);
+}
 
-	return ChatMessageModifier::Result::Error;
+bool FileTransferChatMessageModifier::isUploading(const shared_ptr<FileContent> &fileContent) const {
+	if (isFileTransferInProgressAndValid() && (currentFileContentToTransfer == fileContent)) return true;
+	for (const auto &transfer : parallelTransfers) {
+		if (transfer->isUploading(fileContent)) return true;
+	}
+	return false;
+}
+
+FileTransferChatMessageModifier *FileTransferChatMessageModifier::getParallelTransfer() {
+	shared_ptr<ChatMessage> message = chatMessage.lock();
+	if (!message || !message->getCore()->canStartParallelFileTransfer()) return nullptr;
+
+	for (const auto &transfer : parallelTransfers) {
+		if (!transfer->isFileTransferInProgressAndValid()) return transfer.get();
+	}
+	parallelTransfers.push_back(make_unique<FileTransferChatMessageModifier>(provider));
+	parallelTransfers.back()->parentTransfer = this;
+	return parallelTransfers.back().get();
+}
+
+bool FileTransferChatMessageModifier::isAnyFileTransferInProgress() const {
+	if (isFileTransferInProgressAndValid()) return true;
+	for (const auto &transfer : parallelTransfers) {
+		if (transfer->isFileTransferInProgressAndValid()) return true;
+	}
+	return false;
+}
+
+void FileTransferChatMessageModifier::cancelFileTransfers() {
+	if (isFileTransferInProgressAndValid()) cancelFileTransfer();
+	for (const auto &transfer : parallelTransfers) {
+		if (transfer->isFileTransferInProgressAndValid()) transfer->cancelFileTransfer();
+	}
+}
+
+void FileTransferChatMessageModifier::fileUploadEndBackgroundTasks() {
+	fileUploadEndBackgroundTask();
+	for (const auto &transfer : parallelTransfers)
+		transfer->fileUploadEndBackgroundTask();
 }
 
 // ----------------------------------------------------------
@@ -108,6 +235,9 @@ void FileTransferChatMessageModifier::fileTransferOnProgress(BCTBX_UNUSED(belle_
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message) return;
 
+	// The body of a resumed download only holds the end of the file.
+	offset += resumeOffset;
+	total += resumeOffset;
 	size_t percentage = offset * 100 / total;
 	if (percentage <= lastNotifiedPercentage) {
 		return;
@@ -126,6 +256,8 @@ void FileTransferChatMessageModifier::fileTransferOnProgress(BCTBX_UNUSED(belle_
 	}
 	_linphone_chat_message_notify_file_transfer_progress_indication(msg, content, offset, total);
 	lastNotifiedPercentage = percentage;
+	// The offset of a download is saved at most once per percent of the file.
+	if (!downloadValidator.empty()) saveDownloadResumeState(offset);
 }
 
 static int _chat_message_on_send_body(belle_sip_user_body_handler_t *bh,
@@ -195,7 +327,7 @@ int FileTransferChatMessageModifier::onSendBody(BCTBX_UNUSED(belle_sip_user_body
 	EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
 	if (imee) {
 		size_t max_size = *size;
-		uint8_t *encrypted_buffer = (uint8_t *)ms_malloc0(max_size);
+		uint8_t *encrypted_buffer = getCryptoBuffer(max_size);
 		retval = imee->uploadingFile(L_GET_CPP_PTR_FROM_C_OBJECT(msg), offset, buffer, size, encrypted_buffer,
 		                             currentFileTransferContent);
 		if (retval == 0) {
@@ -206,7 +338,6 @@ int FileTransferChatMessageModifier::onSendBody(BCTBX_UNUSED(belle_sip_user_body
 			}
 			memcpy(buffer, encrypted_buffer, *size);
 		}
-		ms_free(encrypted_buffer);
 	}
 
 	return retval <= 0 && *size != 0 ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
@@ -359,16 +490,7 @@ void FileTransferChatMessageModifier::processResponseFromPostFile(const belle_ht
 				    parsedXmlFileTransferContent->getFileUrl().empty()) {
 					lWarning()
 					    << "Received response from server but unable to parse file name or URL, file transfer failed";
-					message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
-					currentFileTransferContent = nullptr;
-
-					if (meAddress) {
-						message->getPrivate()->setParticipantState(meAddress, ChatMessage::State::NotDelivered,
-						                                           ::ms_time(nullptr));
-					}
-					releaseHttpRequest();
-					fileUploadEndBackgroundTask();
-
+					onUploadFailed(message, ChatMessage::State::NotDelivered);
 					return;
 				}
 
@@ -402,55 +524,41 @@ void FileTransferChatMessageModifier::processResponseFromPostFile(const belle_ht
 				fileUploadEndBackgroundTask();
 			} else {
 				lWarning() << "Received empty response from server, file transfer failed";
-				message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
-				currentFileTransferContent = nullptr;
-
-				if (meAddress) {
-					message->getPrivate()->setParticipantState(meAddress, ChatMessage::State::NotDelivered,
-					                                           ::ms_time(nullptr));
-				}
-				releaseHttpRequest();
-				fileUploadEndBackgroundTask();
+				onUploadFailed(message, ChatMessage::State::NotDelivered);
 			}
 		} else if (code == 400) {
 			lWarning() << "Received HTTP code response " << code
 			           << " for file transfer, probably meaning file is too large";
-			message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
-			currentFileTransferContent = nullptr;
-
-			if (meAddress) {
-				message->getPrivate()->setParticipantState(meAddress, ChatMessage::State::FileTransferError,
-				                                           ::ms_time(nullptr));
-			}
-			releaseHttpRequest();
-			fileUploadEndBackgroundTask();
+			onUploadFailed(message, ChatMessage::State::FileTransferError);
 		} else if (code == 401) {
 			lWarning() << "Received HTTP code response " << code
 			           << " for file transfer, probably meaning that our credentials were rejected";
-			message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
-			currentFileTransferContent = nullptr;
-
-			if (meAddress) {
-				message->getPrivate()->setParticipantState(meAddress, ChatMessage::State::FileTransferError,
-				                                           ::ms_time(nullptr));
-			}
-			releaseHttpRequest();
-			fileUploadEndBackgroundTask();
+			onUploadFailed(message, ChatMessage::State::FileTransferError);
 		} else {
 			lWarning() << "Unhandled HTTP code response " << code << " for file transfer";
-			message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
-			currentFileTransferContent = nullptr;
-
-			if (meAddress) {
-				message->getPrivate()->setParticipantState(meAddress, ChatMessage::State::NotDelivered,
-				                                           ::ms_time(nullptr));
-			}
-			releaseHttpRequest();
-			fileUploadEndBackgroundTask();
+			onUploadFailed(message, ChatMessage::State::NotDelivered);
 		}
 	}
 }
 
+void FileTransferChatMessageModifier::onUploadFailed(const shared_ptr<ChatMessage> &message,
+                                                     ChatMessage::State state) {
+	message->getPrivate()->replaceContent(currentFileTransferContent, currentFileContentToTransfer);
+	currentFileTransferContent = nullptr;
+	releaseHttpRequest();
+
+	// Without this file the message can't be sent: the other uploads are stopped before they complete and send it.
+	FileTransferChatMessageModifier *transfer = parentTransfer ? parentTransfer : this;
+	if (transfer->isAnyFileTransferInProgress()) {
+		lWarning() << "Cancelling the other file uploads of message [" << message << "]";
+		transfer->cancelFileTransfers();
+	}
+
+	const auto &meAddress = message->getMeAddress();
+	if (meAddress) message->getPrivate()->setParticipantState(meAddress, state, ::ms_time(nullptr));
+	transfer->fileUploadEndBackgroundTasks();
+}
+
 static void _chat_message_process_io_error_upload(void *data, const belle_sip_io_error_event_t *event) {
 	FileTransferChatMessageModifier *d = (FileTransferChatMessageModifier *)data;
 	d->processIoErrorUpload(event);
@@ -574,8 +682,18 @@ int FileTransferChatMessageModifier::startHttpTransfer(const string &url,
 		goto error;
 	}
 	if (bh) belle_sip_message_set_body_handler(BELLE_SIP_MESSAGE(httpRequest), BELLE_SIP_BODY_HANDLER(bh));
+	if (resumeOffset > 0) {
+		belle_sip_message_add_header(
+		    BELLE_SIP_MESSAGE(httpRequest),
+		    belle_http_header_create("Range", ("bytes=" + to_string(resumeOffset) + "-").c_str()));
+		// The server answers with the whole file if it changed since the partial download.
+		belle_sip_message_add_header(BELLE_SIP_MESSAGE(httpRequest),
+		                             belle_http_header_create("If-Range", downloadValidator.c_str()));
+	}
 	// keep a reference to the http request to be able to cancel it during upload
 	belle_sip_object_ref(httpRequest);
+	message->getCore()->incrementActiveFileTransferCount();
+	activeTransferCore = message->getCore();
 
 	// give msg to listener to be able to start the actual file upload when server answer a 204 No content
 	httpListener = belle_http_request_listener_create_from_callbacks(cbs, this);
@@ -618,7 +736,7 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::decode(const shared
 		auto fileTransferContent = FileTransferContent::create<FileTransferContent>();
 		fileTransferContent->setContentType(internalContent.getContentType());
 		fileTransferContent->setBody(internalContent.getBody());
-		string xml_body = fileTransferContent->getBodyAsUtf8String();
+		const string &xml_body = fileTransferContent->getBodyAsUtf8String();
 		parseFileTransferXmlIntoContent(xml_body.c_str(), fileTransferContent);
 		fileTransferContent->setRelatedChatMessageId(message->getImdnMessageId());
 		message->addContent(fileTransferContent);
@@ -628,7 +746,7 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::decode(const shared
 	for (auto &content : message->getContents()) {
 		if (content->isFileTransfer()) {
 			auto fileTransferContent = static_pointer_cast<FileTransferContent>(content);
-			string xml_body = fileTransferContent->getBodyAsUtf8String();
+			const string &xml_body = fileTransferContent->getBodyAsUtf8String();
 			parseFileTransferXmlIntoContent(xml_body.c_str(), fileTransferContent);
 			fileTransferContent->setRelatedChatMessageId(message->getImdnMessageId());
 		}
@@ -669,20 +787,26 @@ void FileTransferChatMessageModifier::onRecvBody(BCTBX_UNUSED(belle_sip_user_bod
 	int retval = -1;
 	EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
 	if (imee) {
-		uint8_t *decrypted_buffer = (uint8_t *)ms_malloc0(size);
+		uint8_t *decrypted_buffer = getCryptoBuffer(size);
 		retval = imee->downloadingFile(message, offset, buffer, size, decrypted_buffer, currentFileTransferContent);
 		if (retval == 0) {
 			memcpy(buffer, decrypted_buffer, size);
 		}
-		ms_free(decrypted_buffer);
 	}
 
 	if (retval == 0 || retval == -1) {
-		if (currentFileContentToTransfer->getFilePath().empty()) {
+		if (resumedFile) {
+			if (bctbx_file_write(resumedFile, buffer, size, (off_t)(resumeOffset + offset)) != (ssize_t)size) {
+				lError() << "Unable to write the resumed download of message [" << message << "] to file "
+				         << currentFileContentToTransfer->getFilePath();
+			}
+		} else if (currentFileContentToTransfer->getFilePath().empty()) {
 			LinphoneChatMessage *msg = L_GET_C_BACK_PTR(message);
 			LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
 			LinphoneContent *content = currentFileContentToTransfer->toC();
-			LinphoneBuffer *lb = linphone_buffer_new_from_data(buffer, size);
+			// The chunk is only valid during this call, copy it only if a callback keeps the buffer.
+			LinphoneBuffer *lb = linphone_buffer_new();
+			Buffer::toCpp(lb)->setView(buffer, size);
 			// Deprecated: use list of callbacks now
 			if (linphone_chat_message_cbs_get_file_transfer_recv(cbs)) {
 				linphone_chat_message_cbs_get_file_transfer_recv(cbs)(msg, content, lb);
@@ -692,6 +816,7 @@ void FileTransferChatMessageModifier::onRecvBody(BCTBX_UNUSED(belle_sip_user_bod
 				                                        (const char *)buffer, size);
 			}
 			_linphone_chat_message_notify_file_transfer_recv(msg, content, lb);
+			Buffer::toCpp(lb)->releaseView();
 			linphone_buffer_unref(lb);
 		}
 	} else {
@@ -747,6 +872,7 @@ void FileTransferChatMessageModifier::onRecvEnd(BCTBX_UNUSED(belle_sip_user_body
 
 	shared_ptr<Core> core = message->getCore();
 	const auto &meAddress = message->getMeAddress();
+	closeResumedFile();
 
 	int retval = -1;
 	EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
@@ -756,7 +882,7 @@ void FileTransferChatMessageModifier::onRecvEnd(BCTBX_UNUSED(belle_sip_user_body
 	if (retval == 0 || retval == -1) {
 		if (currentFileContentToTransfer->getFileSize() == 0) {
 			/* case of chunked download, the content-length was not known. Set it now it is done. */
-			size_t sz = belle_sip_body_handler_get_transfered_size(BELLE_SIP_BODY_HANDLER(bh));
+			size_t sz = resumeOffset + belle_sip_body_handler_get_transfered_size(BELLE_SIP_BODY_HANDLER(bh));
 			lInfo() << "Total size downloaded in chuncked mode: " << sz << " bytes.";
 			currentFileContentToTransfer->setFileSize(sz);
 		}
@@ -773,6 +899,7 @@ void FileTransferChatMessageModifier::onRecvEnd(BCTBX_UNUSED(belle_sip_user_body
 				linphone_core_notify_file_transfer_recv(core->getCCore(), msg, content, nullptr, 0);
 			}
 			_linphone_chat_message_notify_file_transfer_recv(msg, content, lb);
+			Buffer::toCpp(lb)->releaseView();
 			linphone_buffer_unref(lb);
 		}
 
@@ -791,6 +918,8 @@ void FileTransferChatMessageModifier::onRecvEnd(BCTBX_UNUSED(belle_sip_user_body
 				message->getPrivate()->addContent(fileContent);
 			}
 
+			if (!downloadUrl.empty()) removeDownloadResumeState(fileContent->getFilePath());
+
 			// Rename file in case of auto download so proper File Content will be available in message state changed
 			// callback
 			if (message->getPrivate()->isAutoFileTransferDownloadInProgress()) {
@@ -871,12 +1000,42 @@ void FileTransferChatMessageModifier::processResponseHeadersFromGetFile(const be
 		// if not done, belle-sip will create a memory body handler, the default
 		belle_sip_message_t *response = BELLE_SIP_MESSAGE(event->response);
 
+		if (resumeOffset > 0) {
+			const string &filePath = currentFileContentToTransfer->getFilePath();
+			if (code == 206) {
+				if (getContentRangeStart(response) != resumeOffset) {
+					lWarning() << "Unexpected range in the resumed download of message [" << message
+					           << "], it will be downloaded again from the start";
+					downloadValidator.clear();
+					removeDownloadResumeState(filePath);
+					unlink(filePath.c_str());
+					onDownloadFailed();
+					return;
+				}
+				resumedFile = bctbx_file_open(bctbx_vfs_get_default(), filePath.c_str(), "r+");
+			}
+			if (!resumedFile) {
+				lInfo() << "Unable to resume the download of message [" << message << "] at offset " << resumeOffset
+				        << " (response code " << code << "), downloading the whole file";
+				resumeOffset = 0;
+				downloadValidator.clear();
+				unlink(filePath.c_str());
+			} else {
+				lInfo() << "Resuming the download of message [" << message << "] at offset " << resumeOffset;
+			}
+		}
+		if (!downloadUrl.empty()) {
+			if (!resumedFile) downloadValidator = getResponseValidator(response);
+			if (downloadValidator.empty()) removeDownloadResumeState(currentFileContentToTransfer->getFilePath());
+			else saveDownloadResumeState(resumeOffset);
+		}
+
 		if (currentFileContentToTransfer) {
 			belle_sip_header_content_length_t *content_length_hdr =
 			    BELLE_SIP_HEADER_CONTENT_LENGTH(belle_sip_message_get_header(response, "Content-Length"));
 			if (content_length_hdr) {
 				currentFileContentToTransfer->setFileSize(
-				    belle_sip_header_content_length_get_content_length(content_length_hdr));
+				    resumeOffset + belle_sip_header_content_length_get_content_length(content_length_hdr));
 				lInfo() << "Extracted content length " << currentFileContentToTransfer->getFileSize() << " from header";
 			}
 
@@ -888,13 +1047,18 @@ void FileTransferChatMessageModifier::processResponseHeadersFromGetFile(const be
 		}
 
 		size_t body_size = 0;
-		if (currentFileContentToTransfer) body_size = currentFileContentToTransfer->getFileSize();
+		if (currentFileContentToTransfer) body_size = currentFileContentToTransfer->getFileSize() - resumeOffset;
 
 		/* Reception buffering : The decryption engine must get data chunks which size is 0 mod 16
 		 * In order to achieve this, we bufferize the input at body handler level as the callbacks
 		 * cannot modify the size or the offset given by the body handler */
 		belle_sip_body_handler_t *body_handler = NULL;
-		if (!currentFileContentToTransfer->getFilePath().empty()) {
+		if (resumedFile) {
+			// Resumed downloads are never encrypted, the chunks are written at their offset in the partial file.
+			body_handler = (belle_sip_body_handler_t *)belle_sip_user_body_handler_new(
+			    body_size, _chat_message_file_transfer_on_progress, nullptr, _chat_message_on_recv_body, nullptr,
+			    _chat_message_on_recv_end, this);
+		} else if (!currentFileContentToTransfer->getFilePath().empty()) {
 			/* the buffering is done by file body handler, use a regular user body handler*/
 			belle_sip_user_body_handler_t *bh =
 			    belle_sip_user_body_handler_new(body_size, _chat_message_file_transfer_on_progress, nullptr,
@@ -921,6 +1085,17 @@ void FileTransferChatMessageModifier::processResponseHeadersFromGetFile(const be
 void FileTransferChatMessageModifier::onDownloadFailed() {
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message) return;
+	closeResumedFile();
+	if (!downloadValidator.empty() && currentFileContentToTransfer) {
+		// What was received before the failure has been written to the partial file by this download.
+		const string &filePath = currentFileContentToTransfer->getFilePath();
+		bctbx_vfs_file_t *file = bctbx_file_open(bctbx_vfs_get_default(), filePath.c_str(), "r");
+		if (file) {
+			int64_t partialSize = bctbx_file_size(file);
+			bctbx_file_close(file);
+			if (partialSize > 0) saveDownloadResumeState((size_t)partialSize);
+		}
+	}
 	message->getCore()->decrementRemainingDownloadFileCount();
 	if (message->getPrivate()->isAutoFileTransferDownloadInProgress()) {
 		lError() << "Auto download failed for message [" << message << "]";
@@ -1009,6 +1184,8 @@ FileTransferChatMessageModifier::downloadFile(const shared_ptr<ChatMessage> &mes
 	chatMessage = message;
 
 	if (httpRequest) {
+		FileTransferChatMessageModifier *transfer = getParallelTransfer();
+		if (transfer) return transfer->downloadFile(message, fileTransferContent);
 		lError() << "Content " << fileTransferContent
 		         << " cannot be downloaded right now because there is already a download in progress.";
 		return DownloadStatus::DownloadInProgress;
@@ -1039,6 +1216,8 @@ FileTransferChatMessageModifier::downloadFile(const shared_ptr<ChatMessage> &mes
 	}
 
 	lastNotifiedPercentage = 0;
+	downloadUrl = canResumeDownload(message) ? fileTransferContent->getFileUrl() : string();
+	resumeOffset = getDownloadResumeOffset();
 	lInfo() << "Downloading file transfer content [" << fileTransferContent
 	        << "], result will be available in file content [" << fileContent->getFilePath() << "]";
 
@@ -1098,6 +1277,7 @@ void FileTransferChatMessageModifier::cancelFileTransfer() {
 
 				if (message && message->getDirection() == ChatMessage::Direction::Incoming) {
 					lWarning() << "Deleting incomplete file " << filePath;
+					removeDownloadResumeState(filePath);
 					int result = unlink(filePath.c_str());
 					if (result != 0) {
 						lError() << "Couldn't delete file " << filePath << ", errno is " << result;
@@ -1135,6 +1315,54 @@ bool FileTransferChatMessageModifier::isFileTransferInProgressAndValid() const {
 	return httpRequest && !belle_http_request_is_cancelled(httpRequest);
 }
 
+bool FileTransferChatMessageModifier::canResumeDownload(const shared_ptr<ChatMessage> &message) const {
+	// The decryption of a file can't start in the middle of it.
+	return !currentFileContentToTransfer->getFilePath().empty() &&
+	       (currentFileTransferContent->getFileKeySize() == 0) &&
+	       linphone_config_get_bool(message->getCore()->getCCore()->config, "misc", "file_transfer_resume_downloads",
+	                                FALSE);
+}
+
+size_t FileTransferChatMessageModifier::getDownloadResumeOffset() {
+	downloadValidator.clear();
+	if (downloadUrl.empty()) return 0;
+
+	const string &filePath = currentFileContentToTransfer->getFilePath();
+	DownloadResumeState state;
+	if (!readDownloadResumeState(filePath, state)) return 0;
+	if ((state.url != downloadUrl) || state.validator.empty()) {
+		removeDownloadResumeState(filePath);
+		return 0;
+	}
+
+	// The saved offset may be ahead of the partial file if the download was interrupted before it was flushed.
+	bctbx_vfs_file_t *file = bctbx_file_open(bctbx_vfs_get_default(), filePath.c_str(), "r");
+	if (!file) return 0;
+	int64_t partialSize = bctbx_file_size(file);
+	bctbx_file_close(file);
+	size_t offset = (partialSize > 0) ? min(state.offset, (size_t)partialSize) : 0;
+	size_t fileSize = currentFileTransferContent->getFileSize();
+	if ((offset == 0) || ((fileSize > 0) && (offset >= fileSize))) return 0;
+	downloadValidator = state.validator;
+	return offset;
+}
+
+void FileTransferChatMessageModifier::saveDownloadResumeState(size_t offset) const {
+	if (!currentFileContentToTransfer) return;
+	DownloadResumeState state;
+	state.url = downloadUrl;
+	state.validator = downloadValidator;
+	state.offset = offset;
+	writeDownloadResumeState(currentFileContentToTransfer->getFilePath(), state);
+}
+
+void FileTransferChatMessageModifier::closeResumedFile() {
+	if (resumedFile) {
+		bctbx_file_close(resumedFile);
+		resumedFile = nullptr;
+	}
+}
+
 void FileTransferChatMessageModifier::releaseHttpRequest() {
 	if (httpRequest) {
 		belle_sip_object_unref(httpRequest);
@@ -1144,7 +1372,19 @@ void FileTransferChatMessageModifier::releaseHttpRequest() {
 			httpListener = nullptr;
 		}
 	}
+	if (auto core = activeTransferCore.lock()) core->decrementActiveFileTransferCount();
+	activeTransferCore.reset();
+	closeResumedFile();
+	downloadUrl.clear();
+	downloadValidator.clear();
 	currentFileContentToTransfer = nullptr;
+	cryptoBuffer = vector<uint8_t>();
+}
+
+uint8_t *FileTransferChatMessageModifier::getCryptoBuffer(size_t size) {
+	// Chunks are at most as big as the belle-sip ones, so the buffer is allocated once per transfer.
+	if (cryptoBuffer.size() < size) cryptoBuffer.resize(size);
+	return cryptoBuffer.data();
 }
 
 /* -------------------------------------------------------------------------------------- */
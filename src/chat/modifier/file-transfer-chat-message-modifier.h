@@ -21,9 +21,15 @@
 #ifndef _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 #define _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 
+#include <list>
+#include <memory>
+#include <vector>
+
 #include <belle-sip/belle-sip.h>
+#include <bctoolbox/vfs.h>
 
 #include "chat-message-modifier.h"
+#include "chat/chat-message/chat-message.h"
 #include "utils/background-task.h"
 
 // =============================================================================
@@ -69,6 +75,10 @@ public:
 	                            std::shared_ptr<FileTransferContent> &fileTransferContent);
 	void cancelFileTransfer();
 	bool isFileTransferInProgressAndValid() const;
+	// Same as above, for this transfer and the ones run alongside it for the other files of the message.
+	void cancelFileTransfers();
+	bool isAnyFileTransferInProgress() const;
+	void fileUploadEndBackgroundTasks();
 	std::string createFakeFileTransferFromUrl(const std::string &url);
 	void fileUploadEndBackgroundTask();
 
@@ -83,6 +93,11 @@ public:
 	                                   const std::string &realFileName) const;
 
 private:
+	int startUpload(const std::shared_ptr<ChatMessage> &message, const std::shared_ptr<FileContent> &fileContent);
+	bool isUploading(const std::shared_ptr<FileContent> &fileContent) const;
+	// Get an idle transfer to run alongside this one, if the core limit of parallel transfers is not reached.
+	FileTransferChatMessageModifier *getParallelTransfer();
+
 	// Body handler is optional, but if set this method takes owneship of it, even in error cases.
 	int uploadFile(belle_sip_body_handler_t *bh);
 	// Body handler is optional, but if set this method takes owneship of it, even in error cases.
@@ -92,10 +107,19 @@ private:
 	                      belle_http_request_listener_callbacks_t *cbs);
 	void fileUploadBeginBackgroundTask();
 
+	// Stop this upload and the ones running alongside it, as the message can't be sent without all its files.
+	void onUploadFailed(const std::shared_ptr<ChatMessage> &message, ChatMessage::State state);
 	void onDownloadFailed();
+	bool canResumeDownload(const std::shared_ptr<ChatMessage> &message) const;
+	size_t getDownloadResumeOffset();
+	void saveDownloadResumeState(size_t offset) const;
+	void closeResumedFile();
 	void releaseHttpRequest();
 	belle_sip_body_handler_t *prepare_upload_body_handler(std::shared_ptr<ChatMessage> message);
 
+	// Get a scratch buffer for the encryption engine, reused for every chunk of the transfer.
+	uint8_t *getCryptoBuffer(size_t size);
+
 	std::string escapeFileName(const std::string &fileName) const;
 	std::string unEscapeFileName(const std::string &fileName) const;
 
@@ -109,6 +133,21 @@ private:
 
 	size_t lastNotifiedPercentage = 0;
 
+	std::vector<uint8_t> cryptoBuffer;
+
+	// An interrupted download is completed with an HTTP range request if the file did not change on the server since.
+	// The URL, the validator (ETag or Last-Modified) and the offset of the download are saved next to the partial file.
+	size_t resumeOffset = 0;
+	bctbx_vfs_file_t *resumedFile = nullptr;
+	std::string downloadUrl;
+	std::string downloadValidator;
+
+	// Core of the running transfer, set while it counts in the active file transfers of the core.
+	std::weak_ptr<Core> activeTransferCore;
+	std::list<std::unique_ptr<FileTransferChatMessageModifier>> parallelTransfers;
+	// Transfer running the other ones alongside it, if this one is one of them.
+	FileTransferChatMessageModifier *parentTransfer = nullptr;
+
 	BackgroundTask bgTask;
 };
 
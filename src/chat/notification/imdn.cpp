@@ -18,9 +18,13 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+#include <vector>
+
 #include <bctoolbox/defs.h>
 
 #include "linphone/utils/algorithm.h"
+#include "linphone/utils/utils.h"
 
 #include "chat/chat-message/imdn-message-p.h"
 #include "chat/chat-room/chat-room.h"
@@ -210,108 +214,183 @@ string Imdn::createXml(const string &id, time_t timestamp, Imdn::Type imdnType,
 #pragma GCC diagnostic pop
 #endif // _MSC_VER
 
-#ifndef _MSC_VER
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-#endif // _MSC_VER
-void Imdn::parse(const shared_ptr<ChatMessage> &chatMessage) {
-#ifdef HAVE_ADVANCED_IM
-	list<string> messagesIds;
-	list<unique_ptr<Xsd::Imdn::Imdn>> imdns;
+static string getXmlLocalName(const string &name) {
+	size_t colon = name.find(':');
+	return (colon == string::npos) ? name : name.substr(colon + 1);
+}
 
-	for (const auto &content : chatMessage->getPrivate()->getContents()) {
-		istringstream data(content->getBodyAsString());
-		unique_ptr<Xsd::Imdn::Imdn> imdn;
-		try {
-			imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
-		} catch (const exception &e) {
-			lError() << "IMDN parsing exception: " << e.what();
+// Parses the attributes of a start tag, calling onAttribute with their local name and raw value.
+template <typename Callback>
+static bool parseXmlAttributes(const string &attributes, const Callback &onAttribute) {
+	size_t pos = 0;
+	while (true) {
+		pos = attributes.find_first_not_of(" \t\r\n", pos);
+		if (pos == string::npos) return true;
+		size_t equal = attributes.find('=', pos);
+		if (equal == string::npos) return false;
+		size_t nameEnd = attributes.find_last_not_of(" \t\r\n", equal - 1);
+		if (nameEnd == string::npos || nameEnd < pos) return false;
+		size_t quote = attributes.find_first_not_of(" \t\r\n", equal + 1);
+		if (quote == string::npos || (attributes[quote] != '"' && attributes[quote] != '\'')) return false;
+		size_t valueEnd = attributes.find(attributes[quote], quote + 1);
+		if (valueEnd == string::npos) return false;
+		onAttribute(getXmlLocalName(attributes.substr(pos, nameEnd + 1 - pos)),
+		            attributes.substr(quote + 1, valueEnd - quote - 1));
+		pos = valueEnd + 1;
+	}
+}
+
+static bool parseImdnReasonCode(const string &attributes, int &reasonCode) {
+	bool validCode = true;
+	bool attributesParsed = parseXmlAttributes(attributes, [&](const string &name, const string &value) {
+		if (name != "code") return;
+		char *end = nullptr;
+		long code = strtol(value.c_str(), &end, 10);
+		if (value.empty() || *end != '\0') validCode = false;
+		else reasonCode = int(code);
+	});
+	return attributesParsed && validCode;
+}
+
+bool Imdn::parseXmlFast(string_view xml, ParsedImdn &parsedImdn) {
+	// Single pass over the body, only looking at the elements of RFC 5438 that are used when receiving an IMDN.
+	// Anything this scanner is not sure to understand (DTD, CDATA, entities in the message ID, malformed input) is
+	// reported as a failure so that the XSD parser handles it.
+	ParsedImdn result;
+	vector<string> elements;
+	bool hasRoot = false;
+	bool hasMessageId = false;
+	size_t pos = 0;
+	while (pos < xml.size()) {
+		size_t tagStart = xml.find('<', pos);
+		if (elements.size() == 2 && elements[1] == "message-id") {
+			size_t textEnd = (tagStart == string::npos) ? xml.size() : tagStart;
+			string text(xml.substr(pos, textEnd - pos));
+			if (text.find('&') != string::npos) return false;
+			result.messageId += text;
 		}
-		if (!imdn) continue;
+		if (tagStart == string::npos) break;
 
-		messagesIds.push_back(imdn->getMessageId());
-		imdns.push_back(std::move(imdn));
-	}
+		if (xml.compare(tagStart, 4, "<!--") == 0) {
+			size_t commentEnd = xml.find("-->", tagStart + 4);
+			if (commentEnd == string::npos) return false;
+			pos = commentEnd + 3;
+			continue;
+		}
+		if (tagStart + 1 >= xml.size() || xml[tagStart + 1] == '!') return false;
+		if (xml[tagStart + 1] == '?') {
+			size_t declarationEnd = xml.find("?>", tagStart + 2);
+			if (declarationEnd == string::npos) return false;
+			pos = declarationEnd + 2;
+			continue;
+		}
 
-	// It seems to be more efficient to only make one database request to get all chat messages from their IMDN message
-	// ID
-	list<shared_ptr<ChatMessage>> chatMessages =
-	    chatMessage->getCore()->getPrivate()->mainDb->findChatMessagesFromImdnMessageId(messagesIds);
-	for (const auto &imdn : imdns) {
-		shared_ptr<ChatMessage> cm = nullptr;
-		for (const auto &chatMessage : chatMessages) {
-			if (chatMessage->getImdnMessageId() == imdn->getMessageId()) {
-				cm = chatMessage;
+		// Attribute values may contain '>', skip the quoted parts when looking for the end of the tag.
+		size_t tagEnd = tagStart + 1;
+		char quote = '\0';
+		for (; tagEnd < xml.size(); tagEnd++) {
+			char c = xml[tagEnd];
+			if (quote != '\0') {
+				if (c == quote) quote = '\0';
+			} else if (c == '"' || c == '\'') {
+				quote = c;
+			} else if (c == '>') {
 				break;
 			}
 		}
+		if (tagEnd == xml.size()) return false;
+		string tag(xml.substr(tagStart + 1, tagEnd - tagStart - 1));
+		pos = tagEnd + 1;
+
+		if (!tag.empty() && tag[0] == '/') {
+			string name = Utils::trim(tag.substr(1));
+			if (elements.empty() || elements.back() != getXmlLocalName(name)) return false;
+			elements.pop_back();
+			continue;
+		}
 
-		if (!cm) {
-			lWarning() << "Received IMDN for unknown message " << imdn->getMessageId();
-		} else {
-			chatMessages.remove(cm);
-
-			shared_ptr<AbstractChatRoom> cr = cm->getChatRoom();
-			auto policy = linphone_core_get_im_notif_policy(cr->getCore()->getCCore());
-			time_t imdnTime = chatMessage->getTime();
-			std::shared_ptr<Address> participantAddress =
-			    Address::create(chatMessage->getFromAddress()->getUriWithoutGruu());
-			std::shared_ptr<Address> localAddress = cr->getLocalAddress();
-			std::shared_ptr<Address> chatMessageFromAddress = cm->getFromAddress();
-			auto &deliveryNotification = imdn->getDeliveryNotification();
-			auto &displayNotification = imdn->getDisplayNotification();
-			if (deliveryNotification.present()) {
-				auto &status = deliveryNotification.get().getStatus();
-				if (status.getDelivered().present() && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::DeliveredToUser,
-					                                      imdnTime);
-				} else if ((status.getFailed().present() || status.getError().present()) &&
-				           (linphone_im_notif_policy_get_recv_imdn_delivered(policy) ||
-				            linphone_im_notif_policy_get_recv_imdn_delivery_error(policy))) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::NotDelivered,
-					                                      imdnTime);
-
-					const auto &chatRoomParams = cr->getCurrentParams();
-					// When the IMDN status is failed for reason code 488 (Not acceptable here) and the chatroom is
-					// encrypted, something is wrong with our encryption session with this peer, stale the active
-					// session the next message (which can be a resend of this one) will be encrypted with a new session
-					if (localAddress->weakEqual(*chatMessageFromAddress) // check the imdn is in response to a message
-					                                                     // sent by the local user
-					    && status.getFailed().present()                  // that we have a fail tag
-					    && status.getReason().present()                  // and a reason tag
-					    && chatRoomParams->getChatParams()->isEncrypted()) { // and the chatroom is encrypted
-						// Check the reason code is 488
-						auto reason = status.getReason().get();
-						auto imee = cr->getCore()->getEncryptionEngine();
-						if ((reason.getCode() == 488) && imee) {
-							// stale the encryption sessions with this device: something went wrong, we will create a
-							// new one at next encryption
-							lWarning() << "Peer " << *chatMessage->getFromAddress()
-							           << " could not decrypt message from " << *chatMessageFromAddress
-							           << " -> Stale the lime X3DH session";
-							imee->staleSession(chatMessageFromAddress->asStringUriOnly(),
-							                   chatMessage->getFromAddress()->asStringUriOnly());
-						}
-					}
-				}
-			} else if (displayNotification.present()) {
-				auto &status = displayNotification.get().getStatus();
-				if (status.getDisplayed().present() && linphone_im_notif_policy_get_recv_imdn_displayed(policy)) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::Displayed, imdnTime);
-					if (localAddress->weakEqual(*participantAddress)) {
-						auto lastMsg = cr->getLastChatMessageInHistory();
-						if (lastMsg == cm) {
-							lInfo() << "Received Display IMDN from ourselves for last message in this chat room, "
-							           "marking it as read";
-							cr->markAsRead();
-						}
+		bool isEmptyElement = !tag.empty() && tag.back() == '/';
+		if (isEmptyElement) tag.pop_back();
+		size_t nameEnd = tag.find_first_of(" \t\r\n");
+		string name = getXmlLocalName(tag.substr(0, nameEnd));
+		string attributes = (nameEnd == string::npos) ? string() : tag.substr(nameEnd);
+		if (name.empty()) return false;
+
+		switch (elements.size()) {
+			case 0:
+				if (hasRoot || name != "imdn") return false;
+				hasRoot = true;
+				break;
+			case 1:
+				if (name == "message-id") hasMessageId = true;
+				else if (name == "delivery-notification") result.isDeliveryNotification = true;
+				else if (name == "display-notification") result.isDisplayNotification = true;
+				break;
+			case 3:
+				if (elements[2] != "status") break;
+				if (elements[1] == "delivery-notification") {
+					if (name == "delivered") result.delivered = true;
+					else if (name == "failed") result.failed = true;
+					else if (name == "error") result.error = true;
+					else if (name == "reason") {
+						result.hasReason = true;
+						if (!parseImdnReasonCode(attributes, result.reasonCode)) return false;
 					}
+				} else if (elements[1] == "display-notification") {
+					if (name == "displayed") result.displayed = true;
 				}
-			}
+				break;
+			default:
+				break;
 		}
+		if (!isEmptyElement) elements.push_back(std::move(name));
+	}
+
+	if (!hasRoot || !elements.empty() || !hasMessageId) return false;
+	result.messageId = Utils::trim(result.messageId);
+	if (result.messageId.empty()) return false;
+	parsedImdn = std::move(result);
+	return true;
+}
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif // _MSC_VER
+bool Imdn::parseXml(string_view xml, ParsedImdn &parsedImdn) {
+	if (parseXmlFast(xml, parsedImdn)) return true;
+
+#ifdef HAVE_ADVANCED_IM
+	istringstream data{string(xml)};
+	unique_ptr<Xsd::Imdn::Imdn> imdn;
+	try {
+		imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
+	} catch (const exception &e) {
+		lError() << "IMDN parsing exception: " << e.what();
 	}
+	if (!imdn) return false;
+
+	ParsedImdn result;
+	result.messageId = imdn->getMessageId();
+	auto &deliveryNotification = imdn->getDeliveryNotification();
+	auto &displayNotification = imdn->getDisplayNotification();
+	if (deliveryNotification.present()) {
+		auto &status = deliveryNotification.get().getStatus();
+		result.isDeliveryNotification = true;
+		result.delivered = status.getDelivered().present();
+		result.failed = status.getFailed().present();
+		result.error = status.getError().present();
+		result.hasReason = status.getReason().present();
+		if (result.hasReason) result.reasonCode = status.getReason().get().getCode();
+	}
+	if (displayNotification.present()) {
+		result.isDisplayNotification = true;
+		result.displayed = displayNotification.get().getStatus().getDisplayed().present();
+	}
+	parsedImdn = std::move(result);
+	return true;
 #else
-	lWarning() << "Advanced IM such as group chat is disabled!";
+	return false;
 #endif
 }
 #ifndef _MSC_VER
@@ -322,36 +401,125 @@ void Imdn::parse(const shared_ptr<ChatMessage> &chatMessage) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #endif // _MSC_VER
-bool Imdn::isError(const shared_ptr<ChatMessage> &chatMessage) {
+void Imdn::parse(const shared_ptr<ChatMessage> &chatMessage) {
 #ifdef HAVE_ADVANCED_IM
+	list<string> messagesIds;
+	list<ParsedImdn> imdns;
+
 	for (const auto &content : chatMessage->getPrivate()->getContents()) {
-		if (content->getContentType() != ContentType::Imdn) continue;
+		ParsedImdn imdn;
+		if (!parseXml(content->getBodyView(), imdn)) continue;
 
-		istringstream data(content->getBodyAsString());
-		unique_ptr<Xsd::Imdn::Imdn> imdn;
-		try {
-			imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
-		} catch (const exception &e) {
-			lError() << "IMDN parsing exception: " << e.what();
+		messagesIds.push_back(imdn.messageId);
+		imdns.push_back(std::move(imdn));
+	}
+	if (imdns.empty()) return;
+
+	// Only make one database request to get all chat messages from their IMDN message ID, then match them with the
+	// IMDNs through a hash table. A given message ID may be found several times in the database.
+	const auto &mainDb = chatMessage->getCore()->getPrivate()->mainDb;
+	unordered_multimap<string, shared_ptr<ChatMessage>> chatMessages;
+	for (auto &cm : mainDb->findChatMessagesFromImdnMessageId(messagesIds))
+		chatMessages.emplace(cm->getImdnMessageId(), cm);
+
+	time_t imdnTime = chatMessage->getTime();
+	std::shared_ptr<Address> participantAddress = Address::create(chatMessage->getFromAddress()->getUriWithoutGruu());
+	list<pair<shared_ptr<ChatMessage>, ChatMessagePrivate::ParticipantStateChange>> stateChanges;
+	list<pair<shared_ptr<EventLog>, MainDb::ParticipantState>> storedStates;
+	list<shared_ptr<ChatMessage>> displayedByUs;
+	for (const auto &imdn : imdns) {
+		auto it = chatMessages.find(imdn.messageId);
+		if (it == chatMessages.end()) {
+			lWarning() << "Received IMDN for unknown message " << imdn.messageId;
+			continue;
+		}
+		shared_ptr<ChatMessage> cm = it->second;
+		chatMessages.erase(it);
+
+		shared_ptr<AbstractChatRoom> cr = cm->getChatRoom();
+		auto policy = linphone_core_get_im_notif_policy(cr->getCore()->getCCore());
+		std::shared_ptr<Address> localAddress = cr->getLocalAddress();
+		std::shared_ptr<Address> chatMessageFromAddress = cm->getFromAddress();
+		ChatMessage::State newState = ChatMessage::State::Idle;
+		if (imdn.isDeliveryNotification) {
+			if (imdn.delivered && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
+				newState = ChatMessage::State::DeliveredToUser;
+			} else if ((imdn.failed || imdn.error) && (linphone_im_notif_policy_get_recv_imdn_delivered(policy) ||
+			                                           linphone_im_notif_policy_get_recv_imdn_delivery_error(policy))) {
+				newState = ChatMessage::State::NotDelivered;
+
+				const auto &chatRoomParams = cr->getCurrentParams();
+				// When the IMDN status is failed for reason code 488 (Not acceptable here) and the chatroom is
+				// encrypted, something is wrong with our encryption session with this peer, stale the active
+				// session the next message (which can be a resend of this one) will be encrypted with a new session
+				if (localAddress->weakEqual(*chatMessageFromAddress) // check the imdn is in response to a message
+				                                                     // sent by the local user
+				    && imdn.failed                                   // that we have a fail tag
+				    && imdn.hasReason                                // and a reason tag
+				    && chatRoomParams->getChatParams()->isEncrypted()) { // and the chatroom is encrypted
+					// Check the reason code is 488
+					auto imee = cr->getCore()->getEncryptionEngine();
+					if ((imdn.reasonCode == 488) && imee) {
+						// stale the encryption sessions with this device: something went wrong, we will create a
+						// new one at next encryption
+						lWarning() << "Peer " << *chatMessage->getFromAddress() << " could not decrypt message from "
+						           << *chatMessageFromAddress << " -> Stale the lime X3DH session";
+						imee->staleSession(chatMessageFromAddress->asStringUriOnly(),
+						                   chatMessage->getFromAddress()->asStringUriOnly());
+					}
+				}
+			} else {
+				continue;
+			}
+		} else if (imdn.isDisplayNotification) {
+			if (!imdn.displayed || !linphone_im_notif_policy_get_recv_imdn_displayed(policy)) continue;
+			newState = ChatMessage::State::Displayed;
+			if (localAddress->weakEqual(*participantAddress)) displayedByUs.push_back(cm);
+		} else {
+			continue;
 		}
-		if (!imdn) continue;
 
-		auto &deliveryNotification = imdn->getDeliveryNotification();
-		if (deliveryNotification.present()) {
-			auto &status = deliveryNotification.get().getStatus();
-			if (status.getFailed().present() || status.getError().present()) return true;
+		ChatMessagePrivate::ParticipantStateChange stateChange;
+		if (!cm->getPrivate()->beginParticipantStateChange(participantAddress, newState, imdnTime, LinphoneReasonNone,
+		                                                   stateChange))
+			continue;
+		if (stateChange.isStored && stateChange.eventLog)
+			storedStates.emplace_back(stateChange.eventLog,
+			                          MainDb::ParticipantState(participantAddress, newState, imdnTime));
+		stateChanges.emplace_back(cm, std::move(stateChange));
+	}
+
+	// The states of all the messages are stored at once, the callbacks are then notified message by message.
+	if (!storedStates.empty()) mainDb->setChatMessagesParticipantState(storedStates);
+	for (const auto &stateChange : stateChanges)
+		stateChange.first->getPrivate()->endParticipantStateChange(stateChange.second);
+
+	for (const auto &cm : displayedByUs) {
+		shared_ptr<AbstractChatRoom> cr = cm->getChatRoom();
+		if (cr->getLastChatMessageInHistory() == cm) {
+			lInfo() << "Received Display IMDN from ourselves for last message in this chat room, marking it as read";
+			cr->markAsRead();
 		}
 	}
-	return false;
 #else
 	lWarning() << "Advanced IM such as group chat is disabled!";
-	return false;
 #endif
 }
 #ifndef _MSC_VER
 #pragma GCC diagnostic pop
 #endif // _MSC_VER
 
+bool Imdn::isError(const shared_ptr<ChatMessage> &chatMessage) {
+	for (const auto &content : chatMessage->getPrivate()->getContents()) {
+		if (content->getContentType() != ContentType::Imdn) continue;
+
+		ParsedImdn imdn;
+		if (!parseXml(content->getBodyView(), imdn)) continue;
+		if (imdn.isDeliveryNotification && (imdn.failed || imdn.error)) return true;
+	}
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 
 int Imdn::timerExpired(void *data, BCTBX_UNUSED(unsigned int revents)) {
@@ -21,6 +21,8 @@
 #ifndef _L_IMDN_H_
 #define _L_IMDN_H_
 
+#include <string_view>
+
 #include "linphone/utils/general.h"
 
 #include "core/core-listener.h"
@@ -71,11 +73,29 @@ public:
 	bool aggregationEnabled() const;
 	void onLinphoneCoreStop();
 
+	// The parts of an IMDN body that are used when receiving it.
+	struct ParsedImdn {
+		std::string messageId;
+		bool isDeliveryNotification = false;
+		bool isDisplayNotification = false;
+		// Status of a delivery notification.
+		bool delivered = false;
+		bool failed = false;
+		bool error = false;
+		bool hasReason = false;
+		int reasonCode = 200;
+		// Status of a display notification.
+		bool displayed = false;
+	};
+
 	static std::string createXml(const std::string &id, time_t time, Imdn::Type imdnType, LinphoneReason reason);
+	static bool parseXml(std::string_view xml, ParsedImdn &parsedImdn);
 	static void parse(const std::shared_ptr<ChatMessage> &chatMessage);
 	static bool isError(const std::shared_ptr<ChatMessage> &chatMessage);
 
 private:
+	static bool parseXmlFast(std::string_view xml, ParsedImdn &parsedImdn);
+
 	LinphoneProxyConfig *getRelatedProxyConfig();
 	static int timerExpired(void *data, unsigned int revents);
 
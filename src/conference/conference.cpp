@@ -93,7 +93,11 @@ Conference::Conference(const shared_ptr<Core> &core,
 }
 
 Conference::~Conference() {
-	setChatRoom(nullptr);
+	// Not through setChatRoom(): the core may already be destroyed and there is no chat room list to update.
+	if (mChatRoom) {
+		removeListener(mChatRoom);
+		mChatRoom = nullptr;
+	}
 	mConfListeners.clear();
 }
 
@@ -733,6 +737,7 @@ void Conference::setConferenceAddress(const std::shared_ptr<Address> &conference
 		}
 
 		mConfParams->setConferenceAddress(conferenceAddress);
+		getCore()->getPrivate()->updateConferenceAddressIndex(this);
 		setState(ConferenceInterface::State::CreationPending);
 		lInfo() << "Conference " << this << " has been given the address " << *mConfParams->getConferenceAddress();
 	} else {
@@ -846,6 +851,7 @@ bool Conference::update(const ConferenceParamsInterface &newParameters) {
 	// The conference parameter account should not change if the application is updating them
 	if (isUpdate) {
 		mConfParams->setAccount(account);
+		if (mChatRoom) getCore()->updateChatRoomListPosition(mChatRoom);
 	}
 	return true;
 };
@@ -2006,6 +2012,7 @@ void Conference::setChatRoom(const std::shared_ptr<AbstractChatRoom> &chatRoom)
 	if (mChatRoom) {
 		addListener(mChatRoom);
 	}
+	getCore()->invalidateChatRoomList();
 }
 
 const std::shared_ptr<AbstractChatRoom> Conference::getChatRoom() const {
@@ -264,6 +264,9 @@ void ClientConferenceEventHandler::conferenceInfoNotifyReceived(const string &xm
 						lError() << "Unrecognized media type " << mediaType;
 					}
 				}
+				// Chat rooms with media may be hidden from the chat room list.
+				const auto &chatRoom = conference->getChatRoom();
+				if (chatRoom) conference->getCore()->updateChatRoomListPosition(chatRoom);
 				if (!isFullState) {
 					conference->notifyAvailableMediaChanged(creationTime, isFullState,
 					                                        conference->getMediaCapabilities());
@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <ctime>
 
 #include <bctoolbox/defs.h>
@@ -30,7 +31,6 @@
 #include "content/content-manager.h"
 #include "content/content-type.h"
 #include "core/core-p.h"
-#include "db/main-db.h"
 #include "event-log/events.h"
 #include "linphone/api/c-content.h"
 #include "linphone/utils/utils.h"
@@ -59,6 +59,11 @@ ServerConferenceEventHandler::ServerConferenceEventHandler(std::shared_ptr<Confe
     : conference(conf), confListener(listener) {
 }
 
+ServerConferenceEventHandler::~ServerConferenceEventHandler() {
+	// Subscriptions may outlive the handler, their callbacks must not reach it anymore.
+	if (mNotifyCbs) mNotifyCbs->setUserData(nullptr);
+}
+
 // -----------------------------------------------------------------------------
 
 void ServerConferenceEventHandler::notifyFullState(const std::shared_ptr<Content> &notify,
@@ -71,13 +76,15 @@ void ServerConferenceEventHandler::notifyOnlyAdmins(const std::shared_ptr<Conten
 	if (!conf) {
 		return;
 	}
+	SalBodyHandler *body = createSharedBody(notify);
 	for (const auto &participant : conf->getParticipants()) {
 		if (participant->isAdmin()) {
 			for (const auto &device : participant->getDevices()) {
-				notifyParticipantDevice(notify, device);
+				notifyParticipantDevice(notify, body, device);
 			}
 		}
 	}
+	if (body) sal_body_handler_unref(body);
 }
 
 void ServerConferenceEventHandler::notifyAllExceptDevice(const std::shared_ptr<Content> &notify,
@@ -86,14 +93,16 @@ void ServerConferenceEventHandler::notifyAllExceptDevice(const std::shared_ptr<C
 	if (!conf) {
 		return;
 	}
+	SalBodyHandler *body = createSharedBody(notify);
 	for (const auto &participant : conf->getParticipants()) {
 		for (const auto &device : participant->getDevices()) {
 			if (device != exceptDevice) {
 				/* Only notify to device that are present in the conference. */
-				notifyParticipantDevice(notify, device);
+				notifyParticipantDevice(notify, body, device);
 			}
 		}
 	}
+	if (body) sal_body_handler_unref(body);
 }
 
 void ServerConferenceEventHandler::notifyAllExcept(const std::shared_ptr<Content> &notify,
@@ -103,11 +112,13 @@ void ServerConferenceEventHandler::notifyAllExcept(const std::shared_ptr<Content
 		return;
 	}
 
+	SalBodyHandler *body = createSharedBody(notify);
 	for (const auto &participant : conf->getParticipants()) {
 		if (participant != exceptParticipant) {
-			notifyParticipant(notify, participant);
+			notifyParticipant(notify, body, participant);
 		}
 	}
+	if (body) sal_body_handler_unref(body);
 }
 
 void ServerConferenceEventHandler::notifyAll(const std::shared_ptr<Content> &notify) {
@@ -116,9 +127,11 @@ void ServerConferenceEventHandler::notifyAll(const std::shared_ptr<Content> &not
 		return;
 	}
 
+	SalBodyHandler *body = createSharedBody(notify);
 	for (const auto &participant : conf->getParticipants()) {
-		notifyParticipant(notify, participant);
+		notifyParticipant(notify, body, participant);
 	}
+	if (body) sal_body_handler_unref(body);
 }
 
 std::shared_ptr<Content> ServerConferenceEventHandler::createNotifyFullState(const shared_ptr<EventSubscribe> &ev) {
@@ -496,104 +509,42 @@ void ServerConferenceEventHandler::addProtocols(const std::shared_ptr<Participan
 	}
 }
 
+std::shared_ptr<Content> ServerConferenceEventHandler::getFullStateNotify() {
+	auto conf = getConference();
+	if (!conf) {
+		return nullptr;
+	}
+
+	// The full state doesn't depend on the subscriber: it can be reused until the conference changes.
+	if (!mFullStateNotify || (mFullStateNotifyVersion != conf->getLastNotify())) {
+		mFullStateNotify = createNotifyFullState(nullptr);
+		mFullStateNotifyVersion = conf->getLastNotify();
+	}
+	return mFullStateNotify;
+}
+
+void ServerConferenceEventHandler::invalidateFullStateNotify() {
+	mFullStateNotify = nullptr;
+}
+
 std::shared_ptr<Content> ServerConferenceEventHandler::createNotifyMultipart(int notifyId) {
 	auto conf = getConference();
 	if (!conf) {
 		return nullptr;
 	}
 
-	auto core = conf->getCore();
-	list<shared_ptr<EventLog>> events = core->getPrivate()->mainDb->getConferenceNotifiedEvents(
-	    ConferenceId(conf->getConferenceAddress(), conf->getConferenceAddress(), core->createConferenceIdParams()),
-	    static_cast<unsigned int>(notifyId));
+	const unsigned int firstMissedNotify = static_cast<unsigned int>(notifyId) + 1;
+	if (mNotifyHistory.empty() || (mNotifyHistory.front().first > firstMissedNotify) ||
+	    (mNotifyHistory.back().first != conf->getLastNotify())) {
+		lInfo() << "Notifies " << firstMissedNotify << " to " << conf->getLastNotify() << " of " << *conf
+		        << " are no longer available";
+		return nullptr;
+	}
 
 	list<shared_ptr<Content>> contents;
-	for (const auto &eventLog : events) {
-		string body;
-		shared_ptr<ConferenceNotifiedEvent> notifiedEvent = static_pointer_cast<ConferenceNotifiedEvent>(eventLog);
-		int eventNotifyId = static_cast<int>(notifiedEvent->getNotifyId());
-		conf->setLastNotify(eventNotifyId == -1 ? (conf->getLastNotify() + 1)
-		                                        : static_cast<unsigned int>(eventNotifyId));
-
-		switch (eventLog->getType()) {
-			case EventLog::Type::ConferenceParticipantAdded: {
-				shared_ptr<ConferenceParticipantEvent> addedEvent =
-				    static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = addedEvent->getParticipantAddress();
-				body = createNotifyParticipantAdded(participantAddress);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantRemoved: {
-				shared_ptr<ConferenceParticipantEvent> removedEvent =
-				    static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = removedEvent->getParticipantAddress();
-				body = createNotifyParticipantRemoved(participantAddress);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantSetAdmin: {
-				shared_ptr<ConferenceParticipantEvent> setAdminEvent =
-				    static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = setAdminEvent->getParticipantAddress();
-				body = createNotifyParticipantAdminStatusChanged(participantAddress, true);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantUnsetAdmin: {
-				shared_ptr<ConferenceParticipantEvent> unsetAdminEvent =
-				    static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = unsetAdminEvent->getParticipantAddress();
-				body = createNotifyParticipantAdminStatusChanged(participantAddress, false);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceAdded: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceAddedEvent =
-				    static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = deviceAddedEvent->getParticipantAddress();
-				const std::shared_ptr<Address> &deviceAddress = deviceAddedEvent->getDeviceAddress();
-				body = createNotifyParticipantDeviceAdded(participantAddress, deviceAddress);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceRemoved: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceRemovedEvent =
-				    static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = deviceRemovedEvent->getParticipantAddress();
-				const std::shared_ptr<Address> &deviceAddress = deviceRemovedEvent->getDeviceAddress();
-				body = createNotifyParticipantDeviceRemoved(participantAddress, deviceAddress);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceStatusChanged: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceStatusChangedEvent =
-				    static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress = deviceStatusChangedEvent->getParticipantAddress();
-				const std::shared_ptr<Address> &deviceAddress = deviceStatusChangedEvent->getDeviceAddress();
-				body = createNotifyParticipantDeviceDataChanged(participantAddress, deviceAddress);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceMediaAvailabilityChanged:
-			case EventLog::Type::ConferenceParticipantDeviceMediaCapabilityChanged: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceMediaCapabilityChangedEvent =
-				    static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				const std::shared_ptr<Address> &participantAddress =
-				    deviceMediaCapabilityChangedEvent->getParticipantAddress();
-				const std::shared_ptr<Address> &deviceAddress = deviceMediaCapabilityChangedEvent->getDeviceAddress();
-				body = createNotifyParticipantDeviceDataChanged(participantAddress, deviceAddress);
-			} break;
-
-			case EventLog::Type::ConferenceSubjectChanged: {
-				shared_ptr<ConferenceSubjectEvent> subjectEvent = static_pointer_cast<ConferenceSubjectEvent>(eventLog);
-				body = createNotifySubjectChanged(subjectEvent->getSubject());
-			} break;
-
-			case EventLog::Type::ConferenceAvailableMediaChanged: {
-				shared_ptr<ConferenceAvailableMediaEvent> availableMediaEvent =
-				    static_pointer_cast<ConferenceAvailableMediaEvent>(eventLog);
-				body = createNotifyAvailableMediaChanged(availableMediaEvent->getAvailableMediaType());
-			} break;
-			default:
-				// We should never pass here!
-				L_ASSERT(false);
-				continue;
-		}
-		contents.emplace_back(makeContent(body));
+	for (auto it = mNotifyHistory.cbegin() + (firstMissedNotify - mNotifyHistory.front().first);
+	     it != mNotifyHistory.cend(); ++it) {
+		contents.emplace_back(makeContent(it->second));
 	}
 
 	if (contents.empty()) return Content::create();
@@ -604,6 +555,27 @@ std::shared_ptr<Content> ServerConferenceEventHandler::createNotifyMultipart(int
 	return Content::create(multipart);
 }
 
+void ServerConferenceEventHandler::addNotifyToHistory(unsigned int notifyId, const string &body) {
+	auto conf = getConference();
+	if (!conf) {
+		return;
+	}
+
+	if (!mNotifyHistory.empty()) {
+		// The body of a notify is built once, even if it is sent in several batches.
+		if (mNotifyHistory.back().first == notifyId) return;
+		// A notify was not built by this handler, or the counter was reset: older notifies can't be chained anymore.
+		if (mNotifyHistory.back().first + 1 != notifyId) mNotifyHistory.clear();
+	}
+
+	const size_t historySize = static_cast<size_t>(linphone_config_get_int(
+	    linphone_core_get_config(conf->getCore()->getCCore()), "misc", "conference_notify_history_size", 32));
+	if (historySize == 0) return;
+	while (mNotifyHistory.size() >= historySize)
+		mNotifyHistory.pop_front();
+	mNotifyHistory.emplace_back(notifyId, body);
+}
+
 string ServerConferenceEventHandler::createNotifyParticipantAdded(const std::shared_ptr<Address> &pAddress) {
 	auto conf = getConference();
 	if (!conf) {
@@ -877,8 +849,6 @@ void ServerConferenceEventHandler::notifyResponseCb(LinphoneEvent *lev) {
 	auto ev = dynamic_pointer_cast<EventSubscribe>(Event::toCpp(lev)->getSharedFromThis());
 	auto cbs = ev->getCurrentCallbacks();
 	ServerConferenceEventHandler *handler = static_cast<ServerConferenceEventHandler *>(cbs->getUserData());
-	cbs->setUserData(nullptr);
-	cbs->notifyResponseCb = nullptr;
 
 	if (ev->getReason() != LinphoneReasonNone) return;
 
@@ -893,16 +863,16 @@ void ServerConferenceEventHandler::notifyResponseCb(LinphoneEvent *lev) {
 		if ((confState != ConferenceInterface::State::Deleted) &&
 		    (confState != ConferenceInterface::State::Terminated)) {
 			if (handler->confListener) {
-				for (const auto &p : conf->getParticipants()) {
-					for (const auto &d : p->getDevices()) {
-						if ((d->getConferenceSubscribeEvent() == ev) &&
-						    (d->getState() == ParticipantDevice::State::Joining)) {
-							// fixme confListener should be removed in the futur. On only relevant for server group
-							// chatroom
-							handler->confListener->onFirstNotifyReceived(d->getAddress());
-							return;
-						}
-					}
+				// The callbacks are kept for every notify of the subscription: look the device up rather than
+				// walking all the devices of the conference on each response.
+				shared_ptr<Participant> participant = handler->getConferenceParticipant(ev->getFrom());
+				shared_ptr<ParticipantDevice> d =
+				    participant ? participant->findDevice(ev->getRemoteContact()) : nullptr;
+				if (d && (d->getConferenceSubscribeEvent() == ev) &&
+				    (d->getState() == ParticipantDevice::State::Joining)) {
+					// fixme confListener should be removed in the futur. On only relevant for server group
+					// chatroom
+					handler->confListener->onFirstNotifyReceived(d->getAddress());
 				}
 			}
 		}
@@ -935,7 +905,9 @@ string ServerConferenceEventHandler::createNotify(ConferenceType confInfo, bool
 	map[""].name = "urn:ietf:params:xml:ns:conference-info";
 	map["linphone-cie"].name = "linphone:xml:ns:conference-info-linphone-extension";
 	serializeConferenceInfo(notify, confInfo, map);
-	return notify.str();
+	string body = notify.str();
+	if (!isFullState) addNotifyToHistory(conf->getLastNotify(), body);
+	return body;
 }
 
 string ServerConferenceEventHandler::createNotifySubjectChanged(const string &subject) {
@@ -1079,7 +1051,17 @@ string ServerConferenceEventHandler::createNotifyAvailableMediaChanged(
 	return createNotify(confInfo);
 }
 
+SalBodyHandler *ServerConferenceEventHandler::createSharedBody(const std::shared_ptr<Content> &content) {
+	if (!content || content->isEmpty()) return nullptr;
+	// A new body handler is owned by nobody until referenced, while the one kept by a clean content is returned with
+	// a reference.
+	const bool isNew = content->isDirty() || !content->getBodyHandler();
+	SalBodyHandler *body = Content::getBodyHandlerFromContent(*content, false);
+	return isNew ? sal_body_handler_ref(body) : body;
+}
+
 void ServerConferenceEventHandler::notifyParticipant(const std::shared_ptr<Content> &notify,
+                                                     const SalBodyHandler *body,
                                                      const shared_ptr<Participant> &participant) {
 	for (const auto &device : participant->getDevices()) {
 		/* Only notify to device that are present in the conference. */
@@ -1091,7 +1073,7 @@ void ServerConferenceEventHandler::notifyParticipant(const std::shared_ptr<Conte
 			case ParticipantDevice::State::OnHold:
 			case ParticipantDevice::State::RequestingToJoin:
 			case ParticipantDevice::State::MutedByFocus:
-				notifyParticipantDevice(notify, device);
+				notifyParticipantDevice(notify, body, device);
 				break;
 			case ParticipantDevice::State::Leaving:
 			case ParticipantDevice::State::Left:
@@ -1103,6 +1085,14 @@ void ServerConferenceEventHandler::notifyParticipant(const std::shared_ptr<Conte
 
 void ServerConferenceEventHandler::notifyParticipantDevice(const shared_ptr<Content> &content,
                                                            const shared_ptr<ParticipantDevice> &device) {
+	SalBodyHandler *body = createSharedBody(content);
+	notifyParticipantDevice(content, body, device);
+	if (body) sal_body_handler_unref(body);
+}
+
+void ServerConferenceEventHandler::notifyParticipantDevice(const shared_ptr<Content> &content,
+                                                           const SalBodyHandler *body,
+                                                           const shared_ptr<ParticipantDevice> &device) {
 	if (!device->isSubscribedToConferenceEventPackage()) return;
 	auto conf = getConference();
 	if (!conf) {
@@ -1110,12 +1100,16 @@ void ServerConferenceEventHandler::notifyParticipantDevice(const shared_ptr<Cont
 	}
 
 	shared_ptr<EventSubscribe> ev = device->getConferenceSubscribeEvent();
-	shared_ptr<EventCbs> cbs = EventCbs::create();
-	cbs->setUserData(this);
-	cbs->notifyResponseCb = notifyResponseCb;
-	ev->addCallbacks(cbs);
+	if (!mNotifyCbs) {
+		mNotifyCbs = EventCbs::create();
+		mNotifyCbs->setUserData(this);
+		mNotifyCbs->notifyResponseCb = notifyResponseCb;
+	}
+	const auto &evCbs = ev->getCallbacksList();
+	if (find(evCbs.cbegin(), evCbs.cend(), mNotifyCbs) == evCbs.cend()) ev->addCallbacks(mNotifyCbs);
 
-	ev->notify(content);
+	// Every request references the same body, it is neither copied nor serialized again for each device.
+	ev->notifyWithBodyHandler(body);
 	LinphoneContent *cContent = content->isEmpty() ? nullptr : content->toC();
 	linphone_core_notify_notify_sent(conf->getCore()->getCCore(), ev->toC(), cContent);
 }
@@ -1168,7 +1162,7 @@ LinphoneStatus ServerConferenceEventHandler::subscribeReceived(const shared_ptr<
 			}
 			lInfo() << "Sending initial notify of " << *conf << " to: " << *dAddress
 			        << " with last notify version set to " << conf->getLastNotify();
-			notifyFullState(createNotifyFullState(ev), device);
+			notifyFullState(getFullStateNotify(), device);
 			device->clearChangingSubscribeEvent();
 		} else if (evLastNotify < lastNotify) {
 			lInfo() << "Sending all missed notify [" << evLastNotify << "-" << lastNotify << "] for " << *conf
@@ -1181,16 +1175,20 @@ LinphoneStatus ServerConferenceEventHandler::subscribeReceived(const shared_ptr<
 			// capabilities. Every subscribe sent for a conference will be answered by a notify full state as events are
 			// not stored in the database
 			const auto &conference = conf->getCore()->findConference(conf->getConferenceId(), false);
-			if ((conference && !conference->isChatOnly()) || forceFullState) {
-				notifyFullState(createNotifyFullState(ev), device);
+			shared_ptr<Content> missedNotifies = nullptr;
+			if ((!conference || conference->isChatOnly()) && !forceFullState) {
+				missedNotifies = createNotifyMultipart(static_cast<int>(evLastNotify));
+			}
+			if (missedNotifies) {
+				notifyParticipantDevice(missedNotifies, device);
 			} else {
-				notifyParticipantDevice(createNotifyMultipart(static_cast<int>(evLastNotify)), device);
+				notifyFullState(getFullStateNotify(), device);
 			}
 		} else if (evLastNotify > lastNotify) {
 			lWarning() << "Last notify received by client [" << evLastNotify << "] for " << *conf
 			           << " should not be higher than last notify sent by server [" << lastNotify
 			           << "] - sending a notify full state in an attempt to recover from this situation";
-			notifyFullState(createNotifyFullState(ev), device);
+			notifyFullState(getFullStateNotify(), device);
 		} else {
 			notifyParticipantDevice(Content::create(), device);
 		}
@@ -1216,8 +1214,8 @@ void ServerConferenceEventHandler::subscriptionStateChanged(const shared_ptr<Eve
 	}
 }
 
-std::shared_ptr<Content> ServerConferenceEventHandler::getNotifyForId(int notifyId,
-                                                                      const shared_ptr<EventSubscribe> &ev) {
+std::shared_ptr<Content>
+ServerConferenceEventHandler::getNotifyForId(int notifyId, BCTBX_UNUSED(const shared_ptr<EventSubscribe> &ev)) {
 	auto conf = getConference();
 	if (!conf) {
 		return nullptr;
@@ -1229,15 +1227,15 @@ std::shared_ptr<Content> ServerConferenceEventHandler::getNotifyForId(int notify
 	                                                     "full_state_trigger_due_to_missing_updates", 10);
 	bool forceFullState =
 	    (notifyId > static_cast<int>(lastNotify)) || (static_cast<int>(lastNotify) - notifyId) > fullStateTrigger;
-	if ((notifyId == 0) || forceFullState) {
-		auto content = createNotifyFullState(ev);
-		auto multipart = ContentManager::contentListToMultipart({content});
-		return Content::create(multipart);
-	} else if (notifyId < static_cast<int>(lastNotify)) {
-		return createNotifyMultipart(notifyId);
+	if ((notifyId != 0) && !forceFullState) {
+		if (notifyId == static_cast<int>(lastNotify)) return Content::create();
+		auto missedNotifies = createNotifyMultipart(notifyId);
+		if (missedNotifies) return missedNotifies;
 	}
 
-	return Content::create();
+	auto content = getFullStateNotify();
+	auto multipart = ContentManager::contentListToMultipart({content});
+	return Content::create(multipart);
 }
 
 std::shared_ptr<Content> ServerConferenceEventHandler::makeContent(const std::string &xml) {
@@ -1262,6 +1260,7 @@ void ServerConferenceEventHandler::onFullStateReceived() {
 
 void ServerConferenceEventHandler::onParticipantAdded(const std::shared_ptr<ConferenceParticipantEvent> &event,
                                                       const std::shared_ptr<Participant> &participant) {
+	invalidateFullStateNotify();
 	auto conf = getConference();
 	if (!conf) {
 		return;
@@ -1286,6 +1285,7 @@ void ServerConferenceEventHandler::onParticipantAdded(const std::shared_ptr<Conf
 
 void ServerConferenceEventHandler::onParticipantRemoved(const std::shared_ptr<ConferenceParticipantEvent> &event,
                                                         const std::shared_ptr<Participant> &participant) {
+	invalidateFullStateNotify();
 	auto conf = getConference();
 	if (!conf) {
 		return;
@@ -1308,6 +1308,7 @@ void ServerConferenceEventHandler::onParticipantRemoved(const std::shared_ptr<Co
 
 void ServerConferenceEventHandler::onParticipantSetAdmin(const std::shared_ptr<ConferenceParticipantEvent> &event,
                                                          const std::shared_ptr<Participant> &participant) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	const bool isAdmin = (event->getType() == EventLog::Type::ConferenceParticipantSetAdmin);
@@ -1326,6 +1327,7 @@ void ServerConferenceEventHandler::onParticipantSetAdmin(const std::shared_ptr<C
 }
 
 void ServerConferenceEventHandler::onSubjectChanged(const std::shared_ptr<ConferenceSubjectEvent> &event) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	if (conf) {
@@ -1353,6 +1355,7 @@ void ServerConferenceEventHandler::onParticipantDeviceIsMuted(const std::shared_
 
 void ServerConferenceEventHandler::onAvailableMediaChanged(
     const std::shared_ptr<ConferenceAvailableMediaEvent> &event) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	if (!conf) {
@@ -1370,6 +1373,7 @@ void ServerConferenceEventHandler::onAvailableMediaChanged(
 void ServerConferenceEventHandler::onParticipantDeviceJoiningRequest(
     BCTBX_UNUSED(const std::shared_ptr<ConferenceParticipantDeviceEvent> &event),
     const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the conference has been terminated
 	auto conf = getConference();
 	const auto &dAddress = device->getAddress();
@@ -1385,6 +1389,7 @@ void ServerConferenceEventHandler::onParticipantDeviceJoiningRequest(
 
 void ServerConferenceEventHandler::onParticipantDeviceAdded(
     const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	const auto &dAddress = device->getAddress();
@@ -1412,6 +1417,7 @@ void ServerConferenceEventHandler::onParticipantDeviceAdded(
 
 void ServerConferenceEventHandler::onParticipantDeviceRemoved(
     const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	const auto &dAddress = device->getAddress();
@@ -1432,6 +1438,7 @@ void ServerConferenceEventHandler::onParticipantDeviceRemoved(
 
 void ServerConferenceEventHandler::onParticipantDeviceStateChanged(
     const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	const auto &dAddress = device->getAddress();
@@ -1453,6 +1460,7 @@ void ServerConferenceEventHandler::onParticipantDeviceStateChanged(
 void ServerConferenceEventHandler::onParticipantDeviceScreenSharingChanged(
     BCTBX_UNUSED(const std::shared_ptr<ConferenceParticipantDeviceEvent> &event),
     const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	if (conf) {
@@ -1468,6 +1476,7 @@ void ServerConferenceEventHandler::onParticipantDeviceScreenSharingChanged(
 void ServerConferenceEventHandler::onParticipantDeviceMediaCapabilityChanged(
     BCTBX_UNUSED(const std::shared_ptr<ConferenceParticipantDeviceEvent> &event),
     const std::shared_ptr<ParticipantDevice> &device) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	const auto &dAddress = device->getAddress();
@@ -1482,6 +1491,7 @@ void ServerConferenceEventHandler::onParticipantDeviceMediaCapabilityChanged(
 
 void ServerConferenceEventHandler::onEphemeralModeChanged(
     const std::shared_ptr<ConferenceEphemeralMessageEvent> &event) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	if (conf) {
@@ -1493,6 +1503,7 @@ void ServerConferenceEventHandler::onEphemeralModeChanged(
 
 void ServerConferenceEventHandler::onEphemeralLifetimeChanged(
     const std::shared_ptr<ConferenceEphemeralMessageEvent> &event) {
+	invalidateFullStateNotify();
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	auto conf = getConference();
 	if (conf) {
@@ -1504,6 +1515,7 @@ void ServerConferenceEventHandler::onEphemeralLifetimeChanged(
 }
 
 void ServerConferenceEventHandler::onStateChanged(LinphonePrivate::ConferenceInterface::State state) {
+	invalidateFullStateNotify();
 	auto conf = getConference();
 	if (!conf) {
 		return;
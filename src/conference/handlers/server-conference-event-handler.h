@@ -21,6 +21,7 @@
 #ifndef _L_LOCAL_CONFERENCE_EVENT_HANDLER_H_
 #define _L_LOCAL_CONFERENCE_EVENT_HANDLER_H_
 
+#include <deque>
 #include <memory>
 #include <string>
 
@@ -58,6 +59,7 @@ class LINPHONE_PUBLIC ServerConferenceEventHandler : public std::enable_shared_f
 #endif
 public:
 	ServerConferenceEventHandler(std::shared_ptr<Conference> conf, ConferenceListener *listener = nullptr);
+	virtual ~ServerConferenceEventHandler();
 
 	void publishStateChanged(const std::shared_ptr<EventPublish> &ev, LinphonePublishState state);
 
@@ -74,8 +76,21 @@ public:
 	void notifyAll(const std::shared_ptr<Content> &notify);
 	void notifyOnlyAdmins(const std::shared_ptr<Content> &notify);
 	std::shared_ptr<Content> createNotifyFullState(const std::shared_ptr<EventSubscribe> &ev);
+	/*
+	 * Build the multipart body of the notifies following notifyId, from the last serialized notifies kept in memory.
+	 * @return nullptr if some of them are no longer kept, in which case a full state must be sent instead.
+	 */
 	std::shared_ptr<Content> createNotifyMultipart(int notifyId);
 
+	/*
+	 * Get the full state NOTIFY body of the current notify version.
+	 * The body is built once per version and shared by all the devices subscribing at that version, so that a
+	 * subscription storm does not rebuild and serialize the whole conference for every device.
+	 * The listener callbacks drop it, as some changes of the conference are not notified and don't bump the version.
+	 */
+	std::shared_ptr<Content> getFullStateNotify();
+	void invalidateFullStateNotify();
+
 	// Conference
 	std::string createNotifyAvailableMediaChanged(const std::map<ConferenceMediaCapabilities, bool> mediaCapabilities);
 	std::string createNotifySubjectChanged();
@@ -231,14 +246,33 @@ protected:
 	ConferenceListener *confListener;
 
 private:
+	void addNotifyToHistory(unsigned int notifyId, const std::string &body);
+
+	// Notify callbacks shared by all the subscriptions of the conference.
+	std::shared_ptr<EventCbs> mNotifyCbs;
+
+	std::shared_ptr<Content> mFullStateNotify;
+	unsigned int mFullStateNotifyVersion = 0;
+	// Serialized bodies of the last consecutive notifies, oldest first. Its size is set by
+	// [misc] conference_notify_history_size.
+	std::deque<std::pair<unsigned int, std::string>> mNotifyHistory;
+
 	std::string createNotify(Xsd::ConferenceInfo::ConferenceType confInfo, bool isFullState = false);
 	std::string createNotifySubjectChanged(const std::string &subject);
 	std::string createNotifyEphemeralLifetime(const long &lifetime);
 	std::string createNotifyEphemeralMode(const EventLog::Type &type);
 	std::shared_ptr<Content> makeContent(const std::string &xml);
-	void notifyParticipant(const std::shared_ptr<Content> &notify, const std::shared_ptr<Participant> &participant);
+	void notifyParticipant(const std::shared_ptr<Content> &notify,
+	                       const SalBodyHandler *body,
+	                       const std::shared_ptr<Participant> &participant);
 	void notifyParticipantDevice(const std::shared_ptr<Content> &content,
 	                             const std::shared_ptr<ParticipantDevice> &device);
+	void notifyParticipantDevice(const std::shared_ptr<Content> &content,
+	                             const SalBodyHandler *body,
+	                             const std::shared_ptr<ParticipantDevice> &device);
+
+	// Body handler of a notify, built once and referenced by the requests sent to all the devices.
+	static SalBodyHandler *createSharedBody(const std::shared_ptr<Content> &content);
 
 	std::shared_ptr<Participant> getConferenceParticipant(const std::shared_ptr<Address> &address) const;
 
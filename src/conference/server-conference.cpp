@@ -258,6 +258,7 @@ bool ServerConference::update(const ConferenceParamsInterface &newParameters) {
 	bool newVideoEnablement = mConfParams->videoEnabled();
 	bool newAudioEnablement = mConfParams->audioEnabled();
 	bool newChatEnablement = mConfParams->chatEnabled();
+	if (mChatRoom) getCore()->updateChatRoomListPosition(mChatRoom);
 
 	// Update endpoints only if audio or video settings have changed
 	if ((newVideoEnablement != previousVideoEnablement) || (newAudioEnablement != previousAudioEnablement)) {
@@ -2250,6 +2251,8 @@ void ServerConference::addParticipantDevice(BCTBX_UNUSED(const shared_ptr<Partic
 			device->setName(deviceInfo->getName());
 			device->setCapabilityDescriptor(deviceInfo->getCapabilityDescriptor());
 			serverGroupChatRoom->updateProtocolVersionFromDevice(device);
+			// No NOTIFY is sent for this change, the cached full state must not keep the previous values.
+			invalidateFullStateNotify();
 		} else if (findParticipant(participant->getAddress())) {
 			bool allDevLeft = !participant->getDevices().empty() && ServerConference::allDevicesLeft(participant);
 			/*
@@ -2278,6 +2281,12 @@ void ServerConference::addParticipantDevice(BCTBX_UNUSED(const shared_ptr<Partic
 #endif // HAVE_ADVANCED_IM
 }
 
+void ServerConference::invalidateFullStateNotify() {
+#ifdef HAVE_ADVANCED_IM
+	if (mEventHandler) mEventHandler->invalidateFullStateNotify();
+#endif // HAVE_ADVANCED_IM
+}
+
 std::shared_ptr<ParticipantDevice> ServerConference::createParticipantDevice(std::shared_ptr<Participant> participant,
                                                                              std::shared_ptr<Call> call) {
 	auto device = Conference::createParticipantDevice(participant, call);
@@ -2300,6 +2309,8 @@ std::shared_ptr<ParticipantDevice> ServerConference::createParticipantDevice(std
 		if (!displayName.empty()) {
 			device->setName(displayName);
 		}
+		// The device may already be known, in which case it is updated without NOTIFY.
+		invalidateFullStateNotify();
 		enableScreenSharing(session, false);
 		if (!mConfParams->isHidden()) {
 			if (mConfParams->chatEnabled()) {
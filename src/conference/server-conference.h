@@ -291,6 +291,8 @@ private:
 	void cleanup();
 
 	void onParticipantDeviceLeft(const std::shared_ptr<ParticipantDevice> &device);
+	// Drop the full state NOTIFY body shared by the subscribers after a change that is not notified.
+	void invalidateFullStateNotify();
 
 	bool checkClientCompatibility(const std::shared_ptr<Call> &call,
 	                              const std::shared_ptr<Address> &remoteContactAddress,
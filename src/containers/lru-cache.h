@@ -33,8 +33,7 @@ LINPHONE_BEGIN_NAMESPACE
 template <typename Key, typename Value>
 class LruCache {
 public:
-	LruCache(int capacity = DefaultCapacity) : mCapacity(capacity) {
-		if (capacity < MinCapacity) capacity = MinCapacity;
+	LruCache(int capacity = DefaultCapacity) : mCapacity(capacity < MinCapacity ? MinCapacity : capacity) {
 	}
 
 	int getCapacity() const {
@@ -45,11 +44,20 @@ public:
 		return int(mKeyToPair.size());
 	}
 
+	// Look up a value and mark it as the most recently used one.
 	Value *operator[](const Key &key) {
 		auto it = mKeyToPair.find(key);
-		return it == mKeyToPair.end() ? nullptr : &it->second.second;
+		if (it == mKeyToPair.end()) {
+			mMisses++;
+			return nullptr;
+		}
+		mHits++;
+		// Splicing keeps the stored list iterator valid.
+		mKeys.splice(mKeys.begin(), mKeys, it->second.first);
+		return &it->second.second;
 	}
 
+	// Look up a value without changing the eviction order.
 	const Value *operator[](const Key &key) const {
 		auto it = mKeyToPair.find(key);
 		return it == mKeyToPair.cend() ? nullptr : &it->second.second;
@@ -60,10 +68,8 @@ public:
 		if (it != mKeyToPair.end()) {
 			mKeys.erase(it->second.first);
 			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
+		} else if (int(mKeyToPair.size()) >= mCapacity) {
+			evictLast();
 		}
 
 		mKeys.push_front(key);
@@ -75,29 +81,62 @@ public:
 		if (it != mKeyToPair.end()) {
 			mKeys.erase(it->second.first);
 			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
+		} else if (int(mKeyToPair.size()) >= mCapacity) {
+			evictLast();
 		}
 
 		mKeys.push_front(key);
 		mKeyToPair.insert({key, std::make_pair(mKeys.begin(), std::move(value))});
 	}
 
+	bool erase(const Key &key) {
+		auto it = mKeyToPair.find(key);
+		if (it == mKeyToPair.end()) return false;
+		mKeys.erase(it->second.first);
+		mKeyToPair.erase(it);
+		return true;
+	}
+
 	void clear() {
 		mKeyToPair.clear();
 		mKeys.clear();
 	}
 
+	unsigned long long getHits() const {
+		return mHits;
+	}
+
+	unsigned long long getMisses() const {
+		return mMisses;
+	}
+
+	unsigned long long getEvictions() const {
+		return mEvictions;
+	}
+
+	void resetCounters() {
+		mHits = mMisses = mEvictions = 0;
+	}
+
 	static constexpr int MinCapacity = 10;
 	static constexpr int DefaultCapacity = 1000;
 
 private:
 	using Pair = std::pair<typename std::list<Key>::iterator, Value>;
 
+	void evictLast() {
+		auto it = mKeyToPair.find(mKeys.back());
+		mKeys.pop_back();
+		mKeyToPair.erase(it);
+		mEvictions++;
+	}
+
 	const int mCapacity;
 
+	unsigned long long mHits = 0;
+	unsigned long long mMisses = 0;
+	unsigned long long mEvictions = 0;
+
 	// See: https://stackoverflow.com/questions/16781886/can-we-store-unordered-maptiterator
 	// Do not store iterator key.
 	std::list<Key> mKeys;
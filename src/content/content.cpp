@@ -110,6 +110,7 @@ Content::~Content() {
 	 * private data like cipher keys or decoded messages.
 	 */
 	mBody.assign(mBody.size(), 0);
+	mCache.buffer.assign(mCache.buffer.size(), '\0');
 	if (mBodyHandler != nullptr) sal_body_handler_unref(mBodyHandler);
 }
 
@@ -133,6 +134,7 @@ Content &Content::operator=(Content &&other) noexcept {
 	mIsDirty = std::move(other.mIsDirty);
 	mBodyHandler = std::move(other.mBodyHandler);
 	other.mBodyHandler = nullptr;
+	resetBodyCache();
 	return *this;
 }
 
@@ -149,7 +151,11 @@ void Content::copy(const Content &other) {
 	mContentEncoding = other.getContentEncoding();
 	mHeaders = other.getHeaders();
 	mSize = other.mSize;
-	mCache = other.mCache;
+	// The body string is rebuilt when needed rather than duplicated along with the body.
+	mCache.name = other.mCache.name;
+	mCache.filePath = other.mCache.filePath;
+	mCache.headerValue = other.mCache.headerValue;
+	resetBodyCache();
 	if (!mIsDirty && mBodyHandler != nullptr) mBodyHandler = sal_body_handler_ref(other.mBodyHandler);
 }
 
@@ -185,26 +191,42 @@ const vector<uint8_t> &Content::getBody() const {
 	return mBody;
 }
 
+string_view Content::getBodyView() const {
+	return string_view(reinterpret_cast<const char *>(mBody.data()), mBody.size());
+}
+
 string Content::getBodyAsString() const {
-	return Utils::utf8ToLocale(string(mBody.begin(), mBody.end()));
+	return Utils::utf8ToLocale(getBodyAsUtf8String());
 }
 
 const string &Content::getBodyAsUtf8String() const {
-	mCache.buffer = string(mBody.begin(), mBody.end());
+	if (!mCache.bufferIsUpToDate) {
+		mCache.buffer.assign(getBodyView());
+		mCache.bufferIsUpToDate = true;
+	}
 	return mCache.buffer;
 }
 
+void Content::resetBodyCache() {
+	// Release the memory as well, the body may be large.
+	string().swap(mCache.buffer);
+	mCache.bufferIsUpToDate = false;
+}
+
 void Content::setBody(const vector<uint8_t> &body) {
 	mBody = body;
+	resetBodyCache();
 }
 
 void Content::setBody(vector<uint8_t> &&body) {
 	mBody = std::move(body);
+	resetBodyCache();
 }
 
 void Content::setBodyFromLocale(const string &body) {
 	string toUtf8 = Utils::localeToUtf8(body);
 	mBody = vector<uint8_t>(toUtf8.cbegin(), toUtf8.cend());
+	resetBodyCache();
 }
 
 void Content::setBody(const void *buffer, size_t size) {
@@ -213,12 +235,14 @@ void Content::setBody(const void *buffer, size_t size) {
 	const char *start = static_cast<const char *>(buffer);
 	if (start != nullptr) mBody = vector<uint8_t>(start, start + size);
 	else mBody.clear();
+	resetBodyCache();
 }
 
 void Content::setBodyFromUtf8(const string &body) {
 	mIsDirty = true;
 
 	mBody = vector<uint8_t>(body.cbegin(), body.cend());
+	resetBodyCache();
 }
 
 const std::string &Content::getName() const {
@@ -350,7 +374,8 @@ SalBodyHandler *Content::getBodyHandlerFromContent(const Content &content, bool
 	ContentType contentType = content.mContentType;
 	if (contentType.isMultipart() && parseMultipart) {
 		size_t size = content.getSize();
-		char *buffer = bctbx_strdup(content.getBodyAsUtf8String().c_str());
+		// The cached string is null terminated, unlike the body itself.
+		const char *buffer = content.getBodyAsUtf8String().c_str();
 		const char *boundary = L_STRING_TO_C(contentType.getParameter("boundary").getValue());
 		belle_sip_multipart_body_handler_t *bh = nullptr;
 		if (boundary) bh = belle_sip_multipart_body_handler_new_from_buffer(buffer, size, boundary);
@@ -374,7 +399,6 @@ SalBodyHandler *Content::getBodyHandlerFromContent(const Content &content, bool
 		}
 
 		bodyHandler = reinterpret_cast<SalBodyHandler *>(BELLE_SIP_BODY_HANDLER(bh));
-		bctbx_free(buffer);
 	} else {
 		bodyHandler = sal_body_handler_new_from_buffer(content.mBody.data(), content.mBody.size());
 	}
@@ -510,7 +534,7 @@ const string Content::exportPlainFileFromEncryptedFile(const string &filePath) c
 }
 
 std::ostream &operator<<(std::ostream &stream, const Content &content) {
-	return stream << "Content of type " << content.getContentType() << " with body " << content.getBodyAsUtf8String();
+	return stream << "Content of type " << content.getContentType() << " with body " << content.getBodyView();
 }
 
 std::ostream &operator<<(std::ostream &stream, const std::list<Content> &contents) {
@@ -546,6 +570,7 @@ bool Content::deflateBody(void) {
 			lInfo() << "Content deflate body from " << mBody.size() << " bytes to " << compressedMessage.size()
 			        << " bytes";
 			mBody = std::move(compressedMessage);
+			resetBodyCache();
 			setContentEncoding("deflate");
 		}
 	}
@@ -604,6 +629,7 @@ bool Content::inflateBody(void) {
 	}
 	lInfo() << "Content inflate message from " << initialSize << " bytes to " << mBody.size() << " bytes";
 	inflateEnd(&zlibStream);
+	resetBodyCache();
 	setContentEncoding("");
 	return true;
 #else  // HAVE_ZLIB
@@ -22,6 +22,7 @@
 #define _L_CONTENT_H_
 
 #include <list>
+#include <string_view>
 #include <vector>
 
 #include "belle-sip/object++.hh"
@@ -71,7 +72,10 @@ public:
 	void setContentEncoding(const std::string &contentEncoding);
 
 	const std::vector<uint8_t> &getBody() const;
+	// Non-owning view of the body, valid until the body is modified.
+	std::string_view getBodyView() const;
 	std::string getBodyAsString() const;
+	// The string is built on first use and kept until the body is modified.
 	const std::string &getBodyAsUtf8String() const;
 
 	void setBody(const std::vector<uint8_t> &body);
@@ -136,6 +140,8 @@ protected:
 	const std::string exportPlainFileFromEncryptedFile(const std::string &filePath) const;
 
 private:
+	void resetBodyCache();
+
 	std::vector<uint8_t> mBody;
 	ContentType mContentType;
 	ContentDisposition mContentDisposition;
@@ -150,6 +156,7 @@ private:
 	struct Cache {
 		std::string name;
 		std::string buffer;
+		bool bufferIsUpToDate = false;
 		std::string filePath;
 		std::string headerValue;
 	} mutable mCache;
@@ -65,6 +65,8 @@ int CorePrivate::addCall(const shared_ptr<Call> &call) {
 		linphone_core_stop_dtmf_stream(q->getCCore());
 	}
 	calls.push_back(call);
+	// Calls are iterated at the active rate, don't let linphone_core_wait() sleep until its timeout.
+	wakeUp();
 
 	linphone_core_notify_call_created(q->getCCore(), call->toC());
 	return 0;
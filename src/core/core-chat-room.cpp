@@ -277,18 +277,31 @@ CorePrivate::searchChatRoom(const std::shared_ptr<ConferenceParams> &params,
                             const std::list<std::shared_ptr<Address>> &participants) const {
 	L_Q();
 	ConferenceContext referenceConferenceContext(params, localAddress, remoteAddress, participants);
-	const auto &chatRooms = q->getRawChatRoomList();
-	const auto it = std::find_if(chatRooms.begin(), chatRooms.end(), [&](const auto &chatRoom) {
+	const auto matches = [&referenceConferenceContext](const shared_ptr<AbstractChatRoom> &chatRoom) {
 		ConferenceContext conferenceContext(chatRoom->getCurrentParams(), chatRoom->getLocalAddress(),
 		                                    chatRoom->getPeerAddress(), chatRoom->getParticipantAddresses());
 		return (referenceConferenceContext == conferenceContext);
-	});
+	};
+
+	const string peerKey = getAddressIndexKey(remoteAddress);
+	if (peerKey.empty()) {
+		// Any peer address matches, all the chat rooms have to be compared.
+		const auto &chatRooms = q->getRawChatRoomList();
+		const auto it = std::find_if(chatRooms.begin(), chatRooms.end(), matches);
+		return (it != chatRooms.cend()) ? *it : nullptr;
+	}
 
-	std::shared_ptr<AbstractChatRoom> chatRoom;
-	if (it != chatRooms.cend()) {
-		chatRoom = *it;
+	// Same order as getRawChatRoomList(): chat rooms of conferences first.
+	const auto conferences = mConferencesByPeerAddress.equal_range(peerKey);
+	for (auto it = conferences.first; it != conferences.second; ++it) {
+		const auto &chatRoom = it->second->getChatRoom();
+		if (chatRoom && matches(chatRoom)) return chatRoom;
 	}
-	return chatRoom;
+	const auto chatRooms = mChatRoomsByPeerAddress.equal_range(peerKey);
+	for (auto it = chatRooms.first; it != chatRooms.second; ++it) {
+		if (it->second && matches(it->second)) return it->second;
+	}
+	return nullptr;
 }
 
 std::shared_ptr<AbstractChatRoom> CorePrivate::searchChatRoom(const std::string identifier) const {
@@ -419,7 +432,7 @@ void CorePrivate::insertChatRoom(const shared_ptr<AbstractChatRoom> &chatRoom) {
 		if (linphone_core_get_global_state(getCCore()) != LinphoneGlobalStartup) {
 			lInfo() << "Insert chat room " << chatRoom << " (id " << conferenceId << ") to core map";
 		}
-		mChatRoomsById[conferenceId] = chatRoom;
+		setChatRoomById(conferenceId, chatRoom);
 	}
 }
 
@@ -432,7 +445,7 @@ void CorePrivate::insertChatRoomWithDb(const shared_ptr<AbstractChatRoom> &chatR
 }
 
 void CorePrivate::loadChatRooms() {
-	mChatRoomsById.clear();
+	clearChatRoomsById();
 #ifdef HAVE_ADVANCED_IM
 	if (clientListEventHandler) clientListEventHandler->clearHandlers();
 #endif
@@ -448,7 +461,9 @@ void CorePrivate::loadChatRooms() {
 		} else {
 			const auto &conference = chatRoom->getConference();
 			const ConferenceId &conferenceId = conference->getConferenceId();
-			mConferenceById.insert(std::make_pair(conferenceId, conference));
+			if (mConferenceById.find(conferenceId) == mConferenceById.end()) {
+				setConferenceById(conferenceId, conference);
+			}
 		}
 
 		// TODO FIXME: Remove later when devices for friends will be notified through presence
@@ -635,8 +650,8 @@ void CorePrivate::updateChatRoomConferenceId(const shared_ptr<AbstractChatRoom>
 	const ConferenceId &newConferenceId = chatRoom->getConferenceId();
 	lInfo() << "Chat room [" << oldConferenceId << "] has been exhumed into [" << newConferenceId << "]";
 
-	mConferenceById.erase(oldConferenceId);
-	mConferenceById[newConferenceId] = chatRoom->getConference();
+	eraseConferenceById(oldConferenceId);
+	setConferenceById(newConferenceId, chatRoom->getConference());
 
 	mainDb->updateChatRoomConferenceId(oldConferenceId, newConferenceId);
 #endif
@@ -647,10 +662,6 @@ void CorePrivate::updateChatRoomConferenceId(const shared_ptr<AbstractChatRoom>
 
 // -----------------------------------------------------------------------------
 
-static bool compare_chat_room(const shared_ptr<AbstractChatRoom> &first, const shared_ptr<AbstractChatRoom> &second) {
-	return first->getLastUpdateTime() > second->getLastUpdateTime();
-}
-
 std::shared_ptr<const Address> Core::getConferenceFactoryAddress(const shared_ptr<Core> &core,
                                                                  const std::shared_ptr<const Address> &localAddress) {
 	auto account = core->lookupKnownAccount(localAddress, true);
@@ -696,53 +707,122 @@ std::list<std::shared_ptr<AbstractChatRoom>> Core::getRawChatRoomList(bool inclu
 	return chatRooms;
 }
 
+static bool isChatRoomVisible(const shared_ptr<AbstractChatRoom> &chatRoom,
+                              bool hideChatRoomsWithMedia,
+                              bool hideEmptyChatRooms,
+                              bool hideChatRoomsFromRemovedProxies,
+                              const vector<shared_ptr<const Address>> &localAddresses) {
+	const auto &chatRoomParams = chatRoom->getCurrentParams();
+
+	if (hideChatRoomsWithMedia) {
+		if (chatRoomParams->audioEnabled() || chatRoomParams->videoEnabled()) {
+			return false;
+		}
+	}
+	if (hideEmptyChatRooms) {
+		if (chatRoom->isEmpty() && !chatRoomParams->isGroup()) {
+			return false;
+		}
+	}
+
+	if (hideChatRoomsFromRemovedProxies) {
+		auto chatRoomLocalAddress = chatRoom->getLocalAddress();
+		const auto found = std::find_if(std::begin(localAddresses), std::end(localAddresses),
+		                                [&](const auto &addr) { return addr->weakEqual(chatRoomLocalAddress); });
+		if (found == std::end(localAddresses)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void Core::updateChatRoomList() const {
 	LinphoneCore *lc = getCCore();
 	LinphoneConfig *config = linphone_core_get_config(lc);
+	auto &index = mChatRoomListIndex;
 
 	bool hideChatRoomsWithMedia = !!linphone_config_get_int(config, "chat", "hide_chat_rooms_with_media", 1);
 	bool hideEmptyChatRooms = !!linphone_config_get_int(config, "misc", "hide_empty_chat_rooms", 1);
 
 	bool hideChatRoomsFromRemovedProxyConfig =
 	    !!linphone_config_get_int(config, "misc", "hide_chat_rooms_from_removed_proxies", 1);
-	list<shared_ptr<const Address>> localAddresses;
+	// Identity addresses are replaced, not modified, when an account is updated.
+	vector<shared_ptr<const Address>> localAddresses;
 	if (hideChatRoomsFromRemovedProxyConfig) {
 		for (const auto &account : getAccounts()) {
-			auto localAddress = account->getAccountParams()->getIdentityAddress();
-			localAddresses.push_front(localAddress);
+			localAddresses.push_back(account->getAccountParams()->getIdentityAddress());
 		}
 	}
 
-	list<shared_ptr<AbstractChatRoom>> rooms;
-
-	for (const auto &chatRoom : getRawChatRoomList()) {
-		const auto &chatRoomParams = chatRoom->getCurrentParams();
-
-		if (hideChatRoomsWithMedia) {
-			if (chatRoomParams->audioEnabled() || chatRoomParams->videoEnabled()) {
+	if (!index.valid || (index.hideChatRoomsWithMedia != hideChatRoomsWithMedia) ||
+	    (index.hideEmptyChatRooms != hideEmptyChatRooms) ||
+	    (index.hideChatRoomsFromRemovedProxies != hideChatRoomsFromRemovedProxyConfig) ||
+	    (index.localAddresses != localAddresses)) {
+		index.hideChatRoomsWithMedia = hideChatRoomsWithMedia;
+		index.hideEmptyChatRooms = hideEmptyChatRooms;
+		index.hideChatRoomsFromRemovedProxies = hideChatRoomsFromRemovedProxyConfig;
+		index.localAddresses = std::move(localAddresses);
+		index.sorted.clear();
+		index.positions.clear();
+		for (const auto &chatRoom : getRawChatRoomList()) {
+			if (!isChatRoomVisible(chatRoom, index.hideChatRoomsWithMedia, index.hideEmptyChatRooms,
+			                       index.hideChatRoomsFromRemovedProxies, index.localAddresses))
 				continue;
-			}
-		}
-		if (hideEmptyChatRooms) {
-			if (chatRoom->isEmpty() && !chatRoomParams->isGroup()) {
-				continue;
-			}
+			index.positions[chatRoom.get()] = index.sorted.emplace(chatRoom->getLastUpdateTime(), chatRoom);
 		}
+		index.valid = true;
+		index.version++;
+	}
 
-		if (hideChatRoomsFromRemovedProxyConfig) {
-			auto chatRoomLocalAddress = chatRoom->getLocalAddress();
-			const auto found = std::find_if(std::begin(localAddresses), std::end(localAddresses),
-			                                [&](const auto &addr) { return addr->weakEqual(chatRoomLocalAddress); });
-			if (found == std::end(localAddresses)) {
-				continue;
-			}
-		}
+	if (index.listVersion != index.version) {
+		mChatRooms.mList.clear();
+		for (const auto &entry : index.sorted)
+			mChatRooms.mList.push_back(entry.second);
+		index.listVersion = index.version;
+	}
+}
+
+bool Core::isChatRoomListed(const shared_ptr<AbstractChatRoom> &chatRoom) const {
+	L_D();
+	const ConferenceId &conferenceId = chatRoom->getConferenceId();
+	const auto conferenceIt = d->mConferenceById.find(conferenceId);
+	if ((conferenceIt != d->mConferenceById.cend()) && (conferenceIt->second->getChatRoom() == chatRoom)) return true;
+	const auto chatRoomIt = d->mChatRoomsById.find(conferenceId);
+	return (chatRoomIt != d->mChatRoomsById.cend()) && (chatRoomIt->second == chatRoom);
+}
 
-		rooms.push_front(chatRoom);
+void Core::invalidateChatRoomList() {
+	auto &index = mChatRoomListIndex;
+	index.valid = false;
+	index.sorted.clear();
+	index.positions.clear();
+	index.version++;
+}
+
+void Core::updateChatRoomListPosition(const shared_ptr<AbstractChatRoom> &chatRoom) {
+	auto &index = mChatRoomListIndex;
+	// The whole list will be rebuilt anyway.
+	if (!index.valid) return;
+	if (!isChatRoomListed(chatRoom)) return;
+
+	const bool visible = isChatRoomVisible(chatRoom, index.hideChatRoomsWithMedia, index.hideEmptyChatRooms,
+	                                       index.hideChatRoomsFromRemovedProxies, index.localAddresses);
+	const time_t lastUpdateTime = chatRoom->getLastUpdateTime();
+	auto it = index.positions.find(chatRoom.get());
+	if (it != index.positions.end()) {
+		if (visible && (it->second->first == lastUpdateTime)) return;
+		index.sorted.erase(it->second);
+		index.positions.erase(it);
+	} else if (!visible) {
+		return;
 	}
+	if (visible) index.positions[chatRoom.get()] = index.sorted.emplace(lastUpdateTime, chatRoom);
+	index.version++;
+}
 
-	rooms.sort(compare_chat_room);
-	mChatRooms.mList = rooms;
+unsigned int Core::getChatRoomListVersion() const {
+	updateChatRoomList();
+	return mChatRoomListIndex.version;
 }
 
 list<shared_ptr<AbstractChatRoom>> &Core::getChatRooms() const {
@@ -752,7 +832,12 @@ list<shared_ptr<AbstractChatRoom>> &Core::getChatRooms() const {
 
 const bctbx_list_t *Core::getChatRoomsCList() const {
 	updateChatRoomList();
-	return mChatRooms.getCList();
+	auto &index = mChatRoomListIndex;
+	if (!index.cList || (index.cListVersion != index.listVersion)) {
+		index.cList = mChatRooms.getCList();
+		index.cListVersion = index.listVersion;
+	}
+	return index.cList;
 }
 
 shared_ptr<AbstractChatRoom> Core::findChatRoom(const ConferenceId &conferenceId, bool logIfNotFound) const {
@@ -774,9 +859,22 @@ shared_ptr<AbstractChatRoom> Core::findChatRoom(const ConferenceId &conferenceId
 }
 
 list<shared_ptr<AbstractChatRoom>> Core::findChatRooms(const std::shared_ptr<Address> &peerAddress) const {
+	L_D();
 	list<shared_ptr<AbstractChatRoom>> output;
-	for (const auto &chatRoom : getRawChatRoomList()) {
-		if (*chatRoom->getPeerAddress() == *peerAddress) {
+	const string peerKey = CorePrivate::getAddressIndexKey(peerAddress);
+	if (peerKey.empty()) return output;
+
+	const auto conferences = d->mConferencesByPeerAddress.equal_range(peerKey);
+	for (auto it = conferences.first; it != conferences.second; ++it) {
+		const auto &chatRoom = it->second->getChatRoom();
+		if (chatRoom && (*chatRoom->getPeerAddress() == *peerAddress)) {
+			output.push_front(chatRoom);
+		}
+	}
+	const auto chatRooms = d->mChatRoomsByPeerAddress.equal_range(peerKey);
+	for (auto it = chatRooms.first; it != chatRooms.second; ++it) {
+		const auto &chatRoom = it->second;
+		if (chatRoom && (*chatRoom->getPeerAddress() == *peerAddress)) {
 			output.push_front(chatRoom);
 		}
 	}
@@ -834,8 +932,8 @@ void Core::deleteChatRoom(const shared_ptr<AbstractChatRoom> &chatRoom) {
 	auto chatRoomInCoreMap = core->findChatRoom(conferenceId, false);
 	if (chatRoomInCoreMap) {
 		CorePrivate *d = core->getPrivate();
-		d->mConferenceById.erase(conferenceId);
-		d->mChatRoomsById.erase(conferenceId);
+		d->eraseConferenceById(conferenceId);
+		d->eraseChatRoomById(conferenceId);
 		if (d->mainDb->isInitialized()) d->mainDb->deleteChatRoom(conferenceId);
 	} else {
 		lError() << "Unable to delete chat room [" << chatRoom << "] with conference ID " << conferenceId
@@ -951,8 +1049,8 @@ LinphoneReason Core::onSipMessageReceived(SalOp *op, const SalMessage *sal_msg)
 				auto basicChatRoom = dynamic_pointer_cast<BasicChatRoom>(chatRoom);
 				basicChatRoom->setConferenceId(conferenceId);
 
-				d->mChatRoomsById.erase(oldConfId);
-				d->mChatRoomsById[conferenceId] = chatRoom;
+				d->eraseChatRoomById(oldConfId);
+				d->setChatRoomById(conferenceId, chatRoom);
 
 				updateChatRoomList();
 			}
@@ -1069,4 +1167,26 @@ void Core::decrementRemainingDownloadFileCount() {
 	}
 }
 
+unsigned int Core::getActiveFileTransferCount() const {
+	return mActiveFileTransferCount;
+}
+
+bool Core::canStartParallelFileTransfer() const {
+	int maxTransfers = linphone_config_get_int(linphone_core_get_config(getCCore()), "misc",
+	                                           "max_parallel_file_transfers", 4);
+	return (maxTransfers > 1) && (mActiveFileTransferCount < (unsigned int)maxTransfers);
+}
+
+void Core::incrementActiveFileTransferCount() {
+	mActiveFileTransferCount++;
+}
+
+void Core::decrementActiveFileTransferCount() {
+	if (mActiveFileTransferCount == 0) {
+		lError() << "Unexpectedly reaching negative active file transfer count";
+		return;
+	}
+	mActiveFileTransferCount--;
+}
+
 LINPHONE_END_NAMESPACE
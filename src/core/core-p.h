@@ -156,14 +156,24 @@ public:
 	                                                                bool encrypted) const;
 	std::shared_ptr<AbstractChatRoom> findExumedChatRoomFromPreviousConferenceId(const ConferenceId conferenceId) const;
 
+	// To be called when the address of a conference that is already in the core map changes.
+	void updateConferenceAddressIndex(const Conference *conference);
+
 	void stopChatMessagesAggregationTimer();
 	void deleteConferenceInfo(const std::shared_ptr<Address> &conferenceAddress);
 	void createConferenceCleanupTimer();
 	void stopConferenceCleanupTimer();
+	void createDbCheckpointTimer();
+	void stopDbCheckpointTimer();
+	void createServerChatRoomQueueSweepTimer();
+	void stopServerChatRoomQueueSweepTimer();
 
 	// Cancel task scheduled on the main loop
 	void doLater(const std::function<void()> &something);
 	belle_sip_main_loop_t *getMainLoop();
+	// Serve the main loop until the timeout expires or wakeUp() is called. wakeUp() is thread-safe.
+	void waitForEvents(int timeoutMs);
+	void wakeUp();
 	std::unique_ptr<MainDb> mainDb;
 #ifdef HAVE_ADVANCED_IM
 	std::unique_ptr<ClientConferenceListEventHandler> clientListEventHandler;
@@ -194,6 +204,7 @@ public:
 private:
 	void stopStartupBgTask();
 	bool isInBackground = false;
+	bool waitingForEvents = false;
 	static int ephemeralMessageTimerExpired(void *data, unsigned int revents);
 
 	std::list<CoreListener *> listeners;
@@ -205,11 +216,29 @@ private:
 	std::list<std::shared_ptr<Call>> calls;
 	std::shared_ptr<Call> currentCall;
 
+	// The chat room and conference maps must only be modified through the following methods, that keep their
+	// secondary indexes up to date.
+	void setChatRoomById(const ConferenceId &conferenceId, const std::shared_ptr<AbstractChatRoom> &chatRoom);
+	void eraseChatRoomById(const ConferenceId &conferenceId);
+	void clearChatRoomsById();
+	void setConferenceById(const ConferenceId &conferenceId, const std::shared_ptr<Conference> &conference);
+	void eraseConferenceById(const ConferenceId &conferenceId);
+	void clearConferencesById();
+	static std::string getAddressIndexKey(const std::shared_ptr<const Address> &address);
+
 	std::unordered_map<ConferenceId, std::shared_ptr<AbstractChatRoom>, ConferenceId::WeakHash, ConferenceId::WeakEqual>
 	    mChatRoomsById;
 	std::unordered_map<ConferenceId, std::shared_ptr<Conference>, ConferenceId::WeakHash, ConferenceId::WeakEqual>
 	    mConferenceById;
 
+	// Secondary indexes of the maps above, keyed by getAddressIndexKey() of the peer address of the map key and of the
+	// conference address. A key only narrows the search down: candidates are still compared with the searched address.
+	std::unordered_multimap<std::string, std::shared_ptr<AbstractChatRoom>> mChatRoomsByPeerAddress;
+	std::unordered_multimap<std::string, std::shared_ptr<Conference>> mConferencesByPeerAddress;
+	std::unordered_multimap<std::string, std::shared_ptr<Conference>> mConferencesByConferenceAddress;
+	std::unordered_map<ConferenceId, std::string, ConferenceId::WeakHash, ConferenceId::WeakEqual>
+	    mConferenceAddressIndexKeys;
+
 	std::unique_ptr<EncryptionEngine> imee;
 
 	std::map<std::string, std::string> specs;
@@ -221,6 +250,8 @@ private:
 	std::list<std::shared_ptr<ChatMessage>> ephemeralMessages;
 	belle_sip_source_t *ephemeralTimer = nullptr;
 	belle_sip_source_t *mConferenceCleanupTimer = nullptr;
+	belle_sip_source_t *mDbCheckpointTimer = nullptr;
+	belle_sip_source_t *mServerChatRoomQueueSweepTimer = nullptr;
 
 	belle_sip_source_t *chatMessagesAggregationTimer = nullptr;
 	BackgroundTask chatMessagesAggregationBackgroundTask{"Chat messages aggregation"};
@@ -86,6 +86,7 @@
 #include "vcard/carddav-params.h"
 
 #ifdef HAVE_ADVANCED_IM
+#include "chat/chat-room/server-chat-room.h"
 #include "xml/ekt-linphone-extension.h"
 #endif // HAVE_ADVANCED_IM
 
@@ -184,6 +185,23 @@ void CorePrivate::init() {
 				lInfo() << "Setting sqlite3 synchronous mode to OFF.";
 				uri += " synchronous=OFF";
 			}
+			if (backend == MainDb::Sqlite3) {
+				// The journaling of the database is left untouched unless a profile is configured.
+				const string profile = L_C_TO_STRING(
+				    linphone_config_get_string(linphone_core_get_config(lc), "storage", "sqlite_profile", ""));
+				const int cacheSizeKb =
+				    linphone_config_get_int(linphone_core_get_config(lc), "storage", "sqlite_cache_size_kb", 0);
+				if (profile == "wal") {
+					lInfo() << "Using sqlite3 WAL profile.";
+					mainDb->setSqliteProfile(MainDb::SqliteProfile::Wal, cacheSizeKb);
+				} else if (profile == "default") {
+					lInfo() << "Using sqlite3 default profile.";
+					mainDb->setSqliteProfile(MainDb::SqliteProfile::Default, cacheSizeKb);
+				} else {
+					if (!profile.empty()) lWarning() << "Unknown sqlite3 profile [" << profile << "], ignoring it.";
+					mainDb->setSqliteProfile(MainDb::SqliteProfile::None, cacheSizeKb);
+				}
+			}
 			lInfo() << "Opening linphone database " << uri << " with backend " << backend;
 			uri = LinphonePrivate::Utils::localeToUtf8(uri); // `mainDb->connect` take a UTF8 string.
 			auto startMs = bctbx_get_cur_time_ms();
@@ -197,6 +215,13 @@ void CorePrivate::init() {
 			if (duration >= 1000) {
 				lWarning() << "Opening database took " << duration << " ms !";
 			}
+			if (linphone_config_get_bool(linphone_core_get_config(lc), "storage", "write_behind", FALSE)) {
+				mainDb->enableWriteBehind(
+				    true, linphone_config_get_int(linphone_core_get_config(lc), "storage", "write_behind_batch_ms", 50));
+			}
+
+			createDbCheckpointTimer();
+			createServerChatRoomQueueSweepTimer();
 
 			loadChatRooms();
 			linphone_core_friends_storage_resync_friends_lists(lc); // Load friends from mainDB if any
@@ -390,6 +415,64 @@ void CorePrivate::stopConferenceCleanupTimer() {
 	}
 }
 
+void CorePrivate::createDbCheckpointTimer() {
+	L_Q();
+
+	// In WAL mode, SQLite checkpoints at the end of the commit that makes the log grow past wal_autocheckpoint pages.
+	// Checkpointing periodically from the main loop keeps the log short and the commits fast.
+	const auto period =
+	    linphone_config_get_int(linphone_core_get_config(getCCore()), "storage", "sqlite_checkpoint_period", 60);
+	if (period > 0 && !mDbCheckpointTimer && mainDb && mainDb->walEnabled()) {
+		auto onDbCheckpoint = [this]() -> bool {
+			mainDb->checkpoint();
+			return BELLE_SIP_CONTINUE;
+		};
+		mDbCheckpointTimer =
+		    q->createTimer(onDbCheckpoint, static_cast<unsigned int>(period) * 1000, "database checkpoint");
+	}
+}
+
+void CorePrivate::stopDbCheckpointTimer() {
+	L_Q();
+	if (mDbCheckpointTimer) {
+		q->destroyTimer(mDbCheckpointTimer);
+		mDbCheckpointTimer = nullptr;
+	}
+}
+
+void CorePrivate::createServerChatRoomQueueSweepTimer() {
+#ifdef HAVE_ADVANCED_IM
+	L_Q();
+
+	// The messages queued by server chat rooms for offline devices are kept one week by default.
+	auto config = linphone_core_get_config(getCCore());
+	const auto period = linphone_config_get_int(config, "misc", "server_chat_room_queue_sweep_period", 3600);
+	const auto retention = linphone_config_get_int(config, "misc", "server_chat_room_queue_retention", 7 * 24 * 3600);
+	const bool isServer = linphone_core_conference_server_enabled(getCCore());
+	if (period > 0 && !mServerChatRoomQueueSweepTimer && mainDb && isServer) {
+		auto onSweep = [this, retention]() -> bool {
+			const time_t createdBeforeThisTime = ms_time(NULL) - retention;
+			for (const auto &[id, conference] : mConferenceById) {
+				auto chatRoom = dynamic_pointer_cast<ServerChatRoom>(conference->getChatRoom());
+				if (chatRoom) chatRoom->sweepQueuedMessages(createdBeforeThisTime);
+			}
+			mainDb->cleanupServerChatRoomQueues(createdBeforeThisTime);
+			return BELLE_SIP_CONTINUE;
+		};
+		mServerChatRoomQueueSweepTimer = q->createTimer(onSweep, static_cast<unsigned int>(period) * 1000,
+		                                                "server chat room queue sweep");
+	}
+#endif // HAVE_ADVANCED_IM
+}
+
+void CorePrivate::stopServerChatRoomQueueSweepTimer() {
+	L_Q();
+	if (mServerChatRoomQueueSweepTimer) {
+		q->destroyTimer(mServerChatRoomQueueSweepTimer);
+		mServerChatRoomQueueSweepTimer = nullptr;
+	}
+}
+
 // Called by _linphone_core_stop_async_start() to stop the asynchronous tasks.
 // Put here the calls to stop some task with asynchronous process and check in CorePrivate::isShutdownDone() if they
 // have finished.
@@ -416,6 +499,8 @@ void CorePrivate::shutdown() {
 
 	stopChatMessagesAggregationTimer();
 	stopConferenceCleanupTimer();
+	stopDbCheckpointTimer();
+	stopServerChatRoomQueueSweepTimer();
 
 	for (const auto &chatRoom : q->getChatRooms()) {
 		for (auto &chatMessage : chatRoom->getTransientChatMessages()) {
@@ -489,7 +574,10 @@ void CorePrivate::uninit() {
 		}
 	}
 
-	mChatRoomsById.clear();
+	clearChatRoomsById();
+
+	// Chat rooms may have queued database writes until now.
+	if (mainDb) mainDb->flushPendingWrites();
 
 	for (const auto &[id, conference] : mConferenceById) {
 		// Terminate audio video conferences just before core is stopped
@@ -497,7 +585,7 @@ void CorePrivate::uninit() {
 		        << " because the core is shutting down";
 		conference->terminate();
 	}
-	mConferenceById.clear();
+	clearConferencesById();
 	q->mConferencesPendingCreation.clear();
 	q->mSipConferenceSchedulers.clear();
 
@@ -526,7 +614,10 @@ void CorePrivate::uninit() {
 }
 
 void CorePrivate::disconnectMainDb() {
+	stopDbCheckpointTimer();
+	stopServerChatRoomQueueSweepTimer();
 	if (mainDb != nullptr) {
+		mainDb->enableWriteBehind(false);
 		mainDb->disconnect();
 	}
 }
@@ -538,6 +629,108 @@ void CorePrivate::stopStartupBgTask() {
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Chat room and conference maps.
+// -----------------------------------------------------------------------------
+
+template <typename T>
+static void eraseFromIndex(unordered_multimap<string, shared_ptr<T>> &index,
+                           const string &key,
+                           const shared_ptr<T> &value) {
+	const auto range = index.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == value) {
+			index.erase(it);
+			return;
+		}
+	}
+}
+
+string CorePrivate::getAddressIndexKey(const std::shared_ptr<const Address> &address) {
+	if (!address || !address->isValid()) return string();
+	// Parameters (GRUU included) are left out and the domain is lowercased, so that addresses that are equal, either
+	// as URIs or as ordered strings without GRUU, have the same key.
+	return Utils::stringToLower(address->getScheme()) + ":" + address->getUsername() + "@" +
+	       Utils::stringToLower(address->getDomain());
+}
+
+void CorePrivate::setChatRoomById(const ConferenceId &conferenceId, const shared_ptr<AbstractChatRoom> &chatRoom) {
+	L_Q();
+	q->invalidateChatRoomList();
+	eraseChatRoomById(conferenceId);
+	mChatRoomsById[conferenceId] = chatRoom;
+	mChatRoomsByPeerAddress.emplace(getAddressIndexKey(conferenceId.getPeerAddress()), chatRoom);
+}
+
+void CorePrivate::eraseChatRoomById(const ConferenceId &conferenceId) {
+	L_Q();
+	auto it = mChatRoomsById.find(conferenceId);
+	if (it == mChatRoomsById.end()) return;
+	q->invalidateChatRoomList();
+	eraseFromIndex(mChatRoomsByPeerAddress, getAddressIndexKey(it->first.getPeerAddress()), it->second);
+	mChatRoomsById.erase(it);
+}
+
+void CorePrivate::clearChatRoomsById() {
+	L_Q();
+	q->invalidateChatRoomList();
+	mChatRoomsById.clear();
+	mChatRoomsByPeerAddress.clear();
+}
+
+void CorePrivate::setConferenceById(const ConferenceId &conferenceId, const shared_ptr<Conference> &conference) {
+	L_Q();
+	q->invalidateChatRoomList();
+	eraseConferenceById(conferenceId);
+	mConferenceById[conferenceId] = conference;
+	mConferencesByPeerAddress.emplace(getAddressIndexKey(conferenceId.getPeerAddress()), conference);
+	const string addressKey = getAddressIndexKey(conference->getConferenceAddress());
+	if (!addressKey.empty()) {
+		mConferencesByConferenceAddress.emplace(addressKey, conference);
+		mConferenceAddressIndexKeys[conferenceId] = addressKey;
+	}
+}
+
+void CorePrivate::eraseConferenceById(const ConferenceId &conferenceId) {
+	L_Q();
+	auto it = mConferenceById.find(conferenceId);
+	if (it == mConferenceById.end()) return;
+	q->invalidateChatRoomList();
+	eraseFromIndex(mConferencesByPeerAddress, getAddressIndexKey(it->first.getPeerAddress()), it->second);
+	auto keyIt = mConferenceAddressIndexKeys.find(conferenceId);
+	if (keyIt != mConferenceAddressIndexKeys.end()) {
+		eraseFromIndex(mConferencesByConferenceAddress, keyIt->second, it->second);
+		mConferenceAddressIndexKeys.erase(keyIt);
+	}
+	mConferenceById.erase(it);
+}
+
+void CorePrivate::clearConferencesById() {
+	L_Q();
+	q->invalidateChatRoomList();
+	mConferenceById.clear();
+	mConferencesByPeerAddress.clear();
+	mConferencesByConferenceAddress.clear();
+	mConferenceAddressIndexKeys.clear();
+}
+
+void CorePrivate::updateConferenceAddressIndex(const Conference *conference) {
+	const ConferenceId &conferenceId = conference->getConferenceId();
+	auto it = mConferenceById.find(conferenceId);
+	if (it == mConferenceById.end() || it->second.get() != conference) return;
+
+	auto keyIt = mConferenceAddressIndexKeys.find(conferenceId);
+	if (keyIt != mConferenceAddressIndexKeys.end()) {
+		eraseFromIndex(mConferencesByConferenceAddress, keyIt->second, it->second);
+		mConferenceAddressIndexKeys.erase(keyIt);
+	}
+	const string addressKey = getAddressIndexKey(conference->getConferenceAddress());
+	if (!addressKey.empty()) {
+		mConferencesByConferenceAddress.emplace(addressKey, it->second);
+		mConferenceAddressIndexKeys[it->first] = addressKey;
+	}
+}
+
 // -----------------------------------------------------------------------------
 
 void CorePrivate::notifyGlobalStateChanged(LinphoneGlobalState state) {
@@ -621,6 +814,35 @@ void CorePrivate::doLater(const std::function<void()> &something) {
 	return belle_sip_main_loop_cpp_do_later(getMainLoop(), something);
 }
 
+void CorePrivate::waitForEvents(int timeoutMs) {
+	belle_sip_main_loop_t *mainLoop = getMainLoop();
+	if (!mainLoop) {
+		ms_usleep((uint64_t)max(timeoutMs, 0) * 1000);
+		return;
+	}
+	if (waitingForEvents) {
+		lError() << "Core is already waiting for events, cannot wait from a callback";
+		return;
+	}
+	waitingForEvents = true;
+	belle_sip_main_loop_sleep(mainLoop, max(timeoutMs, 0));
+	waitingForEvents = false;
+}
+
+void CorePrivate::wakeUp() {
+	belle_sip_main_loop_t *mainLoop = getMainLoop();
+	if (!mainLoop) return;
+	// The main loop can only be stopped from its own thread. The thread-safe queue also wakes up the poll of the main
+	// loop, the task is then run by the wait, or by the next iteration if the core is not waiting.
+	belle_sip_main_loop_do_later_ts(
+	    mainLoop,
+	    [](void *data) {
+		    CorePrivate *d = static_cast<CorePrivate *>(data);
+		    if (d->waitingForEvents) belle_sip_main_loop_quit(d->getMainLoop());
+	    },
+	    this);
+}
+
 void CorePrivate::enableFriendListsSubscription(bool enable) {
 	L_Q();
 
@@ -1983,7 +2205,7 @@ void Core::insertConference(const shared_ptr<Conference> conference) {
 	}
 	if ((conf == nullptr) || (conf != conference)) {
 		lInfo() << "Insert " << *conference << " in RAM with conference ID " << conferenceId << ".";
-		d->mConferenceById.insert_or_assign(conferenceId, conference);
+		d->setConferenceById(conferenceId, conference);
 	}
 }
 
@@ -1992,7 +2214,7 @@ void Core::deleteConference(const ConferenceId &conferenceId) {
 	auto it = d->mConferenceById.find(conferenceId);
 	if (it != d->mConferenceById.cend()) {
 		lInfo() << "Delete " << *(it->second) << " in RAM with conference ID " << conferenceId << ".";
-		d->mConferenceById.erase(it);
+		d->eraseConferenceById(conferenceId);
 	}
 }
 
@@ -2007,22 +2229,26 @@ std::shared_ptr<Conference> Core::searchConference(const std::shared_ptr<Confere
                                                    const std::list<std::shared_ptr<Address>> &participants) const {
 	L_D();
 	ConferenceContext referenceConferenceContext(params, localAddress, remoteAddress, participants);
-	const auto it = std::find_if(
-	    d->mConferenceById.begin(), d->mConferenceById.end(), [&referenceConferenceContext](const auto &p) {
-		    // p is of type std::pair<ConferenceId, std::shared_ptr<Conference>
-		    const auto &conference = p.second;
-		    const ConferenceId &conferenceId = conference->getConferenceId();
-		    ConferenceContext conferenceContext(conference->getCurrentParams(), conferenceId.getLocalAddress(),
-		                                        conferenceId.getPeerAddress(), conference->getParticipantAddresses());
-		    return (referenceConferenceContext == conferenceContext);
-	    });
-
-	std::shared_ptr<Conference> conference;
-	if (it != d->mConferenceById.cend()) {
-		conference = it->second;
+	const auto matches = [&referenceConferenceContext](const shared_ptr<Conference> &conference) {
+		const ConferenceId &conferenceId = conference->getConferenceId();
+		ConferenceContext conferenceContext(conference->getCurrentParams(), conferenceId.getLocalAddress(),
+		                                    conferenceId.getPeerAddress(), conference->getParticipantAddresses());
+		return (referenceConferenceContext == conferenceContext);
+	};
+
+	const string peerKey = CorePrivate::getAddressIndexKey(remoteAddress);
+	if (peerKey.empty()) {
+		// Any peer address matches, all the conferences have to be compared.
+		const auto it = std::find_if(d->mConferenceById.begin(), d->mConferenceById.end(),
+		                             [&matches](const auto &p) { return matches(p.second); });
+		return (it != d->mConferenceById.cend()) ? it->second : nullptr;
 	}
 
-	return conference;
+	const auto conferences = d->mConferencesByPeerAddress.equal_range(peerKey);
+	for (auto it = conferences.first; it != conferences.second; ++it) {
+		if (matches(it->second)) return it->second;
+	}
+	return nullptr;
 }
 
 std::shared_ptr<Conference> Core::searchConference(const std::string identifier) const {
@@ -2037,19 +2263,13 @@ shared_ptr<Conference> Core::searchConference(const std::shared_ptr<const Addres
 	L_D();
 
 	if (!conferenceAddress || !conferenceAddress->isValid()) return nullptr;
-	const auto it = std::find_if(d->mConferenceById.begin(), d->mConferenceById.end(), [&](const auto &p) {
-		// p is of type std::pair<ConferenceId, std::shared_ptr<Conference>
-		const auto &conference = p.second;
-		const auto curConferenceAddress = conference->getConferenceAddress();
-		return (*conferenceAddress == *curConferenceAddress);
-	});
-
-	shared_ptr<Conference> conference = nullptr;
-	if (it != d->mConferenceById.cend()) {
-		conference = it->second;
+	const auto conferences =
+	    d->mConferencesByConferenceAddress.equal_range(CorePrivate::getAddressIndexKey(conferenceAddress));
+	for (auto it = conferences.first; it != conferences.second; ++it) {
+		const auto curConferenceAddress = it->second->getConferenceAddress();
+		if (curConferenceAddress && (*conferenceAddress == *curConferenceAddress)) return it->second;
 	}
-
-	return conference;
+	return nullptr;
 }
 
 void Core::removeConferencePendingCreation(const std::shared_ptr<Conference> &conference) {
@@ -2644,6 +2864,8 @@ void Core::removeAccount(std::shared_ptr<Account> account) {
 	}
 
 	invalidateAccountInConferencesAndChatRooms(account);
+	for (const auto &friendList : getFriendLists())
+		friendList->removePhoneNumberIndex(account);
 
 	if (getDefaultAccount() == account) {
 		setDefaultAccount(nullptr);
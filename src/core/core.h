@@ -23,7 +23,9 @@
 
 #include <functional>
 #include <list>
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 #include <mediastreamer2/mssndcard.h>
 
@@ -188,6 +190,12 @@ public:
 	                                                                bool includeConference = true) const;
 	std::list<std::shared_ptr<AbstractChatRoom>> &getChatRooms() const;
 	const bctbx_list_t *getChatRoomsCList() const;
+	// Incremented each time the list returned by getChatRooms() may have changed.
+	unsigned int getChatRoomListVersion() const;
+	// To be called when chat rooms are added to or removed from the core, or when their parameters change.
+	void invalidateChatRoomList();
+	// To be called when the last update time or the emptiness of a chat room changes.
+	void updateChatRoomListPosition(const std::shared_ptr<AbstractChatRoom> &chatRoom);
 
 	std::shared_ptr<AbstractChatRoom> findChatRoom(const ConferenceId &conferenceId, bool logIfNotFound = true) const;
 	std::list<std::shared_ptr<AbstractChatRoom>> findChatRooms(const std::shared_ptr<Address> &peerAddress) const;
@@ -233,6 +241,14 @@ public:
 	void incrementRemainingDownloadFileCount();
 	void decrementRemainingDownloadFileCount();
 
+	// File transfers actually running. The first transfer of a chat message always starts, as it did when messages
+	// transferred their files one after another. [misc] max_parallel_file_transfers only bounds the count when a
+	// message starts additional transfers alongside it.
+	unsigned int getActiveFileTransferCount() const;
+	bool canStartParallelFileTransfer() const;
+	void incrementActiveFileTransferCount();
+	void decrementActiveFileTransferCount();
+
 	// ---------------------------------------------------------------------------
 	// Conference.
 	// ---------------------------------------------------------------------------
@@ -473,6 +489,7 @@ public:
 private:
 	Core();
 	void updateChatRoomList() const;
+	bool isChatRoomListed(const std::shared_ptr<AbstractChatRoom> &chatRoom) const;
 
 	bool deleteEmptyChatrooms = true;
 	int mImdnToEverybodyThreshold = 5;
@@ -500,12 +517,32 @@ private:
 	std::map<std::string, std::shared_ptr<LinphonePrivate::EventPublish>> mPublishByEtag;
 
 	mutable ListHolder<AbstractChatRoom> mChatRooms;
+
+	// Chat rooms of getChatRooms(), sorted by last update time. The index is rebuilt only when it is invalidated or
+	// when the settings filtering chat rooms change, otherwise chat rooms are moved one at a time.
+	struct ChatRoomListIndex {
+		using Sorted = std::multimap<time_t, std::shared_ptr<AbstractChatRoom>, std::greater<time_t>>;
+
+		bool valid = false;
+		bool hideChatRoomsWithMedia = false;
+		bool hideEmptyChatRooms = false;
+		bool hideChatRoomsFromRemovedProxies = false;
+		std::vector<std::shared_ptr<const Address>> localAddresses;
+		Sorted sorted;
+		std::unordered_map<const AbstractChatRoom *, Sorted::iterator> positions;
+		unsigned int version = 0;
+		unsigned int listVersion = 0;
+		unsigned int cListVersion = 0;
+		const bctbx_list_t *cList = nullptr;
+	};
+	mutable ChatRoomListIndex mChatRoomListIndex;
 	mutable ListHolder<Account> mAccounts;
 	mutable ListHolder<Account> mDeletedAccounts;
 	std::shared_ptr<Account> mDefaultAccount;
 
 	unsigned int mRemainingDownloadFileCount = 0;
 	unsigned int mRemainingUploadFileCount = 0;
+	unsigned int mActiveFileTransferCount = 0;
 	unsigned int mAccountDeletionTimeout = 32;
 
 	mutable bctbx_list_t *mCachedProxyConfigs = NULL;
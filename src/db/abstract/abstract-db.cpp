@@ -142,6 +142,7 @@ bool AbstractDb::forceReconnect() {
 		for (int i = 0; i < retryCount; ++i) {
 			try {
 				lInfo() << "Reconnect... Try: " << i;
+				d->dbSession.clearStatementCache();
 				d->dbSession.getBackendSession()->reconnect(); // Equivalent to close and connect.
 				d->safeInit();
 				lInfo() << "Database reconnection successful!";
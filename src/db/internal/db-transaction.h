@@ -33,11 +33,17 @@
 
 #define L_DB_TRANSACTION L_DB_TRANSACTION_C(this)
 
+// Transaction that doesn't commit the writes queued in write-behind mode first.
+// Only for reads that take these pending writes into account by themselves.
+#define L_DB_TRANSACTION_IGNORE_PENDING_WRITES                                                                         \
+	LinphonePrivate::DbTransactionInfo().set(__func__, this, false) *[&](BCTBX_UNUSED(SmartTransaction & tr))
+
 LINPHONE_BEGIN_NAMESPACE
 
 class SmartTransaction {
 public:
-	SmartTransaction(soci::session *session, const char *name) : mSession(session), mName(name), mIsCommitted(false) {
+	SmartTransaction(soci::session *session, const char *name, const MainDbPrivate *mainDbPrivate)
+	    : mSession(session), mName(name), mMainDbPrivate(mainDbPrivate), mIsCommitted(false) {
 		lDebug() << "Start transaction " << this << " in MainDb::" << mName << ".";
 		mSession->begin();
 	}
@@ -45,6 +51,8 @@ public:
 	~SmartTransaction() {
 		if (!mIsCommitted) {
 			lDebug() << "Rollback transaction " << this << " in MainDb::" << mName << ".";
+			// The ids of the rows inserted by this transaction are no longer valid.
+			mMainDbPrivate->endInternedIdsTransaction(false);
 			try {
 				mSession->rollback();
 			} catch (std::runtime_error &e) {
@@ -62,26 +70,35 @@ public:
 
 		lDebug() << "Commit transaction " << this << " in MainDb::" << mName << ".";
 		mIsCommitted = true;
-		mSession->commit();
+		try {
+			mSession->commit();
+		} catch (...) {
+			mMainDbPrivate->endInternedIdsTransaction(false);
+			throw;
+		}
+		mMainDbPrivate->endInternedIdsTransaction(true);
 	}
 
 private:
 	soci::session *mSession;
 	const char *mName;
+	const MainDbPrivate *mMainDbPrivate;
 	bool mIsCommitted;
 
 	L_DISABLE_COPY(SmartTransaction);
 };
 
 struct DbTransactionInfo {
-	DbTransactionInfo &set(const char *_name, const MainDb *_mainDb) {
+	DbTransactionInfo &set(const char *_name, const MainDb *_mainDb, bool _commitPendingWrites = true) {
 		name = _name;
 		mainDb = const_cast<MainDb *>(_mainDb);
+		commitPendingWrites = _commitPendingWrites;
 		return *this;
 	}
 
 	const char *name = nullptr;
 	MainDb *mainDb = nullptr;
+	bool commitPendingWrites = true;
 };
 
 template <typename Function>
@@ -98,8 +115,13 @@ public:
 		const char *name = info.name;
 		soci::session *session = mainDb->getPrivate()->dbSession.getBackendSession();
 
+		// The session is shared with the write-behind thread.
+		std::lock_guard<Object::Lock> lock(const_cast<Object::Lock &>(mainDb->getLock()));
+		// Keep the queued writes ordered before this transaction.
+		if (info.commitPendingWrites) mainDb->getPrivate()->commitPendingWrites();
+
 		try {
-			SmartTransaction tr(session, name);
+			SmartTransaction tr(session, name, mainDb->getPrivate());
 			mResult = exec<InternalReturnType>(tr);
 		} catch (const soci::soci_error &e) {
 			lWarning() << "Caught exception in MainDb::" << name << "(" << e.what() << ").";
@@ -107,7 +129,7 @@ public:
 			if ((category == soci::soci_error::connection_error || category == soci::soci_error::unknown) &&
 			    mainDb->forceReconnect()) {
 				try {
-					SmartTransaction tr(session, name);
+					SmartTransaction tr(session, name, mainDb->getPrivate());
 					mResult = exec<InternalReturnType>(tr);
 				} catch (const std::exception &e) {
 					lError() << "Unable to execute query after reconnect in MainDb::" << name << "(" << e.what()
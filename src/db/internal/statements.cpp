@@ -152,6 +152,18 @@ constexpr const char *select[SelectCount] = {
 			SELECT value
 			FROM sip_address
 			WHERE id = :1
+		)",
+
+    /* SelectContentTypeId */ R"(
+			SELECT id
+			FROM content_type
+			WHERE value = :1
+		)",
+
+    /* SelectChatMessageParticipantState */ R"(
+			SELECT state
+			FROM chat_message_participant
+			WHERE event_id = :1 AND participant_sip_address_id = :2
 		)"};
 
 // ---------------------------------------------------------------------------
@@ -163,6 +175,85 @@ constexpr AbstractStatement insert[InsertCount] = {
 			INSERT INTO one_to_one_chat_room (
 				chat_room_id, participant_a_sip_address_id, participant_b_sip_address_id
 			) VALUES (:1, :2, :3)
+		)",
+
+    /* InsertSipAddress */ R"(
+			INSERT INTO sip_address (value, display_name) VALUES (:1, :2)
+		)",
+
+    /* InsertContentType */ R"(
+			INSERT INTO content_type (value) VALUES (:1)
+		)",
+
+    /* InsertEvent */ R"(
+			INSERT INTO event (type, creation_time) VALUES (:1, :2)
+		)",
+
+    /* InsertConferenceEvent */ R"(
+			INSERT INTO conference_event (event_id, chat_room_id) VALUES (:1, :2)
+		)",
+
+    /* InsertConferenceChatMessageEvent */ R"(
+			INSERT INTO conference_chat_message_event (
+				event_id, from_sip_address_id, to_sip_address_id,
+				time, state, direction, imdn_message_id, is_secured,
+				delivery_notification_required, display_notification_required,
+				marked_as_read, forward_info, call_id, reply_message_id, reply_sender_address_id, message_id
+			) VALUES (:1, :2, :3, :4, :5, :6, :7, :8, :9, :10, :11, :12, :13, :14, :15, :16)
+		)",
+
+    /* InsertChatMessageContent */ R"(
+			INSERT INTO chat_message_content (event_id, content_type_id, body, body_encoding_type)
+			VALUES (:1, :2, :3, 1)
+		)",
+
+    /* InsertChatMessageParticipant */ R"(
+			INSERT INTO chat_message_participant (event_id, participant_sip_address_id, state, state_change_time)
+			VALUES (:1, :2, :3, :4)
+		)",
+
+    /* InsertChatMessageParticipantCount */
+    {Statement(Backend::Sqlite3, R"(
+			INSERT INTO chat_message_participant_count (event_id, state, participant_count)
+			VALUES (:1, :2, :3)
+			ON CONFLICT (event_id, state)
+			DO UPDATE SET participant_count = participant_count + excluded.participant_count
+		)"),
+     Statement(Backend::Mysql, R"(
+			INSERT INTO chat_message_participant_count (event_id, state, participant_count)
+			VALUES (:1, :2, :3)
+			ON DUPLICATE KEY UPDATE participant_count = participant_count + VALUES(participant_count)
+		)")},
+
+    /* InsertServerChatRoomQueueCursor */
+    {Statement(Backend::Sqlite3, R"(
+			INSERT INTO server_chat_room_queue_cursor (chat_room_sip_address_id, device_sip_address_id, last_message_id)
+			VALUES (:1, :2, :3)
+			ON CONFLICT (chat_room_sip_address_id, device_sip_address_id)
+			DO UPDATE SET last_message_id = excluded.last_message_id
+		)"),
+     Statement(Backend::Mysql, R"(
+			INSERT INTO server_chat_room_queue_cursor (chat_room_sip_address_id, device_sip_address_id, last_message_id)
+			VALUES (:1, :2, :3)
+			ON DUPLICATE KEY UPDATE last_message_id = VALUES(last_message_id)
+		)")}};
+
+// ---------------------------------------------------------------------------
+// Update statements.
+// ---------------------------------------------------------------------------
+
+constexpr const char *update[UpdateCount] = {
+    /* UpdateSipAddressDisplayName */ R"(
+			UPDATE sip_address SET display_name = :1 WHERE id = :2
+		)",
+
+    /* UpdateChatRoomLastMessageId */ R"(
+			UPDATE chat_room SET last_message_id = :1 WHERE id = :2
+		)",
+
+    /* UpdateChatMessageParticipantState */ R"(
+			UPDATE chat_message_participant SET state = :1, state_change_time = :2
+			WHERE event_id = :3 AND participant_sip_address_id = :4
 		)"};
 
 // ---------------------------------------------------------------------------
@@ -176,6 +267,10 @@ const char *get(Select selectStmt) {
 const char *get(Insert insertStmt, AbstractDb::Backend backend) {
 	return insertStmt >= Insert::InsertCount ? nullptr : insert[insertStmt].get(backend);
 }
+
+const char *get(Update updateStmt) {
+	return updateStmt >= Update::UpdateCount ? nullptr : update[updateStmt];
+}
 } // namespace Statements
 
 LINPHONE_END_NAMESPACE
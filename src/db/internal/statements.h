@@ -42,13 +42,46 @@ enum Select {
 	SelectConferenceInfoFromId,
 	SelectConferenceCall,
 	SelectSipAddressFromId,
+	SelectContentTypeId,
+	SelectChatMessageParticipantState,
 	SelectCount
 };
 
-enum Insert { InsertOneToOneChatRoom, InsertCount };
+enum Insert {
+	InsertOneToOneChatRoom,
+	InsertSipAddress,
+	InsertContentType,
+	InsertEvent,
+	InsertConferenceEvent,
+	InsertConferenceChatMessageEvent,
+	InsertChatMessageContent,
+	InsertChatMessageParticipant,
+	InsertChatMessageParticipantCount,
+	InsertServerChatRoomQueueCursor,
+	InsertCount
+};
+
+enum Update {
+	UpdateSipAddressDisplayName,
+	UpdateChatRoomLastMessageId,
+	UpdateChatMessageParticipantState,
+	UpdateCount
+};
 
 const char *get(Select selectStmt);
 const char *get(Insert insertStmt, AbstractDb::Backend backend);
+const char *get(Update updateStmt);
+
+// Ids of the statements in the prepared statement cache of a DbSession.
+constexpr int getCacheId(Select selectStmt) {
+	return selectStmt;
+}
+constexpr int getCacheId(Insert insertStmt) {
+	return SelectCount + insertStmt;
+}
+constexpr int getCacheId(Update updateStmt) {
+	return SelectCount + InsertCount + updateStmt;
+}
 } // namespace Statements
 
 LINPHONE_END_NAMESPACE
@@ -21,7 +21,13 @@
 #ifndef _L_MAIN_DB_P_H_
 #define _L_MAIN_DB_P_H_
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "linphone/utils/utils.h"
 
@@ -45,6 +51,19 @@ public:
 	mutable std::unordered_map<long long, std::weak_ptr<CallLog>> storageIdToCallLog;
 	mutable std::unordered_map<long long, std::weak_ptr<ConferenceInfo>> storageIdToConferenceInfo;
 
+	// True if the chat_message_content_fts full-text index is available and maintained.
+	bool chatMessageFtsEnabled = false;
+
+	// Commit the writes queued in write-behind mode. The MainDb lock must be held. If the batch can't be committed,
+	// it is queued again and false is returned.
+	bool commitPendingWrites();
+
+	// Forget the ids of the sip_address and content_type rows.
+	void clearInternedIds() const;
+	// Must be called when a transaction ends: if it is rolled back after inserting or updating some of these rows, the
+	// interned ids are forgotten.
+	void endInternedIdsTransaction(bool committed) const;
+
 private:
 	// ---------------------------------------------------------------------------
 	// Misc helpers.
@@ -71,6 +90,11 @@ private:
 	                                     const std::string &deviceName);
 	void
 	insertChatMessageParticipant(long long chatMessageId, long long sipAddressId, int state, time_t stateChangeTime);
+	void insertChatMessageParticipants(long long chatMessageId,
+	                                   const std::vector<long long> &sipAddressIds,
+	                                   int state,
+	                                   time_t stateChangeTime);
+	void updateChatMessageParticipantCount(long long chatMessageId, int state, int delta);
 	ParticipantInfo::participant_params_t selectConferenceInfoParticipantParams(const long long participantId) const;
 	ParticipantInfo::participant_params_t
 	migrateConferenceInfoParticipantParams(const ParticipantInfo::participant_params_t &unprocessedParticipantParams,
@@ -200,6 +224,11 @@ private:
 	                                    const std::shared_ptr<Address> &participantAddress,
 	                                    ChatMessage::State state,
 	                                    time_t stateChangeTime);
+	void setChatMessageParticipantState(long long eventId,
+	                                    const std::string &participantSipAddress,
+	                                    const std::string &participantDisplayName,
+	                                    ChatMessage::State state,
+	                                    time_t stateChangeTime);
 
 	void insertNewPreviousConferenceId(const ConferenceId &currentConfId, const ConferenceId &previousConfId);
 	void removePreviousConferenceId(const ConferenceId &confId);
@@ -267,6 +296,67 @@ private:
 	bool importLegacyCallLogs(DbSession &inDbSession);
 #endif
 
+	// ---------------------------------------------------------------------------
+	// Write-behind.
+	// ---------------------------------------------------------------------------
+
+	struct PendingParticipantState {
+		std::string sipAddress;
+		ChatMessage::State state;
+		time_t stateChangeTime;
+	};
+
+	struct PendingWrite {
+		std::function<void()> write;
+		// Called once the transaction of the write is committed.
+		std::function<void()> onCommitted;
+	};
+
+	bool enqueueWrite(std::function<void()> &&write, std::function<void()> &&onCommitted);
+	void startWriter(int batchWindowMs);
+	void stopWriter();
+	void runWriter();
+	void applyPendingParticipantStates(long long eventId, std::list<MainDb::ParticipantState> &states) const;
+
+	std::thread writerThread;
+	mutable std::mutex pendingWritesMutex;
+	std::condition_variable pendingWritesCondition;
+	std::vector<PendingWrite> pendingWrites;
+	std::chrono::milliseconds writeBatchWindow{0};
+	bool writerRunning = false;
+	// Participant states queued but not committed yet, by event id. Protected by the MainDb lock.
+	std::unordered_map<long long, std::list<PendingParticipantState>> pendingParticipantStates;
+
+	// ---------------------------------------------------------------------------
+	// Interning of the sip_address and content_type tables.
+	// ---------------------------------------------------------------------------
+
+	// Rows of these tables are never deleted and their value never changes, so their ids can be kept in memory.
+	// Protected by the MainDb lock.
+	struct InternedSipAddress {
+		long long id;
+		std::string displayName;
+		bool hasDisplayName; // False if the display name stored in database is not known.
+	};
+
+	static constexpr int InternedSipAddressesCapacity = 10000;
+
+	mutable LruCache<std::string, InternedSipAddress> internedSipAddressIds{InternedSipAddressesCapacity};
+	mutable LruCache<long long, std::string> internedSipAddresses{InternedSipAddressesCapacity};
+	mutable std::unordered_map<std::string, long long> internedContentTypeIds;
+	// Set once the current transaction has inserted rows in these tables, or updated display names.
+	mutable bool internedIdsDirty = false;
+
+	// ---------------------------------------------------------------------------
+	// Sqlite3 profile.
+	// ---------------------------------------------------------------------------
+
+	void applySqliteProfile();
+
+	MainDb::SqliteProfile sqliteProfile = MainDb::SqliteProfile::None;
+	int sqliteCacheSizeKb = 0;
+	bool walEnabled = false;
+
 	// ---------------------------------------------------------------------------
 
 	mutable LruCache<ConferenceId, int> unreadChatMessageCountCache;
@@ -28,7 +28,10 @@
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
 
+#include <algorithm>
 #include <ctime>
+#include <iterator>
+#include <unordered_set>
 
 #include <bctoolbox/defs.h>
 
@@ -327,21 +330,37 @@ long long MainDbPrivate::insertSipAddress(const std::shared_ptr<Address> &addres
 long long MainDbPrivate::insertSipAddress(BCTBX_UNUSED(const std::string &sipAddress),
                                           BCTBX_UNUSED(const std::string &displayName)) {
 #ifdef HAVE_DB_STORAGE
+	L_Q();
+	// Display names may be changed by other connections to a shared Mysql database.
+	const bool canInternDisplayName = q->getBackend() == MainDb::Sqlite3;
 	long long sipAddressId = selectSipAddressId(sipAddress, true);
 	if (sipAddressId < 0) {
 		lInfo() << "Insert new sip address in database: `" << sipAddress << "`.";
 		soci::indicator displayNameInd = displayName.empty() ? soci::i_null : soci::i_ok;
 
-		*dbSession.getBackendSession()
-		    << "INSERT INTO sip_address (value, display_name) VALUES (:sipAddress, :displayName)",
-		    soci::use(sipAddress), soci::use(displayName, displayNameInd);
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertSipAddress),
+		                                 Statements::get(Statements::InsertSipAddress, q->getBackend()),
+		                                 soci::use(sipAddress), soci::use(displayName, displayNameInd));
 
-		return dbSession.getLastInsertId();
+		sipAddressId = dbSession.getLastInsertId();
+		internedIdsDirty = true;
+		internedSipAddressIds.insert(sipAddress, InternedSipAddress{sipAddressId, displayName, canInternDisplayName});
+		internedSipAddresses.insert(sipAddressId, sipAddress);
+		return sipAddressId;
 	} else if (sipAddressId >= 0 && !displayName.empty()) {
+		InternedSipAddress *interned = internedSipAddressIds[sipAddress];
+		if (interned && interned->hasDisplayName && interned->displayName == displayName) return sipAddressId;
+
 		lInfo() << "Updating sip address display name in database: `" << sipAddress << "`.";
 
-		*dbSession.getBackendSession() << "UPDATE sip_address SET display_name = :displayName WHERE id = :id",
-		    soci::use(displayName), soci::use(sipAddressId);
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::UpdateSipAddressDisplayName),
+		                                 Statements::get(Statements::UpdateSipAddressDisplayName),
+		                                 soci::use(displayName), soci::use(sipAddressId));
+		if (interned) {
+			internedIdsDirty = true;
+			interned->displayName = displayName;
+			interned->hasDisplayName = canInternDisplayName;
+		}
 	}
 
 	return sipAddressId;
@@ -352,15 +371,21 @@ long long MainDbPrivate::insertSipAddress(BCTBX_UNUSED(const std::string &sipAdd
 
 void MainDbPrivate::insertContent(long long chatMessageId, const Content &content) {
 #ifdef HAVE_DB_STORAGE
+	L_Q();
 	soci::session *session = dbSession.getBackendSession();
 
 	const long long &contentTypeId = insertContentType(content.getContentType().getMediaType());
 	const string &body = content.getBodyAsUtf8String();
-	*session << "INSERT INTO chat_message_content (event_id, content_type_id, body, body_encoding_type) VALUES"
-	            " (:chatMessageId, :contentTypeId, :body, 1)",
-	    soci::use(chatMessageId), soci::use(contentTypeId), soci::use(body);
+	dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertChatMessageContent),
+	                                 Statements::get(Statements::InsertChatMessageContent, q->getBackend()),
+	                                 soci::use(chatMessageId), soci::use(contentTypeId), soci::use(body));
 
 	const long long &chatMessageContentId = dbSession.getLastInsertId();
+	if (chatMessageFtsEnabled && content.getContentType() == ContentType::PlainText) {
+		*session << "INSERT INTO chat_message_content_fts (rowid, body) VALUES (:chatMessageContentId, :body)",
+		    soci::use(chatMessageContentId), soci::use(body);
+	}
+
 	if (content.isFile()) {
 		const FileContent &fileContent = static_cast<const FileContent &>(content);
 		const string &name = fileContent.getFileName();
@@ -382,16 +407,24 @@ void MainDbPrivate::insertContent(long long chatMessageId, const Content &conten
 
 long long MainDbPrivate::insertContentType(const string &contentType) {
 #ifdef HAVE_DB_STORAGE
-	soci::session *session = dbSession.getBackendSession();
+	L_Q();
 
-	long long contentTypeId;
-	*session << "SELECT id FROM content_type WHERE value = :contentType", soci::use(contentType),
-	    soci::into(contentTypeId);
-	if (session->got_data()) return contentTypeId;
+	auto it = internedContentTypeIds.find(contentType);
+	if (it != internedContentTypeIds.end()) return it->second;
 
-	lInfo() << "Insert new content type in database: `" << contentType << "`.";
-	*session << "INSERT INTO content_type (value) VALUES (:contentType)", soci::use(contentType);
-	return dbSession.getLastInsertId();
+	long long contentTypeId;
+	if (!dbSession.executeCachedStatement(Statements::getCacheId(Statements::SelectContentTypeId),
+	                                      Statements::get(Statements::SelectContentTypeId), soci::use(contentType),
+	                                      soci::into(contentTypeId))) {
+		lInfo() << "Insert new content type in database: `" << contentType << "`.";
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertContentType),
+		                                 Statements::get(Statements::InsertContentType, q->getBackend()),
+		                                 soci::use(contentType));
+		contentTypeId = dbSession.getLastInsertId();
+		internedIdsDirty = true;
+	}
+	internedContentTypeIds[contentType] = contentTypeId;
+	return contentTypeId;
 #else
 	return -1;
 #endif
@@ -593,15 +626,47 @@ void MainDbPrivate::insertChatMessageParticipant(long long chatMessageId,
 	L_Q();
 	if (q->isInitialized()) {
 		auto stateChangeTm = dbSession.getTimeWithSociIndicator(stateChangeTime);
-		*dbSession.getBackendSession()
-		    << "INSERT INTO chat_message_participant (event_id, participant_sip_address_id, state, state_change_time)"
-		       " VALUES (:chatMessageId, :sipAddressId, :state, :stateChangeTm)",
-		    soci::use(chatMessageId), soci::use(sipAddressId), soci::use(state),
-		    soci::use(stateChangeTm.first, stateChangeTm.second);
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertChatMessageParticipant),
+		                                 Statements::get(Statements::InsertChatMessageParticipant, q->getBackend()),
+		                                 soci::use(chatMessageId), soci::use(sipAddressId), soci::use(state),
+		                                 soci::use(stateChangeTm.first, stateChangeTm.second));
+		updateChatMessageParticipantCount(chatMessageId, state, 1);
 	}
 #endif
 }
 
+void MainDbPrivate::insertChatMessageParticipants(long long chatMessageId,
+                                                  const vector<long long> &sipAddressIds,
+                                                  int state,
+                                                  time_t stateChangeTime) {
+#ifdef HAVE_DB_STORAGE
+	L_Q();
+	if (!q->isInitialized() || sipAddressIds.empty()) return;
+
+	// All the rows are sent in one bulk execution of the statement instead of one execution per participant.
+	const size_t count = sipAddressIds.size();
+	auto stateChangeTm = dbSession.getTimeWithSociIndicator(stateChangeTime);
+	vector<long long> chatMessageIds(count, chatMessageId);
+	vector<int> states(count, state);
+	vector<tm> stateChangeTms(count, stateChangeTm.first);
+	vector<soci::indicator> stateChangeTmIndicators(count, stateChangeTm.second);
+	dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertChatMessageParticipant),
+	                                 Statements::get(Statements::InsertChatMessageParticipant, q->getBackend()),
+	                                 soci::use(chatMessageIds), soci::use(sipAddressIds), soci::use(states),
+	                                 soci::use(stateChangeTms, stateChangeTmIndicators));
+	updateChatMessageParticipantCount(chatMessageId, state, int(count));
+#endif
+}
+
+void MainDbPrivate::updateChatMessageParticipantCount(long long chatMessageId, int state, int delta) {
+#ifdef HAVE_DB_STORAGE
+	L_Q();
+	dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertChatMessageParticipantCount),
+	                                 Statements::get(Statements::InsertChatMessageParticipantCount, q->getBackend()),
+	                                 soci::use(chatMessageId), soci::use(state), soci::use(delta));
+#endif
+}
+
 long long MainDbPrivate::insertConferenceInfo(const std::shared_ptr<ConferenceInfo> &conferenceInfo,
                                               const std::shared_ptr<ConferenceInfo> &oldConferenceInfo) {
 #ifdef HAVE_DB_STORAGE
@@ -1011,24 +1076,27 @@ long long MainDbPrivate::insertOrUpdateFriendList(const std::shared_ptr<FriendLi
 	std::string rlsUri = list->getRlsUri();
 	std::string syncUri = list->getUri();
 	std::string ctag = list->getRevision();
+	std::string syncToken = list->getSyncToken();
 	int type = list->getType();
 
 	if (friendListId > 0) {
 		*dbSession.getBackendSession()
 		    << "UPDATE friends_list SET "
-		       "name = :name, rls_uri = :rlsUri, sync_uri = :syncUri, type = :type, ctag = :ctag "
+		       "name = :name, rls_uri = :rlsUri, sync_uri = :syncUri, type = :type, ctag = :ctag, "
+		       "sync_token = :syncToken "
 		       "WHERE id = :friendListId",
 		    soci::use(name), soci::use(rlsUri), soci::use(syncUri), soci::use(type), soci::use(ctag),
-		    soci::use(friendListId);
+		    soci::use(syncToken), soci::use(friendListId);
 	} else {
 		lInfo() << "Insert new friend list in database: " << name;
 
 		*dbSession.getBackendSession() << "INSERT INTO friends_list ("
-		                                  "name, rls_uri, sync_uri, revision, type, ctag"
+		                                  "name, rls_uri, sync_uri, revision, type, ctag, sync_token"
 		                                  ") VALUES ("
-		                                  ":name, :rlsUri, :syncUri, 0, :type, :ctag"
+		                                  ":name, :rlsUri, :syncUri, 0, :type, :ctag, :syncToken"
 		                                  ")",
-		    soci::use(name), soci::use(rlsUri), soci::use(syncUri), soci::use(type), soci::use(ctag);
+		    soci::use(name), soci::use(rlsUri), soci::use(syncUri), soci::use(type), soci::use(ctag),
+		    soci::use(syncToken);
 
 		friendListId = dbSession.getLastInsertId();
 	}
@@ -1102,28 +1170,55 @@ long long MainDbPrivate::selectSipAddressId(const std::shared_ptr<Address> &addr
 long long MainDbPrivate::selectSipAddressId(const string &sipAddress, const bool caseSensitive) const {
 #ifdef HAVE_DB_STORAGE
 	long long sipAddressId;
-	soci::session *session = dbSession.getBackendSession();
 	if (caseSensitive) {
-		*session << Statements::get(Statements::SelectSipAddressIdCaseSensitive), soci::use(sipAddress),
-		    soci::into(sipAddressId);
-	} else {
-		*session << Statements::get(Statements::SelectSipAddressIdCaseInsensitive), soci::use(sipAddress),
-		    soci::into(sipAddressId);
+		const InternedSipAddress *interned = internedSipAddressIds[sipAddress];
+		if (interned) return interned->id;
+
+		if (!dbSession.executeCachedStatement(Statements::getCacheId(Statements::SelectSipAddressIdCaseSensitive),
+		                                      Statements::get(Statements::SelectSipAddressIdCaseSensitive),
+		                                      soci::use(sipAddress), soci::into(sipAddressId)))
+			return -1;
+
+		internedSipAddressIds.insert(sipAddress, InternedSipAddress{sipAddressId, string(), false});
+		internedSipAddresses.insert(sipAddressId, sipAddress);
+		return sipAddressId;
 	}
+	// Several addresses may match, which a cached statement doesn't support.
+	soci::session *session = dbSession.getBackendSession();
+	*session << Statements::get(Statements::SelectSipAddressIdCaseInsensitive), soci::use(sipAddress),
+	    soci::into(sipAddressId);
 	return session->got_data() ? sipAddressId : -1;
 #else
 	return -1;
 #endif
 }
 
+void MainDbPrivate::clearInternedIds() const {
+	internedSipAddressIds.clear();
+	internedSipAddresses.clear();
+	internedContentTypeIds.clear();
+	internedIdsDirty = false;
+}
+
+void MainDbPrivate::endInternedIdsTransaction(bool committed) const {
+	// Read-only transactions are never committed, they must not drop the interned ids.
+	if (!committed && internedIdsDirty) clearInternedIds();
+	internedIdsDirty = false;
+}
+
 std::string MainDbPrivate::selectSipAddressFromId(long long sipAddressId) const {
 #ifdef HAVE_DB_STORAGE
-	std::string sipAddress;
+	const string *interned = internedSipAddresses[sipAddressId];
+	if (interned) return *interned;
 
-	soci::session *session = dbSession.getBackendSession();
-	*session << Statements::get(Statements::SelectSipAddressFromId), soci::use(sipAddressId), soci::into(sipAddress);
+	std::string sipAddress;
+	if (!dbSession.executeCachedStatement(Statements::getCacheId(Statements::SelectSipAddressFromId),
+	                                      Statements::get(Statements::SelectSipAddressFromId), soci::use(sipAddressId),
+	                                      soci::into(sipAddress)))
+		return std::string();
 
-	return session->got_data() ? sipAddress : std::string();
+	internedSipAddresses.insert(sipAddressId, sipAddress);
+	return sipAddress;
 #else
 	return std::string();
 #endif
@@ -1163,11 +1258,11 @@ long long MainDbPrivate::selectChatRoomId(long long peerSipAddressId, long long
 #ifdef HAVE_DB_STORAGE
 	long long chatRoomId;
 
-	soci::session *session = dbSession.getBackendSession();
-	*session << Statements::get(Statements::SelectChatRoomId), soci::use(peerSipAddressId),
-	    soci::use(localSipAddressId), soci::into(chatRoomId);
-
-	return session->got_data() ? chatRoomId : -1;
+	return dbSession.executeCachedStatement(Statements::getCacheId(Statements::SelectChatRoomId),
+	                                        Statements::get(Statements::SelectChatRoomId), soci::use(peerSipAddressId),
+	                                        soci::use(localSipAddressId), soci::into(chatRoomId))
+	           ? chatRoomId
+	           : -1;
 #else
 	return -1;
 #endif
@@ -1307,6 +1402,7 @@ long long MainDbPrivate::selectConferenceCallId(const std::string &callId) {
 
 void MainDbPrivate::deleteContents(long long chatMessageId) {
 #ifdef HAVE_DB_STORAGE
+	// Entries of chat_message_content_fts are removed by the chat_message_content_fts_delete trigger.
 	*dbSession.getBackendSession() << "DELETE FROM chat_message_content WHERE event_id = :chatMessageId",
 	    soci::use(chatMessageId);
 #endif
@@ -1551,10 +1647,12 @@ shared_ptr<EventLog> MainDbPrivate::selectConferenceSubjectEvent(const Conferenc
 
 long long MainDbPrivate::insertEvent(const shared_ptr<EventLog> &eventLog) {
 #ifdef HAVE_DB_STORAGE
+	L_Q();
 	const int &type = int(eventLog->getType());
 	auto creationTime = dbSession.getTimeWithSociIndicator(eventLog->getCreationTime());
-	*dbSession.getBackendSession() << "INSERT INTO event (type, creation_time) VALUES (:type, :creationTime)",
-	    soci::use(type), soci::use(creationTime.first, creationTime.second);
+	dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertEvent),
+	                                 Statements::get(Statements::InsertEvent, q->getBackend()), soci::use(type),
+	                                 soci::use(creationTime.first, creationTime.second));
 
 	return dbSession.getLastInsertId();
 #else
@@ -1574,12 +1672,13 @@ long long MainDbPrivate::insertConferenceEvent(const shared_ptr<EventLog> &event
 		// Otherwise it's an error.
 		lError() << "Unable to find chat room storage id of: " << conferenceId << ".";
 	} else {
+		L_Q();
 		eventId = insertEvent(eventLog);
 
 		soci::session *session = dbSession.getBackendSession();
-		*session << "INSERT INTO conference_event (event_id, chat_room_id)"
-		            " VALUES (:eventId, :chatRoomId)",
-		    soci::use(eventId), soci::use(curChatRoomId);
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::InsertConferenceEvent),
+		                                 Statements::get(Statements::InsertConferenceEvent, q->getBackend()),
+		                                 soci::use(eventId), soci::use(curChatRoomId));
 
 		if (eventLog->getType() == EventLog::Type::ConferenceTerminated)
 			*session << "UPDATE chat_room SET flags = 1, last_notify_id = 0 WHERE id = :chatRoomId",
@@ -1675,23 +1774,15 @@ long long MainDbPrivate::insertConferenceChatMessageEvent(const shared_ptr<Event
 	}
 	const long long &replyToSipAddressId = sipAddressId;
 
-	*dbSession.getBackendSession()
-	    << "INSERT INTO conference_chat_message_event ("
-	       "  event_id, from_sip_address_id, to_sip_address_id,"
-	       "  time, state, direction, imdn_message_id, is_secured,"
-	       "  delivery_notification_required, display_notification_required,"
-	       "  marked_as_read, forward_info, call_id, reply_message_id, reply_sender_address_id, message_id"
-	       ") VALUES ("
-	       "  :eventId, :localSipaddressId, :remoteSipaddressId,"
-	       "  :time, :state, :direction, :imdnMessageId, :isSecured,"
-	       "  :deliveryNotificationRequired, :displayNotificationRequired,"
-	       "  :markedAsRead, :forwardInfo, :callId, :replyMessageId, :replyToSipAddressId, :messageId"
-	       ")",
-	    soci::use(eventId), soci::use(fromSipAddressId), soci::use(toSipAddressId),
-	    soci::use(messageTime.first, messageTime.second), soci::use(state), soci::use(direction),
-	    soci::use(imdnMessageId), soci::use(isSecured), soci::use(deliveryNotificationRequired),
-	    soci::use(displayNotificationRequired), soci::use(markedAsRead), soci::use(forwardInfo), soci::use(callId),
-	    soci::use(replyMessageId), soci::use(replyToSipAddressId), soci::use(messageId);
+	L_Q();
+	dbSession.executeCachedStatement(
+	    Statements::getCacheId(Statements::InsertConferenceChatMessageEvent),
+	    Statements::get(Statements::InsertConferenceChatMessageEvent, q->getBackend()), soci::use(eventId),
+	    soci::use(fromSipAddressId), soci::use(toSipAddressId), soci::use(messageTime.first, messageTime.second),
+	    soci::use(state), soci::use(direction), soci::use(imdnMessageId), soci::use(isSecured),
+	    soci::use(deliveryNotificationRequired), soci::use(displayNotificationRequired), soci::use(markedAsRead),
+	    soci::use(forwardInfo), soci::use(callId), soci::use(replyMessageId), soci::use(replyToSipAddressId),
+	    soci::use(messageId));
 
 	if (isEphemeral) {
 		long ephemeralLifetime = chatMessage->getEphemeralLifetime();
@@ -1708,14 +1799,17 @@ long long MainDbPrivate::insertConferenceChatMessageEvent(const shared_ptr<Event
 		insertContent(eventId, *content);
 
 	shared_ptr<AbstractChatRoom> chatRoom(chatMessage->getChatRoom());
-	for (const auto &participant : chatRoom->getParticipants()) {
-		const long long &participantSipAddressId = selectSipAddressId(participant->getAddress(), true);
-		insertChatMessageParticipant(eventId, participantSipAddressId, state, chatMessage->getTime());
-	}
+	const auto &participants = chatRoom->getParticipants();
+	vector<long long> participantSipAddressIds;
+	participantSipAddressIds.reserve(participants.size());
+	for (const auto &participant : participants)
+		participantSipAddressIds.push_back(selectSipAddressId(participant->getAddress(), true));
+	insertChatMessageParticipants(eventId, participantSipAddressIds, state, chatMessage->getTime());
 
 	const long long &dbChatRoomId = selectChatRoomId(chatRoom->getConferenceId());
-	*dbSession.getBackendSession() << "UPDATE chat_room SET last_message_id = :1 WHERE id = :2", soci::use(eventId),
-	    soci::use(dbChatRoomId);
+	dbSession.executeCachedStatement(Statements::getCacheId(Statements::UpdateChatRoomLastMessageId),
+	                                 Statements::get(Statements::UpdateChatRoomLastMessageId), soci::use(eventId),
+	                                 soci::use(dbChatRoomId));
 
 	if (direction == int(ChatMessage::Direction::Incoming) && !markedAsRead) {
 		int *count = unreadChatMessageCountCache[chatRoom->getConferenceId()];
@@ -2093,18 +2187,33 @@ void MainDbPrivate::setChatMessageParticipantState(const shared_ptr<EventLog> &e
 	MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
 	const long long &eventId = dEventKey->storageId;
 	auto participantAddressWithoutGruu = participantAddress->getUriWithoutGruu();
-	long long participantSipAddressId = selectSipAddressId(participantAddressWithoutGruu, true);
-	long long nbEntries;
-	*dbSession.getBackendSession() << "SELECT count(*) FROM chat_message_participant WHERE event_id = :eventId AND "
-	                                  "participant_sip_address_id = :participantSipAddressId",
-	    soci::into(nbEntries), soci::use(eventId), soci::use(participantSipAddressId);
+	if (!participantAddressWithoutGruu.isValid()) return;
+	// This is a hack, because all addresses don't print their parameters in the same order.
+	setChatMessageParticipantState(eventId, participantAddressWithoutGruu.toStringUriOnlyOrdered(),
+	                               participantAddressWithoutGruu.getDisplayName(), state, stateChangeTime);
+#endif
+}
+
+void MainDbPrivate::setChatMessageParticipantState(long long eventId,
+                                                   const string &participantSipAddress,
+                                                   const string &participantDisplayName,
+                                                   ChatMessage::State state,
+                                                   time_t stateChangeTime) {
+#ifdef HAVE_DB_STORAGE
+	long long participantSipAddressId = selectSipAddressId(participantSipAddress, true);
+	int intState = 0;
+	const bool found = participantSipAddressId > 0 &&
+	                   dbSession.executeCachedStatement(
+	                       Statements::getCacheId(Statements::SelectChatMessageParticipantState),
+	                       Statements::get(Statements::SelectChatMessageParticipantState), soci::into(intState),
+	                       soci::use(eventId), soci::use(participantSipAddressId));
 
 	int stateInt = int(state);
 
-	if (nbEntries == 0) {
+	if (!found) {
 		if (participantSipAddressId <= 0) {
 			// If the address is not found in the DB, add it
-			participantSipAddressId = insertSipAddress(participantAddressWithoutGruu);
+			participantSipAddressId = insertSipAddress(participantSipAddress, participantDisplayName);
 		}
 		// We may be receiving an IMDN for a participant that received the message but we weren't aware of
 		insertChatMessageParticipant(eventId, participantSipAddressId, stateInt, stateChangeTime);
@@ -2112,10 +2221,6 @@ void MainDbPrivate::setChatMessageParticipantState(const shared_ptr<EventLog> &e
 		/* setChatMessageParticipantState can be called by updateConferenceChatMessageEvent, which try to update
 		 participant state by message state. However, we can not change state Displayed/DeliveredToUser to
 		 Delivered/NotDelivered. */
-		int intState;
-		*dbSession.getBackendSession() << "SELECT state FROM chat_message_participant WHERE event_id = :eventId AND "
-		                                  "participant_sip_address_id = :participantSipAddressId",
-		    soci::into(intState), soci::use(eventId), soci::use(participantSipAddressId);
 		ChatMessage::State dbState = ChatMessage::State(intState);
 
 		if (int(state) < intState &&
@@ -2125,16 +2230,177 @@ void MainDbPrivate::setChatMessageParticipantState(const shared_ptr<EventLog> &e
 		}
 
 		auto stateChangeTm = dbSession.getTimeWithSociIndicator(stateChangeTime);
-		*dbSession.getBackendSession()
-		    << "UPDATE chat_message_participant SET state = :state,"
-		       " state_change_time = :stateChangeTm"
-		       " WHERE event_id = :eventId AND participant_sip_address_id = :participantSipAddressId",
-		    soci::use(stateInt), soci::use(stateChangeTm.first, stateChangeTm.second), soci::use(eventId),
-		    soci::use(participantSipAddressId);
+		dbSession.executeCachedStatement(Statements::getCacheId(Statements::UpdateChatMessageParticipantState),
+		                                 Statements::get(Statements::UpdateChatMessageParticipantState),
+		                                 soci::use(stateInt), soci::use(stateChangeTm.first, stateChangeTm.second),
+		                                 soci::use(eventId), soci::use(participantSipAddressId));
+		if (stateInt != intState) {
+			updateChatMessageParticipantCount(eventId, intState, -1);
+			updateChatMessageParticipantCount(eventId, stateInt, 1);
+		}
 	}
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// Write-behind.
+// -----------------------------------------------------------------------------
+
+bool MainDbPrivate::enqueueWrite(std::function<void()> &&write, std::function<void()> &&onCommitted) {
+	{
+		lock_guard<mutex> lock(pendingWritesMutex);
+		if (!writerRunning) return false;
+		pendingWrites.push_back({std::move(write), std::move(onCommitted)});
+	}
+	pendingWritesCondition.notify_one();
+	return true;
+}
+
+bool MainDbPrivate::commitPendingWrites() {
+#ifdef HAVE_DB_STORAGE
+	vector<PendingWrite> writes;
+	{
+		lock_guard<mutex> lock(pendingWritesMutex);
+		writes.swap(pendingWrites);
+	}
+	if (writes.empty() || !dbSession) return true;
+
+	try {
+		SmartTransaction tr(dbSession.getBackendSession(), __func__, this);
+		for (const auto &write : writes) {
+			// A failing write must not prevent the other ones of the batch from being committed.
+			try {
+				write.write();
+			} catch (const exception &e) {
+				lError() << "Unable to execute pending write in MainDb: `" << e.what() << "`.";
+			}
+		}
+		tr.commit();
+		lDebug() << "Committed " << writes.size() << " pending writes in MainDb.";
+	} catch (const exception &e) {
+		lError() << "Unable to commit " << writes.size() << " pending writes in MainDb, they will be retried: `"
+		         << e.what() << "`.";
+		// Keep the batch ahead of the writes queued meanwhile, readers still get its states from memory.
+		lock_guard<mutex> lock(pendingWritesMutex);
+		pendingWrites.insert(pendingWrites.begin(), make_move_iterator(writes.begin()),
+		                     make_move_iterator(writes.end()));
+		return false;
+	}
+
+	for (const auto &write : writes) {
+		if (write.onCommitted) write.onCommitted();
+	}
+#endif
+	return true;
+}
+
+void MainDbPrivate::startWriter(int batchWindowMs) {
+	lock_guard<mutex> lock(pendingWritesMutex);
+	if (writerRunning) return;
+	writeBatchWindow = chrono::milliseconds(batchWindowMs > 0 ? batchWindowMs : 0);
+	writerRunning = true;
+	writerThread = thread(&MainDbPrivate::runWriter, this);
+}
+
+void MainDbPrivate::stopWriter() {
+	{
+		lock_guard<mutex> lock(pendingWritesMutex);
+		if (!writerRunning) return;
+		writerRunning = false;
+	}
+	pendingWritesCondition.notify_one();
+	writerThread.join();
+
+	// Commit what the writer left behind. On failure, the next MainDb transaction retries.
+	lock_guard<Object::Lock> lock(const_cast<Object::Lock &>(getLock()));
+	commitPendingWrites();
+}
+
+void MainDbPrivate::runWriter() {
+	unique_lock<mutex> lock(pendingWritesMutex);
+	while (writerRunning) {
+		pendingWritesCondition.wait(lock, [this] { return !writerRunning || !pendingWrites.empty(); });
+		if (!writerRunning) break;
+
+		// Let the writes of the same burst accumulate to commit them together.
+		pendingWritesCondition.wait_for(lock, writeBatchWindow, [this] { return !writerRunning; });
+		lock.unlock();
+		bool committed;
+		{
+			lock_guard<Object::Lock> dbLock(const_cast<Object::Lock &>(getLock()));
+			committed = commitPendingWrites();
+		}
+		lock.lock();
+
+		// Don't retry a failed batch in a busy loop.
+		if (!committed)
+			pendingWritesCondition.wait_for(lock, max(writeBatchWindow, chrono::milliseconds(1000)),
+			                                [this] { return !writerRunning; });
+	}
+}
+
+void MainDbPrivate::applySqliteProfile() {
+#ifdef HAVE_DB_STORAGE
+	L_Q();
+	walEnabled = false;
+	if (q->getBackend() != MainDb::Sqlite3) return;
+
+	soci::session *session = dbSession.getBackendSession();
+	try {
+		if (sqliteCacheSizeKb > 0) *session << "PRAGMA cache_size = -" + Utils::toString(sqliteCacheSizeKb);
+		if (sqliteProfile == MainDb::SqliteProfile::None) return;
+
+		// The bctbx VFS doesn't implement the shared memory methods, so the wal-index can only be kept in heap memory.
+		// SQLite does so in exclusive locking mode, which must be set before the database is accessed in WAL mode.
+		// It is also needed to go back to rollback journaling if a previous connection left the database in WAL mode.
+		// mmap_size is not set: the VFS doesn't implement xFetch, so SQLite would ignore it.
+		*session << "PRAGMA locking_mode = EXCLUSIVE";
+		string journalMode;
+		if (sqliteProfile == MainDb::SqliteProfile::Wal) {
+			*session << "PRAGMA journal_mode = WAL", soci::into(journalMode);
+			if (journalMode == "wal") {
+				// Commits no longer sync the database, only checkpoints do. A power loss may roll back the last
+				// transactions but can't corrupt the database.
+				int synchronous = 0;
+				*session << "PRAGMA synchronous", soci::into(synchronous);
+				if (synchronous > 1) *session << "PRAGMA synchronous = NORMAL";
+				walEnabled = true;
+				lInfo() << "Sqlite3 database is in WAL mode.";
+				return;
+			}
+			lWarning() << "Unable to enable WAL mode on sqlite3 database, journal mode is: " << journalMode;
+		} else {
+			*session << "PRAGMA journal_mode = DELETE", soci::into(journalMode);
+		}
+		*session << "PRAGMA locking_mode = NORMAL";
+	} catch (const soci::soci_error &e) {
+		lWarning() << "Unable to apply sqlite3 profile: " << e.what();
+	}
+#endif
+}
+
+void MainDbPrivate::applyPendingParticipantStates(long long eventId, list<MainDb::ParticipantState> &states) const {
+	const auto it = pendingParticipantStates.find(eventId);
+	if (it == pendingParticipantStates.cend()) return;
+
+	for (const auto &pendingState : it->second) {
+		auto stateIt = find_if(states.begin(), states.end(), [&pendingState](const MainDb::ParticipantState &state) {
+			return state.address && state.address->toStringUriOnlyOrdered() == pendingState.sipAddress;
+		});
+		if (stateIt == states.end()) {
+			states.emplace_back(Address::create(pendingState.sipAddress), pendingState.state,
+			                    pendingState.stateChangeTime);
+			continue;
+		}
+		// Same rule as setChatMessageParticipantState(): Displayed/DeliveredToUser can't be downgraded.
+		if (int(pendingState.state) < int(stateIt->state) &&
+		    (stateIt->state == ChatMessage::State::Displayed || stateIt->state == ChatMessage::State::DeliveredToUser))
+			continue;
+		stateIt->state = pendingState.state;
+		stateIt->timestamp = pendingState.stateChangeTime;
+	}
+}
+
 // ---------------------------------------------------------------------------
 // Call log API.
 // ---------------------------------------------------------------------------
@@ -2496,6 +2762,7 @@ std::shared_ptr<FriendList> MainDbPrivate::selectFriendList(const soci::row &row
 	} else {
 		friendList->mRevision = ctag;
 	}
+	friendList->mSyncToken = row.get<string>(7);
 
 	return friendList;
 }
@@ -3150,6 +3417,12 @@ void MainDbPrivate::updateSchema() {
 		lDebug() << "Caught exception " << e.what() << ": Column 'ctag' already exists in table 'friends_list'";
 	}
 
+	try {
+		*session << "ALTER TABLE friends_list ADD COLUMN sync_token VARCHAR(2047) NOT NULL DEFAULT ''";
+	} catch (const soci::soci_error &e) {
+		lDebug() << "Caught exception " << e.what() << ": Column 'sync_token' already exists in table 'friends_list'";
+	}
+
 	try {
 		*session << "ALTER TABLE conference_info ADD COLUMN audio BOOLEAN NOT NULL DEFAULT 1";
 	} catch (const soci::soci_error &e) {
@@ -3192,6 +3465,91 @@ void MainDbPrivate::updateSchema() {
 		         << ": Column 'expiry_time' already exists in table 'conference_info'";
 	}
 
+	// Number of participants in each state for every chat message, kept up to date with chat_message_participant so
+	// that the state of a message in a large group chat doesn't require reading the state of all its participants.
+	{
+		const bool participantCountExists = dbSession.checkTableExists("chat_message_participant_count");
+		*session << "CREATE TABLE IF NOT EXISTS chat_message_participant_count ("
+		            "  event_id" +
+		                dbSession.primaryKeyRefStr("BIGINT UNSIGNED") +
+		                ","
+		                "  state TINYINT UNSIGNED NOT NULL,"
+		                "  participant_count INT NOT NULL,"
+
+		                "  PRIMARY KEY (event_id, state),"
+
+		                "  FOREIGN KEY (event_id)"
+		                "    REFERENCES conference_chat_message_event(event_id)"
+		                "    ON DELETE CASCADE"
+		                ") " +
+		                charset;
+		if (!participantCountExists) {
+			lInfo() << "Counting chat message participants by state.";
+			*session << "INSERT INTO chat_message_participant_count (event_id, state, participant_count)"
+			            "  SELECT event_id, state, count(*) FROM chat_message_participant GROUP BY event_id, state";
+		}
+	}
+
+	// Full-text index of the text/plain chat message contents. Only available with a sqlite3 library built with
+	// FTS5, searches fall back to a LIKE scan otherwise. Rowids of the index are the chat_message_content ids and rows
+	// deleted from chat_message_content (directly or through the ON DELETE CASCADE of events) are dropped by trigger.
+	// The trigram tokenizer lets the index prefilter the messages containing any substring of at least 3 characters.
+	chatMessageFtsEnabled = false;
+	if (backend == MainDb::Backend::Sqlite3) {
+		try {
+			int triggerCount = 0;
+			*session << "SELECT count(*) FROM sqlite_master"
+			            "  WHERE type = 'trigger' AND name = 'chat_message_content_fts_delete'",
+			    soci::into(triggerCount);
+			string tableSql;
+			soci::indicator tableSqlInd = soci::i_null;
+			*session << "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'chat_message_content_fts'",
+			    soci::into(tableSql, tableSqlInd);
+			const bool tableExists = session->got_data();
+			if (tableExists && (tableSqlInd != soci::i_ok || tableSql.find("trigram") == string::npos)) {
+				lInfo() << "Dropping word based full-text index of chat message contents.";
+				*session << "DROP TRIGGER IF EXISTS chat_message_content_fts_delete";
+				*session << "DROP TABLE chat_message_content_fts";
+				triggerCount = 0;
+			}
+			*session << "CREATE VIRTUAL TABLE IF NOT EXISTS chat_message_content_fts USING fts5("
+			            "  body,"
+			            "  tokenize = 'trigram'"
+			            ")";
+			// Fails if the table exists but the sqlite3 library has no FTS5 support.
+			int ftsCount = 0;
+			*session << "SELECT count(*) FROM chat_message_content_fts WHERE rowid = 0", soci::into(ftsCount);
+			if (!tableExists || triggerCount == 0) {
+				// Either the index is new, or it has not been maintained while FTS5 was not available.
+				lInfo() << "Building full-text index of chat message contents.";
+				const string contentType = ContentType::PlainText.getMediaType();
+				*session << "DELETE FROM chat_message_content_fts";
+				*session << "INSERT INTO chat_message_content_fts (rowid, body)"
+				            "  SELECT chat_message_content.id, chat_message_content.body"
+				            "  FROM chat_message_content, content_type"
+				            "  WHERE content_type.id = chat_message_content.content_type_id"
+				            "  AND content_type.value = :contentType",
+				    soci::use(contentType);
+				*session << "CREATE TRIGGER IF NOT EXISTS chat_message_content_fts_delete"
+				            "  AFTER DELETE ON chat_message_content"
+				            "  BEGIN"
+				            "    DELETE FROM chat_message_content_fts WHERE rowid = old.id;"
+				            "  END";
+			}
+			chatMessageFtsEnabled = true;
+		} catch (const soci::soci_error &e) {
+			lWarning() << "Unable to create full-text index of chat message contents, text searches will not be "
+			              "indexed: "
+			           << e.what();
+			// The trigger would make every deletion of chat message contents fail.
+			try {
+				*session << "DROP TRIGGER IF EXISTS chat_message_content_fts_delete";
+			} catch (const soci::soci_error &e) {
+				lError() << "Unable to drop full-text index trigger of chat message contents: " << e.what();
+			}
+		}
+	}
+
 	// /!\ Warning : if varchar columns < 255 were to be indexed, their size must be set back to 191 = max indexable
 	// (KEY or UNIQUE) varchar size for mysql < 5.7 with charset utf8mb4 (both here and in column creation)
 	//
@@ -3612,6 +3970,11 @@ bool MainDbPrivate::importLegacyCallLogs(DbSession &inDbSession) {
 MainDb::MainDb(const shared_ptr<Core> &core) : AbstractDb(*new MainDbPrivate), CoreAccessor(core) {
 }
 
+MainDb::~MainDb() {
+	L_D();
+	d->stopWriter();
+}
+
 void MainDb::init() {
 #ifdef HAVE_DB_STORAGE
 	L_D();
@@ -3626,8 +3989,14 @@ void MainDb::init() {
 	auto timestampType = bind(&DbSession::timestampType, &d->dbSession);
 	auto varcharPrimaryKeyStr = bind(&DbSession::varcharPrimaryKeyStr, &d->dbSession, _1);
 
+	// The ids may belong to a previously connected database.
+	d->clearInternedIds();
+
 	initCleanup();
 
+	// Must be done outside of any transaction to be able to change the journal mode.
+	d->applySqliteProfile();
+
 	session->begin();
 
 	try {
@@ -4387,6 +4756,56 @@ void MainDb::init() {
 		                ") " +
 		                charset;
 
+		*session << "CREATE TABLE IF NOT EXISTS server_chat_room_queued_message ("
+		            "  id" +
+		                primaryKeyStr("BIGINT UNSIGNED") +
+		                ","
+
+		                "  chat_room_sip_address_id" +
+		                primaryKeyRefStr("BIGINT UNSIGNED") +
+		                " NOT NULL,"
+		                "  from_sip_address_id" +
+		                primaryKeyRefStr("BIGINT UNSIGNED") +
+		                " NOT NULL,"
+		                "  content_type TEXT NOT NULL,"
+		                "  body TEXT NOT NULL,"
+		                "  headers TEXT NOT NULL,"
+		                "  creation_time" +
+		                timestampType() +
+		                " NOT NULL,"
+
+		                "  UNIQUE (chat_room_sip_address_id, id),"
+
+		                "  FOREIGN KEY (chat_room_sip_address_id)"
+		                "    REFERENCES sip_address(id)"
+		                "    ON DELETE CASCADE,"
+		                "  FOREIGN KEY (from_sip_address_id)"
+		                "    REFERENCES sip_address(id)"
+		                "    ON DELETE CASCADE"
+		                ") " +
+		                charset;
+
+		// The cursors do not reference the messages: they stay valid when the dispatched messages are deleted.
+		*session << "CREATE TABLE IF NOT EXISTS server_chat_room_queue_cursor ("
+		            "  chat_room_sip_address_id" +
+		                primaryKeyRefStr("BIGINT UNSIGNED") +
+		                " NOT NULL,"
+		                "  device_sip_address_id" +
+		                primaryKeyRefStr("BIGINT UNSIGNED") +
+		                " NOT NULL,"
+		                "  last_message_id BIGINT NOT NULL,"
+
+		                "  PRIMARY KEY (chat_room_sip_address_id, device_sip_address_id),"
+
+		                "  FOREIGN KEY (chat_room_sip_address_id)"
+		                "    REFERENCES sip_address(id)"
+		                "    ON DELETE CASCADE,"
+		                "  FOREIGN KEY (device_sip_address_id)"
+		                "    REFERENCES sip_address(id)"
+		                "    ON DELETE CASCADE"
+		                ") " +
+		                charset;
+
 		d->updateSchema();
 
 		migrateConferenceInfos();
@@ -4395,12 +4814,14 @@ void MainDb::init() {
 		d->updateModuleVersion("friends", ModuleVersionFriends);
 	} catch (const soci::soci_error &e) {
 		lError() << "Exception while creating or updating the database's schema : " << e.what();
+		d->clearInternedIds();
 		session->rollback();
 		// Throw exception so that it can be catched by the calling function
 		throw e;
 		return;
 	}
 	session->commit();
+	d->endInternedIdsTransaction(true);
 
 	initCleanup();
 #endif
@@ -5016,7 +5437,22 @@ list<shared_ptr<ChatMessage>> MainDb::getEphemeralMessages() const {
 list<MainDb::ParticipantState> MainDb::getChatMessageParticipantsByImdnState(const shared_ptr<EventLog> &eventLog,
                                                                              ChatMessage::State state) const {
 #ifdef HAVE_DB_STORAGE
-	return L_DB_TRANSACTION {
+	{
+		L_D();
+		L_SYNC();
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		const long long eventId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+		if (d->pendingParticipantStates.find(eventId) != d->pendingParticipantStates.cend()) {
+			// Some states are not committed yet.
+			list<MainDb::ParticipantState> result = getChatMessageParticipantStates(eventLog);
+			result.remove_if([state](const MainDb::ParticipantState &participantState) {
+				return participantState.state != state;
+			});
+			return result;
+		}
+	}
+
+	return L_DB_TRANSACTION_IGNORE_PENDING_WRITES {
 		L_D();
 
 		const EventLogPrivate *dEventLog = eventLog->getPrivate();
@@ -5043,7 +5479,7 @@ list<MainDb::ParticipantState> MainDb::getChatMessageParticipantsByImdnState(con
 
 list<MainDb::ParticipantState> MainDb::getChatMessageParticipantStates(const shared_ptr<EventLog> &eventLog) const {
 #ifdef HAVE_DB_STORAGE
-	return L_DB_TRANSACTION {
+	return L_DB_TRANSACTION_IGNORE_PENDING_WRITES {
 		L_D();
 
 		const EventLogPrivate *dEventLog = eventLog->getPrivate();
@@ -5062,6 +5498,7 @@ list<MainDb::ParticipantState> MainDb::getChatMessageParticipantStates(const sha
 			states.emplace_back(Address::create(row.get<string>(0)), ChatMessage::State(row.get<int>(1)),
 			                    d->dbSession.getTime(row, 2));
 		}
+		d->applyPendingParticipantStates(eventId, states);
 		return states;
 	};
 #else
@@ -5071,25 +5508,143 @@ list<MainDb::ParticipantState> MainDb::getChatMessageParticipantStates(const sha
 
 ChatMessage::State MainDb::getChatMessageParticipantState(const shared_ptr<EventLog> &eventLog,
                                                           const std::shared_ptr<Address> &participantAddress) const {
+	ChatMessage::State state = ChatMessage::State::Idle;
+	findChatMessageParticipantState(eventLog, participantAddress, state);
+	return state;
+}
+
+bool MainDb::findChatMessageParticipantState(const shared_ptr<EventLog> &eventLog,
+                                             const std::shared_ptr<Address> &participantAddress,
+                                             ChatMessage::State &state) const {
 #ifdef HAVE_DB_STORAGE
-	return L_DB_TRANSACTION {
+	{
+		L_D();
+		L_SYNC();
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		const long long eventId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+		if (d->pendingParticipantStates.find(eventId) != d->pendingParticipantStates.cend()) {
+			// Some states are not committed yet.
+			const string sipAddress = participantAddress->toStringUriOnlyOrdered();
+			for (const auto &participantState : getChatMessageParticipantStates(eventLog)) {
+				if (participantState.address && participantState.address->toStringUriOnlyOrdered() == sipAddress) {
+					state = participantState.state;
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	return L_DB_TRANSACTION_IGNORE_PENDING_WRITES {
 		L_D();
 
 		const EventLogPrivate *dEventLog = eventLog->getPrivate();
 		MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
 		const long long &eventId = dEventKey->storageId;
 		const long long &participantSipAddressId = d->selectSipAddressId(participantAddress, true);
+		if (participantSipAddressId <= 0) return false;
 
-		unsigned int state = (unsigned int)ChatMessage::State::Idle;
-		*d->dbSession.getBackendSession()
-		    << "SELECT state FROM chat_message_participant"
-		       " WHERE event_id = :eventId AND participant_sip_address_id = :participantSipAddressId",
-		    soci::into(state), soci::use(eventId), soci::use(participantSipAddressId);
+		int intState = int(ChatMessage::State::Idle);
+		if (!d->dbSession.executeCachedStatement(
+		        Statements::getCacheId(Statements::SelectChatMessageParticipantState),
+		        Statements::get(Statements::SelectChatMessageParticipantState), soci::into(intState),
+		        soci::use(eventId), soci::use(participantSipAddressId)))
+			return false;
+
+		state = ChatMessage::State(intState);
+		return true;
+	};
+#else
+	return false;
+#endif
+}
+
+map<ChatMessage::State, int> MainDb::getChatMessageParticipantStateCounts(const shared_ptr<EventLog> &eventLog) const {
+#ifdef HAVE_DB_STORAGE
+	{
+		L_D();
+		L_SYNC();
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		const long long eventId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+		if (d->pendingParticipantStates.find(eventId) != d->pendingParticipantStates.cend()) {
+			// Some states are not committed yet.
+			map<ChatMessage::State, int> counts;
+			for (const auto &participantState : getChatMessageParticipantStates(eventLog))
+				counts[participantState.state]++;
+			return counts;
+		}
+	}
+
+	return L_DB_TRANSACTION_IGNORE_PENDING_WRITES {
+		L_D();
+
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
+		const long long &eventId = dEventKey->storageId;
+
+		static const string query = "SELECT state, participant_count FROM chat_message_participant_count"
+		                            " WHERE event_id = :eventId AND participant_count > 0";
+		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << query, soci::use(eventId));
+
+		map<ChatMessage::State, int> counts;
+		for (const auto &row : rows)
+			counts[ChatMessage::State(row.get<int>(0))] = row.get<int>(1);
+		return counts;
+	};
+#else
+	return map<ChatMessage::State, int>();
+#endif
+}
+
+size_t MainDb::countChatMessageParticipantStates(const shared_ptr<EventLog> &eventLog,
+                                                 const list<shared_ptr<Address>> &participantAddresses) const {
+#ifdef HAVE_DB_STORAGE
+	if (participantAddresses.empty()) return 0;
+	{
+		L_D();
+		L_SYNC();
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		const long long eventId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+		if (d->pendingParticipantStates.find(eventId) != d->pendingParticipantStates.cend()) {
+			// Some states are not committed yet.
+			unordered_set<string> sipAddresses;
+			for (const auto &participantState : getChatMessageParticipantStates(eventLog)) {
+				if (participantState.address) sipAddresses.insert(participantState.address->toStringUriOnlyOrdered());
+			}
+			size_t count = 0;
+			for (const auto &address : participantAddresses) {
+				if (sipAddresses.find(address->toStringUriOnlyOrdered()) != sipAddresses.cend()) count++;
+			}
+			return count;
+		}
+	}
 
-		return ChatMessage::State(state);
+	return L_DB_TRANSACTION_IGNORE_PENDING_WRITES {
+		L_D();
+
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
+		const long long &eventId = dEventKey->storageId;
+
+		// Participants without sip_address row can't have a state.
+		string sipAddressIds;
+		for (const auto &address : participantAddresses) {
+			const long long sipAddressId = d->selectSipAddressId(address, true);
+			if (sipAddressId <= 0) continue;
+			if (!sipAddressIds.empty()) sipAddressIds += ", ";
+			sipAddressIds += Utils::toString(sipAddressId);
+		}
+		if (sipAddressIds.empty()) return size_t(0);
+
+		int count = 0;
+		*d->dbSession.getBackendSession() << "SELECT count(*) FROM chat_message_participant"
+		                                     " WHERE event_id = :eventId AND participant_sip_address_id IN (" +
+		                                         sipAddressIds + ")",
+		    soci::use(eventId), soci::into(count);
+		return size_t(max(count, 0));
 	};
 #else
-	return ChatMessage::State::Idle;
+	return 0;
 #endif
 }
 
@@ -5098,9 +5653,65 @@ void MainDb::setChatMessageParticipantState(const shared_ptr<EventLog> &eventLog
                                             ChatMessage::State state,
                                             time_t stateChangeTime) {
 #ifdef HAVE_DB_STORAGE
+	L_D();
+	if (writeBehindEnabled()) {
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		const long long eventId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+		const Address participantAddressWithoutGruu = participantAddress->getUriWithoutGruu();
+		if (!participantAddressWithoutGruu.isValid()) return;
+
+		// Only plain values are given to the writer thread.
+		MainDbPrivate::PendingParticipantState pendingState{participantAddressWithoutGruu.toStringUriOnlyOrdered(),
+		                                                    state, stateChangeTime};
+		const string displayName = participantAddressWithoutGruu.getDisplayName();
+
+		L_SYNC();
+		auto &eventPendingStates = d->pendingParticipantStates[eventId];
+		eventPendingStates.push_back(pendingState);
+		if (d->enqueueWrite(
+		        [d, eventId, pendingState, displayName]() {
+			        d->setChatMessageParticipantState(eventId, pendingState.sipAddress, displayName,
+			                                          pendingState.state, pendingState.stateChangeTime);
+		        },
+		        [d, eventId]() {
+			        // Until now, readers got this state from pendingParticipantStates.
+			        auto it = d->pendingParticipantStates.find(eventId);
+			        if (it != d->pendingParticipantStates.end()) {
+				        it->second.pop_front();
+				        if (it->second.empty()) d->pendingParticipantStates.erase(it);
+			        }
+		        }))
+			return;
+
+		eventPendingStates.pop_back();
+		if (eventPendingStates.empty()) d->pendingParticipantStates.erase(eventId);
+	}
+
+	L_DB_TRANSACTION {
+		d->setChatMessageParticipantState(eventLog, participantAddress, state, stateChangeTime);
+		tr.commit();
+	};
+#endif
+}
+
+void MainDb::setChatMessagesParticipantState(
+    const list<pair<shared_ptr<EventLog>, ParticipantState>> &participantStates) {
+#ifdef HAVE_DB_STORAGE
+	if (participantStates.empty()) return;
+
+	if (writeBehindEnabled()) {
+		// The writer thread already groups the queued writes.
+		for (const auto &participantState : participantStates)
+			setChatMessageParticipantState(participantState.first, participantState.second.address,
+			                               participantState.second.state, participantState.second.timestamp);
+		return;
+	}
+
 	L_DB_TRANSACTION {
 		L_D();
-		d->setChatMessageParticipantState(eventLog, participantAddress, state, stateChangeTime);
+		for (const auto &participantState : participantStates)
+			d->setChatMessageParticipantState(participantState.first, participantState.second.address,
+			                                  participantState.second.state, participantState.second.timestamp);
 		tr.commit();
 	};
 #endif
@@ -5457,24 +6068,24 @@ MainDb::findChatMessagesFromImdnMessageId(const std::list<std::string> &imdnMess
 	    " LEFT JOIN sip_address AS reply_sender_address ON reply_sender_address.id = reply_sender_address_id"
 	    " WHERE (imdn_message_id = ";
 
+	if (imdnMessageIds.empty()) return list<shared_ptr<ChatMessage>>();
+
 	return L_DB_TRANSACTION {
 		L_D();
 
+		// The ids come from remote IMDNs: they are bound, never inserted in the query itself.
 		ostringstream ostr;
 		ostr << query;
-		size_t index = 0;
-		size_t listSize = imdnMessageIds.size();
-		for (const auto &id : imdnMessageIds) {
-			ostr << "'" << id << "'";
-			if (index < listSize - 1) {
-				ostr << " OR imdn_message_id = ";
-			} else {
-				ostr << " ) ";
-			}
-			index += 1;
+		for (size_t index = 0; index < imdnMessageIds.size(); index++) {
+			if (index > 0) ostr << " OR imdn_message_id = ";
+			ostr << ":id" << index;
 		}
+		ostr << " ) ";
 		string computedQuery = ostr.str();
-		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << computedQuery);
+		soci::details::prepare_temp_type prepared = (d->dbSession.getBackendSession()->prepare << computedQuery);
+		for (const auto &id : imdnMessageIds)
+			prepared, soci::use(id);
+		soci::rowset<soci::row> rows(prepared);
 
 		list<shared_ptr<ChatMessage>> chatMessages;
 		for (const auto &row : rows) {
@@ -6950,33 +7561,71 @@ void MainDb::deleteChatRoomParticipantDevice(const shared_ptr<AbstractChatRoom>
 #endif
 }
 
+#ifdef HAVE_DB_STORAGE
+// Same columns as Statements::SelectConferenceEvent, as expected by selectGenericConferenceEvent.
+static const string SearchChatMessagesQuery =
+    "SELECT conference_event_view.id AS event_id, type, conference_event_view.creation_time, "
+    "  from_sip_address.value, to_sip_address.value, time, imdn_message_id, state, direction, is_secured, "
+    "  notify_id, device_sip_address.value, participant_sip_address.value, conference_event_view.subject, "
+    "  delivery_notification_required, display_notification_required, peer_sip_address.value, "
+    "  local_sip_address.value, marked_as_read, forward_info, ephemeral_lifetime, expired_time, lifetime, "
+    "  reply_message_id, reply_sender_address.value, message_id "
+    "FROM conference_event_view "
+    "JOIN chat_room ON chat_room.id = chat_room_id "
+    "JOIN sip_address AS peer_sip_address ON peer_sip_address.id = peer_sip_address_id "
+    "JOIN sip_address AS local_sip_address ON local_sip_address.id = local_sip_address_id "
+    "LEFT JOIN sip_address AS from_sip_address ON from_sip_address.id = from_sip_address_id "
+    "LEFT JOIN sip_address AS to_sip_address ON to_sip_address.id = to_sip_address_id "
+    "LEFT JOIN sip_address AS device_sip_address ON device_sip_address.id = device_sip_address_id "
+    "LEFT JOIN sip_address AS participant_sip_address ON participant_sip_address.id = "
+    "participant_sip_address_id "
+    "LEFT JOIN sip_address AS reply_sender_address ON reply_sender_address.id = reply_sender_address_id "
+    "LEFT JOIN chat_message_content ON chat_message_content.event_id = conference_event_view.id ";
+
+// Turn a user search string into a FTS5 query matching a superset of the messages the LIKE condition built from the
+// same arguments matches: the LIKE condition must always be applied on top of it. With the trigram tokenizer a quoted
+// term matches any substring of a body. Terms shorter than 3 characters and LIKE wildcards can't be looked up, they
+// are left to the LIKE condition alone. Returns an empty string if no term can be looked up.
+static string buildChatMessageFtsQuery(const string &text, bool splitWords) {
+	string query;
+	for (const auto &word : splitWords ? bctoolbox::Utils::split(text, " ") : vector<string>{text}) {
+		if (word.find_first_of("%_") != string::npos) continue;
+		size_t length = 0; // In unicode characters.
+		for (const char c : word) {
+			if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) length++;
+		}
+		if (length < 3) continue;
+		if (!query.empty()) query += " AND ";
+		query += "\"" + Utils::replaceAll(word, "\"", "\"\"") + "\"";
+	}
+	return query;
+}
+
+// LIKE based search condition. If splitWords is set, every space separated word of text must be present in the
+// message body, otherwise text is searched as a whole.
+static string buildChatMessageLikeCondition(const string &text, bool splitWords) {
+	string condition = "chat_message_content.content_type_id = 1 ";
+	for (const auto &word : splitWords ? bctoolbox::Utils::split(text, " ") : vector<string>{text}) {
+		if (word.empty() && splitWords) continue;
+		condition += "AND chat_message_content.body LIKE '%" + Utils::replaceAll(word, "'", "''") + "%' ";
+	}
+	return condition;
+}
+#endif
+
 shared_ptr<EventLog> MainDb::searchChatMessagesByText(const ConferenceId &conferenceId,
                                                       const std::string &text,
                                                       const shared_ptr<const EventLog> &from,
                                                       LinphoneSearchDirection direction) {
 #ifdef HAVE_DB_STORAGE
-	std::string patternToFind = Utils::replaceAll(text, "'", "''"); // replace all ' by ''
-	string query =
-	    "SELECT conference_event_view.id AS event_id, type, conference_event_view.creation_time, "
-	    "  from_sip_address.value, to_sip_address.value, time, imdn_message_id, state, direction, is_secured, "
-	    "  notify_id, device_sip_address.value, participant_sip_address.value, conference_event_view.subject, "
-	    "  delivery_notification_required, display_notification_required, peer_sip_address.value, "
-	    "  local_sip_address.value, marked_as_read, forward_info, ephemeral_lifetime, expired_time, lifetime, "
-	    "  reply_message_id, reply_sender_address.value, message_id "
-	    "FROM conference_event_view "
-	    "JOIN chat_room ON chat_room.id = chat_room_id "
-	    "JOIN sip_address AS peer_sip_address ON peer_sip_address.id = peer_sip_address_id "
-	    "JOIN sip_address AS local_sip_address ON local_sip_address.id = local_sip_address_id "
-	    "LEFT JOIN sip_address AS from_sip_address ON from_sip_address.id = from_sip_address_id "
-	    "LEFT JOIN sip_address AS to_sip_address ON to_sip_address.id = to_sip_address_id "
-	    "LEFT JOIN sip_address AS device_sip_address ON device_sip_address.id = device_sip_address_id "
-	    "LEFT JOIN sip_address AS participant_sip_address ON participant_sip_address.id = "
-	    "participant_sip_address_id "
-	    "LEFT JOIN sip_address AS reply_sender_address ON reply_sender_address.id = reply_sender_address_id "
-	    "LEFT JOIN chat_message_content ON chat_message_content.event_id = conference_event_view.id "
-	    "WHERE chat_room_id = :chatRoomId AND chat_message_content.content_type_id = 1 "
-	    "  AND chat_message_content.body LIKE '%" +
-	    patternToFind + "%' ";
+	L_D();
+
+	const string ftsQuery = d->chatMessageFtsEnabled ? buildChatMessageFtsQuery(text, false) : string();
+	string query = SearchChatMessagesQuery + "WHERE chat_room_id = :chatRoomId AND ";
+	query += buildChatMessageLikeCondition(text, false);
+	if (!ftsQuery.empty())
+		query += "AND chat_message_content.id IN ("
+		         "SELECT rowid FROM chat_message_content_fts WHERE chat_message_content_fts MATCH :ftsQuery) ";
 
 	if (from != nullptr) {
 		const EventLogPrivate *dEventLog = from->getPrivate();
@@ -7007,7 +7656,10 @@ shared_ptr<EventLog> MainDb::searchChatMessagesByText(const ConferenceId &confer
 		shared_ptr<EventLog> message;
 		if (!chatRoom) return message;
 
-		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << query, soci::use(chatRoomId));
+		soci::session *session = d->dbSession.getBackendSession();
+		soci::rowset<soci::row> rows =
+		    ftsQuery.empty() ? (session->prepare << query, soci::use(chatRoomId))
+		                     : (session->prepare << query, soci::use(chatRoomId), soci::use(ftsQuery));
 
 		const auto &row = rows.begin();
 		if (row != rows.end()) {
@@ -7021,6 +7673,61 @@ shared_ptr<EventLog> MainDb::searchChatMessagesByText(const ConferenceId &confer
 #endif
 }
 
+list<shared_ptr<EventLog>>
+MainDb::findChatMessagesByText(const ConferenceId &conferenceId, const std::string &text, int begin, int end) const {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+
+	if (begin < 0) begin = 0;
+
+	list<shared_ptr<EventLog>> events;
+	if (end > 0 && begin > end) {
+		lWarning() << "Unable to search chat messages. Invalid range.";
+		return events;
+	}
+
+	// Results are ranked by relevance (bm25) when the full-text index is usable, by recency otherwise.
+	const string ftsQuery = d->chatMessageFtsEnabled ? buildChatMessageFtsQuery(text, true) : string();
+	string query = SearchChatMessagesQuery;
+	if (ftsQuery.empty()) {
+		query += "WHERE chat_room_id = :chatRoomId AND " + buildChatMessageLikeCondition(text, true);
+		query += "ORDER BY event_id DESC";
+	} else {
+		query += "JOIN (SELECT rowid, rank FROM chat_message_content_fts WHERE chat_message_content_fts MATCH "
+		         ":ftsQuery) AS fts ON fts.rowid = chat_message_content.id "
+		         "WHERE chat_room_id = :chatRoomId AND " +
+		         buildChatMessageLikeCondition(text, true);
+		query += "ORDER BY fts.rank, event_id DESC";
+	}
+
+	if (end > 0) query += " LIMIT " + Utils::toString(end - begin);
+	else query += " LIMIT " + d->dbSession.noLimitValue();
+
+	if (begin > 0) query += " OFFSET " + Utils::toString(begin);
+
+	return L_DB_TRANSACTION {
+		L_D();
+
+		shared_ptr<AbstractChatRoom> chatRoom = d->findChatRoom(conferenceId);
+		if (!chatRoom) return events;
+
+		const long long &chatRoomId = d->selectChatRoomId(conferenceId);
+		soci::session *session = d->dbSession.getBackendSession();
+		soci::rowset<soci::row> rows =
+		    ftsQuery.empty() ? (session->prepare << query, soci::use(chatRoomId))
+		                     : (session->prepare << query, soci::use(ftsQuery), soci::use(chatRoomId));
+		for (const auto &row : rows) {
+			shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, row);
+			if (event) events.push_back(event);
+		}
+
+		return events;
+	};
+#else
+	return list<shared_ptr<EventLog>>();
+#endif
+}
+
 // -----------------------------------------------------------------------------
 
 std::list<std::shared_ptr<ConferenceInfo>>
@@ -7302,6 +8009,173 @@ void MainDb::cleanupConferenceInfo(time_t expiredBeforeThisTime) {
 #endif
 }
 
+// -----------------------------------------------------------------------------
+
+long long MainDb::insertServerChatRoomQueuedMessage(const std::shared_ptr<Address> &chatRoomAddress,
+                                                    const ServerChatRoomQueuedMessage &message,
+                                                    const std::list<std::shared_ptr<Address>> &newRecipients) {
+#ifdef HAVE_DB_STORAGE
+	if (isInitialized()) {
+		return L_DB_TRANSACTION {
+			L_D();
+			soci::session *session = d->dbSession.getBackendSession();
+			const long long chatRoomSipAddressId = d->insertSipAddress(chatRoomAddress);
+			const long long fromSipAddressId = d->insertSipAddress(Address::create(message.fromAddress));
+			// The content type is stored as is: its parameters, such as the boundary of an encrypted message, change
+			// with each message and would fill the shared content_type table.
+			auto creationTime = d->dbSession.getTimeWithSociIndicator(message.creationTime);
+			*session << "INSERT INTO server_chat_room_queued_message (chat_room_sip_address_id, from_sip_address_id,"
+			            " content_type, body, headers, creation_time) VALUES (:chatRoomSipAddressId,"
+			            " :fromSipAddressId, :contentType, :body, :headers, :creationTime)",
+			    soci::use(chatRoomSipAddressId), soci::use(fromSipAddressId), soci::use(message.contentType),
+			    soci::use(message.body), soci::use(message.headers),
+			    soci::use(creationTime.first, creationTime.second);
+			const long long messageId = d->dbSession.getLastInsertId();
+
+			const long long lastMessageId = messageId - 1;
+			for (const auto &recipient : newRecipients) {
+				const long long deviceSipAddressId = d->insertSipAddress(recipient);
+				*session << "INSERT INTO server_chat_room_queue_cursor (chat_room_sip_address_id,"
+				            " device_sip_address_id, last_message_id) VALUES (:chatRoomSipAddressId,"
+				            " :deviceSipAddressId, :lastMessageId)",
+				    soci::use(chatRoomSipAddressId), soci::use(deviceSipAddressId), soci::use(lastMessageId);
+			}
+			tr.commit();
+			return messageId;
+		};
+	}
+#endif
+	return -1;
+}
+
+list<MainDb::ServerChatRoomQueuedMessage>
+MainDb::getServerChatRoomQueuedMessages(const std::shared_ptr<Address> &chatRoomAddress, long long afterId) {
+#ifdef HAVE_DB_STORAGE
+	if (isInitialized()) {
+		static const string query =
+		    "SELECT server_chat_room_queued_message.id, from_sip_address.value, content_type, body, headers,"
+		    " creation_time"
+		    " FROM server_chat_room_queued_message"
+		    " JOIN sip_address AS from_sip_address ON from_sip_address.id = from_sip_address_id"
+		    " WHERE chat_room_sip_address_id = :chatRoomSipAddressId AND server_chat_room_queued_message.id > :afterId"
+		    " ORDER BY server_chat_room_queued_message.id";
+
+		return L_DB_TRANSACTION {
+			L_D();
+			list<ServerChatRoomQueuedMessage> messages;
+			const long long chatRoomSipAddressId = d->selectSipAddressId(chatRoomAddress, true);
+			if (chatRoomSipAddressId < 0) return messages;
+
+			soci::session *session = d->dbSession.getBackendSession();
+			soci::rowset<soci::row> rows =
+			    (session->prepare << query, soci::use(chatRoomSipAddressId), soci::use(afterId));
+			for (const auto &row : rows) {
+				ServerChatRoomQueuedMessage message;
+				message.id = d->dbSession.resolveId(row, 0);
+				message.fromAddress = row.get<string>(1);
+				message.contentType = row.get<string>(2);
+				message.body = row.get<string>(3);
+				message.headers = row.get<string>(4);
+				message.creationTime = d->dbSession.getTime(row, 5);
+				messages.push_back(std::move(message));
+			}
+			tr.commit();
+			return messages;
+		};
+	}
+#endif
+	return list<ServerChatRoomQueuedMessage>();
+}
+
+map<string, long long> MainDb::getServerChatRoomQueueCursors(const std::shared_ptr<Address> &chatRoomAddress) {
+#ifdef HAVE_DB_STORAGE
+	if (isInitialized()) {
+		static const string query = "SELECT device_sip_address.value, last_message_id"
+		                            " FROM server_chat_room_queue_cursor"
+		                            " JOIN sip_address AS device_sip_address"
+		                            " ON device_sip_address.id = device_sip_address_id"
+		                            " WHERE chat_room_sip_address_id = :chatRoomSipAddressId";
+
+		return L_DB_TRANSACTION {
+			L_D();
+			map<string, long long> cursors;
+			const long long chatRoomSipAddressId = d->selectSipAddressId(chatRoomAddress, true);
+			if (chatRoomSipAddressId < 0) return cursors;
+
+			soci::session *session = d->dbSession.getBackendSession();
+			soci::rowset<soci::row> rows = (session->prepare << query, soci::use(chatRoomSipAddressId));
+			for (const auto &row : rows)
+				cursors[row.get<string>(0)] = d->dbSession.resolveId(row, 1);
+			tr.commit();
+			return cursors;
+		};
+	}
+#endif
+	return map<string, long long>();
+}
+
+bool MainDb::updateServerChatRoomQueueCursors(const std::shared_ptr<Address> &chatRoomAddress,
+                                              const map<string, long long> &cursors,
+                                              const list<string> &removedDevices) {
+#ifdef HAVE_DB_STORAGE
+	if (isInitialized()) {
+		return L_DB_TRANSACTION {
+			L_D();
+			soci::session *session = d->dbSession.getBackendSession();
+			const long long chatRoomSipAddressId = d->insertSipAddress(chatRoomAddress);
+			for (const auto &cursor : cursors) {
+				const long long deviceSipAddressId = d->insertSipAddress(cursor.first, string());
+				d->dbSession.executeCachedStatement(
+				    Statements::getCacheId(Statements::InsertServerChatRoomQueueCursor),
+				    Statements::get(Statements::InsertServerChatRoomQueueCursor, getBackend()),
+				    soci::use(chatRoomSipAddressId), soci::use(deviceSipAddressId), soci::use(cursor.second));
+			}
+			for (const auto &device : removedDevices) {
+				const long long deviceSipAddressId = d->selectSipAddressId(device, true);
+				if (deviceSipAddressId < 0) continue;
+				*session << "DELETE FROM server_chat_room_queue_cursor"
+				            " WHERE chat_room_sip_address_id = :chatRoomSipAddressId"
+				            " AND device_sip_address_id = :deviceSipAddressId",
+				    soci::use(chatRoomSipAddressId), soci::use(deviceSipAddressId);
+			}
+			tr.commit();
+			return true;
+		};
+	}
+#endif
+	return false;
+}
+
+void MainDb::cleanupServerChatRoomQueues(time_t createdBeforeThisTime) {
+#ifdef HAVE_DB_STORAGE
+	if (isInitialized()) {
+		L_DB_TRANSACTION {
+			L_D();
+			soci::session *session = d->dbSession.getBackendSession();
+			auto creationTime = d->dbSession.getTimeWithSociIndicator(createdBeforeThisTime);
+			*session << "DELETE FROM server_chat_room_queued_message WHERE creation_time < :creationTime",
+			    soci::use(creationTime.first, creationTime.second);
+			// Messages are only needed as long as a device of their chat room has not received them.
+			*session << "DELETE FROM server_chat_room_queued_message WHERE NOT EXISTS ("
+			            "  SELECT 1 FROM server_chat_room_queue_cursor"
+			            "  WHERE server_chat_room_queue_cursor.chat_room_sip_address_id ="
+			            "    server_chat_room_queued_message.chat_room_sip_address_id"
+			            "  AND server_chat_room_queue_cursor.last_message_id < server_chat_room_queued_message.id"
+			            ")";
+			// Without messages, a device gets a new cursor when a message is queued for it.
+			*session << "DELETE FROM server_chat_room_queue_cursor WHERE NOT EXISTS ("
+			            "  SELECT 1 FROM server_chat_room_queued_message"
+			            "  WHERE server_chat_room_queued_message.chat_room_sip_address_id ="
+			            "    server_chat_room_queue_cursor.chat_room_sip_address_id"
+			            ")";
+			tr.commit();
+		};
+	}
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
 long long MainDb::findExpiredConferenceId(const std::shared_ptr<Address> &uri) {
 #ifdef HAVE_DB_STORAGE
 	if (isInitialized()) {
@@ -7710,6 +8584,28 @@ long long MainDb::insertFriend(const std::shared_ptr<Friend> &f) {
 #endif
 }
 
+void MainDb::insertFriends(BCTBX_UNUSED(const std::list<std::shared_ptr<Friend>> &friends)) {
+#ifdef HAVE_DB_STORAGE
+	// A transaction per friend makes importing a large address book very slow, while a single one for all of them
+	// would lock the database for too long.
+	static constexpr size_t maxFriendsPerTransaction = 500;
+	auto chunkBegin = friends.cbegin();
+	while (chunkBegin != friends.cend()) {
+		auto chunkEnd = chunkBegin;
+		for (size_t i = 0; (i < maxFriendsPerTransaction) && (chunkEnd != friends.cend()); i++)
+			++chunkEnd;
+		L_DB_TRANSACTION {
+			L_D();
+
+			for (auto it = chunkBegin; it != chunkEnd; ++it)
+				(*it)->mStorageId = d->insertOrUpdateFriend(*it);
+			tr.commit();
+		};
+		chunkBegin = chunkEnd;
+	}
+#endif
+}
+
 long long MainDb::insertFriendList(const std::shared_ptr<FriendList> &list) {
 #ifdef HAVE_DB_STORAGE
 	return L_DB_TRANSACTION {
@@ -7816,7 +8712,7 @@ std::list<std::shared_ptr<FriendList>> MainDb::getFriendLists() {
 
 		soci::rowset<soci::row> rows =
 		    (session->prepare
-		     << "SELECT id, name, rls_uri, sync_uri, revision, type, ctag FROM friends_list ORDER BY id");
+		     << "SELECT id, name, rls_uri, sync_uri, revision, type, ctag, sync_token FROM friends_list ORDER BY id");
 		for (const auto &row : rows) {
 			auto list = d->selectFriendList(row);
 			list->setCore(getCore());
@@ -7942,6 +8838,59 @@ bool MainDb::import(Backend, const string &parameters) {
 #endif
 }
 
+void MainDb::enableWriteBehind(bool enable, int batchWindowMs) {
+	L_D();
+	if (enable) {
+		lInfo() << "Enabling MainDb write-behind mode with a batch window of " << batchWindowMs << " ms.";
+		d->startWriter(batchWindowMs);
+	} else {
+		d->stopWriter();
+	}
+}
+
+bool MainDb::writeBehindEnabled() const {
+	L_D();
+	lock_guard<mutex> lock(d->pendingWritesMutex);
+	return d->writerRunning;
+}
+
+void MainDb::flushPendingWrites() {
+	L_D();
+	L_SYNC();
+	d->commitPendingWrites();
+}
+
+void MainDb::setSqliteProfile(SqliteProfile profile, int cacheSizeKb) {
+	L_D();
+	d->sqliteProfile = profile;
+	d->sqliteCacheSizeKb = cacheSizeKb;
+}
+
+bool MainDb::walEnabled() const {
+	L_D();
+	return d->walEnabled;
+}
+
+void MainDb::checkpoint() {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+	L_SYNC();
+	if (!d->walEnabled) return;
+
+	// PASSIVE never blocks: the frames still used by a reader are copied by a next checkpoint.
+	try {
+		int busy = 0;
+		int logFrames = 0;
+		int checkpointedFrames = 0;
+		*d->dbSession.getBackendSession() << "PRAGMA wal_checkpoint(PASSIVE)", soci::into(busy), soci::into(logFrames),
+		    soci::into(checkpointedFrames);
+		lDebug() << "Sqlite3 checkpoint: " << checkpointedFrames << "/" << logFrames << " frames of the WAL copied.";
+	} catch (const soci::soci_error &e) {
+		lWarning() << "Sqlite3 checkpoint failed: " << e.what();
+	}
+#endif
+}
+
 MainDb::FilterMask MainDb::getFilterMaskFromHistoryFilterMask(AbstractChatRoom::HistoryFilterMask historyFilterMask) {
 	FilterMask mask;
 
@@ -22,6 +22,7 @@
 #define _L_MAIN_DB_H_
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <utility>
 
@@ -81,6 +82,16 @@ public:
 		time_t timestamp = 0;
 	};
 
+	// A message received by a server chat room, waiting to be relayed to offline devices.
+	struct ServerChatRoomQueuedMessage {
+		long long id = -1;
+		std::string fromAddress;
+		std::string contentType;
+		std::string body;
+		std::string headers; // "Name: value\r\n" lines.
+		time_t creationTime = 0;
+	};
+
 	struct ChatRoomContext {
 		ChatRoomContext(const std::shared_ptr<AbstractChatRoom> &chatRoom,
 		                long long dbId,
@@ -96,6 +107,7 @@ public:
 	};
 
 	MainDb(const std::shared_ptr<Core> &core);
+	~MainDb();
 
 	// ---------------------------------------------------------------------------
 	// Generic.
@@ -137,10 +149,23 @@ public:
 	std::list<ParticipantState> getChatMessageParticipantStates(const std::shared_ptr<EventLog> &eventLog) const;
 	ChatMessage::State getChatMessageParticipantState(const std::shared_ptr<EventLog> &eventLog,
 	                                                  const std::shared_ptr<Address> &participantAddress) const;
+	// Same as getChatMessageParticipantState() but tells if the participant has a state for this message.
+	bool findChatMessageParticipantState(const std::shared_ptr<EventLog> &eventLog,
+	                                     const std::shared_ptr<Address> &participantAddress,
+	                                     ChatMessage::State &state) const;
+	// Number of participants in each state, read from counters instead of from the state of every participant.
+	std::map<ChatMessage::State, int>
+	getChatMessageParticipantStateCounts(const std::shared_ptr<EventLog> &eventLog) const;
+	// Number of the given participants having a state for this message.
+	size_t countChatMessageParticipantStates(const std::shared_ptr<EventLog> &eventLog,
+	                                         const std::list<std::shared_ptr<Address>> &participantAddresses) const;
 	void setChatMessageParticipantState(const std::shared_ptr<EventLog> &eventLog,
 	                                    const std::shared_ptr<Address> &participantAddress,
 	                                    ChatMessage::State state,
 	                                    time_t stateChangeTime);
+	// Store the participant states of several messages in a single transaction.
+	void setChatMessagesParticipantState(
+	    const std::list<std::pair<std::shared_ptr<EventLog>, ParticipantState>> &participantStates);
 
 	std::list<std::shared_ptr<ChatMessage>> getEphemeralMessages() const;
 
@@ -168,6 +193,8 @@ public:
 	                                                   const std::string &text,
 	                                                   const std::shared_ptr<const EventLog> &from,
 	                                                   LinphoneSearchDirection direction);
+	std::list<std::shared_ptr<EventLog>>
+	findChatMessagesByText(const ConferenceId &conferenceId, const std::string &text, int begin, int end) const;
 
 	// ---------------------------------------------------------------------------
 	// Conference events.
@@ -245,6 +272,28 @@ public:
 	void insertNewPreviousConferenceId(const ConferenceId &currentConfId, const ConferenceId &previousConfId);
 	void removePreviousConferenceId(const ConferenceId &confId);
 
+	// ---------------------------------------------------------------------------
+	// Server chat room message queue.
+	// ---------------------------------------------------------------------------
+
+	// A queued message is stored once for all its recipients. Each device has a cursor, the id of the last message
+	// dispatched to it: the devices that have none yet get one pointing just before the new message.
+	// Returns the id of the message or -1 on failure.
+	long long insertServerChatRoomQueuedMessage(const std::shared_ptr<Address> &chatRoomAddress,
+	                                            const ServerChatRoomQueuedMessage &message,
+	                                            const std::list<std::shared_ptr<Address>> &newRecipients);
+	// Messages of a chat room with an id greater than afterId, in queue order.
+	std::list<ServerChatRoomQueuedMessage>
+	getServerChatRoomQueuedMessages(const std::shared_ptr<Address> &chatRoomAddress, long long afterId);
+	// Cursors of a chat room, by device address.
+	std::map<std::string, long long> getServerChatRoomQueueCursors(const std::shared_ptr<Address> &chatRoomAddress);
+	// Create or move the given cursors and delete those of the removed devices, in a single transaction.
+	bool updateServerChatRoomQueueCursors(const std::shared_ptr<Address> &chatRoomAddress,
+	                                      const std::map<std::string, long long> &cursors,
+	                                      const std::list<std::string> &removedDevices);
+	// Delete the messages created before the given time and those that have been dispatched to all the devices.
+	void cleanupServerChatRoomQueues(time_t createdBeforeThisTime);
+
 	// ---------------------------------------------------------------------------
 	// Conference Info.
 	// ---------------------------------------------------------------------------
@@ -293,6 +342,8 @@ public:
 	// Friend & FriendList.
 	// ---------------------------------------------------------------------------
 	long long insertFriend(const std::shared_ptr<Friend> &f);
+	// Insert or update many friends, in a few transactions. Their storage ids are updated.
+	void insertFriends(const std::list<std::shared_ptr<Friend>> &friends);
 	long long insertFriendList(const std::shared_ptr<FriendList> &list);
 	void deleteFriend(const std::shared_ptr<Friend> &f);
 	void deleteFriendList(const std::shared_ptr<FriendList> &list);
@@ -313,6 +364,24 @@ public:
 	// Import legacy calls/messages from old db. Returns true if something was done.
 	bool import(Backend backend, const std::string &parameters) override;
 
+	// In write-behind mode, chat message participant states are queued and committed by a dedicated thread, in one
+	// transaction per batch window, instead of one transaction each.
+	void enableWriteBehind(bool enable, int batchWindowMs = 50);
+	bool writeBehindEnabled() const;
+	// Commit the writes queued in write-behind mode now.
+	void flushPendingWrites();
+
+	// Journaling profile of the sqlite3 backend, applied each time the database is connected.
+	// None: the journaling pragmas of the database are left untouched.
+	// Default: rollback journal, a database left in WAL mode by a previous connection goes back to it.
+	// Wal: write-ahead log with synchronous=NORMAL. The database is then locked by the connection until it is closed,
+	// so it must not be shared with another process.
+	enum class SqliteProfile { None, Default, Wal };
+	void setSqliteProfile(SqliteProfile profile, int cacheSizeKb = 0);
+	bool walEnabled() const;
+	// Copy the content of the write-ahead log into the database, if it can be done without waiting.
+	void checkpoint();
+
 	static FilterMask getFilterMaskFromHistoryFilterMask(AbstractChatRoom::HistoryFilterMask historyFilterMask);
 
 protected:
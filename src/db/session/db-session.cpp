@@ -18,6 +18,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+
 #include "linphone/utils/utils.h"
 
 #include "db-session.h"
@@ -30,11 +32,16 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+// Statements cached by the DbSession itself use negative ids.
+static constexpr int LastInsertIdStatementId = -1;
+
 class DbSessionPrivate {
 public:
 	enum class Backend { None, Mysql, Sqlite3 } backend = Backend::None;
 
 	std::unique_ptr<soci::session> backendSession;
+	// Declared after the session to be destroyed before it.
+	mutable std::unordered_map<int, std::unique_ptr<soci::statement>> statementCache;
 };
 
 DbSession::DbSession() : mPrivate(new DbSessionPrivate) {
@@ -203,23 +210,40 @@ long long DbSession::getLastInsertId() const {
 
 	L_D();
 
-	string sql;
 	switch (d->backend) {
 		case DbSessionPrivate::Backend::Mysql:
-			sql = "SELECT LAST_INSERT_ID()";
+			executeCachedStatement(LastInsertIdStatementId, "SELECT LAST_INSERT_ID()", soci::into(id));
 			break;
 		case DbSessionPrivate::Backend::Sqlite3:
-			sql = "SELECT last_insert_rowid()";
+			executeCachedStatement(LastInsertIdStatementId, "SELECT last_insert_rowid()", soci::into(id));
 			break;
 		case DbSessionPrivate::Backend::None:
 			break;
 	}
 
-	if (!sql.empty()) {
-		*d->backendSession << sql, soci::into(id);
+	return id;
+}
+
+soci::statement &DbSession::getCachedStatement(int id, const char *sql) const {
+	L_D();
+
+	auto &statement = d->statementCache[id];
+	if (!statement) {
+		statement = makeUnique<soci::statement>(*d->backendSession);
+		try {
+			statement->alloc();
+			statement->prepare(sql);
+		} catch (...) {
+			d->statementCache.erase(id);
+			throw;
+		}
 	}
+	return *statement;
+}
 
-	return id;
+void DbSession::clearStatementCache() {
+	L_D();
+	d->statementCache.clear();
 }
 
 void DbSession::enableForeignKeys(bool status) {
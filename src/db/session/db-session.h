@@ -66,7 +66,32 @@ public:
 
 	unsigned int getUnsignedInt(const soci::row &row, std::size_t col, const unsigned int def = 0) const;
 
+	// Execute a statement that is prepared only once for the lifetime of the session. The statement is identified by
+	// `id`, `sql` is only used the first time. The uses and intos are bound again at each execution.
+	// A cached statement must return at most one row. Returns true if a row was fetched.
+	template <typename... Exchanges>
+	bool executeCachedStatement(int id, const char *sql, Exchanges &&...exchanges) const {
+		soci::statement &statement = getCachedStatement(id, sql);
+		(statement.exchange(std::forward<Exchanges>(exchanges)), ...);
+		try {
+			statement.define_and_bind();
+			bool gotData = statement.execute(true);
+			// Step to the end of the result, otherwise the statement stays active and keeps its read transaction.
+			if (gotData) statement.fetch();
+			statement.bind_clean_up();
+			return gotData;
+		} catch (...) {
+			statement.bind_clean_up();
+			throw;
+		}
+	}
+
+	// Must be called before the backend session is reconnected.
+	void clearStatementCache();
+
 private:
+	soci::statement &getCachedStatement(int id, const char *sql) const;
+
 	DbSessionPrivate *mPrivate;
 
 	L_DECLARE_PRIVATE(DbSession);
@@ -180,23 +180,33 @@ LinphoneStatus EventSubscribe::deny(LinphoneReason reason) {
 	return err;
 }
 
-LinphoneStatus EventSubscribe::notify(const std::shared_ptr<const Content> &body) {
-	SalBodyHandler *body_handler;
+bool EventSubscribe::canNotify() const {
 	if (mSubscriptionState != LinphoneSubscriptionActive &&
 	    mSubscriptionState != LinphoneSubscriptionIncomingReceived) {
 		lError() << "EventSubscribe::notify(): cannot notify if subscription is not active.";
-		return -1;
+		return false;
 	}
 	if (mDir != LinphoneSubscriptionIncoming) {
 		lError() << "EventSubscribe::notify(): cannot notify if not an incoming subscription.";
-		return -1;
+		return false;
 	}
+	return true;
+}
+
+LinphoneStatus EventSubscribe::notify(const std::shared_ptr<const Content> &body) {
+	if (!canNotify()) return -1;
 	const LinphoneContent *cBody = (body && !body->isEmpty()) ? body->toC() : nullptr;
-	body_handler = sal_body_handler_from_content(cBody, false);
+	SalBodyHandler *body_handler = sal_body_handler_from_content(cBody, false);
 	auto subscribeOp = dynamic_cast<SalSubscribeOp *>(mOp);
 	return subscribeOp->notify(body_handler);
 }
 
+LinphoneStatus EventSubscribe::notifyWithBodyHandler(const SalBodyHandler *bodyHandler) {
+	if (!canNotify()) return -1;
+	auto subscribeOp = dynamic_cast<SalSubscribeOp *>(mOp);
+	return subscribeOp->notify(bodyHandler);
+}
+
 void EventSubscribe::notifyNotifyResponse() {
 	LINPHONE_HYBRID_OBJECT_INVOKE_CBS_NO_ARG(Event, this, linphone_event_cbs_get_notify_response);
 }
@@ -68,6 +68,8 @@ public:
 	LinphoneStatus deny(LinphoneReason reason) override;
 
 	LinphoneStatus notify(const std::shared_ptr<const Content> &body);
+	// The body handler is only referenced by the request, so that the same body can be sent to many subscribers.
+	LinphoneStatus notifyWithBodyHandler(const SalBodyHandler *bodyHandler);
 	void notifyNotifyResponse();
 
 	LinphoneSubscriptionState getState() const;
@@ -83,6 +85,8 @@ public:
 	void terminate() override;
 
 private:
+	bool canNotify() const;
+
 	LinphoneSubscriptionDir mDir = LinphoneSubscriptionInvalidDir;
 	LinphoneSubscriptionState mSubscriptionState = LinphoneSubscriptionNone;
 
@@ -19,13 +19,14 @@
  */
 
 #include <fstream>
-#include <set>
+#include <unordered_map>
 
 #include "bctoolbox/list.h"
 #include <bctoolbox/defs.h>
 
 #include "friend-list.h"
 
+#include "account/account.h"
 #include "c-wrapper/internal/c-tools.h"
 #include "content/content.h"
 #include "core/core-p.h"
@@ -45,7 +46,7 @@
 #include "vcard/vcard-context.h"
 #include "vcard/vcard.h"
 #ifdef HAVE_XML2
-#include "xml/xml-parsing-context.h"
+#include "xml/xml-reader.h"
 #endif // HAVE_XML2
 
 // =============================================================================
@@ -144,6 +145,14 @@ const std::list<std::shared_ptr<Friend>> &FriendList::getDirtyFriendsToUpdate()
 	return mDirtyFriendsToUpdate;
 }
 
+const FriendSearchIndex &FriendList::getSearchIndex() const {
+	// Normalized phone numbers depend on the default account, rebuild the index if it has changed.
+	const auto &account = getCore()->getDefaultAccount();
+	if (!mSearchIndex || !mSearchIndex->isUpToDate(account))
+		mSearchIndex = std::make_unique<FriendSearchIndex>(mFriendsList.mList, account);
+	return *mSearchIndex;
+}
+
 LinphoneFriendListType FriendList::getType() const {
 	return mType;
 }
@@ -317,6 +326,11 @@ LinphoneStatus FriendList::importFriendsFromVcard4File(const std::string &vcardF
 	return importFriendsFromVcard4(vcards);
 }
 
+void FriendList::invalidateSearchIndex() {
+	mSearchIndex = nullptr;
+	mPhoneNumberIndexes.clear();
+}
+
 void FriendList::notifyPresence(const std::shared_ptr<PresenceModel> &model) const {
 	for (const auto &f : mFriendsList.mList)
 		f->notify(model);
@@ -330,6 +344,10 @@ void FriendList::removeFriends() {
 	removeFriends(true);
 }
 
+void FriendList::removePhoneNumberIndex(const std::shared_ptr<const Account> &account) {
+	mPhoneNumberIndexes.erase(account.get());
+}
+
 bool FriendList::subscriptionsEnabled() const {
 	return mSubscriptionsEnabled;
 }
@@ -467,6 +485,11 @@ void FriendList::updateRevision(const string &revision) {
 	saveInDb();
 }
 
+void FriendList::updateSyncToken(const string &syncToken) {
+	mSyncToken = syncToken;
+	saveInDb();
+}
+
 // -----------------------------------------------------------------------------
 
 LinphoneFriendListStatus FriendList::addFriend(const std::shared_ptr<Friend> &lf, bool synchronize) {
@@ -599,9 +622,10 @@ std::shared_ptr<Friend> FriendList::findFriendByOutSubscribe(SalOp *op) const {
 
 std::shared_ptr<Friend> FriendList::findFriendByPhoneNumber(const std::shared_ptr<Account> &account,
                                                             const std::string &normalizedPhoneNumber) const {
-	const auto it = std::find_if(mFriendsList.mList.cbegin(), mFriendsList.mList.cend(),
-	                             [&](const auto &f) { return f->hasPhoneNumber(account, normalizedPhoneNumber); });
-	return (it == mFriendsList.mList.cend()) ? nullptr : *it;
+	if (!account || normalizedPhoneNumber.empty()) return nullptr;
+	const auto &index = getPhoneNumberIndex(account);
+	const auto it = index.find(normalizedPhoneNumber);
+	return (it == index.cend()) ? nullptr : it->second;
 }
 
 std::shared_ptr<Address> FriendList::getRlsAddressWithCoreFallback() const {
@@ -618,6 +642,40 @@ std::shared_ptr<Address> FriendList::getRlsAddressWithCoreFallback() const {
 	return lc->default_rls_addr ? Address::getSharedFromThis(lc->default_rls_addr) : nullptr;
 }
 
+const std::unordered_map<std::string, std::shared_ptr<Friend>> &
+FriendList::getPhoneNumberIndex(const std::shared_ptr<Account> &account) const {
+	// Account params are replaced, not modified, when the account is updated, e.g. with another international prefix.
+	const auto &accountParams = account->getAccountParams();
+	auto indexIt = mPhoneNumberIndexes.find(account.get());
+	if ((indexIt != mPhoneNumberIndexes.end()) && indexIt->second.built &&
+	    (indexIt->second.account.lock() == account) && (indexIt->second.accountParams.lock() == accountParams))
+		return indexIt->second.friends;
+
+	// Drop the indexes of the accounts that no longer exist before building this one.
+	for (auto it = mPhoneNumberIndexes.begin(); it != mPhoneNumberIndexes.end();) {
+		if (it->second.account.expired()) it = mPhoneNumberIndexes.erase(it);
+		else it++;
+	}
+	PhoneNumberIndex &index = mPhoneNumberIndexes[account.get()];
+	index.friends.clear();
+	for (const auto &f : mFriendsList.mList) {
+		for (const auto &phoneNumber : f->getPhoneNumbers()) {
+			char *normalizedPhoneNumber =
+			    linphone_account_normalize_phone_number(account->toC(), L_STRING_TO_C(phoneNumber));
+			if (!normalizedPhoneNumber) continue;
+			// Keep the first friend of the list having the number, as a linear search would.
+			if (normalizedPhoneNumber[0] != '\0') index.friends.emplace(normalizedPhoneNumber, f);
+			bctbx_free(normalizedPhoneNumber);
+		}
+	}
+	index.account = account;
+	index.accountParams = accountParams;
+	index.built = true;
+	lDebug() << "Built phone number index of friend list [" << toC() << "] for account [" << account->toC()
+	         << "]: " << index.friends.size() << " numbers";
+	return index.friends;
+}
+
 bool FriendList::hasSubscribeInactive() const {
 	if (mBodylessSubscription) return true;
 	for (const auto &lf : mFriendsList.mList) {
@@ -634,6 +692,7 @@ LinphoneFriendListStatus FriendList::importFriend(const std::shared_ptr<Friend>
 	lf->mFriendList = this;
 	mFriendsList.mList.push_front(lf);
 	lf->addAddressesAndNumbersIntoMaps(getSharedFromThis());
+	invalidateSearchIndex();
 	if (synchronize) {
 		mDirtyFriendsToUpdate.push_front(lf);
 		mBctbxDirtyFriendsToUpdate = bctbx_list_prepend(mBctbxDirtyFriendsToUpdate, lf->toC());
@@ -646,21 +705,21 @@ LinphoneStatus FriendList::importFriendsFromVcard4(const std::list<std::shared_p
 		lError() << "vCard support wasn't enabled at compilation time";
 		return -1;
 	}
-	int count = 0;
+	std::list<std::shared_ptr<Friend>> importedFriends;
 	for (const auto &vcard : vcards) {
 		if (vcard->getUid().empty()) vcard->generateUniqueId();
 		std::shared_ptr<Friend> f = Friend::create(getCore(), vcard);
-		if (importFriend(f, true) == LinphoneFriendListOK) {
-			f->saveInDb(), count++;
-		}
+		if (importFriend(f, true) == LinphoneFriendListOK) importedFriends.push_back(f);
 	}
+	saveFriendsInDb(importedFriends);
 	saveInDb();
-	return count;
+	return static_cast<LinphoneStatus>(importedFriends.size());
 }
 
 void FriendList::invalidateFriendsMaps() {
 	mFriendsMapByRefKey.clear();
 	mFriendsMapByUri.clear();
+	invalidateSearchIndex();
 	for (const auto &f : mFriendsList.mList)
 		f->addAddressesAndNumbersIntoMaps(getSharedFromThis());
 }
@@ -684,47 +743,52 @@ void FriendList::notifyPresenceReceived(const std::shared_ptr<const Content> &co
 		           << contentType.getType() << "/" << contentType.getSubType() << "'";
 		return;
 	}
-	LinphoneContent *firstPart = linphone_content_get_part(content->toC(), 0);
-	if (!firstPart) {
+	// The parts are used from the multipart body handler as they are, without making a Content of each of them.
+	SalBodyHandler *bodyHandler = Content::getBodyHandlerFromContent(*content);
+	const bctbx_list_t *parts =
+	    (bodyHandler && sal_body_handler_is_multipart(bodyHandler)) ? sal_body_handler_get_parts(bodyHandler) : nullptr;
+	if (!parts) {
 		lWarning() << "'multipart/related' presence notified but it doesn't contain any part";
-		return;
-	}
-	if (Content::toCpp(firstPart)->getContentType() != ContentType::Rlmi) {
-		lWarning() << "multipart presence notified but first part is not 'application/rlmi+xml'";
-		linphone_content_unref(firstPart);
-		return;
+	} else {
+		const SalBodyHandler *firstPart = static_cast<const SalBodyHandler *>(parts->data);
+		if (ContentType(L_C_TO_STRING(sal_body_handler_get_type(firstPart)),
+		                L_C_TO_STRING(sal_body_handler_get_subtype(firstPart))) != ContentType::Rlmi) {
+			lWarning() << "multipart presence notified but first part is not 'application/rlmi+xml'";
+		} else {
+			parseMultipartRelatedBody(parts);
+		}
 	}
-	parseMultipartRelatedBody(content, Content::toCpp(firstPart)->getBodyAsUtf8String());
-	linphone_content_unref(firstPart);
+	if (bodyHandler) sal_body_handler_unref(bodyHandler);
 }
 
 #ifdef HAVE_XML2
 
 class FriendListXmlException : public std::exception {
 public:
-	FriendListXmlException(const char *msg) : mMessage(msg) {
+	FriendListXmlException(const std::string &msg) : mMessage(msg) {
 	}
 	const char *what() const throw() override {
-		return mMessage;
+		return mMessage.c_str();
 	}
 
 private:
-	const char *mMessage;
+	std::string mMessage;
 };
 
-void FriendList::parseMultipartRelatedBody(const std::shared_ptr<const Content> &content,
-                                           const std::string &firstPartBody) {
+static string_view getBodyHandlerView(const SalBodyHandler *bodyHandler) {
+	const char *data = static_cast<const char *>(sal_body_handler_get_data(bodyHandler));
+	return data ? string_view(data, sal_body_handler_get_size(bodyHandler)) : string_view();
+}
+
+void FriendList::parseMultipartRelatedBody(const bctbx_list_t *parts) {
+	static constexpr const char *rlmiNs = "urn:ietf:params:xml:ns:rlmi";
 	try {
-		XmlParsingContext xmlCtx(firstPartBody);
-		if (!xmlCtx.isValid()) {
-			stringstream ss;
-			ss << "Wrongly formatted rlmi+xml body: " << xmlCtx.getError();
-			throw FriendListXmlException(ss.str().c_str());
-		}
+		// The RLMI document is read in a single pass with a forward-only reader.
+		XmlReader reader(getBodyHandlerView(static_cast<const SalBodyHandler *>(parts->data)));
+		if (!reader.readRootElement() || !reader.isElement(rlmiNs, "list"))
+			throw FriendListXmlException("Wrongly formatted rlmi+xml body: " + reader.getError());
 
-		xmlXPathRegisterNs(xmlCtx.getXpathContext(), reinterpret_cast<const xmlChar *>("rlmi"),
-		                   reinterpret_cast<const xmlChar *>("urn:ietf:params:xml:ns:rlmi"));
-		std::string versionStr = xmlCtx.getAttributeTextContent("/rlmi:list", "version");
+		std::string versionStr = reader.getAttribute("version");
 		if (versionStr.empty()) throw FriendListXmlException("rlmi+xml: No version attribute in list");
 		int version = atoi(versionStr.c_str());
 		if (version < mExpectedNotificationVersion) {
@@ -732,26 +796,71 @@ void FriendList::parseMultipartRelatedBody(const std::shared_ptr<const Content>
 			lWarning() << "rlmi+xml: Received notification with version " << version << " expected was "
 			           << mExpectedNotificationVersion << ", dialog may have been reseted";
 		}
-		std::string fullStateStr = xmlCtx.getAttributeTextContent("/rlmi:list", "fullState");
+		std::string fullStateStr = reader.getAttribute("fullState");
 		if (fullStateStr.empty()) throw FriendListXmlException("rlmi+xml: No fullState attribute in list");
-		bool fullState = false;
-		std::string fullStateString(fullStateStr);
-		if ((fullStateString == "true") || (fullStateString == "1")) {
-			fullState = true;
+		bool fullState = (fullStateStr == "true") || (fullStateStr == "1");
+		if ((mExpectedNotificationVersion == 0) && !fullState)
+			throw FriendListXmlException("rlmi+xml: Notification with version 0 is not full state, this is not valid");
+
+		// The resources are applied once the whole document has been read, so that a malformed notification
+		// neither clears the presence of the friends nor moves the expected version.
+		struct RlmiResource {
+			std::string uri;
+			std::string name;
+			std::string cid;
+			bool hasName = false;
+		};
+		std::vector<RlmiResource> resources;
+		int depth = reader.getDepth();
+		while (reader.readChildElement(depth)) {
+			if (!reader.isElement(rlmiNs, "resource")) continue;
+			RlmiResource resource;
+			resource.uri = reader.getAttribute("uri");
+			int resourceDepth = reader.getDepth();
+			while (reader.readChildElement(resourceDepth)) {
+				if (reader.isElement(rlmiNs, "name")) {
+					resource.hasName = true;
+					if (resource.name.empty()) resource.name = reader.getTextContent();
+				} else if (reader.isElement(rlmiNs, "instance")) {
+					if (resource.cid.empty() && (reader.getAttribute("state") == "active"))
+						resource.cid = reader.getAttribute("cid");
+				}
+			}
+			if (!resource.uri.empty()) resources.push_back(std::move(resource));
+		}
+		if (reader.hasError()) throw FriendListXmlException("Wrongly formatted rlmi+xml body: " + reader.getError());
+
+		if (fullState) {
 			for (const auto &lf : mFriendsList.mList)
 				lf->clearPresenceModels();
 		}
-		if ((mExpectedNotificationVersion == 0) && !fullState)
-			throw FriendListXmlException("rlmi+xml: Notification with version 0 is not full state, this is not valid");
 		mExpectedNotificationVersion = version + 1;
 
-		xmlXPathObjectPtr nameObject = xmlCtx.getXpathObjectForNodeList("/rlmi:list/rlmi:resource/rlmi:name/..");
-		if (nameObject && nameObject->nodesetval) {
-			for (int i = 1; i <= nameObject->nodesetval->nodeNr; i++) {
-				xmlCtx.setXpathContextNode(xmlXPathNodeSetItem(nameObject->nodesetval, i - 1));
-				std::string name = xmlCtx.getTextContent("./rlmi:name");
-				std::string uri = xmlCtx.getTextContent("./@uri");
-				if (uri.empty()) continue;
+		std::unordered_map<std::string_view, const SalBodyHandler *> partsByContentId;
+		for (const bctbx_list_t *it = parts; it != nullptr; it = it->next) {
+			const SalBodyHandler *part = static_cast<const SalBodyHandler *>(it->data);
+			const char *contentId = sal_body_handler_get_header(part, "Content-Id");
+			if (contentId) partsByContentId.emplace(contentId, part);
+		}
+
+		// Friends for which presence information has been received, in order, and whether their presence_received
+		// callbacks are to be invoked. Each friend is notified once, whatever the number of its resources.
+		std::vector<std::pair<std::shared_ptr<Friend>, bool>> friendsPresenceReceived;
+		std::unordered_map<const Friend *, size_t> friendsPresenceReceivedIndexes;
+		const auto presenceReceived = [&](const std::shared_ptr<Friend> &lf, const std::string &uri,
+		                                  const std::shared_ptr<PresenceModel> &model) {
+			bool notify = lf->presenceReceived(getSharedFromThis(), uri, model);
+			size_t index = friendsPresenceReceived.size();
+			const auto [it, inserted] = friendsPresenceReceivedIndexes.emplace(lf.get(), index);
+			if (inserted) friendsPresenceReceived.emplace_back(lf, notify);
+			else if (notify) friendsPresenceReceived[it->second].second = true;
+		};
+
+		for (auto &resource : resources) {
+			std::string &uri = resource.uri;
+			const std::string &name = resource.name;
+			const std::string &cid = resource.cid;
+			if (resource.hasName) {
 				std::shared_ptr<Address> addr = Address::create(uri);
 				if (!addr) continue;
 				std::shared_ptr<Friend> lf = findFriendByAddress(addr);
@@ -759,93 +868,62 @@ void FriendList::parseMultipartRelatedBody(const std::shared_ptr<const Content>
 					lf = Friend::create(getCore(), uri);
 					addFriend(lf);
 				}
-				if (!name.empty()) lf->setName(name);
+				if (lf && !name.empty()) lf->setName(name);
 			}
-		}
-		if (nameObject) xmlXPathFreeObject(nameObject);
-
-		std::set<std::shared_ptr<Friend>> listFriendsPresenceReceived;
-		bctbx_list_t *parts = linphone_content_get_parts(content->toC());
-		xmlXPathObjectPtr resourceObject =
-		    xmlCtx.getXpathObjectForNodeList("/rlmi:list/rlmi:resource/rlmi:instance[@state=\"active\"]/..");
-		if (resourceObject && resourceObject->nodesetval) {
-			for (int i = 1; i <= resourceObject->nodesetval->nodeNr; i++) {
-				xmlCtx.setXpathContextNode(xmlXPathNodeSetItem(resourceObject->nodesetval, i - 1));
-				std::string cid = xmlCtx.getTextContent("./rlmi:instance/@cid");
-				if (!cid.empty()) {
-					std::shared_ptr<Content> presencePart = nullptr;
-					bctbx_list_t *it = parts;
-					while (it != nullptr) {
-						LinphoneContent *content = (LinphoneContent *)it->data;
-						const char *header = linphone_content_get_custom_header(content, "Content-Id");
-						if (header && (std::string(header) == cid)) {
-							presencePart = Content::toCpp(content)->getSharedFromThis();
-							break;
-						}
-						it = bctbx_list_next(it);
-					}
-					if (!presencePart) {
-						lWarning() << "rlmi+xml: Cannot find part with Content-Id: " << cid;
-					} else {
-						SalPresenceModel *presence = nullptr;
-						const ContentType &presencePartContentType = presencePart->getContentType();
-						PresenceModel::parsePresence(presencePartContentType.getType(),
-						                             presencePartContentType.getSubType(),
-						                             presencePart->getBodyAsUtf8String(), &presence);
-						if (presence) {
-							// Try to reduce CPU cost of linphone_address_new and find_friend_by_address by only doing
-							// it when we know for sure we have a presence to notify
-							std::string uri = xmlCtx.getTextContent("./@uri");
-							if (uri.empty()) continue;
-							std::shared_ptr<Address> addr = Address::create(uri);
-							if (!addr) continue;
-
-							// Clean the URI
-							if (addr->hasUriParam("gr")) addr->removeUriParam("gr");
-							uri = addr->asStringUriOnly();
-
-							const auto [first, last] = mFriendsMapByUri.equal_range(uri);
-							if (first == last) {
-								if (mBodylessSubscription) {
-									std::shared_ptr<Friend> lf = Friend::create(getCore(), uri);
-									addFriend(lf);
-									lf->presenceReceived(
-									    getSharedFromThis(), uri,
-									    PresenceModel::toCpp((LinphonePresenceModel *)presence)->getSharedFromThis());
-									listFriendsPresenceReceived.insert(lf);
-								}
-							} else {
-								// Save the equal_range iterators for looping because mFriendsMapByUri might
-								// change during the loop, leading to wrong presence notifications
-								std::list<std::multimap<std::string, std::shared_ptr<Friend>>::iterator> its;
-								for (auto it = first; it != last; it++)
-									its.push_back(it);
-								for (const auto &it : its) {
-									it->second->presenceReceived(
-									    getSharedFromThis(), uri,
-									    PresenceModel::toCpp((LinphonePresenceModel *)presence)->getSharedFromThis());
-									listFriendsPresenceReceived.insert(it->second);
-								}
-							}
-
-							PresenceModel::toCpp((LinphonePresenceModel *)presence)->unref();
-						}
-					}
-				}
+
+			if (cid.empty()) continue;
+			const auto partIt = partsByContentId.find(cid);
+			if (partIt == partsByContentId.cend()) {
+				lWarning() << "rlmi+xml: Cannot find part with Content-Id: " << cid;
+				continue;
+			}
+			const SalBodyHandler *presencePart = partIt->second;
+			SalPresenceModel *presence = nullptr;
+			PresenceModel::parsePresence(L_C_TO_STRING(sal_body_handler_get_type(presencePart)),
+			                             L_C_TO_STRING(sal_body_handler_get_subtype(presencePart)),
+			                             getBodyHandlerView(presencePart), &presence);
+			if (!presence) continue;
+			const std::shared_ptr<PresenceModel> model =
+			    PresenceModel::toCpp((LinphonePresenceModel *)presence)->getSharedFromThis();
+			PresenceModel::toCpp((LinphonePresenceModel *)presence)->unref();
+
+			// Only parse the URI if it is not already known as is, e.g. to remove a gr parameter.
+			auto range = mFriendsMapByUri.equal_range(uri);
+			if (range.first == range.second) {
+				std::shared_ptr<Address> addr = Address::create(uri);
+				if (!addr) continue;
+				if (addr->hasUriParam("gr")) addr->removeUriParam("gr");
+				uri = addr->asStringUriOnly();
+				range = mFriendsMapByUri.equal_range(uri);
 			}
 
-			// Notify list with all friends for which we received presence information
-			if (!listFriendsPresenceReceived.empty()) {
-				bctbx_list_t *l = nullptr;
-				for (const auto &lf : listFriendsPresenceReceived)
-					l = bctbx_list_append(l, lf->toC());
-				LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_presence_received, l);
-				bctbx_list_free(l);
+			if (range.first == range.second) {
+				if (mBodylessSubscription) {
+					std::shared_ptr<Friend> lf = Friend::create(getCore(), uri);
+					addFriend(lf);
+					presenceReceived(lf, uri, model);
+				}
+			} else {
+				// Save the equal_range iterators for looping because mFriendsMapByUri might
+				// change during the loop, leading to wrong presence notifications
+				std::list<std::multimap<std::string, std::shared_ptr<Friend>>::iterator> its;
+				for (auto it = range.first; it != range.second; it++)
+					its.push_back(it);
+				for (const auto &it : its)
+					presenceReceived(it->second, uri, model);
 			}
 		}
-
-		bctbx_list_free_with_data(parts, (void (*)(void *))linphone_content_unref);
-		if (resourceObject) xmlXPathFreeObject(resourceObject);
+		for (const auto &[lf, notify] : friendsPresenceReceived) {
+			if (notify) lf->notifyPresenceReceived();
+		}
+		// Notify list with all friends for which we received presence information
+		if (!friendsPresenceReceived.empty()) {
+			bctbx_list_t *l = nullptr;
+			for (auto it = friendsPresenceReceived.crbegin(); it != friendsPresenceReceived.crend(); it++)
+				l = bctbx_list_prepend(l, it->first->toC());
+			LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_presence_received, l);
+			bctbx_list_free(l);
+		}
 	} catch (FriendListXmlException &e) {
 		lWarning() << e.what();
 	}
@@ -853,8 +931,7 @@ void FriendList::parseMultipartRelatedBody(const std::shared_ptr<const Content>
 
 #else
 
-void FriendList::parseMultipartRelatedBody(BCTBX_UNUSED(const std::shared_ptr<const Content> &content),
-                                           BCTBX_UNUSED(const std::string &firstPartBody)) {
+void FriendList::parseMultipartRelatedBody(BCTBX_UNUSED(const bctbx_list_t *parts)) {
 	lWarning() << "FriendList::parseMultipartRelatedBody() is stubbed.";
 }
 
@@ -908,6 +985,7 @@ void FriendList::removeFriends(bool removeFromServer) {
 		deleteFriend(lf, removeFromServer);
 	}
 	mFriendsList.mList.clear();
+	invalidateSearchIndex();
 }
 
 LinphoneFriendListStatus FriendList::removeFriend(const std::shared_ptr<Friend> &lf, bool removeFromServer) {
@@ -917,6 +995,7 @@ LinphoneFriendListStatus FriendList::removeFriend(const std::shared_ptr<Friend>
 
 	deleteFriend(lf, removeFromServer);
 	mFriendsList.mList.erase(it);
+	invalidateSearchIndex();
 	return LinphoneFriendListOK;
 }
 
@@ -945,6 +1024,18 @@ void FriendList::saveInDb() {
 #endif
 }
 
+void FriendList::saveFriendsInDb(BCTBX_UNUSED(const std::list<std::shared_ptr<Friend>> &friends)) {
+#ifdef HAVE_DB_STORAGE
+	if (friends.empty() || !databaseStorageEnabled()) return;
+	if (mStorageId < 0) saveInDb();
+	try {
+		std::unique_ptr<MainDb> &mainDb = L_GET_PRIVATE_FROM_C_OBJECT(getCore()->getCCore())->mainDb;
+		if (mainDb) mainDb->insertFriends(friends);
+	} catch (std::bad_weak_ptr &) {
+	}
+#endif
+}
+
 void FriendList::sendListSubscription() {
 	std::shared_ptr<Address> address = getRlsAddressWithCoreFallback();
 	if (!address) {
@@ -1016,6 +1107,7 @@ void FriendList::sendListSubscriptionWithoutBody(const std::shared_ptr<Address>
 
 void FriendList::setFriends(const std::list<std::shared_ptr<Friend>> &friends) {
 	mFriendsList.mList = friends;
+	invalidateSearchIndex();
 }
 
 void FriendList::updateSubscriptions() {
@@ -1077,31 +1169,63 @@ void FriendList::subscriptionStateChanged(LinphoneCore *lc,
 
 #ifdef VCARD_ENABLED
 
-void FriendList::carddavCreated(const std::shared_ptr<Friend> &f) {
-	addLocalFriend(f); // Add as local because we do not want to synchronize it right now
-	LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_created, f->toC());
-}
-
 void FriendList::carddavDone(bool success, const std::string &msg) {
 	LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_sync_status_changed,
 	                                  success ? LinphoneFriendListSyncSuccessful : LinphoneFriendListSyncFailure,
 	                                  msg.c_str());
 }
 
+void FriendList::carddavPulled(
+    const std::list<std::shared_ptr<Friend>> &createdFriends,
+    const std::list<std::pair<std::shared_ptr<Friend>, std::shared_ptr<Friend>>> &updatedFriends) {
+	std::list<std::shared_ptr<Friend>> friendsToSave;
+	if (!updatedFriends.empty()) {
+		std::unordered_map<const Friend *, std::list<std::shared_ptr<Friend>>::iterator> positions;
+		positions.reserve(mFriendsList.mList.size());
+		for (auto it = mFriendsList.mList.begin(); it != mFriendsList.mList.end(); ++it)
+			positions.emplace(it->get(), it);
+		for (const auto &[newFriend, oldFriend] : updatedFriends) {
+			// The same contact may be updated twice in a pull, the second time it replaces the first new friend.
+			auto positionIt = positions.find(oldFriend.get());
+			if (positionIt != positions.end()) {
+				auto it = positionIt->second;
+				*it = newFriend;
+				positions.erase(positionIt);
+				positions.emplace(newFriend.get(), it);
+			}
+			friendsToSave.push_back(newFriend);
+		}
+		invalidateFriendsMaps();
+	}
+	for (const auto &f : createdFriends) {
+		// Same duplicate check as addFriend(), that can't be used as it saves each friend on its own.
+		const std::string refKey = f->getRefKey();
+		if (!refKey.empty() && findFriendByRefKey(refKey)) {
+			lWarning() << "[CardDAV] Friend [" << f->getName() << "] with ref key [" << refKey << "] already in list ["
+			           << mDisplayName << "], ignored.";
+			continue;
+		}
+		// Add as local because we do not want to synchronize it right now
+		if (importFriend(f, false) != LinphoneFriendListOK) continue;
+		friendsToSave.push_back(f);
+		if (mRlsUri.empty()) f->apply();
+	}
+	saveFriendsInDb(friendsToSave);
+
+	for (const auto &[newFriend, oldFriend] : updatedFriends)
+		LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_updated,
+		                                  newFriend->toC(), oldFriend->toC());
+	for (const auto &f : createdFriends) {
+		if (f->mFriendList != this) continue;
+		LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_created, f->toC());
+	}
+}
+
 void FriendList::carddavRemoved(const std::shared_ptr<Friend> &f) {
 	removeFriend(f, false);
 	LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_deleted, f->toC());
 }
 
-void FriendList::carddavUpdated(const std::shared_ptr<Friend> &newFriend, const std::shared_ptr<Friend> &oldFriend) {
-	auto it = std::find_if(mFriendsList.mList.begin(), mFriendsList.mList.end(),
-	                       [&](const auto &elem) { return elem == oldFriend; });
-	if (it != mFriendsList.mList.end()) *it = newFriend;
-	newFriend->saveInDb();
-	LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_updated, newFriend->toC(),
-	                                  oldFriend->toC());
-}
-
 #endif /* VCARD_ENABLED */
 
 // -----------------------------------------------------------------------------
@@ -21,17 +21,21 @@
 #ifndef _L_FRIEND_LIST_H_
 #define _L_FRIEND_LIST_H_
 
+#include <unordered_map>
+
 #include "belle-sip/object++.hh"
 
 #include "c-wrapper/c-wrapper.h"
 #include "core/core-accessor.h"
 #include "private_functions.h"
+#include "search/friend-search-index.h"
 
 // =============================================================================
 
 LINPHONE_BEGIN_NAMESPACE
 
 class Account;
+class AccountParams;
 #if VCARD_ENABLED
 class CardDAVContext;
 #endif
@@ -107,6 +111,7 @@ public:
 	LinphoneFriendListType getType() const;
 	const std::string &getUri() const;
 	const std::list<std::shared_ptr<Friend>> &getDirtyFriendsToUpdate() const;
+	const FriendSearchIndex &getSearchIndex() const;
 	bool isSubscriptionBodyless() const;
 
 	// Other
@@ -124,17 +129,23 @@ public:
 	std::list<std::shared_ptr<Friend>> findFriendsByUri(const std::string &uri) const;
 	LinphoneStatus importFriendsFromVcard4Buffer(const std::string &vcardBuffer);
 	LinphoneStatus importFriendsFromVcard4File(const std::string &vcardFile);
+	void invalidateSearchIndex();
 	void notifyPresence(const std::shared_ptr<PresenceModel> &model) const;
 	LinphoneFriendListStatus removeFriend(const std::shared_ptr<Friend> &lf);
 	void removeFriends();
+	void removePhoneNumberIndex(const std::shared_ptr<const Account> &account);
 	bool subscriptionsEnabled() const;
 	void synchronizeFriendsFromServer();
 	void updateDirtyFriends();
 	void updateRevision(const std::string &revision);
+	void updateSyncToken(const std::string &syncToken);
 
 	const std::string &getRevision() const {
 		return mRevision;
 	}
+	const std::string &getSyncToken() const {
+		return mSyncToken;
+	}
 
 private:
 	LinphoneFriendListStatus addFriend(const std::shared_ptr<Friend> &lf, bool synchronize);
@@ -145,18 +156,21 @@ private:
 	std::shared_ptr<Friend> findFriendByPhoneNumber(const std::shared_ptr<Account> &account,
 	                                                const std::string &normalizedPhoneNumber) const;
 	std::shared_ptr<Address> getRlsAddressWithCoreFallback() const;
+	const std::unordered_map<std::string, std::shared_ptr<Friend>> &
+	getPhoneNumberIndex(const std::shared_ptr<Account> &account) const;
 	bool hasSubscribeInactive() const;
 	LinphoneFriendListStatus importFriend(const std::shared_ptr<Friend> &lf, bool synchronize);
 	LinphoneStatus importFriendsFromVcard4(const std::list<std::shared_ptr<Vcard>> &vcards);
 	void invalidateFriendsMaps();
 	void invalidateSubscriptions();
 	void notifyPresenceReceived(const std::shared_ptr<const Content> &content);
-	void parseMultipartRelatedBody(const std::shared_ptr<const Content> &content, const std::string &firstPartBody);
+	void parseMultipartRelatedBody(const bctbx_list_t *parts);
 	void deleteFriend(const std::shared_ptr<Friend> &lf, bool removeFromServer);
 	LinphoneFriendListStatus removeFriend(const std::shared_ptr<Friend> &lf, bool removeFromServer);
 	void removeFriends(bool removeFromServer);
 	void removeFromDb();
 	void saveInDb();
+	void saveFriendsInDb(const std::list<std::shared_ptr<Friend>> &friends);
 	void sendListSubscription();
 	void sendListSubscriptionWithBody(const std::shared_ptr<Address> &address);
 	void sendListSubscriptionWithoutBody(const std::shared_ptr<Address> &address);
@@ -168,10 +182,10 @@ private:
 	subscriptionStateChanged(LinphoneCore *lc, const std::shared_ptr<Event> event, LinphoneSubscriptionState state);
 #ifdef VCARD_ENABLED
 	void createCardDavContextIfNotDoneYet();
-	void carddavCreated(const std::shared_ptr<Friend> &f);
 	void carddavDone(bool success, const std::string &msg);
+	void carddavPulled(const std::list<std::shared_ptr<Friend>> &createdFriends,
+	                   const std::list<std::pair<std::shared_ptr<Friend>, std::shared_ptr<Friend>>> &updatedFriends);
 	void carddavRemoved(const std::shared_ptr<Friend> &f);
-	void carddavUpdated(const std::shared_ptr<Friend> &newFriend, const std::shared_ptr<Friend> &oldFriend);
 #endif
 
 	std::shared_ptr<Event> mEvent;
@@ -181,6 +195,16 @@ private:
 	mutable ListHolder<Friend> mFriendsList;
 	std::map<std::string, std::shared_ptr<Friend>> mFriendsMapByRefKey;
 	std::multimap<std::string, std::shared_ptr<Friend>> mFriendsMapByUri;
+	mutable std::unique_ptr<FriendSearchIndex> mSearchIndex; // Built on demand by MagicSearch.
+	// Friends by phone number normalized with the dial plan of an account, built on demand for each account.
+	// The account is kept to tell it from a later account allocated at the same address once it has been freed.
+	struct PhoneNumberIndex {
+		std::weak_ptr<const Account> account;
+		std::weak_ptr<const AccountParams> accountParams;
+		std::unordered_map<std::string, std::shared_ptr<Friend>> friends;
+		bool built = false;
+	};
+	mutable std::unordered_map<const Account *, PhoneNumberIndex> mPhoneNumberIndexes;
 	std::array<unsigned char, 16> *mContentDigest = nullptr;
 	int mExpectedNotificationVersion;
 	long long mStorageId = -1;
@@ -188,6 +212,7 @@ private:
 	std::list<std::shared_ptr<Friend>> mDirtyFriendsToUpdate;
 	bctbx_list_t *mBctbxDirtyFriendsToUpdate = nullptr; // This field must be kept in sync with mDirtyFriendsToUpdate
 	std::string mRevision = "";
+	std::string mSyncToken = ""; // RFC 6578 sync token of the CardDAV address book
 	bool mSubscriptionsEnabled = false;
 	bool mBodylessSubscription = false;
 	LinphoneFriendListType mType = LinphoneFriendListTypeDefault;
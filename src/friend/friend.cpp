@@ -117,6 +117,7 @@ LinphoneStatus Friend::setAddress(const std::shared_ptr<const Address> &address)
 	} else {
 		mUri = newAddress;
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 
 	return 0;
 }
@@ -147,6 +148,7 @@ LinphoneStatus Friend::setName(const std::string &name) {
 		}
 		mUri->setDisplayName(name);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 	return 0;
 }
 
@@ -157,6 +159,7 @@ void Friend::setNativeUri(const std::string &nativeUri) {
 void Friend::setOrganization(const std::string &organization) {
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->setOrganization(organization);
+		if (mFriendList) mFriendList->invalidateSearchIndex();
 	}
 }
 
@@ -201,7 +204,10 @@ void Friend::setVcard(const std::shared_ptr<Vcard> &vcard) {
 
 	mVcard = vcard;
 	mRefKey = vcard->getUid();
-	if (mFriendList) saveInDb();
+	if (mFriendList) {
+		mFriendList->invalidateSearchIndex();
+		saveInDb();
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -544,6 +550,7 @@ void Friend::addAddress(const std::shared_ptr<const Address> &address) {
 	} else if (!mUri) {
 		mUri = newAddr;
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 void Friend::addPhoneNumber(const std::string &phoneNumber) {
@@ -565,6 +572,7 @@ void Friend::addPhoneNumber(const std::string &phoneNumber) {
 		if (!mVcard) createVcard(phoneNumber);
 		if (mVcard) mVcard->addPhoneNumber(phoneNumber);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 void Friend::addPhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumber> &phoneNumber) {
@@ -587,6 +595,7 @@ void Friend::addPhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumb
 		if (!mVcard) createVcard(phone);
 		if (mVcard) mVcard->addPhoneNumberWithLabel(phoneNumber);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 bool Friend::createVcard(const std::string &name) {
@@ -627,7 +636,10 @@ void Friend::done() {
 		}
 	}
 	apply();
-	if (mFriendList) saveInDb();
+	if (mFriendList) {
+		mFriendList->invalidateSearchIndex();
+		saveInDb();
+	}
 }
 
 void Friend::edit() {
@@ -714,6 +726,10 @@ FriendList *Friend::getFriendList() const {
 	return mFriendList;
 }
 
+bool Friend::hasPresenceModels() const {
+	return !mPresenceModels.empty();
+}
+
 bool Friend::isPresenceReceived() const {
 	return mPresenceReceived;
 }
@@ -742,6 +758,7 @@ void Friend::removeAddress(const std::shared_ptr<const Address> &address) {
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removeSipAddress(uri);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 void Friend::removePhoneNumber(const std::string &phoneNumber) {
@@ -751,6 +768,7 @@ void Friend::removePhoneNumber(const std::string &phoneNumber) {
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removePhoneNumber(phoneNumber);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 void Friend::removePhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumber> &phoneNumber) {
@@ -763,6 +781,7 @@ void Friend::removePhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneN
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removePhoneNumberWithLabel(phoneNumber);
 	}
+	if (mFriendList) mFriendList->invalidateSearchIndex();
 }
 
 bool Friend::subscribesEnabled() const {
@@ -982,7 +1001,17 @@ const std::string &Friend::phoneNumberToSipUri(const std::string &phoneNumber) c
 	return pair.first->second;
 }
 
-void Friend::presenceReceived(const std::shared_ptr<FriendList> list,
+void Friend::notifyPresenceReceived() {
+	LINPHONE_HYBRID_OBJECT_INVOKE_CBS_NO_ARG(Friend, this, linphone_friend_cbs_get_presence_received);
+	linphone_core_notify_notify_presence_received(getCore()->getCCore(), toC()); // Deprecated
+}
+
+/*
+ * Store the presence model received for one of the URIs or phone numbers of the friend. The friend presence_received
+ * callbacks are not invoked here but by notifyPresenceReceived(), so that a NOTIFY carrying several presence documents
+ * for the same friend notifies it once.
+ */
+bool Friend::presenceReceived(const std::shared_ptr<FriendList> list,
                               const std::string &uri,
                               const std::shared_ptr<PresenceModel> &model) {
 	mPresenceReceived = true;
@@ -997,7 +1026,7 @@ void Friend::presenceReceived(const std::shared_ptr<FriendList> list,
 		const std::shared_ptr<Address> sipAddress = getCore()->interpretUrl(presenceUri, false);
 		if (!sipAddress) {
 			lError() << "Failed to parse [" << presenceUri << "] received by presence as Address!";
-			return;
+			return false;
 		}
 		sipAddress->clean(); // To get rid of ;user=phone at the end
 
@@ -1019,9 +1048,7 @@ void Friend::presenceReceived(const std::shared_ptr<FriendList> list,
 		linphone_core_notify_notify_presence_received_for_uri_or_tel(getCore()->getCCore(), toC(), phoneNumber.c_str(),
 		                                                             model->toC());
 	}
-
-	LINPHONE_HYBRID_OBJECT_INVOKE_CBS_NO_ARG(Friend, this, linphone_friend_cbs_get_presence_received);
-	linphone_core_notify_notify_presence_received(getCore()->getCCore(), toC()); // Deprecated
+	return true;
 }
 
 void Friend::releaseOps() {
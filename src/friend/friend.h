@@ -149,6 +149,7 @@ public:
 	bool hasCapabilityWithVersion(const LinphoneFriendCapability capability, float version) const;
 	bool hasCapabilityWithVersionOrMore(const LinphoneFriendCapability capability, float version) const;
 	bool hasPhoneNumber(const std::string &searchedPhoneNumber) const;
+	bool hasPresenceModels() const;
 	bool inList() const;
 	FriendList *getFriendList() const;
 	bool isPresenceReceived() const;
@@ -171,8 +172,9 @@ private:
 	bool hasPhoneNumber(const std::shared_ptr<Account> &account, const std::string &searchedPhoneNumber) const;
 	void invalidateSubscription();
 	void notify(const std::shared_ptr<PresenceModel> &presence);
+	void notifyPresenceReceived();
 	const std::string &phoneNumberToSipUri(const std::string &phoneNumber) const;
-	void presenceReceived(const std::shared_ptr<FriendList> list,
+	bool presenceReceived(const std::shared_ptr<FriendList> list,
 	                      const std::string &uri,
 	                      const std::shared_ptr<PresenceModel> &model);
 	void releaseOps();
@@ -27,9 +27,9 @@ std::unique_ptr<Json::CharReader> JsonDocument::sReader;
 
 JsonDocument::JsonDocument(const Content &content) {
 	Json::String err;
-	std::string body = content.getBodyAsUtf8String();
+	std::string_view body = content.getBodyView();
 
-	if (!getReader().parse(body.c_str(), body.c_str() + body.size(), &mValue, &err)) {
+	if (!getReader().parse(body.data(), body.data() + body.size(), &mValue, &err)) {
 		lError() << "JsonDocument parse error: " << err;
 	}
 }
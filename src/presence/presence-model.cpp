@@ -30,7 +30,7 @@
 #include "presence-person.h"
 #include "presence-service.h"
 #ifdef HAVE_XML2
-#include "xml/xml-parsing-context.h"
+#include "xml/xml-reader.h"
 #endif // HAVE_XML2
 
 #include "private.h" // TODO: To remove if possible
@@ -335,115 +335,95 @@ bool PresenceModel::isOnline() const {
 
 #ifdef HAVE_XML2
 
-int PresenceModel::parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext) {
-	std::stringstream ss;
-	xmlXPathObjectPtr noteObject = xmlContext.getXpathObjectForNodeList("/pidf:presence/pidf:note");
-	if (noteObject && noteObject->nodesetval) {
-		for (int i = 1; i <= noteObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()), ss << "/pidf:presence/pidf:note[" << i << "]";
-			std::string noteStr = xmlContext.getTextContent(ss.str());
-			if (noteStr.empty()) continue;
-			ss.clear(), ss.str(std::string()), ss << "/pidf:presence/pidf:note[" << i << "]/@xml:lang";
-			std::string lang = xmlContext.getTextContent(ss.str());
-			std::shared_ptr<PresenceNote> note = PresenceNote::create(noteStr, lang);
-			mNotes.push_back(note);
+int PresenceModel::parsePidfXmlPresencePerson(XmlReader &reader, time_t &timestamp) {
+	std::string personIdStr = reader.getAttribute("id");
+	std::string personTimestampStr;
+	std::vector<std::shared_ptr<PresenceNote>> notes;
+	std::shared_ptr<PresencePerson> person = PresencePerson::create(personIdStr, timestamp);
+	int depth = reader.getDepth();
+	while (reader.readChildElement(depth)) {
+		if (reader.isElement(dmNs, "timestamp")) {
+			if (personTimestampStr.empty()) personTimestampStr = reader.getTextContent();
+		} else if (reader.isElement(rpidNs, "activities")) {
+			int err = person->parsePidfXmlPresenceActivities(reader);
+			if (err < 0) return err;
+		} else if (reader.isElement(dmNs, "note")) {
+			std::shared_ptr<PresenceNote> note = parsePidfXmlNote(reader);
+			if (note) notes.push_back(note);
 		}
 	}
-	if (noteObject) xmlXPathFreeObject(noteObject);
-	return 0;
-}
-
-int PresenceModel::parsePidfXmlPresencePersons(XmlParsingContext &xmlContext) {
-	stringstream ss;
-	time_t timestamp = static_cast<time_t>(-1);
-	int err = 0;
-	xmlXPathObjectPtr personObject = xmlContext.getXpathObjectForNodeList(PresencePerson::pidfXmlPrefix.data());
-	if (personObject && personObject->nodesetval) {
-		for (int i = 1; i <= personObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()), ss << PresencePerson::pidfXmlPrefix.data() << "[" << i << "]/@id";
-			std::string personIdStr = xmlContext.getTextContent(ss.str());
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << i << "]/dm:timestamp";
-			std::string personTimestampStr = xmlContext.getTextContent(ss.str());
-			if (!personTimestampStr.empty()) timestamp = PresenceModel::parseTimestamp(personTimestampStr);
-			std::shared_ptr<PresencePerson> person = PresencePerson::create(personIdStr, timestamp);
-			err = person->parsePidfXmlPresenceActivities(xmlContext, (unsigned int)i);
-			if (err == 0) err = person->parsePidfXmlPresenceNotes(xmlContext, (unsigned int)i);
-			if (err == 0) addPerson(person);
-			if (err != 0) break;
-		}
+	/* The timestamp of a person applies to the following ones that do not have their own. */
+	if (!personTimestampStr.empty()) {
+		timestamp = PresenceModel::parseTimestamp(personTimestampStr);
+		person->mTimestamp = timestamp;
 	}
-	if (personObject) xmlXPathFreeObject(personObject);
-	if (err < 0) {
-		/* Remove all the persons added since there was an error. */
-		clearPersons();
-	}
-	return err;
+	for (const auto &note : notes)
+		person->addNote(note);
+	addPerson(person);
+	return 0;
 }
 
-int PresenceModel::parsePidfXmlPresenceServices(XmlParsingContext &xmlContext) {
-	stringstream ss;
+int PresenceModel::parsePidfXmlPresenceService(XmlReader &reader) {
 	LinphonePresenceBasicStatus basicStatus;
-
-	xmlXPathObjectPtr serviceObject = xmlContext.getXpathObjectForNodeList(PresenceService::pidfXmlPrefix.data());
-	if (serviceObject && serviceObject->nodesetval) {
-		for (int i = 1; i <= serviceObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/pidf:status/pidf:basic";
-			std::string basicStatusStr = xmlContext.getTextContent(ss.str());
-			if (basicStatusStr.empty()) continue;
-			if (basicStatusStr == "open") basicStatus = LinphonePresenceBasicStatusOpen;
-			else if (basicStatusStr == "closed") basicStatus = LinphonePresenceBasicStatusClosed;
-			else return -1; /* Invalid value for basic status. */
-
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/pidf:status/pidfonline:online";
-			xmlXPathObjectPtr pidfonlineObject = xmlContext.getXpathObjectForNodeList(ss.str());
-			if (pidfonlineObject) {
-				if (pidfonlineObject->nodesetval && pidfonlineObject->nodesetval->nodeNr > 0) mIsOnline = true;
-				xmlXPathFreeObject(pidfonlineObject);
+	std::string serviceIdStr = reader.getAttribute("id");
+	std::string basicStatusStr;
+	std::string timestampStr;
+	std::string contactStr;
+	bool online = false;
+	std::list<std::pair<std::string, std::string>> capabilities;
+	std::vector<std::shared_ptr<PresenceNote>> notes;
+
+	int depth = reader.getDepth();
+	while (reader.readChildElement(depth)) {
+		if (reader.isElement(pidfNs, "status")) {
+			int statusDepth = reader.getDepth();
+			while (reader.readChildElement(statusDepth)) {
+				if (reader.isElement(pidfNs, "basic")) {
+					if (basicStatusStr.empty()) basicStatusStr = reader.getTextContent();
+				} else if (reader.isElement(pidfonlineNs, "online")) {
+					online = true;
+				}
 			}
-
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/pidf:timestamp";
-			std::string timestampStr = xmlContext.getTextContent(ss.str());
-
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/pidf:contact";
-			std::string contactStr = xmlContext.getTextContent(ss.str());
-
-			ss.clear(), ss.str(std::string()), ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/@id";
-			std::string serviceIdStr = xmlContext.getTextContent(ss.str());
-			std::shared_ptr<PresenceService> service = PresenceService::create(serviceIdStr, basicStatus);
-
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << i << "]/oma-pres:service-description";
-			xmlXPathObjectPtr descriptionsObject = xmlContext.getXpathObjectForNodeList(ss.str());
-			std::list<std::string> descriptions;
-			if (descriptionsObject) {
-				if (descriptionsObject->nodesetval) {
-					for (int j = 1; j <= descriptionsObject->nodesetval->nodeNr; j++) {
-						xmlContext.setXpathContextNode(xmlXPathNodeSetItem(descriptionsObject->nodesetval, j - 1));
-						std::string serviceId = xmlContext.getTextContent("./oma-pres:service-id");
-						if (!serviceId.empty()) {
-							std::string version = xmlContext.getTextContent("./oma-pres:version");
-							descriptions.push_back(serviceId);
-							service->addCapability(serviceId, version);
-						}
-					}
+		} else if (reader.isElement(pidfNs, "timestamp")) {
+			if (timestampStr.empty()) timestampStr = reader.getTextContent();
+		} else if (reader.isElement(pidfNs, "contact")) {
+			if (contactStr.empty()) contactStr = reader.getTextContent();
+		} else if (reader.isElement(omaPresNs, "service-description")) {
+			std::string serviceId;
+			std::string version;
+			int descriptionDepth = reader.getDepth();
+			while (reader.readChildElement(descriptionDepth)) {
+				if (reader.isElement(omaPresNs, "service-id")) {
+					if (serviceId.empty()) serviceId = reader.getTextContent();
+				} else if (reader.isElement(omaPresNs, "version")) {
+					if (version.empty()) version = reader.getTextContent();
 				}
-				xmlXPathFreeObject(descriptionsObject);
 			}
-
-			if (!timestampStr.empty()) service->setTimestamp(PresenceModel::parseTimestamp(timestampStr));
-			if (!contactStr.empty()) service->setContact(contactStr);
-			if (!descriptions.empty()) service->setDescriptions(descriptions);
-			service->parsePidfXmlPresenceNotes(xmlContext, (unsigned int)i);
-			addService(service);
+			if (!serviceId.empty()) capabilities.emplace_back(serviceId, version);
+		} else if (reader.isElement(pidfNs, "note")) {
+			std::shared_ptr<PresenceNote> note = parsePidfXmlNote(reader);
+			if (note) notes.push_back(note);
 		}
 	}
-	if (serviceObject) xmlXPathFreeObject(serviceObject);
 
+	if (basicStatusStr.empty()) return 0;
+	if (basicStatusStr == "open") basicStatus = LinphonePresenceBasicStatusOpen;
+	else if (basicStatusStr == "closed") basicStatus = LinphonePresenceBasicStatusClosed;
+	else return -1; /* Invalid value for basic status. */
+	if (online) mIsOnline = true;
+
+	std::shared_ptr<PresenceService> service = PresenceService::create(serviceIdStr, basicStatus);
+	std::list<std::string> descriptions;
+	for (const auto &capability : capabilities) {
+		descriptions.push_back(capability.first);
+		service->addCapability(capability.first, capability.second);
+	}
+	if (!timestampStr.empty()) service->setTimestamp(PresenceModel::parseTimestamp(timestampStr));
+	if (!contactStr.empty()) service->setContact(contactStr);
+	if (!descriptions.empty()) service->setDescriptions(descriptions);
+	for (const auto &note : notes)
+		service->addNote(note);
+	addService(service);
 	return 0;
 }
 
@@ -604,7 +584,7 @@ std::string PresenceModel::generatePresenceId() {
 
 void PresenceModel::parsePresence(const std::string &contentType,
                                   const std::string &contentSubtype,
-                                  const std::string &body,
+                                  std::string_view body,
                                   SalPresenceModel **result) {
 	if (contentType != "application") {
 		*result = nullptr;
@@ -617,42 +597,48 @@ void PresenceModel::parsePresence(const std::string &contentType,
 		return;
 	}
 
-	std::shared_ptr<PresenceModel> model = nullptr;
-	XmlParsingContext xmlContext = XmlParsingContext(body);
-	if (xmlContext.isValid()) model = PresenceModel::parsePidfXmlPresence(xmlContext);
-	else ms_warning("Wrongly formatted presence XML: %s", xmlContext.getError().c_str());
+	XmlReader reader(body);
+	std::shared_ptr<PresenceModel> model = PresenceModel::parsePidfXmlPresence(reader);
+	if (reader.hasError()) {
+		ms_warning("Wrongly formatted presence XML: %s", reader.getError().c_str());
+		model = nullptr;
+	}
 
 	*result = (SalPresenceModel *)(model ? linphone_presence_model_ref(model->toC()) : nullptr);
 }
 
-std::shared_ptr<PresenceModel> PresenceModel::parsePidfXmlPresence(XmlParsingContext &xmlContext) {
-	int err;
-
-	if (xmlContext.createXpathContext() < 0) return nullptr;
+std::shared_ptr<PresenceModel> PresenceModel::parsePidfXmlPresence(XmlReader &reader) {
+	if (!reader.readRootElement()) return nullptr;
 
 	std::shared_ptr<PresenceModel> model = PresenceModel::create();
-	xmlXPathRegisterNs(xmlContext.getXpathContext(), reinterpret_cast<const xmlChar *>("pidf"),
-	                   reinterpret_cast<const xmlChar *>("urn:ietf:params:xml:ns:pidf"));
-	xmlXPathRegisterNs(xmlContext.getXpathContext(), reinterpret_cast<const xmlChar *>("dm"),
-	                   reinterpret_cast<const xmlChar *>("urn:ietf:params:xml:ns:pidf:data-model"));
-	xmlXPathRegisterNs(xmlContext.getXpathContext(), reinterpret_cast<const xmlChar *>("rpid"),
-	                   reinterpret_cast<const xmlChar *>("urn:ietf:params:xml:ns:pidf:rpid"));
-	xmlXPathRegisterNs(xmlContext.getXpathContext(), reinterpret_cast<const xmlChar *>("pidfonline"),
-	                   reinterpret_cast<const xmlChar *>("http://www.linphone.org/xsds/pidfonline.xsd"));
-	xmlXPathRegisterNs(xmlContext.getXpathContext(), reinterpret_cast<const xmlChar *>("oma-pres"),
-	                   reinterpret_cast<const xmlChar *>("urn:oma:xml:prs:pidf:oma-pres"));
-	err = model->parsePidfXmlPresenceServices(xmlContext);
-	if (err == 0) {
-		err = model->parsePidfXmlPresencePersons(xmlContext);
-	}
-	if (err == 0) {
-		err = model->parsePidfXmlPresenceNotes(xmlContext);
+	if (!reader.isElement(pidfNs, "presence")) return model;
+
+	/* Services, persons and notes are read in a single pass over the document. */
+	time_t personTimestamp = static_cast<time_t>(-1);
+	int err = 0;
+	int depth = reader.getDepth();
+	while ((err == 0) && reader.readChildElement(depth)) {
+		if (reader.isElement(pidfNs, "tuple")) {
+			err = model->parsePidfXmlPresenceService(reader);
+		} else if (reader.isElement(dmNs, "person")) {
+			err = model->parsePidfXmlPresencePerson(reader, personTimestamp);
+		} else if (reader.isElement(pidfNs, "note")) {
+			std::shared_ptr<PresenceNote> note = parsePidfXmlNote(reader);
+			if (note) model->mNotes.push_back(note);
+		}
 	}
 
 	if (err < 0) model = nullptr;
 	return model;
 }
 
+std::shared_ptr<PresenceNote> PresenceModel::parsePidfXmlNote(XmlReader &reader) {
+	std::string lang = reader.getAttribute("xml:lang");
+	std::string noteStr = reader.getTextContent();
+	if (noteStr.empty()) return nullptr;
+	return PresenceNote::create(noteStr, lang);
+}
+
 time_t PresenceModel::parseTimestamp(const std::string &timestamp) {
 	struct tm ret;
 	time_t seconds;
@@ -685,7 +671,7 @@ time_t PresenceModel::parseTimestamp(const std::string &timestamp) {
 
 void PresenceModel::parsePresence(BCTBX_UNUSED(const std::string &contentType),
                                   BCTBX_UNUSED(const std::string &contentSubtype),
-                                  BCTBX_UNUSED(const std::string &body),
+                                  BCTBX_UNUSED(std::string_view body),
                                   SalPresenceModel **result) {
 	if (result) *result = nullptr;
 	ms_warning("PresenceModel::parsePresence(): stubbed.");
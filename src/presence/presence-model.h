@@ -21,6 +21,8 @@
 #ifndef _L_PRESENCE_MODEL_H_
 #define _L_PRESENCE_MODEL_H_
 
+#include <string_view>
+
 #ifdef HAVE_XML2
 #include <libxml/xmlwriter.h>
 #endif // HAVE_XML2
@@ -38,7 +40,7 @@ class PresenceNote;
 class PresencePerson;
 class PresenceService;
 #ifdef HAVE_XML2
-class XmlParsingContext;
+class XmlReader;
 #endif /* HAVE_XML2 */
 
 /**
@@ -110,9 +112,9 @@ public:
 	bool isOnline() const;
 
 #ifdef HAVE_XML2
-	int parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext);
-	int parsePidfXmlPresencePersons(XmlParsingContext &xmlContext);
-	int parsePidfXmlPresenceServices(XmlParsingContext &xmlContext);
+	// Parse the element the reader is on, and its children.
+	int parsePidfXmlPresencePerson(XmlReader &reader, time_t &timestamp);
+	int parsePidfXmlPresenceService(XmlReader &reader);
 #endif /* HAVE_XML2 */
 
 private:
@@ -122,13 +124,20 @@ private:
 	static std::string generatePresenceId();
 	static void parsePresence(const std::string &contentType,
 	                          const std::string &contentSubtype,
-	                          const std::string &body,
+	                          std::string_view body,
 	                          SalPresenceModel **result);
 	static time_t parseTimestamp(const std::string &timestamp);
 
 #ifdef HAVE_XML2
-	static std::shared_ptr<PresenceModel> parsePidfXmlPresence(XmlParsingContext &xmlContext);
+	static std::shared_ptr<PresenceModel> parsePidfXmlPresence(XmlReader &reader);
+	static std::shared_ptr<PresenceNote> parsePidfXmlNote(XmlReader &reader);
 	static int timestampToXml(xmlTextWriterPtr writer, time_t timestamp, const std::string &ns);
+
+	static constexpr const char *pidfNs = "urn:ietf:params:xml:ns:pidf";
+	static constexpr const char *dmNs = "urn:ietf:params:xml:ns:pidf:data-model";
+	static constexpr const char *rpidNs = "urn:ietf:params:xml:ns:pidf:rpid";
+	static constexpr const char *pidfonlineNs = "http://www.linphone.org/xsds/pidfonline.xsd";
+	static constexpr const char *omaPresNs = "urn:oma:xml:prs:pidf:oma-pres";
 #endif /* HAVE_XML2 */
 
 	bool mIsOnline;
@@ -18,6 +18,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include <bctoolbox/defs.h>
 
 #include "presence-person.h"
@@ -26,7 +28,7 @@
 #include "presence/presence-model.h"
 #include "presence/presence-note.h"
 #ifdef HAVE_XML2
-#include "xml/xml-parsing-context.h"
+#include "xml/xml-reader.h"
 #endif // HAVE_XML2
 
 // =============================================================================
@@ -145,81 +147,24 @@ bool PresencePerson::hasNotes() const {
 // -----------------------------------------------------------------------------
 
 #ifdef HAVE_XML2
-int PresencePerson::parsePidfXmlPresenceActivities(XmlParsingContext &xmlContext, unsigned int personIdx) {
-	stringstream ss;
-	int err = 0;
-	ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/rpid:activities";
-	xmlXPathObjectPtr activitiesNodesObject = xmlContext.getXpathObjectForNodeList(ss.str());
-	if (activitiesNodesObject && activitiesNodesObject->nodesetval) {
-		for (int i = 1; i <= activitiesNodesObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/rpid:activities[" << i
-			       << "]/rpid:*";
-			xmlXPathObjectPtr activitiesObject = xmlContext.getXpathObjectForNodeList(ss.str());
-			if (activitiesObject && activitiesObject->nodesetval) {
-				for (int j = 0; j < activitiesObject->nodesetval->nodeNr; j++) {
-					xmlNodePtr activityNode = activitiesObject->nodesetval->nodeTab[j];
-					if (activityNode->name && PresenceActivity::isValidActivityName((const char *)activityNode->name)) {
-						LinphonePresenceActivityType activityType;
-						char *description = (char *)xmlNodeGetContent(activityNode);
-						if (description && (description[0] == '\0')) {
-							xmlFree(description);
-							description = nullptr;
-						}
-						err = PresenceActivity::activityNameToType((const char *)activityNode->name, &activityType);
-						if (err < 0) break;
-						std::shared_ptr<PresenceActivity> activity =
-						    PresenceActivity::create(activityType, L_C_TO_STRING(description));
-						addActivity(activity);
-						if (description) xmlFree(description);
-					}
-				}
-			}
-			if (activitiesObject) xmlXPathFreeObject(activitiesObject);
-			if (err < 0) break;
-		}
-	}
-	if (activitiesNodesObject) xmlXPathFreeObject(activitiesNodesObject);
-
-	return err;
-}
-
-int PresencePerson::parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext, unsigned int personIdx) {
-	stringstream ss;
-	ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/rpid:activities/rpid:note";
-	xmlXPathObjectPtr noteObject = xmlContext.getXpathObjectForNodeList(ss.str());
-	if (noteObject && noteObject->nodesetval) {
-		for (int i = 1; i <= noteObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/rpid:activities/rpid:note[" << i
-			       << "]";
-			std::string noteStr = xmlContext.getTextContent(ss.str());
-			if (noteStr.empty()) continue;
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/rpid:activities/rpid:note[" << i
-			       << "]/@xml:lang";
-			std::string lang = xmlContext.getTextContent(ss.str());
-			std::shared_ptr<PresenceNote> note = PresenceNote::create(noteStr, lang);
-			addActivitiesNote(note);
-		}
-	}
-	if (noteObject) xmlXPathFreeObject(noteObject);
-	ss.clear(), ss.str(std::string()), ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/dm:note";
-	noteObject = xmlContext.getXpathObjectForNodeList(ss.str());
-	if (noteObject && noteObject->nodesetval) {
-		for (int i = 1; i <= noteObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/dm:note[" << i << "]";
-			std::string noteStr = xmlContext.getTextContent(ss.str());
-			if (noteStr.empty()) continue;
-			ss.clear(), ss.str(std::string()),
-			    ss << PresencePerson::pidfXmlPrefix.data() << "[" << personIdx << "]/dm:note[" << i << "]/@xml:lang";
-			std::string lang = xmlContext.getTextContent(ss.str());
-			std::shared_ptr<PresenceNote> note = PresenceNote::create(noteStr, lang);
-			addNote(note);
+int PresencePerson::parsePidfXmlPresenceActivities(XmlReader &reader) {
+	int depth = reader.getDepth();
+	while (reader.readChildElement(depth)) {
+		const char *ns = reader.getNamespace();
+		if (!ns || (strcmp(ns, PresenceModel::rpidNs) != 0)) continue;
+		const char *name = reader.getLocalName();
+		if (strcmp(name, "note") == 0) {
+			std::shared_ptr<PresenceNote> note = PresenceModel::parsePidfXmlNote(reader);
+			if (note) addActivitiesNote(note);
+		} else if (PresenceActivity::isValidActivityName(name)) {
+			LinphonePresenceActivityType activityType;
+			int err = PresenceActivity::activityNameToType(name, &activityType);
+			if (err < 0) return err;
+			std::shared_ptr<PresenceActivity> activity =
+			    PresenceActivity::create(activityType, reader.getTextContent());
+			addActivity(activity);
 		}
 	}
-	if (noteObject) xmlXPathFreeObject(noteObject);
 	return 0;
 }
 
@@ -37,7 +37,7 @@ class PresenceActivity;
 class PresenceModel;
 class PresenceNote;
 #ifdef HAVE_XML2
-class XmlParsingContext;
+class XmlReader;
 #endif /* HAVE_XML2 */
 
 class PresencePerson : public bellesip::HybridObject<LinphonePresencePerson, PresencePerson>, public UserDataAccessor {
@@ -77,11 +77,8 @@ public:
 
 private:
 #ifdef HAVE_XML2
-	int parsePidfXmlPresenceActivities(XmlParsingContext &xmlContext, unsigned int personIdx);
-	int parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext, unsigned int personIdx);
+	int parsePidfXmlPresenceActivities(XmlReader &reader);
 	int toXml(xmlTextWriterPtr writer) const;
-
-	static constexpr std::string_view pidfXmlPrefix = "/pidf:presence/dm:person";
 #endif /* HAVE_XML2 */
 
 	time_t mTimestamp;
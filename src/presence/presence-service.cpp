@@ -26,9 +26,6 @@
 #include "presence/presence-model.h"
 #include "presence/presence-note.h"
 #include "presence/presence-service.h"
-#ifdef HAVE_XML2
-#include "xml/xml-parsing-context.h"
-#endif // HAVE_XML2
 
 // =============================================================================
 
@@ -158,28 +155,6 @@ void PresenceService::setTimestamp(time_t timestamp) {
 }
 
 #ifdef HAVE_XML2
-int PresenceService::parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext, unsigned int serviceIdx) {
-	stringstream ss;
-	ss << PresenceService::pidfXmlPrefix.data() << "[" << serviceIdx << "]/pidf:note";
-	xmlXPathObjectPtr noteObject = xmlContext.getXpathObjectForNodeList(ss.str());
-	if (noteObject && noteObject->nodesetval) {
-		for (int i = 1; i <= noteObject->nodesetval->nodeNr; i++) {
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << serviceIdx << "]/pidf:note[" << i << "]";
-			std::string noteStr = xmlContext.getTextContent(ss.str());
-			if (noteStr.empty()) continue;
-			ss.clear(), ss.str(std::string()),
-			    ss << PresenceService::pidfXmlPrefix.data() << "[" << serviceIdx << "]/pidf:note[" << i
-			       << "]/@xml:lang";
-			std::string lang = xmlContext.getTextContent(ss.str());
-			std::shared_ptr<PresenceNote> note = PresenceNote::create(noteStr, lang);
-			addNote(note);
-		}
-	}
-	if (noteObject) xmlXPathFreeObject(noteObject);
-	return 0;
-}
-
 int PresenceService::toXml(xmlTextWriterPtr writer, const std::string &defaultContact, bool isOnline) const {
 	return PresenceService::toXml(this, writer, defaultContact, isOnline);
 }
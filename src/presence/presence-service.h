@@ -30,9 +30,6 @@ LINPHONE_BEGIN_NAMESPACE
 class Account;
 class PresenceModel;
 class PresenceNote;
-#ifdef HAVE_XML2
-class XmlParsingContext;
-#endif /* HAVE_XML2 */
 
 class LINPHONE_PUBLIC PresenceService : public bellesip::HybridObject<LinphonePresenceService, PresenceService>,
                                         public UserDataAccessor {
@@ -77,12 +74,9 @@ private:
 	void setTimestamp(time_t timestamp);
 
 #ifdef HAVE_XML2
-	int parsePidfXmlPresenceNotes(XmlParsingContext &xmlContext, unsigned int serviceIdx);
 	int toXml(xmlTextWriterPtr writer, const std::string &defaultContact, bool isOnline) const;
 	static int
 	toXml(const PresenceService *service, xmlTextWriterPtr writer, const std::string &defaultContact, bool isOnline);
-
-	static constexpr std::string_view pidfXmlPrefix = "/pidf:presence/pidf:tuple";
 #endif /* HAVE_XML2 */
 
 	LinphonePresenceBasicStatus mStatus;
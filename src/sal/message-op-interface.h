@@ -53,11 +53,11 @@ protected:
 			belle_sip_message_add_header(BELLE_SIP_MESSAGE(req),
 			                             BELLE_SIP_HEADER(belle_sip_header_content_length_create(0)));
 		} else {
-			std::string body = content.getBodyAsUtf8String();
+			std::string_view body = content.getBodyView();
 			size_t contentLength = body.size();
 			belle_sip_message_add_header(BELLE_SIP_MESSAGE(req),
 			                             BELLE_SIP_HEADER(belle_sip_header_content_length_create(contentLength)));
-			belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), body.c_str(), contentLength);
+			belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), body.data(), contentLength);
 		}
 	}
 };
@@ -88,4 +88,18 @@ int SalMessageOp::sendMessage(const Content &content) {
 	return sendRequest(request);
 }
 
+int SalMessageOp::sendMessage(const SalBodyHandler *bodyHandler) {
+	mDir = Dir::Outgoing;
+
+	auto request = buildRequest("MESSAGE");
+	if (!request) return -1;
+
+	time_t curtime = std::time(nullptr);
+	belle_sip_message_add_header(BELLE_SIP_MESSAGE(request),
+	                             BELLE_SIP_HEADER(belle_sip_header_date_create_from_time(&curtime)));
+	if (bodyHandler)
+		belle_sip_message_set_body_handler(BELLE_SIP_MESSAGE(request), BELLE_SIP_BODY_HANDLER(bodyHandler));
+	return sendRequest(request);
+}
+
 LINPHONE_END_NAMESPACE
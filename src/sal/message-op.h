@@ -31,6 +31,8 @@ public:
 	SalMessageOp(Sal *sal);
 
 	int sendMessage(const Content &content) override;
+	// Send a MESSAGE whose body is an already built body handler, that may be shared with other requests.
+	int sendMessage(const SalBodyHandler *bodyHandler);
 	int reply(SalReason reason) override {
 		return SalOp::replyMessage(reason);
 	}
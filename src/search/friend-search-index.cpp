@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2010-2025 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <bctoolbox/defs.h>
+
+#include "account/account.h"
+#include "address/address.h"
+#include "friend-search-index.h"
+#include "friend/friend.h"
+#include "linphone/api/c-account.h"
+#include "linphone/utils/utils.h"
+#include "logger/logger.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+// -----------------------------------------------------------------------------
+// SearchFilter.
+// -----------------------------------------------------------------------------
+
+SearchFilter::SearchFilter(const string &filter) : mFilter(Utils::stringToLower(filter)) {
+	// White spaces act as wildcards (used by LDAP), empty words are meaningless.
+	size_t start = 0;
+	while (start < mFilter.size()) {
+		size_t end = mFilter.find(' ', start);
+		if (end == string::npos) end = mFilter.size();
+		if (end > start) mWords.push_back(mFilter.substr(start, end - start));
+		start = end + 1;
+	}
+}
+
+bool SearchFilter::refines(const SearchFilter &previous) const {
+	return mFilter.compare(0, previous.mFilter.size(), previous.mFilter) == 0;
+}
+
+bool SearchFilter::matches(const string &haystack) const {
+	if (matchesAnything()) return true;
+	return matchesLowercase(Utils::stringToLower(haystack));
+}
+
+bool SearchFilter::matchesLowercase(const string &lowercaseHaystack) const {
+	// Finding each word at the first possible position after the previous one is enough to tell if the words appear
+	// in order.
+	size_t position = 0;
+	for (const auto &word : mWords) {
+		position = lowercaseHaystack.find(word, position);
+		if (position == string::npos) return false;
+		position += word.size();
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// FriendSearchIndex.
+// -----------------------------------------------------------------------------
+
+static inline uint32_t getBigram(const string &str, size_t i) {
+	return (uint32_t(uint8_t(str[i])) << 8) | uint8_t(str[i + 1]);
+}
+
+static inline uint32_t getTrigram(const string &str, size_t i) {
+	return (uint32_t(uint8_t(str[i])) << 16) | (uint32_t(uint8_t(str[i + 1])) << 8) | uint8_t(str[i + 2]);
+}
+
+FriendSearchIndex::FriendSearchIndex(const list<shared_ptr<Friend>> &friends, const shared_ptr<Account> &account) {
+	if (account) {
+		mBuiltWithAccount = true;
+		mAccountParams = account->getAccountParams();
+	}
+
+	mFriends.reserve(friends.size());
+	mKeys.reserve(friends.size());
+	vector<uint32_t> bigrams;
+	vector<uint32_t> trigrams;
+	for (const auto &lFriend : friends) {
+		uint32_t friendIndex = uint32_t(mFriends.size());
+		mFriends.push_back(lFriend);
+		mKeys.emplace_back();
+		bigrams.clear();
+		trigrams.clear();
+
+		addKey(friendIndex, lFriend->getName(), bigrams, trigrams);
+		addKey(friendIndex, lFriend->getOrganization(), bigrams, trigrams);
+		for (const auto &addr : lFriend->getAddresses()) {
+			addKey(friendIndex, addr->getUsername(), bigrams, trigrams);
+			addKey(friendIndex, addr->getDisplayName(), bigrams, trigrams);
+			addKey(friendIndex, addr->asString(), bigrams, trigrams);
+		}
+		const auto phoneNumbers = lFriend->getPhoneNumbers();
+		for (const auto &number : phoneNumbers) {
+			addKey(friendIndex, number, bigrams, trigrams);
+			if (account) {
+				char *buff = linphone_account_normalize_phone_number(account->toC(), number.c_str());
+				if (buff) {
+					if (number != buff) addKey(friendIndex, buff, bigrams, trigrams);
+					bctbx_free(buff);
+				}
+			}
+		}
+		if (!phoneNumbers.empty()) mFriendsWithPhoneNumbers.push_back(friendIndex);
+
+		// Friends are indexed in order, so postings stay sorted as long as each gram is added once per friend.
+		sort(bigrams.begin(), bigrams.end());
+		bigrams.erase(unique(bigrams.begin(), bigrams.end()), bigrams.end());
+		for (uint32_t gram : bigrams)
+			mBigrams[gram].push_back(friendIndex);
+		sort(trigrams.begin(), trigrams.end());
+		trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+		for (uint32_t gram : trigrams)
+			mTrigrams[gram].push_back(friendIndex);
+	}
+	lDebug() << "[Magic Search] Built search index of " << mFriends.size() << " friends (" << mTrigrams.size()
+	         << " trigrams)";
+}
+
+void FriendSearchIndex::addKey(uint32_t friendIndex,
+                               string key,
+                               vector<uint32_t> &bigrams,
+                               vector<uint32_t> &trigrams) {
+	if (key.empty()) return;
+	key = Utils::stringToLower(key);
+	for (size_t i = 0; i + 1 < key.size(); i++)
+		bigrams.push_back(getBigram(key, i));
+	for (size_t i = 0; i + 2 < key.size(); i++)
+		trigrams.push_back(getTrigram(key, i));
+	mKeys[friendIndex].push_back(std::move(key));
+}
+
+bool FriendSearchIndex::isUpToDate(const shared_ptr<Account> &account) const {
+	if (!account) return !mBuiltWithAccount;
+	// Account params are replaced, not modified, when the account is updated.
+	return mBuiltWithAccount && mAccountParams.lock() == account->getAccountParams();
+}
+
+void FriendSearchIndex::intersect(Posting &result, const Posting &other) {
+	Posting intersection;
+	set_intersection(result.cbegin(), result.cend(), other.cbegin(), other.cend(), back_inserter(intersection));
+	result = std::move(intersection);
+}
+
+FriendSearchIndex::Posting FriendSearchIndex::findWordCandidates(const string &word) const {
+	if (word.size() == 2) {
+		auto it = mBigrams.find(getBigram(word, 0));
+		return (it == mBigrams.cend()) ? Posting() : it->second;
+	}
+
+	Posting candidates;
+	for (size_t i = 0; i + 2 < word.size(); i++) {
+		auto it = mTrigrams.find(getTrigram(word, i));
+		if (it == mTrigrams.cend()) return Posting();
+		if (i == 0) candidates = it->second;
+		else intersect(candidates, it->second);
+		if (candidates.empty()) break;
+	}
+	return candidates;
+}
+
+bool FriendSearchIndex::matchesKeys(uint32_t friendIndex, const SearchFilter &filter) const {
+	for (const auto &key : mKeys[friendIndex]) {
+		if (filter.matchesLowercase(key)) return true;
+	}
+	return false;
+}
+
+list<shared_ptr<Friend>> FriendSearchIndex::findCandidates(const SearchFilter &filter) const {
+	list<shared_ptr<Friend>> result;
+	if (filter.matchesAnything()) {
+		mHasLastCandidates = false;
+		result.assign(mFriends.cbegin(), mFriends.cend());
+		return result;
+	}
+
+	Posting candidates;
+	bool pruned = false;
+	if (mHasLastCandidates && filter.refines(mLastFilter)) {
+		// The friends that did not match the previous filter cannot match this one.
+		candidates = mLastCandidates;
+		pruned = true;
+	} else {
+		for (const auto &word : filter.getWords()) {
+			// Single characters are too common to be worth looking up.
+			if (word.size() < 2) continue;
+			if (!pruned) {
+				candidates = findWordCandidates(word);
+				pruned = true;
+			} else {
+				intersect(candidates, findWordCandidates(word));
+			}
+			if (candidates.empty()) break;
+		}
+	}
+	if (!pruned) {
+		candidates.resize(mFriends.size());
+		for (uint32_t i = 0; i < uint32_t(mFriends.size()); i++)
+			candidates[i] = i;
+	}
+
+	Posting matching;
+	for (uint32_t friendIndex : candidates) {
+		if (matchesKeys(friendIndex, filter)) matching.push_back(friendIndex);
+	}
+	mLastFilter = filter;
+	mLastCandidates = matching;
+	mHasLastCandidates = true;
+
+	// Presence contacts change without the friend being edited, so they can't be indexed: merge friends that may
+	// match through them, keeping the list order.
+	auto matchingIt = matching.cbegin();
+	for (uint32_t friendIndex : mFriendsWithPhoneNumbers) {
+		if (!mFriends[friendIndex]->hasPresenceModels()) continue;
+		for (; matchingIt != matching.cend() && *matchingIt < friendIndex; ++matchingIt)
+			result.push_back(mFriends[*matchingIt]);
+		if (matchingIt != matching.cend() && *matchingIt == friendIndex) ++matchingIt;
+		result.push_back(mFriends[friendIndex]);
+	}
+	for (; matchingIt != matching.cend(); ++matchingIt)
+		result.push_back(mFriends[*matchingIt]);
+	return result;
+}
+
+LINPHONE_END_NAMESPACE
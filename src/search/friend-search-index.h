@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2010-2025 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_FRIEND_SEARCH_INDEX_H_
+#define _L_FRIEND_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Account;
+class AccountParams;
+class Friend;
+
+/**
+ * Compiled form of a MagicSearch filter.
+ * A string matches if all the space separated words of the filter are found in it, in the same order and ignoring
+ * ASCII case. It is equivalent to the ".*word1.*word2.*" regex MagicSearch used to build, without compiling and running
+ * a regex for every tested string.
+ */
+class SearchFilter {
+public:
+	SearchFilter() = default;
+	explicit SearchFilter(const std::string &filter);
+
+	const std::string &getFilter() const {
+		return mFilter;
+	}
+
+	const std::vector<std::string> &getWords() const {
+		return mWords;
+	}
+
+	bool matchesAnything() const {
+		return mWords.empty();
+	}
+
+	/**
+	 * @return true if every string matching this filter also matches the previous one, i.e. this filter is the previous
+	 * one with more characters typed at its end.
+	 */
+	bool refines(const SearchFilter &previous) const;
+
+	bool matches(const std::string &haystack) const;
+	bool matchesLowercase(const std::string &lowercaseHaystack) const;
+
+private:
+	std::string mFilter; // Lowercase.
+	std::vector<std::string> mWords;
+};
+
+/**
+ * Search index of the friends of a FriendList, used by MagicSearch to avoid testing every friend on each keystroke.
+ * For every friend it keeps the lowercase strings MagicSearch looks into (name, organization, SIP addresses, raw and
+ * normalized phone numbers) and bigram/trigram postings of them.
+ * The index is a snapshot: the FriendList drops it whenever a friend is added, removed or edited, and it must be
+ * rebuilt when the default account (used to normalize phone numbers) changes.
+ */
+class FriendSearchIndex {
+public:
+	FriendSearchIndex(const std::list<std::shared_ptr<Friend>> &friends, const std::shared_ptr<Account> &account);
+
+	bool isUpToDate(const std::shared_ptr<Account> &account) const;
+
+	/**
+	 * Get the friends of the list that may match a filter, in the list order.
+	 * All the friends for which MagicSearch::searchInFriend() may return results are returned. As presence contacts
+	 * are not indexed, friends having phone numbers with presence information are always part of the candidates.
+	 */
+	std::list<std::shared_ptr<Friend>> findCandidates(const SearchFilter &filter) const;
+
+	size_t size() const {
+		return mFriends.size();
+	}
+
+private:
+	using Posting = std::vector<uint32_t>;
+
+	void addKey(uint32_t friendIndex, std::string key, std::vector<uint32_t> &bigrams, std::vector<uint32_t> &trigrams);
+	Posting findWordCandidates(const std::string &word) const;
+	bool matchesKeys(uint32_t friendIndex, const SearchFilter &filter) const;
+
+	static void intersect(Posting &result, const Posting &other);
+
+	std::vector<std::shared_ptr<Friend>> mFriends;
+	std::vector<std::vector<std::string>> mKeys;
+	Posting mFriendsWithPhoneNumbers;
+	std::unordered_map<uint32_t, Posting> mBigrams;
+	std::unordered_map<uint32_t, Posting> mTrigrams;
+
+	bool mBuiltWithAccount = false;
+	std::weak_ptr<const AccountParams> mAccountParams;
+
+	// Candidates of the last search, used to narrow the next one when the filter grows.
+	mutable SearchFilter mLastFilter;
+	mutable Posting mLastCandidates;
+	mutable bool mHasLastCandidates = false;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_FRIEND_SEARCH_INDEX_H_
@@ -22,7 +22,6 @@
 
 #include <bctoolbox/defs.h>
 #include <bctoolbox/list.h>
-#include <bctoolbox/regex.h>
 
 #include "address/address.h"
 #include "c-wrapper/c-wrapper.h"
@@ -63,8 +62,6 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
-static const std::regex charactersToEscape(R"([\.\^\$\+\(\)\[\]\{\}\|\?\*])");
-
 MagicSearch::MagicSearch(const shared_ptr<Core> &core) : CoreAccessor(core) {
 }
 
@@ -185,7 +182,7 @@ void MagicSearch::getContactListFromFilterAsync(const string &filter,
                                                 LinphoneMagicSearchAggregation aggregation) {
 	lDebug() << "[Magic Search] New async search: " << filter;
 
-	setupRegex(filter);
+	setupFilter(filter);
 	if (mAsyncData.pushRequest(SearchRequest(filter, withDomain, sourceFlags, aggregation)) ==
 	    1) { // This is a new request.
 		if (mAutoResetCache || mFilter.size() > filter.size()) {
@@ -216,7 +213,7 @@ list<shared_ptr<SearchResult>> MagicSearch::getContactListFromFilter(const strin
 		resetSearchCache();
 	}
 
-	setupRegex(filter);
+	setupFilter(filter);
 	if (!getSearchCache().empty() && !filter.empty()) {
 		resultList = continueSearch(withDomain, aggregation);
 		resetSearchCache();
@@ -432,7 +429,8 @@ list<shared_ptr<SearchResult>> MagicSearch::getResultsFromFriends(bool onlyStarr
 			        << friendList->getDisplayName() << "] because it's type is set to Application Cache";
 			continue;
 		}
-		for (const auto &lFriend : friends) {
+		// Only look into the friends that may match the filter.
+		for (const auto &lFriend : friendList->getSearchIndex().findCandidates(mSearchFilter)) {
 			bool isStarred = lFriend->getStarred();
 			if (!onlyStarred || isStarred) {
 				int flags = LinphoneMagicSearchSourceFriends;
@@ -933,46 +931,14 @@ unsigned int MagicSearch::searchInAddress(const shared_ptr<const Address> &lAddr
 	return getMinWeight();
 }
 
-void MagicSearch::setupRegex(const string &filter) {
-	string lowercaseFilter = filter;
-	transform(lowercaseFilter.begin(), lowercaseFilter.end(), lowercaseFilter.begin(),
-	          [](unsigned char c) { return tolower(c); });
-
-	if (lowercaseFilter.empty()) {
-		// Match anything
-		lowercaseFilter = ".*";
-	} else {
-		lowercaseFilter = regex_replace(lowercaseFilter, charactersToEscape, "\\$&");
-		// Replace white space by wildcard (used by LDAP)
-		lowercaseFilter = Utils::replaceAll(lowercaseFilter, " ", ".*");
-		if (lowercaseFilter != ".*") {
-			lowercaseFilter = ".*" + lowercaseFilter + ".*";
-		}
-	}
-
-	// Replace any regex special character by escaped version of it, such as '+' for example
-	lDebug() << "[Magic Search] Building regex [" << lowercaseFilter << "]";
-	mFilterRegex = lowercaseFilter;
+void MagicSearch::setupFilter(const string &filter) {
+	mSearchFilter = SearchFilter(filter);
 	mFilterApplyFullSipUri =
 	    (filter.rfind("sip:", 0) == 0 || filter.rfind("sips:", 0) == 0 || filter.rfind("@") != string::npos);
 }
 
 unsigned int MagicSearch::getWeight(const string &haystack) const {
-	string lowercaseHaystack = haystack;
-
-	transform(lowercaseHaystack.begin(), lowercaseHaystack.end(), lowercaseHaystack.begin(),
-	          [](unsigned char c) { return tolower(c); });
-
-	if (bctbx_is_matching_regex_log_context(lowercaseHaystack.c_str(), mFilterRegex.c_str(), TRUE,
-#ifdef _MSC_VER
-	                                        __FUNCSIG__
-#else
-	                                        __PRETTY_FUNCTION__
-#endif
-	                                        )) {
-		return getMaxWeight();
-	}
-	return getMinWeight();
+	return mSearchFilter.matches(haystack) ? getMaxWeight() : getMinWeight();
 }
 
 bool MagicSearch::checkDomain(const shared_ptr<Friend> &lFriend,
@@ -38,6 +38,7 @@
 
 #include "core/core-accessor.h"
 #include "core/core.h"
+#include "friend-search-index.h"
 #include "magic-search-plugin.h"
 #include "search-async-data.h"
 #include "search-request.h"
@@ -380,7 +381,7 @@ public:
 	bool iterate(void);
 
 private:
-	void setupRegex(const std::string &filter);
+	void setupFilter(const std::string &filter);
 
 	int mState = 0;
 	unsigned int mMinWeight = 0;
@@ -393,7 +394,7 @@ private:
 	std::string mFilter;
 	bool mAutoResetCache = true; // When a new search start, let MagicSearch to clean its cache
 	bool returnEmptyFriends = false;
-	std::string mFilterRegex;
+	SearchFilter mSearchFilter;
 	bool mFilterApplyFullSipUri =
 	    false; // If true, searchInAddress will check the full SIP URI, otherwise only display name & username
 
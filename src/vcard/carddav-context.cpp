@@ -18,6 +18,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+
 #include "bctoolbox/defs.h"
 
 #include "carddav-context.h"
@@ -42,6 +44,12 @@ LINPHONE_BEGIN_NAMESPACE
 CardDAVContext::CardDAVContext(const shared_ptr<Core> &core) : CoreAccessor(core) {
 }
 
+// Name of a vCard in the address book, i.e. the last segment of its URL.
+static string getVcardName(const string &url) {
+	auto slashPos = url.rfind('/');
+	return url.substr((slashPos == string::npos) ? 0 : slashPos + 1);
+}
+
 // -----------------------------------------------------------------------------
 
 void CardDAVContext::deleteVcard(const shared_ptr<Friend> &f) {
@@ -144,12 +152,14 @@ void CardDAVContext::synchronize() {
 	}
 
 	mCtag = friendList->getRevision();
+	mSyncToken = friendList->getSyncToken();
+	mMoreChangesAvailable = false;
 	mSyncUri = friendList->getUri();
 
-	if (!mCtag.empty()) {
+	if (!mCtag.empty() || !mSyncToken.empty()) {
 		lInfo() << "[CardDAV] A synchronization was already made, only query server CTAG and compare it with locally "
 		           "stored CTAG ["
-		        << mCtag << "]";
+		        << mCtag << "] and sync token [" << mSyncToken << "]";
 		retrieveAddressBookCtag();
 	} else {
 		lInfo() << "[CardDAV] Address book URL isn't known yet for sure, starting discovery process";
@@ -262,7 +272,7 @@ void CardDAVContext::addressBookUrlAndCtagRetrieved(const list<CardDAVResponse>
 				friendList->updateRevision(mCtag);
 			}
 			lInfo() << "[CardDAV] Friend list sync URI & revision updated, fetching vCards";
-			fetchVcards();
+			fetchVcardsChanges(addressbook.mSyncToken);
 		} else {
 			lInfo() << "[CardDAV] No changes found on server, skipping sync";
 			serverToClientSyncDone(true, "Synchronization skipped because cTag already up to date");
@@ -272,12 +282,12 @@ void CardDAVContext::addressBookUrlAndCtagRetrieved(const list<CardDAVResponse>
 	}
 }
 
-void CardDAVContext::addressBookCtagRetrieved(string ctag) {
+void CardDAVContext::addressBookCtagRetrieved(string ctag, string syncToken) {
 	if (ctag.empty() || ctag != mCtag) {
 		lInfo() << "[CardDAV] User address book has CTAG [" << ctag << "] but our local one is [" << mCtag
 		        << "], fetching vCards";
 		mCtag = ctag;
-		fetchVcards();
+		fetchVcardsChanges(syncToken);
 	} else {
 		lInfo() << "[CardDAV] No changes found on server, skipping sync";
 		serverToClientSyncDone(true, "Synchronization skipped because cTag already up to date");
@@ -288,6 +298,31 @@ void CardDAVContext::fetchVcards() {
 	sendQuery(CardDAVQuery::createAddressbookQuery(this));
 }
 
+void CardDAVContext::fetchVcardsChanges(const string &syncToken) {
+	if (mSyncToken.empty() || syncToken.empty()) {
+		// Either the server doesn't support sync-collection or we never synchronized with it: list all the vCards.
+		mSyncToken = syncToken;
+		fetchVcards();
+	} else if (syncToken == mSyncToken) {
+		lInfo() << "[CardDAV] No changes found on server, skipping sync";
+		serverToClientSyncDone(true, "Synchronization skipped because sync token already up to date");
+	} else {
+		lInfo() << "[CardDAV] Address book sync token is [" << syncToken << "] but our local one is [" << mSyncToken
+		        << "], fetching changes";
+		string localSyncToken = mSyncToken;
+		// Should the server reject our token, all the vCards will be listed and this one will be up to date.
+		mSyncToken = syncToken;
+		sendQuery(CardDAVQuery::createSyncCollectionQuery(this, localSyncToken));
+	}
+}
+
+void CardDAVContext::fetchNextVcardsChanges() {
+	mMoreChangesAvailable = false;
+	lInfo() << "[CardDAV] Server didn't return all changes, fetching the next ones from sync token [" << mSyncToken
+	        << "]";
+	sendQuery(CardDAVQuery::createSyncCollectionQuery(this, mSyncToken));
+}
+
 void CardDAVContext::pullVcards(const list<CardDAVResponse> &list) {
 	sendQuery(CardDAVQuery::createAddressbookMultigetQuery(this, list));
 }
@@ -430,7 +465,8 @@ void CardDAVContext::processQueryResponse(shared_ptr<CardDAVQuery> query, const
 						addressBookUrlAndCtagRetrieved(parseAddressBookUrlAndCtagValueFromXmlResponse(body));
 						break;
 					case CardDAVQuery::PropfindType::AddressBookCTAG:
-						addressBookCtagRetrieved(parseAddressBookCtagValueFromXmlResponse(body));
+						addressBookCtagRetrieved(parseAddressBookCtagValueFromXmlResponse(body),
+						                         parseAddressBookSyncTokenValueFromXmlResponse(body));
 						break;
 				}
 				break;
@@ -438,6 +474,18 @@ void CardDAVContext::processQueryResponse(shared_ptr<CardDAVQuery> query, const
 			case CardDAVQuery::Type::AddressbookQueryWithFilter:
 				vcardsFetched(parseVcardsEtagsFromXmlResponse(body));
 				break;
+			case CardDAVQuery::Type::SyncCollection: {
+				string syncToken;
+				bool truncated = false;
+				list<CardDAVResponse> changes = parseVcardsChangesFromXmlResponse(body, syncToken, truncated);
+				if (syncToken.empty()) {
+					// Without the new token the changes can't be applied, or the next ones would be skipped for good.
+					lWarning() << "[CardDAV] Sync collection response has no sync token, listing all vCards";
+					fetchVcards();
+				} else {
+					vcardsChangesFetched(changes, syncToken, truncated);
+				}
+			} break;
 			case CardDAVQuery::Type::AddressbookMultiget: {
 				shared_ptr<FriendList> friendList = mFriendList.lock();
 				if (friendList) {
@@ -480,6 +528,10 @@ void CardDAVContext::processQueryResponse(shared_ptr<CardDAVQuery> query, const
 				lError() << "[CardDAV] Unknown request: " << static_cast<int>(query->mType);
 				break;
 		}
+	} else if (query->mType == CardDAVQuery::Type::SyncCollection) {
+		// Most likely 403 or 409 because the server no longer knows our sync token (RFC 6578 section 3.2).
+		lWarning() << "[CardDAV] Sync collection query HTTP result code was [" << code << "], listing all vCards";
+		fetchVcards();
 	} else {
 		if (mWellKnownQueried) {
 			stringstream ssMsg;
@@ -498,6 +550,10 @@ void CardDAVContext::serverToClientSyncDone(bool success, const string &msg) {
 	shared_ptr<FriendList> friendList = mFriendList.lock();
 	if (success) {
 		if (friendList) {
+			if (!mSyncToken.empty() && (mSyncToken != friendList->getSyncToken())) {
+				lInfo() << "[CardDAV] Sync successful, saving new sync token [" << mSyncToken << "]";
+				friendList->updateSyncToken(mSyncToken);
+			}
 			if (!mCtag.empty()) {
 				lInfo() << "[CardDAV] Sync successful, saving new cTag [" << mCtag << "]";
 				friendList->updateRevision(mCtag);
@@ -575,6 +631,52 @@ void CardDAVContext::vcardsFetched(const list<CardDAVResponse> &vCards) {
 	pullVcards(vCardsToPull);
 }
 
+void CardDAVContext::vcardsChangesFetched(const list<CardDAVResponse> &changes,
+                                          const string &syncToken,
+                                          bool truncated) {
+	shared_ptr<FriendList> friendList = mFriendList.lock();
+	if (!friendList) return;
+
+	mSyncToken = syncToken;
+	mMoreChangesAvailable = truncated;
+
+	// vCards URLs may only be known by their path on the server, so they are matched on their name.
+	unordered_map<string, shared_ptr<Friend>> friendsByVcardName;
+	for (const auto &f : friendList->getFriends()) {
+		shared_ptr<Vcard> vcard = f->getVcard();
+		if (!vcard || vcard->getUrl().empty()) continue;
+		friendsByVcardName.emplace(getVcardName(vcard->getUrl()), f);
+	}
+
+	list<CardDAVResponse> vCardsToPull;
+	list<shared_ptr<Friend>> friendsToRemove;
+	for (const auto &change : changes) {
+		const auto friendIt = friendsByVcardName.find(getVcardName(change.mUrl));
+		if (change.mDeleted) {
+			if (friendIt != friendsByVcardName.cend()) friendsToRemove.push_back(friendIt->second);
+			continue;
+		}
+		if (friendIt != friendsByVcardName.cend()) {
+			const string etag = friendIt->second->getVcard()->getEtag();
+			if (!etag.empty() && (etag == change.mEtag)) {
+				lInfo() << "[CardDAV] Contact [" << friendIt->second->getName()
+				        << "] is already up-to-date, do not ask server for it";
+				continue;
+			}
+		}
+		lInfo() << "[CardDAV] Pulling vCard [" << change.mUrl << "] with eTag [" << change.mEtag << "]";
+		vCardsToPull.push_back(change);
+	}
+	for (const auto &f : friendsToRemove) {
+		lInfo() << "[CardDAV] Contact removed [" << f->getName() << "] with eTag [" << f->getVcard()->getEtag() << "]";
+		friendList->carddavRemoved(f);
+	}
+
+	if (!vCardsToPull.empty()) pullVcards(vCardsToPull);
+	else if (mMoreChangesAvailable) fetchNextVcardsChanges();
+	else serverToClientSyncDone(true, "");
+}
+
 void CardDAVContext::magicSearchResultsVcardsPulled(const list<CardDAVResponse> &vCards) {
 	shared_ptr<CardDavMagicSearchPlugin> plugin = mCardDavMagicSearchPlugin.lock();
 	if (!plugin) return;
@@ -617,11 +719,23 @@ void CardDAVContext::vcardsPulled(const list<CardDAVResponse> &vCards) {
 	if (!friendList) return;
 
 	if (!vCards.empty()) {
+		// Index the friends by UID once instead of looking up the whole list for each downloaded vCard.
+		unordered_map<string, shared_ptr<Friend>> friendsByUid;
 		const list<shared_ptr<Friend>> &friends = friendList->getFriends();
+		friendsByUid.reserve(friends.size());
+		for (const auto &f : friends) {
+			shared_ptr<Vcard> friendVcard = f->getVcard();
+			if (!friendVcard || friendVcard->getUid().empty()) continue;
+			friendsByUid.emplace(friendVcard->getUid(), f);
+		}
+
+		list<shared_ptr<Friend>> createdFriends;
+		// A pull may contain the same new contact twice, the last vCard replaces the friend created for the first one.
+		unordered_map<string, list<shared_ptr<Friend>>::iterator> createdFriendsByUid;
+		list<pair<shared_ptr<Friend>, shared_ptr<Friend>>> updatedFriends;
+		auto vcardContext = VcardContext::getSharedFromThis(getCore()->getCCore()->vcard_context);
 		for (const auto &response : vCards) {
-			string vCardBuffer = response.mVcard;
-			shared_ptr<Vcard> vcard =
-			    VcardContext::getSharedFromThis(getCore()->getCCore()->vcard_context)->getVcardFromBuffer(vCardBuffer);
+			shared_ptr<Vcard> vcard = vcardContext->getVcardFromBuffer(response.mVcard);
 			if (vcard) {
 				// Compute downloaded vCards' URL and save it (+ eTag)
 				auto slashPos = response.mUrl.rfind('/');
@@ -640,17 +754,14 @@ void CardDAVContext::vcardsPulled(const list<CardDAVResponse> &vCards) {
 				        << vcard->getUrl() << "]";
 				shared_ptr<Friend> newFriend = Friend::create(getCore(), vcard);
 				if (newFriend) {
-					const auto friendIt = find_if(friends.cbegin(), friends.cend(), [&](const auto &oldFriend) {
-						shared_ptr<Vcard> oldFriendVcard = oldFriend->getVcard();
-						shared_ptr<Vcard> newFriendVcard = newFriend->getVcard();
-						if (!oldFriendVcard || !newFriendVcard) return false;
-						string oldFriendUid = oldFriendVcard->getUid();
-						string newFriendUid = newFriendVcard->getUid();
-						if (oldFriendUid.empty() || newFriendUid.empty()) return false;
-						return oldFriendUid == newFriendUid;
-					});
-					if (friendIt != friends.cend()) {
-						shared_ptr<Friend> oldFriend = *friendIt;
+					auto createdIt = createdFriendsByUid.find(vcard->getUid());
+					auto friendIt = friendsByUid.find(vcard->getUid());
+					if (createdIt != createdFriendsByUid.end()) {
+						lInfo() << "[CardDAV] Contact created [" << newFriend->getName() << "] again with eTag ["
+						        << newFriend->getVcard()->getEtag() << "]";
+						*createdIt->second = newFriend;
+					} else if (friendIt != friendsByUid.end()) {
+						shared_ptr<Friend> oldFriend = friendIt->second;
 						newFriend->mStorageId = oldFriend->mStorageId;
 						newFriend->setIncSubscribePolicy(oldFriend->getIncSubscribePolicy());
 						newFriend->enableSubscribes(oldFriend->subscribesEnabled());
@@ -660,11 +771,13 @@ void CardDAVContext::vcardsPulled(const list<CardDAVResponse> &vCards) {
 
 						lInfo() << "[CardDAV] Contact updated [" << newFriend->getName() << "] with eTag ["
 						        << newFriend->getVcard()->getEtag() << "]";
-						friendList->carddavUpdated(newFriend, oldFriend);
+						friendIt->second = newFriend;
+						updatedFriends.emplace_back(newFriend, oldFriend);
 					} else {
 						lInfo() << "[CardDAV] Contact created [" << newFriend->getName() << "] with eTag ["
 						        << newFriend->getVcard()->getEtag() << "]";
-						friendList->carddavCreated(newFriend);
+						createdFriendsByUid.emplace(vcard->getUid(),
+						                            createdFriends.insert(createdFriends.end(), newFriend));
 					}
 				} else {
 					lError() << "[CardDAV] Couldn't create a friend from vCard";
@@ -673,8 +786,11 @@ void CardDAVContext::vcardsPulled(const list<CardDAVResponse> &vCards) {
 				lError() << "[CardDAV] Couldn't parse vCard...";
 			}
 		}
+		// The friends are added to the list and stored in the database all at once.
+		friendList->carddavPulled(createdFriends, updatedFriends);
 	}
-	serverToClientSyncDone(true, "");
+	if (mMoreChangesAvailable) fetchNextVcardsChanges();
+	else serverToClientSyncDone(true, "");
 }
 
 // -----------------------------------------------------------------------------
@@ -735,10 +851,12 @@ list<CardDAVResponse> CardDAVContext::parseAddressBookUrlAndCtagValueFromXmlResp
 								string ctag = xmlCtx.getTextContent("d:propstat/d:prop/x1:getctag");
 								string url = xmlCtx.getTextContent("d:href");
 								string displayName = xmlCtx.getTextContent("d:propstat/d:prop/d:displayname");
+								string syncToken = xmlCtx.getTextContent("d:propstat/d:prop/d:sync-token");
 
 								CardDAVResponse response;
 								response.mDisplayName = displayName;
 								response.mCtag = ctag;
+								response.mSyncToken = syncToken;
 								response.mUrl = url;
 								result.push_back(std::move(response));
 
@@ -802,6 +920,59 @@ string CardDAVContext::parseAddressBookCtagValueFromXmlResponse(BCTBX_UNUSED(con
 	return "";
 }
 
+string CardDAVContext::parseAddressBookSyncTokenValueFromXmlResponse(const string &body) {
+	XmlParsingContext xmlCtx(body);
+	if (xmlCtx.isValid()) {
+		xmlCtx.initCarddavNs();
+		string response = xmlCtx.getTextContent("/d:multistatus/d:response/d:propstat/d:prop/d:sync-token");
+		lInfo() << "[CardDAV] Extracted sync token value from body [" << response << "]";
+		return response;
+	}
+	return "";
+}
+
+list<CardDAVResponse>
+CardDAVContext::parseVcardsChangesFromXmlResponse(const string &body, string &syncToken, bool &truncated) {
+	list<CardDAVResponse> result;
+	XmlParsingContext xmlCtx(body);
+	if (xmlCtx.isValid()) {
+		xmlCtx.initCarddavNs();
+		syncToken = xmlCtx.getTextContent("/d:multistatus/d:sync-token");
+		xmlXPathObjectPtr responses = xmlCtx.getXpathObjectForNodeList("/d:multistatus/d:response");
+		if (responses && responses->nodesetval) {
+			xmlNodeSetPtr responsesNodes = responses->nodesetval;
+			for (int i = 0; i < responsesNodes->nodeNr; i++) {
+				xmlCtx.setXpathContextNode(responsesNodes->nodeTab[i]);
+				string url = xmlCtx.getTextContent("d:href");
+				string status = xmlCtx.getTextContent("d:status");
+				if (status.find(" 507 ") != string::npos) {
+					// The response is about the address book itself: the next changes need another query.
+					lInfo() << "[CardDAV] Server didn't return all changes";
+					truncated = true;
+					continue;
+				}
+				if (url.empty() || (url.back() == '/')) continue;
+
+				CardDAVResponse response;
+				response.mUrl = url;
+				if (status.find(" 404 ") != string::npos) {
+					response.mDeleted = true;
+					lInfo() << "[CardDAV] Found removed vCard object with URL [" << url << "]";
+				} else {
+					response.mEtag = xmlCtx.getTextContent("d:propstat/d:prop/d:getetag");
+					lInfo() << "[CardDAV] Found changed vCard object with eTag [" << response.mEtag << "] and URL ["
+					        << url << "]";
+				}
+				result.push_back(std::move(response));
+			}
+			xmlXPathFreeObject(responses);
+		}
+	} else {
+		lError() << "[CardDAV] Body received for sync collection query isn't valid!";
+	}
+	return result;
+}
+
 list<CardDAVResponse> CardDAVContext::parseVcardsEtagsFromXmlResponse(const string &body) {
 	list<CardDAVResponse> result;
 	XmlParsingContext xmlCtx(body);
@@ -892,6 +1063,16 @@ string CardDAVContext::parseAddressBookCtagValueFromXmlResponse(BCTBX_UNUSED(con
 	return "";
 }
 
+string CardDAVContext::parseAddressBookSyncTokenValueFromXmlResponse(BCTBX_UNUSED(const string &body)) {
+	return "";
+}
+
+list<CardDAVResponse> CardDAVContext::parseVcardsChangesFromXmlResponse(BCTBX_UNUSED(const string &body),
+                                                                         BCTBX_UNUSED(string &syncToken),
+                                                                         BCTBX_UNUSED(bool &truncated)) {
+	return list<CardDAVResponse>();
+}
+
 list<CardDAVResponse> CardDAVContext::parseVcardsEtagsFromXmlResponse(BCTBX_UNUSED(const string &body)) {
 	return list<CardDAVResponse>();
 }
@@ -28,6 +28,8 @@
 
 // =============================================================================
 
+class CardDAVContextTester;
+
 LINPHONE_BEGIN_NAMESPACE
 
 class CardDAVQuery;
@@ -46,6 +48,7 @@ public:
 	// Friends
 	friend CardDAVQuery;
 	friend FriendList;
+	friend class ::CardDAVContextTester;
 
 	// Setters
 	void setFriendList(const std::shared_ptr<FriendList> &lf) {
@@ -65,9 +68,11 @@ private:
 	void userPrincipalUrlRetrieved(std::string principalUrl);
 	void userAddressBookHomeUrlRetrieved(std::string addressBookHomeUrl);
 	void addressBookUrlAndCtagRetrieved(const std::list<CardDAVResponse> &list);
-	void addressBookCtagRetrieved(std::string ctag);
+	void addressBookCtagRetrieved(std::string ctag, std::string syncToken);
 
 	void fetchVcards();
+	void fetchVcardsChanges(const std::string &syncToken);
+	void fetchNextVcardsChanges();
 	void pullVcards(const std::list<CardDAVResponse> &list);
 
 	void queryWellKnown(std::shared_ptr<CardDAVQuery> query);
@@ -84,18 +89,25 @@ private:
 	void vcardsFetched(const std::list<CardDAVResponse> &vCards);
 	void magicSearchResultsVcardsPulled(const std::list<CardDAVResponse> &vCards);
 	void vcardsPulled(const std::list<CardDAVResponse> &vCards);
+	void vcardsChangesFetched(const std::list<CardDAVResponse> &changes, const std::string &syncToken, bool truncated);
 
 	std::string generateUrlFromServerAddressAndUid(const std::string &serverUrl);
 	std::string parseUserPrincipalUrlValueFromXmlResponse(const std::string &body);
 	std::string parseUserAddressBookUrlValueFromXmlResponse(const std::string &body);
 	std::list<CardDAVResponse> parseAddressBookUrlAndCtagValueFromXmlResponse(const std::string &body);
 	std::string parseAddressBookCtagValueFromXmlResponse(const std::string &body);
+	std::string parseAddressBookSyncTokenValueFromXmlResponse(const std::string &body);
+	std::list<CardDAVResponse>
+	parseVcardsChangesFromXmlResponse(const std::string &body, std::string &syncToken, bool &truncated);
 	std::list<CardDAVResponse> parseVcardsEtagsFromXmlResponse(const std::string &body);
 	std::list<CardDAVResponse> parseVcardsFromXmlResponse(const std::string &body);
 
 	std::string getUrlSchemeHostAndPort() const;
 
 	std::string mCtag = "";
+	// RFC 6578 sync token of the address book, used to only fetch the vCards changed since the last synchronization.
+	std::string mSyncToken = "";
+	bool mMoreChangesAvailable = false;
 	std::string mSyncUri = "";
 	std::string mScheme = "http";
 	std::string mHost = "";
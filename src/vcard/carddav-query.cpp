@@ -32,6 +32,35 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+// Values coming from the server, such as the sync token, are opaque and may contain XML markup characters.
+static string escapeXmlText(const string &text) {
+	string escaped;
+	escaped.reserve(text.size());
+	for (char c : text) {
+		switch (c) {
+			case '&':
+				escaped += "&amp;";
+				break;
+			case '<':
+				escaped += "&lt;";
+				break;
+			case '>':
+				escaped += "&gt;";
+				break;
+			case '"':
+				escaped += "&quot;";
+				break;
+			case '\'':
+				escaped += "&apos;";
+				break;
+			default:
+				escaped += c;
+				break;
+		}
+	}
+	return escaped;
+}
+
 string CardDavPropFilter::toXmlString() const {
 	ostringstream ss;
 	ss << "<card:prop-filter name=\"" << mField << "\"><card:text-match";
@@ -64,6 +93,7 @@ bool CardDAVQuery::isClientToServerSync() const {
 		case Type::AddressbookQuery:
 		case Type::AddressbookQueryWithFilter:
 		case Type::AddressbookMultiget:
+		case Type::SyncCollection:
 			return false;
 		case Type::Put:
 		case Type::Delete:
@@ -135,6 +165,17 @@ shared_ptr<CardDAVQuery> CardDAVQuery::createAddressbookQueryWithFilter(CardDAVC
 	return query;
 }
 
+shared_ptr<CardDAVQuery> CardDAVQuery::createSyncCollectionQuery(CardDAVContext *context, const string &syncToken) {
+	shared_ptr<CardDAVQuery> query = make_shared<CardDAVQuery>(context);
+	query->mDepth = "0"; // RFC 6578: the sync-collection report is only defined for Depth 0
+	query->mBody = "<d:sync-collection xmlns:d=\"DAV:\"><d:sync-token>" + escapeXmlText(syncToken) +
+	               "</d:sync-token><d:sync-level>1</d:sync-level><d:prop><d:getetag /></d:prop></d:sync-collection>";
+	query->mMethod = "REPORT";
+	query->mUrl = context->mSyncUri;
+	query->mType = Type::SyncCollection;
+	return query;
+}
+
 shared_ptr<CardDAVQuery> CardDAVQuery::createDeleteQuery(CardDAVContext *context, const shared_ptr<Vcard> &vcard) {
 	shared_ptr<CardDAVQuery> query = make_shared<CardDAVQuery>(context);
 	query->mIfmatch = vcard->getEtag();
@@ -172,7 +213,7 @@ shared_ptr<CardDAVQuery> CardDAVQuery::createAddressBookUrlAndCtagPropfindQuery(
 	shared_ptr<CardDAVQuery> query = make_shared<CardDAVQuery>(context);
 	query->mDepth = "1"; // This PROPFIND must have Depth 1!
 	query->mBody = "<d:propfind xmlns:d=\"DAV:\" xmlns:cs=\"http://calendarserver.org/ns/\"><d:prop><d:resourcetype "
-	               "/><d:displayname /><cs:getctag /></d:prop></d:propfind>";
+	               "/><d:displayname /><cs:getctag /><d:sync-token /></d:prop></d:propfind>";
 	query->mMethod = "PROPFIND";
 	query->mUrl = context->mSyncUri;
 	query->mType = Type::Propfind;
@@ -184,7 +225,7 @@ shared_ptr<CardDAVQuery> CardDAVQuery::createAddressBookCtagPropfindQuery(CardDA
 	shared_ptr<CardDAVQuery> query = make_shared<CardDAVQuery>(context);
 	query->mDepth = "1"; // This PROPFIND must have Depth 1!
 	query->mBody = "<d:propfind xmlns:d=\"DAV:\" xmlns:cs=\"http://calendarserver.org/ns/\"><d:prop><cs:getctag "
-	               "/></d:prop></d:propfind>";
+	               "/><d:sync-token /></d:prop></d:propfind>";
 	query->mMethod = "PROPFIND";
 	query->mUrl = context->mSyncUri;
 	query->mType = Type::Propfind;
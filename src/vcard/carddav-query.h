@@ -49,7 +49,15 @@ public:
 
 class CardDAVQuery : public UserDataAccessor {
 public:
-	enum class Type { Propfind, AddressbookQuery, AddressbookQueryWithFilter, AddressbookMultiget, Put, Delete };
+	enum class Type {
+		Propfind,
+		AddressbookQuery,
+		AddressbookQueryWithFilter,
+		AddressbookMultiget,
+		SyncCollection,
+		Put,
+		Delete
+	};
 	enum class PropfindType { UserPrincipal, UserAddressBooksHome, AddressBookUrlAndCTAG, AddressBookCTAG };
 
 	CardDAVQuery(CardDAVContext *context);
@@ -70,6 +78,8 @@ public:
 	    CardDAVContext *context, const std::list<CardDavPropFilter> &propFilters, unsigned int limit);
 	static std::shared_ptr<CardDAVQuery> createAddressbookMultigetQuery(CardDAVContext *context,
 	                                                                    const std::list<CardDAVResponse> &list);
+	static std::shared_ptr<CardDAVQuery> createSyncCollectionQuery(CardDAVContext *context,
+	                                                               const std::string &syncToken);
 	static std::shared_ptr<CardDAVQuery> createDeleteQuery(CardDAVContext *context,
 	                                                       const std::shared_ptr<Vcard> &vcard);
 	static std::shared_ptr<CardDAVQuery> createPutQuery(CardDAVContext *context, const std::shared_ptr<Vcard> &vcard);
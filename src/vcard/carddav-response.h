@@ -35,9 +35,11 @@ public:
 
 	std::string mDisplayName;
 	std::string mCtag;
+	std::string mSyncToken;
 	std::string mEtag;
 	std::string mUrl;
 	std::string mVcard;
+	bool mDeleted = false; // The vCard was removed from the address book, as reported by a sync-collection REPORT.
 };
 
 LINPHONE_END_NAMESPACE
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2010-2025 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <bctoolbox/defs.h>
+
+#include "xml-reader.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+XmlReader::XmlReader(string_view body) {
+	mReader = xmlReaderForMemory(body.data(), static_cast<int>(body.size()), nullptr, nullptr, XML_PARSE_NONET);
+	if (!mReader) {
+		mError = true;
+		mErrorMessage = "Cannot create XML reader";
+		return;
+	}
+	xmlTextReaderSetErrorHandler(mReader, XmlReader::errorHandler, this);
+}
+
+XmlReader::~XmlReader() {
+	if (mReader) xmlFreeTextReader(mReader);
+}
+
+// -----------------------------------------------------------------------------
+
+bool XmlReader::readRootElement() {
+	while (read()) {
+		if (xmlTextReaderNodeType(mReader) == XML_READER_TYPE_ELEMENT) return true;
+	}
+	return false;
+}
+
+bool XmlReader::readChildElement(int parentDepth) {
+	while (mPending || read()) {
+		mPending = false;
+		int depth = xmlTextReaderDepth(mReader);
+		int type = xmlTextReaderNodeType(mReader);
+		if (depth <= parentDepth) {
+			// The parent has ended. Its end tag is consumed, any other node is left to the enclosing loop: empty
+			// elements have no end tag, so this may be the next sibling of the parent.
+			if ((depth < parentDepth) || (type != XML_READER_TYPE_END_ELEMENT)) mPending = true;
+			return false;
+		}
+		if ((depth == parentDepth + 1) && (type == XML_READER_TYPE_ELEMENT)) return true;
+	}
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+
+int XmlReader::getDepth() const {
+	return mReader ? xmlTextReaderDepth(mReader) : -1;
+}
+
+bool XmlReader::isElement(const char *ns, const char *localName) const {
+	const char *elementNs = getNamespace();
+	const char *elementName = getLocalName();
+	return elementNs && elementName && (strcmp(elementNs, ns) == 0) && (strcmp(elementName, localName) == 0);
+}
+
+const char *XmlReader::getNamespace() const {
+	return mReader ? reinterpret_cast<const char *>(xmlTextReaderConstNamespaceUri(mReader)) : nullptr;
+}
+
+const char *XmlReader::getLocalName() const {
+	return mReader ? reinterpret_cast<const char *>(xmlTextReaderConstLocalName(mReader)) : nullptr;
+}
+
+string XmlReader::getAttribute(const char *name) const {
+	if (!mReader) return string();
+	xmlChar *value = xmlTextReaderGetAttribute(mReader, reinterpret_cast<const xmlChar *>(name));
+	if (!value) return string();
+	string result(reinterpret_cast<const char *>(value));
+	xmlFree(value);
+	return result;
+}
+
+string XmlReader::getTextContent() const {
+	if (!mReader) return string();
+	// Only the subtree of the current element is built, the reader then goes on with its children.
+	xmlNodePtr node = xmlTextReaderExpand(mReader);
+	if (!node) return string();
+	xmlChar *content = xmlNodeGetContent(node);
+	if (!content) return string();
+	string result(reinterpret_cast<const char *>(content));
+	xmlFree(content);
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+
+bool XmlReader::read() {
+	if (!mReader || mError) return false;
+	int ret = xmlTextReaderRead(mReader);
+	if (ret < 0) mError = true;
+	return ret == 1;
+}
+
+void XmlReader::errorHandler(void *arg,
+                             const char *msg,
+                             xmlParserSeverities severity,
+                             BCTBX_UNUSED(xmlTextReaderLocatorPtr locator)) {
+	if ((severity != XML_PARSER_SEVERITY_ERROR) && (severity != XML_PARSER_SEVERITY_VALIDITY_ERROR)) return;
+	XmlReader *reader = static_cast<XmlReader *>(arg);
+	reader->mError = true;
+	if (reader->mErrorMessage.empty() && msg) {
+		reader->mErrorMessage = msg;
+		while (!reader->mErrorMessage.empty() && (reader->mErrorMessage.back() == '\n'))
+			reader->mErrorMessage.pop_back();
+	}
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2010-2025 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_XML_READER_H_
+#define _L_XML_READER_H_
+
+#include <string>
+#include <string_view>
+
+#include <libxml/xmlreader.h>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Forward-only reader of an XML document, on top of the libxml2 text reader: no tree is built for the document, which
+ * is parsed while it is walked.
+ * Elements are matched on their namespace URI and local name, whatever prefixes the document uses. The children of an
+ * element are walked with:
+ * @code
+ * int depth = reader.getDepth();
+ * while (reader.readChildElement(depth)) { ... }
+ * @endcode
+ * Nested loops may be left at any time, the outer loop resumes after the end of the current child.
+ */
+class XmlReader {
+public:
+	explicit XmlReader(std::string_view body);
+	XmlReader(const XmlReader &other) = delete;
+	~XmlReader();
+
+	// Move to the root element of the document, return false if there is none.
+	bool readRootElement();
+	// Move to the next child element of the element at the given depth, return false once this element has ended.
+	bool readChildElement(int parentDepth);
+
+	int getDepth() const;
+	bool isElement(const char *ns, const char *localName) const;
+	const char *getNamespace() const;
+	const char *getLocalName() const;
+	// Get an attribute of the current element by its qualified name, e.g. "id" or "xml:lang".
+	std::string getAttribute(const char *name) const;
+	// Get the text content of the current element and of its descendants.
+	std::string getTextContent() const;
+
+	bool hasError() const {
+		return mError;
+	}
+	const std::string &getError() const {
+		return mErrorMessage;
+	}
+
+private:
+	static void errorHandler(void *arg, const char *msg, xmlParserSeverities severity, xmlTextReaderLocatorPtr locator);
+
+	bool read();
+
+	xmlTextReaderPtr mReader = nullptr;
+	// The current node has been read by a nested loop but belongs to an enclosing one.
+	bool mPending = false;
+	bool mError = false;
+	std::string mErrorMessage;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_XML_READER_H_
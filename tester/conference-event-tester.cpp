@@ -1508,6 +1508,15 @@ void send_first_notify() {
 	BC_ASSERT_TRUE(!tester->participants.find(bobAddr->toString())->second);
 	BC_ASSERT_TRUE(tester->participants.find(aliceAddr->toString())->second);
 
+	// The full state is shared by the subscribers until the conference changes.
+	auto fullState = localHandler->getFullStateNotify();
+	BC_ASSERT_PTR_NOT_NULL(fullState);
+	BC_ASSERT_TRUE(localHandler->getFullStateNotify() == fullState);
+	localHandler->invalidateFullStateNotify();
+	auto newFullState = localHandler->getFullStateNotify();
+	BC_ASSERT_TRUE(newFullState != fullState);
+	BC_ASSERT_TRUE(localHandler->getFullStateNotify() == newFullState);
+
 	linphone_core_manager_destroy(marie);
 	linphone_core_manager_destroy(pauline);
 }
@@ -2282,6 +2291,12 @@ void send_subject_changed_notify() {
 	BC_ASSERT_TRUE(confListener->participants.find(aliceAddr->toString())->second);
 	BC_ASSERT_EQUAL(localConf->getLastNotify(), (lastNotifyCount + 1), int, "%d");
 
+	// The last notify is kept serialized for the devices that missed it, older ones are replaced by a full state.
+	ServerConferenceEventHandler *localHandler =
+	    (L_ATTR_GET(dynamic_pointer_cast<ServerConference>(localConf).get(), mEventHandler)).get();
+	BC_ASSERT_PTR_NOT_NULL(localHandler->createNotifyMultipart(static_cast<int>(lastNotifyCount)));
+	BC_ASSERT_PTR_NULL(localHandler->createNotifyMultipart(-1));
+
 	linphone_core_manager_destroy(marie);
 	linphone_core_manager_destroy(pauline);
 }
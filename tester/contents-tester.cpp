@@ -684,6 +684,31 @@ static void content_header_parsing(void) {
 	BC_ASSERT_TRUE(header.getValueWithParams() == value);
 }
 
+static void content_body_views(void) {
+	Content content;
+	content.setBodyFromUtf8("first body");
+	BC_ASSERT_TRUE(content.getBodyView() == "first body");
+	const char *cached = content.getBodyAsUtf8String().c_str();
+	BC_ASSERT_STRING_EQUAL(cached, "first body");
+	// The cached string is kept as long as the body is not modified.
+	BC_ASSERT_PTR_EQUAL(content.getBodyAsUtf8String().c_str(), cached);
+
+	content.setBodyFromUtf8("second body");
+	BC_ASSERT_TRUE(content.getBodyView() == "second body");
+	BC_ASSERT_STRING_EQUAL(content.getBodyAsUtf8String().c_str(), "second body");
+
+	const char *binary = "a\0b";
+	content.setBody(binary, 3);
+	BC_ASSERT_EQUAL((int)content.getBodyView().size(), 3, int, "%d");
+	BC_ASSERT_TRUE(content.getBodyAsUtf8String() == string(binary, 3));
+
+	Content copy(content);
+	BC_ASSERT_TRUE(copy.getBodyView() == content.getBodyView());
+	content.setBodyFromUtf8("third body");
+	BC_ASSERT_TRUE(copy.getBodyAsUtf8String() == string(binary, 3));
+	BC_ASSERT_STRING_EQUAL(content.getBodyAsUtf8String().c_str(), "third body");
+}
+
 static void content_public_api(void) {
 	LinphoneContent *content = linphone_factory_create_content(linphone_factory_get());
 
@@ -715,6 +740,7 @@ test_t contents_tests[] = {TEST_NO_TAG("Multipart to list", multipart_to_list),
                            TEST_NO_TAG("List to multipart", list_to_multipart),
                            TEST_NO_TAG("Content type parsing", content_type_parsing),
                            TEST_NO_TAG("Content header parsing", content_header_parsing),
+                           TEST_NO_TAG("Content body views", content_body_views),
                            TEST_NO_TAG("Content C public API", content_public_api)};
 
 test_suite_t contents_test_suite = {"Contents",
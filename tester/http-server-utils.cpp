@@ -79,3 +79,161 @@ std::string HttpServerWithBearerAuth::loadFile(const std::string &resource) {
 	}
 	return "";
 }
+
+FileTransferServer::FileTransferServer() {
+	mBaseUrl = "http://127.0.0.1:" + mListeningPort;
+	Post("/upload", [this](const httplib::Request &req, httplib::Response &res,
+	                       const httplib::ContentReader &contentReader) {
+		if (!req.is_multipart_form_data()) {
+			// The first request of an upload is empty, it only checks that the server is there.
+			contentReader([](BCTBX_UNUSED(const char *data), BCTBX_UNUSED(size_t length)) { return true; });
+			res.status = 204;
+			return;
+		}
+		int index = mFileCount++;
+		std::ofstream file(getFilePath(index), std::ios::binary);
+		std::string fileName;
+		std::string contentType;
+		size_t fileSize = 0;
+		contentReader(
+		    [&](const httplib::MultipartFormData &part) {
+			    fileName = part.filename;
+			    contentType = part.content_type;
+			    return true;
+		    },
+		    [&](const char *data, size_t length) {
+			    file.write(data, (std::streamsize)length);
+			    fileSize += length;
+			    return true;
+		    });
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			if (fileName == mHeldUpload) mUploadsReleasedCondition.wait(lock, [this] { return mUploadsReleased; });
+			mUploadCounts[fileName]++;
+			if (fileName == mFailingUpload) {
+				res.status = 500;
+				return;
+			}
+		}
+		std::ostringstream xml;
+		xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+		    << "<file xmlns=\"urn:gsma:params:xml:ns:rcs:rcs:fthttp\">\r\n"
+		    << "<file-info type=\"file\">\r\n"
+		    << "<file-size>" << fileSize << "</file-size>\r\n"
+		    << "<file-name>" << fileName << "</file-name>\r\n"
+		    << "<content-type>" << contentType << "</content-type>\r\n"
+		    << "<data url=\"" << mBaseUrl << "/download/" << index << "\" until=\"2100-01-01T00:00:00Z\"/>\r\n"
+		    << "</file-info>\r\n"
+		    << "</file>";
+		res.set_content(xml.str(), "application/vnd.gsma.rcs-ft-http+xml");
+	});
+	Get(R"(/download/(\d+))", [this](const httplib::Request &req, httplib::Response &res) {
+		int index = std::stoi(req.matches[1]);
+		auto file = std::make_shared<std::ifstream>(getFilePath(index), std::ios::binary);
+		if (!file->is_open()) {
+			res.status = 404;
+			return;
+		}
+		std::string eTag = getETag(index);
+		// A range of a file that changed since the validator of the client is answered with the whole file.
+		if (req.has_header("If-Range") && (req.get_header_value("If-Range") != eTag))
+			const_cast<httplib::Request &>(req).ranges.clear();
+		size_t interruption = 0;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mLastDownloadRange = req.get_header_value("Range");
+			mLastDownloadStatus = req.ranges.empty() ? 200 : 206;
+			interruption = mDownloadInterruption;
+			mDownloadInterruption = 0;
+		}
+		file->seekg(0, std::ios::end);
+		size_t fileSize = (size_t)file->tellg();
+		res.set_header("ETag", eTag);
+		auto sentSize = std::make_shared<size_t>(0);
+		res.set_content_provider(
+		    fileSize, "application/octet-stream",
+		    [file, interruption, sentSize](size_t offset, size_t length, httplib::DataSink &sink) {
+			    size_t chunkSize = std::min(length, (size_t)65536);
+			    if (interruption > 0) {
+				    // Returning false closes the connection in the middle of the body.
+				    if (*sentSize >= interruption) return false;
+				    chunkSize = std::min(chunkSize, interruption - *sentSize);
+			    }
+			    std::vector<char> chunk(chunkSize);
+			    file->seekg((std::streamoff)offset);
+			    file->read(chunk.data(), (std::streamsize)chunk.size());
+			    sink.write(chunk.data(), (size_t)file->gcount());
+			    *sentSize += (size_t)file->gcount();
+			    return file->gcount() > 0;
+		    });
+	});
+	BCTBX_SLOGI << " Waiting for file transfers on " << mBaseUrl;
+}
+
+FileTransferServer::~FileTransferServer() {
+	// The server can only be stopped once no request is waiting.
+	releaseUploads();
+	for (int index = 0; index < mFileCount; index++)
+		remove(getFilePath(index).c_str());
+}
+
+std::string FileTransferServer::getUploadUrl() const {
+	return mBaseUrl + "/upload";
+}
+
+std::string FileTransferServer::getFilePath(int index) const {
+	char *path = bc_tester_file(("file-transfer-server-" + mListeningPort + "-" + std::to_string(index)).c_str());
+	std::string filePath(path);
+	bc_free(path);
+	return filePath;
+}
+
+std::string FileTransferServer::getETag(int index) const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return "\"" + std::to_string(index) + "-" + std::to_string(mETagGeneration) + "\"";
+}
+
+void FileTransferServer::failUploadsOf(const std::string &fileName) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFailingUpload = fileName;
+}
+
+void FileTransferServer::holdUploadsOf(const std::string &fileName) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mHeldUpload = fileName;
+	mUploadsReleased = false;
+}
+
+void FileTransferServer::releaseUploads() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mUploadsReleased = true;
+	}
+	mUploadsReleasedCondition.notify_all();
+}
+
+int FileTransferServer::getUploadCount(const std::string &fileName) const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto it = mUploadCounts.find(fileName);
+	return (it != mUploadCounts.end()) ? it->second : 0;
+}
+
+void FileTransferServer::interruptNextDownloadAfter(size_t size) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mDownloadInterruption = size;
+}
+
+void FileTransferServer::changeETags() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mETagGeneration++;
+}
+
+std::string FileTransferServer::getLastDownloadRange() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLastDownloadRange;
+}
+
+int FileTransferServer::getLastDownloadStatus() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLastDownloadStatus;
+}
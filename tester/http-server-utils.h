@@ -18,6 +18,11 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 #include "belle_sip_tester_utils.h"
 
 /*
@@ -41,3 +46,45 @@ private:
 	std::string mBaseUrl;
 	std::string mRealm;
 };
+
+/*
+ * Fake http file transfer server, storing the uploaded files on disk and serving them back.
+ * It lets file transfers run at full speed on the loopback interface, without the TLS server of the test platform.
+ */
+class FileTransferServer : public bellesip::HttpServer {
+public:
+	FileTransferServer();
+	~FileTransferServer();
+	/* Returns the url to set as file transfer server */
+	std::string getUploadUrl() const;
+	/* Answers the uploads of the files with this name with an error 500 */
+	void failUploadsOf(const std::string &fileName);
+	/* Delays the answer to the uploads of the files with this name until releaseUploads() or the destruction */
+	void holdUploadsOf(const std::string &fileName);
+	void releaseUploads();
+	/* Returns how many times a file with this name was uploaded */
+	int getUploadCount(const std::string &fileName) const;
+	/* Closes the connection of the next download once this number of bytes of the file is sent */
+	void interruptNextDownloadAfter(size_t size);
+	/* Changes the ETag of all the files, as if they were modified since they were uploaded */
+	void changeETags();
+	/* Returns the Range header and the status code of the last download request */
+	std::string getLastDownloadRange() const;
+	int getLastDownloadStatus() const;
+
+private:
+	std::string getFilePath(int index) const;
+	std::string getETag(int index) const;
+	std::string mBaseUrl;
+	std::atomic<int> mFileCount{0};
+	mutable std::mutex mMutex;
+	std::string mFailingUpload;
+	std::string mHeldUpload;
+	bool mUploadsReleased = false;
+	std::condition_variable mUploadsReleasedCondition;
+	std::map<std::string, int> mUploadCounts;
+	size_t mDownloadInterruption = 0;
+	int mETagGeneration = 0;
+	std::string mLastDownloadRange;
+	int mLastDownloadStatus = 0;
+};
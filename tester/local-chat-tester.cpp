@@ -18,8 +18,14 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+#include <vector>
+
+#include "chat/chat-room/server-chat-room.h"
 #include "conference/participant.h"
+#include "content/content-manager.h"
 #include "core/core-p.h"
+#include "http-server-utils.h"
 #include "linphone/api/c-chat-room.h"
 #include "linphone/chat.h"
 #include "local-conference-tester-functions.h"
@@ -131,6 +137,221 @@ static void group_chat_room_creation_server(void) {
 	}
 }
 
+static void group_chat_room_server_message_queue(void) {
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress());
+		ClientConference laure("laure_tcp_rc", focus.getConferenceFactoryAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+		focus.registerAsParticipantDevice(laure);
+
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+		coresList = bctbx_list_append(coresList, laure.getLc());
+
+		Address paulineAddr = pauline.getIdentity();
+		Address laureAddr = laure.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+		participantsAddresses = bctbx_list_append(participantsAddresses, linphone_address_ref(laureAddr.toC()));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+		stats initialLaureStats = laure.getStats();
+
+		// Marie creates a new group chat room
+		const char *initialSubject = "Queue";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+		LinphoneChatRoom *paulineCr = check_creation_chat_room_client_side(
+		    coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 2, FALSE);
+		LinphoneChatRoom *laureCr = check_creation_chat_room_client_side(coresList, laure.getCMgr(), &initialLaureStats,
+		                                                                 confAddr, initialSubject, 2, FALSE);
+		BC_ASSERT_PTR_NOT_NULL(paulineCr);
+		BC_ASSERT_PTR_NOT_NULL(laureCr);
+
+		const auto conferenceAddress = Address::toCpp(confAddr)->getSharedFromThis();
+		auto &focusMainDb = L_GET_PRIVATE_FROM_C_OBJECT(focus.getLc())->mainDb;
+		auto findCursor = [&focusMainDb, &conferenceAddress](const Address &participantAddress) {
+			for (const auto &cursor : focusMainDb->getServerChatRoomQueueCursors(conferenceAddress)) {
+				if (Address(cursor.first).getUriWithoutGruu().weakEqual(participantAddress)) return cursor.second;
+			}
+			return -1LL;
+		};
+
+		// Each message is relayed to all the present devices, their cursors are moved past it.
+		for (int i = 0; i < 3; i++) {
+			LinphoneChatMessage *msg = _send_message(marieCr, "Hello");
+			BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceived,
+			                             initialPaulineStats.number_of_LinphoneMessageReceived + i + 1,
+			                             liblinphone_tester_sip_timeout));
+			BC_ASSERT_TRUE(wait_for_list(coresList, &laure.getStats().number_of_LinphoneMessageReceived,
+			                             initialLaureStats.number_of_LinphoneMessageReceived + i + 1,
+			                             liblinphone_tester_sip_timeout));
+			linphone_chat_message_unref(msg);
+		}
+		const auto queuedMessages = focusMainDb->getServerChatRoomQueuedMessages(conferenceAddress, 0);
+		BC_ASSERT_EQUAL(queuedMessages.size(), 3, size_t, "%zu");
+		if (!queuedMessages.empty()) {
+			const long long lastMessageId = queuedMessages.back().id;
+			BC_ASSERT_EQUAL(findCursor(paulineAddr), lastMessageId, long long, "%lld");
+			BC_ASSERT_EQUAL(findCursor(laureAddr), lastMessageId, long long, "%lld");
+		}
+
+		// The cursors of all the devices of a removed participant are deleted.
+		LinphoneParticipant *laureParticipant = linphone_chat_room_find_participant(marieCr, laureAddr.toC());
+		BC_ASSERT_PTR_NOT_NULL(laureParticipant);
+		linphone_chat_room_remove_participant(marieCr, laureParticipant);
+		BC_ASSERT_TRUE(wait_for_list(coresList, &marie.getStats().number_of_participants_removed,
+		                             initialMarieStats.number_of_participants_removed + 1,
+		                             liblinphone_tester_sip_timeout));
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline, laure}).wait([&findCursor, &laureAddr] {
+			return findCursor(laureAddr) < 0;
+		}));
+		BC_ASSERT_GREATER_STRICT(findCursor(paulineAddr), 0, long long, "%lld");
+
+		// Nothing is dispatched again after a restart of the server.
+		stats paulineStats = pauline.getStats();
+		coresList = bctbx_list_remove(coresList, focus.getLc());
+		focus.reStart();
+		coresList = bctbx_list_append(coresList, focus.getLc());
+		LinphoneAddress *paulineDeviceAddress = linphone_address_clone(
+		    linphone_proxy_config_get_contact(linphone_core_get_default_proxy_config(pauline.getLc())));
+		focus.notifyParticipantDeviceRegistration(confAddr, paulineDeviceAddress);
+		linphone_address_unref(paulineDeviceAddress);
+		// A replayed message would be sent at the registration, before this one: it must be the first one received.
+		LinphoneChatMessage *msg = _send_message(marieCr, "After restart");
+		BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceived,
+		                             paulineStats.number_of_LinphoneMessageReceived + 1,
+		                             liblinphone_tester_sip_timeout));
+		BC_ASSERT_EQUAL(pauline.getStats().number_of_LinphoneMessageReceived,
+		                paulineStats.number_of_LinphoneMessageReceived + 1, int, "%d");
+		LinphoneChatMessage *paulineMsg = pauline.getStats().last_received_chat_message;
+		BC_ASSERT_PTR_NOT_NULL(paulineMsg);
+		if (paulineMsg) BC_ASSERT_STRING_EQUAL(linphone_chat_message_get_utf8_text(paulineMsg), "After restart");
+		linphone_chat_message_unref(msg);
+
+		linphone_chat_room_leave(paulineCr);
+		bctbx_list_free(coresList);
+	}
+}
+
+class ServerChatRoomTester {
+public:
+	static bool canRelayMessage(const std::shared_ptr<ServerChatRoom> &chatRoom,
+	                            const std::shared_ptr<ServerChatRoom::Message> &message) {
+		return chatRoom->canRelayMessage(message);
+	}
+};
+
+static void check_relayed_message(LinphoneChatMessage *msg, const char *text, bool_t toSameUser) {
+	BC_ASSERT_PTR_NOT_NULL(msg);
+	if (!msg) return;
+	BC_ASSERT_STRING_EQUAL(linphone_chat_message_get_utf8_text(msg), text);
+	BC_ASSERT_STRING_EQUAL(linphone_chat_message_get_custom_header(msg, "Priority"), "urgent");
+	BC_ASSERT_STRING_EQUAL(linphone_chat_message_get_custom_header(msg, "Session-mode"), "true");
+	const char *messageType = linphone_chat_message_get_custom_header(msg, "X-fs-message-type");
+	if (toSameUser) BC_ASSERT_STRING_EQUAL(messageType, "chat-service");
+	else BC_ASSERT_PTR_NULL(messageType);
+}
+
+static void group_chat_room_server_relay(void) {
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference marie2("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(marie2);
+		focus.registerAsParticipantDevice(pauline);
+
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, marie2.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+		Address paulineAddr = pauline.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialMarie2Stats = marie2.getStats();
+		stats initialPaulineStats = pauline.getStats();
+
+		// Marie creates a new group chat room
+		const char *initialSubject = "Relay";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+		check_creation_chat_room_client_side(coresList, marie2.getCMgr(), &initialMarie2Stats, confAddr,
+		                                     initialSubject, 1, TRUE);
+		check_creation_chat_room_client_side(coresList, pauline.getCMgr(), &initialPaulineStats, confAddr,
+		                                     initialSubject, 1, FALSE);
+
+		std::shared_ptr<ServerChatRoom> serverChatRoom;
+		for (const auto &chatRoom : focus.getCore().getChatRooms()) {
+			serverChatRoom = dynamic_pointer_cast<ServerChatRoom>(chatRoom);
+			if (serverChatRoom) break;
+		}
+		BC_ASSERT_PTR_NOT_NULL(serverChatRoom);
+		if (!serverChatRoom) {
+			bctbx_list_free(coresList);
+			return;
+		}
+
+		// A plain message of a created chat room is relayed from a single request template.
+		const auto plainMessage = ServerChatRoom::createMessage(marie.getIdentity().toString(), ContentType::PlainText,
+		                                                        "Hello", nullptr);
+		BC_ASSERT_TRUE(ServerChatRoomTester::canRelayMessage(serverChatRoom, plainMessage));
+
+		// The parts of an encrypted message are rebuilt for each device by the chat message machinery.
+		Content part;
+		part.setContentType(ContentType::PlainText);
+		part.setBodyFromUtf8("Hello");
+		std::list<Content *> parts{&part, &part};
+		Content multipart = ContentManager::contentListToMultipart(parts, true);
+		const auto encryptedMessage = ServerChatRoom::createMessage(
+		    marie.getIdentity().toString(), multipart.getContentType(), multipart.getBodyAsUtf8String(), nullptr);
+		BC_ASSERT_FALSE(encryptedMessage->contentsList.empty());
+		BC_ASSERT_FALSE(ServerChatRoomTester::canRelayMessage(serverChatRoom, encryptedMessage));
+
+		// The relayed requests carry the body and the headers of the received one, for each kind of recipient.
+		const char *text = "Relayed to everybody";
+		LinphoneChatMessage *msg = linphone_chat_room_create_message_from_utf8(marieCr, text);
+		linphone_chat_message_add_custom_header(msg, "Priority", "urgent");
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceived,
+		                             initialPaulineStats.number_of_LinphoneMessageReceived + 1,
+		                             liblinphone_tester_sip_timeout));
+		BC_ASSERT_TRUE(wait_for_list(coresList, &marie2.getStats().number_of_LinphoneMessageReceived,
+		                             initialMarie2Stats.number_of_LinphoneMessageReceived + 1,
+		                             liblinphone_tester_sip_timeout));
+		check_relayed_message(pauline.getStats().last_received_chat_message, text, FALSE);
+		check_relayed_message(marie2.getStats().last_received_chat_message, text, TRUE);
+		BC_ASSERT_FALSE(wait_for_list(coresList, &marie.getStats().number_of_LinphoneMessageReceived,
+		                              initialMarieStats.number_of_LinphoneMessageReceived + 1, 1000));
+		linphone_chat_message_unref(msg);
+
+		// Once the chat room is no longer in the Created state, the messages are no longer relayed directly.
+		for (const auto &participant : serverChatRoom->getParticipants()) {
+			std::shared_ptr<Address> participantAddress = participant->getAddress();
+			linphone_chat_room_set_participant_devices(serverChatRoom->toC(), participantAddress->toC(), NULL);
+		}
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, marie2, pauline}).wait([&focus] {
+			return focus.getCore().getChatRooms().size() == 0;
+		}));
+		BC_ASSERT_NOT_EQUAL((int)serverChatRoom->getState(), (int)ConferenceInterface::State::Created, int, "%d");
+		BC_ASSERT_FALSE(ServerChatRoomTester::canRelayMessage(serverChatRoom, plainMessage));
+
+		bctbx_list_free(coresList);
+	}
+}
+
 static void group_chat_room_server_deletion(void) {
 	Focus focus("chloe_rc");
 	{ // to make sure focus is destroyed after clients.
@@ -3712,6 +3933,215 @@ static void group_chat_room_with_duplications(void) {
 		bctbx_list_free(coresList);
 	}
 }
+
+static void write_file_transfer_test_file(const char *filePath, size_t fileSize) {
+	ofstream file(filePath, ios::binary);
+	vector<char> data(fileSize);
+	for (size_t i = 0; i < fileSize; i++)
+		data[i] = (char)((i / 4096 + i) & 0xff);
+	file.write(data.data(), (streamsize)fileSize);
+}
+
+static size_t get_file_transfer_test_file_size(const char *filePath) {
+	ifstream file(filePath, ios::binary | ios::ate);
+	return file.is_open() ? (size_t)file.tellg() : 0;
+}
+
+static void add_file_transfer_test_content(LinphoneChatMessage *msg, const char *name, const char *filePath) {
+	LinphoneContent *content = linphone_core_create_content(linphone_chat_message_get_core(msg));
+	linphone_content_set_type(content, "application");
+	linphone_content_set_subtype(content, "octet-stream");
+	linphone_content_set_name(content, name);
+	linphone_content_set_file_path(content, filePath);
+	linphone_chat_message_add_file_content(msg, content);
+	linphone_content_unref(content);
+}
+
+static void group_chat_room_parallel_file_upload_failure(void) {
+	FileTransferServer fileTransferServer;
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+		linphone_core_set_file_transfer_server(marie.getLc(), fileTransferServer.getUploadUrl().c_str());
+
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+		Address paulineAddr = pauline.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+
+		const char *initialSubject = "Parallel uploads";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+		LinphoneChatRoom *paulineCr = check_creation_chat_room_client_side(
+		    coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 1, FALSE);
+		BC_ASSERT_PTR_NOT_NULL(paulineCr);
+
+		char *largeFilePath = random_filepath("parallel_upload_large", "bin");
+		char *smallFilePath = random_filepath("parallel_upload_small", "bin");
+		write_file_transfer_test_file(largeFilePath, 256 * 1024);
+		write_file_transfer_test_file(smallFilePath, 1024);
+		// The large file is still being uploaded when the upload of the small one fails.
+		fileTransferServer.holdUploadsOf("large.bin");
+		fileTransferServer.failUploadsOf("small.bin");
+
+		// The failure of the upload of the small file stops the upload of the large one, the message is not sent.
+		initialPaulineStats = pauline.getStats();
+		LinphoneChatMessage *msg = linphone_chat_room_create_empty_message(marieCr);
+		add_file_transfer_test_content(msg, "large.bin", largeFilePath);
+		add_file_transfer_test_content(msg, "small.bin", smallFilePath);
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).wait([msg] {
+			LinphoneChatMessageState state = linphone_chat_message_get_state(msg);
+			return (state == LinphoneChatMessageStateNotDelivered) ||
+			       (state == LinphoneChatMessageStateFileTransferError);
+		}));
+		// The upload of the large file has been cancelled on the client: its end can't upload the small file again.
+		BC_ASSERT_EQUAL(marie.getCore().getActiveFileTransferCount(), 0, unsigned int, "%u");
+		BC_ASSERT_EQUAL(linphone_core_get_remaining_upload_file_count(marie.getLc()), 0, unsigned int, "%u");
+		BC_ASSERT_EQUAL(fileTransferServer.getUploadCount("small.bin"), 1, int, "%d");
+		LinphoneChatMessageState state = linphone_chat_message_get_state(msg);
+		BC_ASSERT_TRUE((state == LinphoneChatMessageStateNotDelivered) ||
+		               (state == LinphoneChatMessageStateFileTransferError));
+		BC_ASSERT_EQUAL(pauline.getStats().number_of_LinphoneMessageReceivedWithFile,
+		                initialPaulineStats.number_of_LinphoneMessageReceivedWithFile, int, "%d");
+		linphone_chat_message_unref(msg);
+
+		remove(largeFilePath);
+		remove(smallFilePath);
+		bc_free(largeFilePath);
+		bc_free(smallFilePath);
+		bctbx_list_free(coresList);
+	}
+}
+
+static void group_chat_room_file_download_resume_base(bool_t fileChanged) {
+	const size_t fileSize = 4 * 1024 * 1024;
+	FileTransferServer fileTransferServer;
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+		linphone_core_set_file_transfer_server(marie.getLc(), fileTransferServer.getUploadUrl().c_str());
+		linphone_config_set_bool(linphone_core_get_config(pauline.getLc()), "misc", "file_transfer_resume_downloads",
+		                         TRUE);
+
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+		Address paulineAddr = pauline.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+
+		const char *initialSubject = "Resumed downloads";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+		LinphoneChatRoom *paulineCr = check_creation_chat_room_client_side(
+		    coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 1, FALSE);
+		BC_ASSERT_PTR_NOT_NULL(paulineCr);
+
+		char *sendFilePath = random_filepath("download_resume", "bin");
+		char *receiveFilePath = random_filepath("receive_download_resume", "bin");
+		write_file_transfer_test_file(sendFilePath, fileSize);
+
+		initialPaulineStats = pauline.getStats();
+		LinphoneChatMessage *msg = linphone_chat_room_create_empty_message(marieCr);
+		add_file_transfer_test_content(msg, "resume.bin", sendFilePath);
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).wait([msg] {
+			return (linphone_chat_message_get_state(msg) == LinphoneChatMessageStateDelivered);
+		}));
+		linphone_chat_message_unref(msg);
+
+		BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceivedWithFile,
+		                             initialPaulineStats.number_of_LinphoneMessageReceivedWithFile + 1,
+		                             liblinphone_tester_sip_timeout));
+		LinphoneChatMessage *paulineMsg = pauline.getStats().last_received_chat_message;
+		BC_ASSERT_PTR_NOT_NULL(paulineMsg);
+		if (paulineMsg) {
+			LinphoneChatMessageCbs *cbs = linphone_factory_create_chat_message_cbs(linphone_factory_get());
+			linphone_chat_message_cbs_set_msg_state_changed(cbs, liblinphone_tester_chat_message_msg_state_changed);
+			linphone_chat_message_add_callbacks(paulineMsg, cbs);
+			linphone_chat_message_cbs_unref(cbs);
+
+			// The connection is closed in the middle of the first download, the received part is kept.
+			fileTransferServer.interruptNextDownloadAfter(fileSize / 2);
+			LinphoneContent *fileTransferContent = linphone_chat_message_get_file_transfer_information(paulineMsg);
+			BC_ASSERT_PTR_NOT_NULL(fileTransferContent);
+			if (fileTransferContent) {
+				linphone_content_set_file_path(fileTransferContent, receiveFilePath);
+				linphone_chat_message_download_content(paulineMsg, fileTransferContent);
+			}
+			BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageFileTransferError,
+			                             initialPaulineStats.number_of_LinphoneMessageFileTransferError + 1,
+			                             liblinphone_tester_sip_timeout));
+			size_t partialSize = get_file_transfer_test_file_size(receiveFilePath);
+			BC_ASSERT_GREATER_STRICT(partialSize, 0, size_t, "%zu");
+			BC_ASSERT_LOWER_STRICT(partialSize, fileSize, size_t, "%zu");
+
+			// The download is resumed from the partial file, unless the file changed on the server since.
+			if (fileChanged) fileTransferServer.changeETags();
+			fileTransferContent = linphone_chat_message_get_file_transfer_information(paulineMsg);
+			BC_ASSERT_PTR_NOT_NULL(fileTransferContent);
+			if (fileTransferContent) {
+				linphone_content_set_file_path(fileTransferContent, receiveFilePath);
+				linphone_chat_message_download_content(paulineMsg, fileTransferContent);
+			}
+			if (BC_ASSERT_TRUE(wait_for_list(coresList,
+			                                 &pauline.getStats().number_of_LinphoneMessageFileTransferDone,
+			                                 initialPaulineStats.number_of_LinphoneMessageFileTransferDone + 1,
+			                                 liblinphone_tester_sip_timeout))) {
+				compare_files(sendFilePath, receiveFilePath);
+			}
+
+			const string range = fileTransferServer.getLastDownloadRange();
+			BC_ASSERT_EQUAL(range.rfind("bytes=", 0), 0, size_t, "%zu");
+			if (fileChanged) {
+				BC_ASSERT_EQUAL(fileTransferServer.getLastDownloadStatus(), 200, int, "%d");
+			} else {
+				BC_ASSERT_EQUAL(fileTransferServer.getLastDownloadStatus(), 206, int, "%d");
+				// The buffered end of the partial file may not be part of the saved offset.
+				size_t offset = (size_t)strtoull(range.c_str() + 6, nullptr, 10);
+				BC_ASSERT_GREATER_STRICT(offset, 0, size_t, "%zu");
+				BC_ASSERT_LOWER(offset, partialSize, size_t, "%zu");
+			}
+			// The state of the download is forgotten once it is complete.
+			BC_ASSERT_EQUAL(get_file_transfer_test_file_size((string(receiveFilePath) + ".resume").c_str()), 0,
+			                size_t, "%zu");
+		}
+
+		remove(sendFilePath);
+		remove(receiveFilePath);
+		remove((string(receiveFilePath) + ".resume").c_str());
+		bc_free(sendFilePath);
+		bc_free(receiveFilePath);
+		bctbx_list_free(coresList);
+	}
+}
+
+static void group_chat_room_file_download_resume(void) {
+	group_chat_room_file_download_resume_base(FALSE);
+}
+
+static void group_chat_room_file_download_resume_file_changed(void) {
+	group_chat_room_file_download_resume_base(TRUE);
+}
 } // namespace LinphoneTest
 
 static test_t local_conference_chat_basic_tests[] = {
@@ -3719,6 +4149,14 @@ static test_t local_conference_chat_basic_tests[] = {
                  LinphoneTest::group_chat_room_creation_server,
                  "LeaksMemory"), /* beacause of coreMgr restart*/
     TEST_NO_TAG("Group chat Server chat room deletion", LinphoneTest::group_chat_room_server_deletion),
+    TEST_NO_TAG("Group chat server relay", LinphoneTest::group_chat_room_server_relay),
+    TEST_ONE_TAG("Group chat server message queue",
+                 LinphoneTest::group_chat_room_server_message_queue,
+                 "LeaksMemory"), /* beacause of coreMgr restart*/
+    TEST_NO_TAG("Group chat parallel file upload failure", LinphoneTest::group_chat_room_parallel_file_upload_failure),
+    TEST_NO_TAG("Group chat file download resume", LinphoneTest::group_chat_room_file_download_resume),
+    TEST_NO_TAG("Group chat file download resume after file change",
+                LinphoneTest::group_chat_room_file_download_resume_file_changed),
     TEST_ONE_TAG("Group chat with duplications",
                  LinphoneTest::group_chat_room_with_duplications,
                  "LeaksMemory"), /* beacause of coreMgr restart*/
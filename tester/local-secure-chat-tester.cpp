@@ -18,6 +18,9 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+#include <vector>
+
 #ifdef HAVE_SOCI
 #include <soci/soci.h>
 #endif // HAVE_SOCI
@@ -25,6 +28,7 @@
 #include "conference/conference.h"
 #include "conference/participant.h"
 #include "core/core-p.h"
+#include "http-server-utils.h"
 #include "liblinphone_tester.h"
 #include "linphone/api/c-chat-room.h"
 #include "linphone/chat.h"
@@ -870,6 +874,138 @@ static void secure_one_to_one_chat_room_with_client_removed_from_database(void)
 	}
 }
 
+static void file_transfer_benchmark_recv(LinphoneChatMessage *msg,
+                                         BCTBX_UNUSED(LinphoneContent *content),
+                                         const LinphoneBuffer *buffer) {
+	size_t *receivedSize =
+	    (size_t *)linphone_chat_message_cbs_get_user_data(linphone_chat_message_get_current_callbacks(msg));
+	*receivedSize += linphone_buffer_get_size(buffer);
+}
+
+static double file_transfer_benchmark_throughput(size_t size, chrono::steady_clock::time_point start) {
+	auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+	return (double)size / (1024 * 1024) / ((double)max<long long>(elapsed, 1) / 1000);
+}
+
+static void secure_chat_room_encrypted_file_transfer_benchmark(void) {
+	const size_t chunkSize = 1024 * 1024;
+	const size_t fileSize = 1024 * chunkSize;
+	FileTransferServer fileTransferServer;
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		linphone_core_enable_lime_x3dh(focus.getLc(), TRUE);
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress(), TRUE);
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress(), TRUE);
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+		linphone_core_set_file_transfer_server(marie.getLc(), fileTransferServer.getUploadUrl().c_str());
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+
+		BC_ASSERT_TRUE(linphone_core_lime_x3dh_enabled(marie.getLc()));
+		BC_ASSERT_TRUE(linphone_core_lime_x3dh_enabled(pauline.getLc()));
+
+		Address paulineAddr = pauline.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+
+		const char *initialSubject = "Benchmark";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, TRUE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		BC_ASSERT_PTR_NOT_NULL(marieCr);
+		const LinphoneAddress *confAddr = marieCr ? linphone_chat_room_get_conference_address(marieCr) : NULL;
+		LinphoneChatRoom *paulineCr = check_creation_chat_room_client_side(
+		    coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 1, FALSE);
+		BC_ASSERT_PTR_NOT_NULL(paulineCr);
+
+		char *sendFilepath = random_filepath("file_transfer_benchmark", "bin");
+		{
+			ofstream file(sendFilepath, ios::binary);
+			vector<char> chunk(chunkSize);
+			for (size_t offset = 0; offset < fileSize; offset += chunkSize) {
+				for (size_t i = 0; i < chunkSize; i++)
+					chunk[i] = (char)((offset / chunkSize + i) & 0xff);
+				file.write(chunk.data(), (streamsize)chunkSize);
+			}
+		}
+
+		if (marieCr && paulineCr) {
+			initialPaulineStats = pauline.getStats();
+			LinphoneContent *content = linphone_core_create_content(marie.getLc());
+			linphone_content_set_type(content, "application");
+			linphone_content_set_subtype(content, "octet-stream");
+			linphone_content_set_name(content, "benchmark.bin");
+			linphone_content_set_file_path(content, sendFilepath);
+			LinphoneChatMessage *msg = linphone_chat_room_create_empty_message(marieCr);
+			linphone_chat_message_add_file_content(msg, content);
+			linphone_content_unref(content);
+
+			auto start = chrono::steady_clock::now();
+			linphone_chat_message_send(msg);
+			BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).waitUntil(chrono::minutes(10), [msg] {
+				return (linphone_chat_message_get_state(msg) == LinphoneChatMessageStateDelivered);
+			}));
+			ms_message("Encrypted upload of %zu MB: %.1f MB/s", fileSize / (1024 * 1024),
+			           file_transfer_benchmark_throughput(fileSize, start));
+			linphone_chat_message_unref(msg);
+
+			BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceivedWithFile,
+			                             initialPaulineStats.number_of_LinphoneMessageReceivedWithFile + 1,
+			                             liblinphone_tester_sip_timeout));
+			LinphoneChatMessage *paulineMsg = pauline.getStats().last_received_chat_message;
+			BC_ASSERT_PTR_NOT_NULL(paulineMsg);
+			if (paulineMsg) {
+				// Chunks are handed to the application instead of being written to a file.
+				size_t receivedSize = 0;
+				LinphoneChatMessageCbs *cbs = linphone_factory_create_chat_message_cbs(linphone_factory_get());
+				linphone_chat_message_cbs_set_file_transfer_recv(cbs, file_transfer_benchmark_recv);
+				linphone_chat_message_cbs_set_user_data(cbs, &receivedSize);
+				linphone_chat_message_add_callbacks(paulineMsg, cbs);
+				linphone_chat_message_cbs_unref(cbs);
+
+				start = chrono::steady_clock::now();
+				LinphoneContent *fileTransferContent = linphone_chat_message_get_file_transfer_information(paulineMsg);
+				BC_ASSERT_PTR_NOT_NULL(fileTransferContent);
+				if (fileTransferContent) linphone_chat_message_download_content(paulineMsg, fileTransferContent);
+				const int fileTransferDone = initialPaulineStats.number_of_LinphoneMessageFileTransferDone + 1;
+				BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).waitUntil(chrono::minutes(10), [&] {
+					return pauline.getStats().number_of_LinphoneMessageFileTransferDone >= fileTransferDone;
+				}));
+				BC_ASSERT_EQUAL(receivedSize, fileSize, size_t, "%zu");
+				ms_message("Encrypted download of %zu MB: %.1f MB/s", fileSize / (1024 * 1024),
+				           file_transfer_benchmark_throughput(receivedSize, start));
+			}
+		}
+		remove(sendFilepath);
+		bc_free(sendFilepath);
+
+		for (auto chatRoom : focus.getCore().getChatRooms()) {
+			for (auto participant : chatRoom->getParticipants()) {
+				//  force deletion by removing devices
+				auto participantAddress = participant->getAddress();
+				linphone_chat_room_set_participant_devices(chatRoom->toC(), participantAddress->toC(), NULL);
+			}
+		}
+
+		// wait until chatroom is deleted server side
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).wait([&focus] {
+			return focus.getCore().getChatRooms().size() == 0;
+		}));
+
+		// to avoid creation attempt of a new chatroom
+		LinphoneProxyConfig *config = linphone_core_get_default_proxy_config(focus.getLc());
+		linphone_proxy_config_edit(config);
+		linphone_proxy_config_set_conference_factory_uri(config, NULL);
+		linphone_proxy_config_done(config);
+		bctbx_list_free(coresList);
+	}
+}
+
 } // namespace LinphoneTest
 
 static test_t local_conference_secure_chat_tests[] = {
@@ -895,7 +1031,10 @@ static test_t local_conference_secure_chat_tests[] = {
                 LinphoneTest::group_chat_room_lime_server_encrypted_message),
     TEST_ONE_TAG("Secure one-to-one chat with client removed from database",
                  LinphoneTest::secure_one_to_one_chat_room_with_client_removed_from_database,
-                 "LeaksMemory")};
+                 "LeaksMemory"),
+    TEST_ONE_TAG("Secure chat encrypted file transfer benchmark",
+                 LinphoneTest::secure_chat_room_encrypted_file_transfer_benchmark,
+                 "skip")}; /* 1 GB transfer, run on demand */
 
 test_suite_t local_conference_test_suite_secure_chat = {"Local conference tester (Secure Chat)",
                                                         NULL,
@@ -51,12 +51,16 @@ public:
 	MainDbProvider(const char *db_file,
 	               bool_t keep_gruu = TRUE,
 	               bool_t unify_chatroom_address = FALSE,
-	               bool_t is_conference_server = FALSE) {
+	               bool_t is_conference_server = FALSE,
+	               const char *sqlite_profile = nullptr) {
 		mCoreManager = linphone_core_manager_create("empty_rc");
 		char *roDbPath = bc_tester_res(db_file);
 		char *rwDbPath = bc_tester_file(core_db);
 		BC_ASSERT_FALSE(liblinphone_tester_copy_file(roDbPath, rwDbPath));
 		linphone_config_set_string(linphone_core_get_config(mCoreManager->lc), "storage", "uri", rwDbPath);
+		if (sqlite_profile)
+			linphone_config_set_string(linphone_core_get_config(mCoreManager->lc), "storage", "sqlite_profile",
+			                           sqlite_profile);
 		linphone_core_enable_gruu_in_conference_address(mCoreManager->lc, keep_gruu);
 		linphone_config_set_bool(linphone_core_get_config(mCoreManager->lc), "misc", "unify_chatroom_address",
 		                         unify_chatroom_address);
@@ -644,6 +648,292 @@ static void search_messages_in_chat_room(void) {
 	}
 }
 
+static void search_messages_in_chat_room_ranked(void) {
+	MainDbProvider provider("db/chatrooms.db");
+	MainDb &mainDb = provider.getMainDb();
+	if (mainDb.isInitialized()) {
+		shared_ptr<AbstractChatRoom> chatRoom;
+		for (const auto &c : mainDb.getChatRooms()) {
+			if (c->getSubject() == "Les réunions") {
+				chatRoom = c;
+				break;
+			}
+		}
+		BC_ASSERT_PTR_NOT_NULL(chatRoom);
+		if (!chatRoom) return;
+		const ConferenceId &conferenceId = chatRoom->getConferenceId();
+
+		auto listEvent = mainDb.findChatMessagesByText(conferenceId, "réunion", 0, -1);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)4, size_t, "%zu");
+
+		// Pagination
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "réunion", 0, 3);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)3, size_t, "%zu");
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "réunion", 3, 6);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)1, size_t, "%zu");
+
+		// All the words must be present
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "réunion Pauline", 0, -1);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)1, size_t, "%zu");
+		if (!listEvent.empty()) {
+			auto chatMessage = static_pointer_cast<ConferenceChatMessageEvent>(listEvent.front())->getChatMessage();
+			BC_ASSERT_STRING_EQUAL(linphone_chat_message_get_utf8_text(L_GET_C_BACK_PTR(chatMessage)),
+			                       "On a prévu une petit réunion avec Super Marie et Super Pauline");
+		}
+
+		// Substrings inside words match, as with a LIKE scan
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "union", 0, -1);
+		BC_ASSERT_GREATER(listEvent.size(), (size_t)4, size_t, "%zu");
+
+		// New messages are searchable until they are deleted
+		shared_ptr<ChatMessage> newMessage = chatRoom->createChatMessageFromUtf8("Nouvelle réunion demain, 10h? Zq");
+		newMessage->send();
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "réunion", 0, -1);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)5, size_t, "%zu");
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "dema", 0, -1);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)1, size_t, "%zu");
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "zq", 0, -1);
+		BC_ASSERT_EQUAL(listEvent.size(), (size_t)1, size_t, "%zu");
+
+		// Punctuation is part of the searched text
+		shared_ptr<EventLog> found = mainDb.searchChatMessagesByText(conferenceId, "demain, 10h?", nullptr,
+		                                                             LinphoneSearchDirectionUp);
+		BC_ASSERT_PTR_NOT_NULL(found);
+		found = mainDb.searchChatMessagesByText(conferenceId, "demain 10h", nullptr, LinphoneSearchDirectionUp);
+		BC_ASSERT_PTR_NULL(found);
+
+		chatRoom->deleteMessageFromHistory(newMessage);
+		listEvent = mainDb.findChatMessagesByText(conferenceId, "demain", 0, -1);
+		BC_ASSERT_TRUE(listEvent.empty());
+	} else {
+		BC_FAIL("Database not initialized");
+	}
+}
+
+static void write_behind_participant_states(void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	if (mainDb.isInitialized()) {
+		auto events =
+		    mainDb.getHistoryRange(ConferenceId(Address::create("sip:test-4@sip.linphone.org")->getSharedFromThis(),
+		                                        Address::create("sip:test-1@sip.linphone.org"), ConferenceIdParams()),
+		                           0, 1, MainDb::Filter::ConferenceChatMessageFilter);
+		BC_ASSERT_EQUAL(events.size(), 1, size_t, "%zu");
+		if (events.empty()) return;
+		const shared_ptr<EventLog> &event = events.front();
+		const auto pauline = Address::create("sip:pauline@sip.example.org");
+		const auto marie = Address::create("sip:marie@sip.example.org");
+		const size_t initialCount = mainDb.getChatMessageParticipantStates(event).size();
+
+		// Use a long batch window so that nothing is committed before the flush.
+		mainDb.enableWriteBehind(true, 10000);
+		BC_ASSERT_TRUE(mainDb.writeBehindEnabled());
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::DeliveredToUser, 100);
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::Displayed, 200);
+		mainDb.setChatMessageParticipantState(event, marie, ChatMessage::State::DeliveredToUser, 300);
+		// Displayed can't go back to Delivered.
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::Delivered, 400);
+
+		// Pending states are visible before being committed.
+		BC_ASSERT_EQUAL((int)mainDb.getChatMessageParticipantState(event, pauline), (int)ChatMessage::State::Displayed,
+		                int, "%d");
+		BC_ASSERT_EQUAL(mainDb.getChatMessageParticipantStates(event).size(), initialCount + 2, size_t, "%zu");
+		BC_ASSERT_EQUAL(mainDb.getChatMessageParticipantsByImdnState(event, ChatMessage::State::DeliveredToUser).size(),
+		                1, size_t, "%zu");
+
+		mainDb.flushPendingWrites();
+		mainDb.enableWriteBehind(false);
+		BC_ASSERT_FALSE(mainDb.writeBehindEnabled());
+
+		BC_ASSERT_EQUAL((int)mainDb.getChatMessageParticipantState(event, pauline), (int)ChatMessage::State::Displayed,
+		                int, "%d");
+		BC_ASSERT_EQUAL((int)mainDb.getChatMessageParticipantState(event, marie),
+		                (int)ChatMessage::State::DeliveredToUser, int, "%d");
+		BC_ASSERT_EQUAL(mainDb.getChatMessageParticipantStates(event).size(), initialCount + 2, size_t, "%zu");
+	} else {
+		BC_FAIL("Database not initialized");
+	}
+}
+
+static void check_participant_state_counts(const MainDb &mainDb, const shared_ptr<EventLog> &event) {
+	map<ChatMessage::State, int> expectedCounts;
+	for (const auto &participantState : mainDb.getChatMessageParticipantStates(event))
+		expectedCounts[participantState.state]++;
+	auto counts = mainDb.getChatMessageParticipantStateCounts(event);
+	BC_ASSERT_EQUAL(counts.size(), expectedCounts.size(), size_t, "%zu");
+	for (const auto &expectedCount : expectedCounts)
+		BC_ASSERT_EQUAL(counts[expectedCount.first], expectedCount.second, int, "%d");
+}
+
+static void participant_state_counts(void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	if (mainDb.isInitialized()) {
+		auto events =
+		    mainDb.getHistoryRange(ConferenceId(Address::create("sip:test-4@sip.linphone.org")->getSharedFromThis(),
+		                                        Address::create("sip:test-1@sip.linphone.org"), ConferenceIdParams()),
+		                           0, 1, MainDb::Filter::ConferenceChatMessageFilter);
+		BC_ASSERT_EQUAL(events.size(), 1, size_t, "%zu");
+		if (events.empty()) return;
+		const shared_ptr<EventLog> &event = events.front();
+		const auto pauline = Address::create("sip:pauline@sip.example.org");
+
+		// Counters of existing messages are computed when the table is created.
+		check_participant_state_counts(mainDb, event);
+
+		ChatMessage::State state;
+		BC_ASSERT_FALSE(mainDb.findChatMessageParticipantState(event, pauline, state));
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::Delivered, 100);
+		check_participant_state_counts(mainDb, event);
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::Displayed, 200);
+		check_participant_state_counts(mainDb, event);
+		// Displayed can't go back to Delivered, counters must not move.
+		mainDb.setChatMessageParticipantState(event, pauline, ChatMessage::State::Delivered, 300);
+		check_participant_state_counts(mainDb, event);
+		BC_ASSERT_TRUE(mainDb.findChatMessageParticipantState(event, pauline, state));
+		BC_ASSERT_EQUAL((int)state, (int)ChatMessage::State::Displayed, int, "%d");
+
+		// The counters can only be trusted if the states belong to the current participants.
+		const auto stranger = Address::create("sip:stranger@sip.example.org");
+		BC_ASSERT_EQUAL(mainDb.countChatMessageParticipantStates(event, {pauline}), 1, size_t, "%zu");
+		BC_ASSERT_EQUAL(mainDb.countChatMessageParticipantStates(event, {stranger}), 0, size_t, "%zu");
+		BC_ASSERT_EQUAL(mainDb.countChatMessageParticipantStates(event, {pauline, stranger}), 1, size_t, "%zu");
+	} else {
+		BC_FAIL("Database not initialized");
+	}
+}
+
+static void server_chat_room_queue(void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	if (mainDb.isInitialized()) {
+		const auto chatRoom = Address::create("sip:chatroom-queue@conf.example.org");
+		const auto laure = Address::create("sip:laure@sip.example.org;gr=urn:uuid:laure");
+		const auto marie = Address::create("sip:marie@sip.example.org;gr=urn:uuid:marie");
+		const auto pauline = Address::create("sip:pauline@sip.example.org;gr=urn:uuid:pauline");
+		const time_t now = ms_time(NULL);
+
+		MainDb::ServerChatRoomQueuedMessage message;
+		message.fromAddress = laure->toString();
+		message.contentType = "text/plain";
+		message.body = "Hello";
+		message.headers = "Priority: urgent\r\n";
+		message.creationTime = now;
+		long long firstId = mainDb.insertServerChatRoomQueuedMessage(chatRoom, message, {marie, pauline});
+		BC_ASSERT_GREATER_STRICT(firstId, 0, long long, "%lld");
+		message.body = "World";
+		// The parameters of the content type, such as the boundary of an encrypted message, are kept as is.
+		message.contentType = "multipart/encrypted;boundary=queue-boundary";
+		long long secondId = mainDb.insertServerChatRoomQueuedMessage(chatRoom, message, {});
+		BC_ASSERT_GREATER_STRICT(secondId, firstId, long long, "%lld");
+
+		// Both messages are stored once, Marie and Pauline point before the first one.
+		auto cursors = mainDb.getServerChatRoomQueueCursors(chatRoom);
+		BC_ASSERT_EQUAL(cursors.size(), 2, size_t, "%zu");
+		BC_ASSERT_EQUAL(cursors[marie->toStringUriOnlyOrdered()], firstId - 1, long long, "%lld");
+		auto messages = mainDb.getServerChatRoomQueuedMessages(chatRoom, firstId - 1);
+		BC_ASSERT_EQUAL(messages.size(), 2, size_t, "%zu");
+		if (messages.size() == 2) {
+			BC_ASSERT_STRING_EQUAL(messages.front().body.c_str(), "Hello");
+			BC_ASSERT_STRING_EQUAL(messages.front().contentType.c_str(), "text/plain");
+			BC_ASSERT_STRING_EQUAL(messages.front().headers.c_str(), "Priority: urgent\r\n");
+			BC_ASSERT_STRING_EQUAL(messages.back().body.c_str(), "World");
+			BC_ASSERT_STRING_EQUAL(messages.back().contentType.c_str(), "multipart/encrypted;boundary=queue-boundary");
+		}
+
+		// The first message is dispatched to everybody, the second one is still waiting for Pauline.
+		mainDb.updateServerChatRoomQueueCursors(
+		    chatRoom, {{marie->toStringUriOnlyOrdered(), secondId}, {pauline->toStringUriOnlyOrdered(), firstId}}, {});
+		cursors = mainDb.getServerChatRoomQueueCursors(chatRoom);
+		BC_ASSERT_EQUAL(cursors.size(), 2, size_t, "%zu");
+		BC_ASSERT_EQUAL(cursors[marie->toStringUriOnlyOrdered()], secondId, long long, "%lld");
+		BC_ASSERT_EQUAL(cursors[pauline->toStringUriOnlyOrdered()], firstId, long long, "%lld");
+		mainDb.cleanupServerChatRoomQueues(now - 3600);
+		messages = mainDb.getServerChatRoomQueuedMessages(chatRoom, 0);
+		BC_ASSERT_EQUAL(messages.size(), 1, size_t, "%zu");
+		if (!messages.empty()) BC_ASSERT_EQUAL(messages.front().id, secondId, long long, "%lld");
+
+		// Once Pauline is gone, nothing is left to dispatch.
+		mainDb.updateServerChatRoomQueueCursors(chatRoom, {}, {pauline->toStringUriOnlyOrdered()});
+		mainDb.cleanupServerChatRoomQueues(now - 3600);
+		BC_ASSERT_TRUE(mainDb.getServerChatRoomQueuedMessages(chatRoom, 0).empty());
+		BC_ASSERT_TRUE(mainDb.getServerChatRoomQueueCursors(chatRoom).empty());
+	} else {
+		BC_FAIL("Database not initialized");
+	}
+}
+
+static void sqlite_profile_benchmark_base(const char *sqlite_profile, long &insertMs, long &readMs) {
+	const int messageCount = 500;
+	const int historyReadCount = 50;
+	const int historyRangeSize = 100;
+	insertMs = readMs = 0;
+
+	MainDbProvider provider("db/chatrooms.db", TRUE, FALSE, FALSE, sqlite_profile);
+	MainDb &mainDb = provider.getMainDb();
+	if (!mainDb.isInitialized()) {
+		BC_FAIL("Database not initialized");
+		return;
+	}
+	BC_ASSERT_EQUAL(mainDb.walEnabled(), strcmp(sqlite_profile, "wal") == 0, bool, "%d");
+	auto chatRooms = mainDb.getChatRooms();
+	BC_ASSERT_FALSE(chatRooms.empty());
+	if (chatRooms.empty()) return;
+	const shared_ptr<AbstractChatRoom> &chatRoom = chatRooms.front();
+	const ConferenceId &conferenceId = chatRoom->getConferenceId();
+
+	// One transaction per message, as when messages are received one by one.
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < messageCount; i++) {
+		shared_ptr<ChatMessage> chatMessage = chatRoom->createChatMessageFromUtf8("Benchmark message " + to_string(i));
+		BC_ASSERT_TRUE(mainDb.addEvent(make_shared<ConferenceChatMessageEvent>(::ms_time(nullptr), chatMessage)));
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	insertMs = (long)chrono::duration_cast<chrono::milliseconds>(end - start).count();
+
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < historyReadCount; i++) {
+		auto events =
+		    mainDb.getHistoryRange(conferenceId, 0, historyRangeSize, MainDb::Filter::ConferenceChatMessageFilter);
+		BC_ASSERT_EQUAL(events.size(), (size_t)historyRangeSize, size_t, "%zu");
+	}
+	end = chrono::high_resolution_clock::now();
+	readMs = (long)chrono::duration_cast<chrono::milliseconds>(end - start).count();
+
+	// Checkpointing must not lose anything.
+	mainDb.checkpoint();
+	BC_ASSERT_GREATER(mainDb.getChatMessageCount(conferenceId), messageCount, int, "%d");
+}
+
+static void sqlite_profile_benchmark(void) {
+	long defaultInsertMs, defaultReadMs, walInsertMs, walReadMs;
+	sqlite_profile_benchmark_base("default", defaultInsertMs, defaultReadMs);
+	sqlite_profile_benchmark_base("wal", walInsertMs, walReadMs);
+	// Only report the figures, timings are too dependent on the storage to be asserted.
+	ms_message("sqlite_profile_benchmark(): inserts took %li ms with default profile, %li ms with wal profile",
+	           defaultInsertMs, walInsertMs);
+	ms_message("sqlite_profile_benchmark(): history reads took %li ms with default profile, %li ms with wal profile",
+	           defaultReadMs, walReadMs);
+}
+
+static void sqlite_profiles(void) {
+	{
+		// Without a configured profile, the journaling of the database is left as it is.
+		MainDbProvider provider("db/chatrooms.db");
+		MainDb &mainDb = provider.getMainDb();
+		BC_ASSERT_TRUE(mainDb.isInitialized());
+		BC_ASSERT_FALSE(mainDb.walEnabled());
+	}
+	{
+		MainDbProvider provider("db/chatrooms.db", TRUE, FALSE, FALSE, "wal");
+		MainDb &mainDb = provider.getMainDb();
+		BC_ASSERT_TRUE(mainDb.isInitialized());
+		BC_ASSERT_TRUE(mainDb.walEnabled());
+		BC_ASSERT_FALSE(mainDb.getChatRooms().empty());
+		mainDb.checkpoint();
+	}
+}
+
 test_t main_db_tests[] = {
     TEST_NO_TAG("Get events count", get_events_count),
     TEST_NO_TAG("Get messages count", get_messages_count),
@@ -662,7 +952,13 @@ test_t main_db_tests[] = {
                 database_with_chatroom_duplicates_gruu_pruned_conference_server),
     TEST_NO_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms),
     TEST_NO_TAG("Load a lot of chatrooms cleaning GRUU", load_a_lot_of_chatrooms_cleaning_gruu),
-    TEST_NO_TAG("Search messages in chatroom", search_messages_in_chat_room)};
+    TEST_NO_TAG("Search messages in chatroom", search_messages_in_chat_room),
+    TEST_NO_TAG("Search messages in chatroom ranked", search_messages_in_chat_room_ranked),
+    TEST_NO_TAG("Write-behind participant states", write_behind_participant_states),
+    TEST_NO_TAG("Participant state counts", participant_state_counts),
+    TEST_NO_TAG("Server chat room queue", server_chat_room_queue),
+    TEST_NO_TAG("Sqlite profiles", sqlite_profiles),
+    TEST_ONE_TAG("Sqlite profile benchmark", sqlite_profile_benchmark, "skip")}; /* Timings only, run on demand */
 
 test_suite_t main_db_test_suite = {"MainDb",
                                    NULL,
@@ -4537,6 +4537,41 @@ static void migration_from_messages_db(void) {
 	bctbx_free(tmp_db);
 }
 
+static void chat_room_list_version(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
+
+	unsigned int version = linphone_core_get_chat_rooms_version(pauline->lc);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(linphone_core_get_chat_rooms(pauline->lc)), 0, int, "%d");
+	// Nothing changed, the version must be the same.
+	BC_ASSERT_EQUAL(linphone_core_get_chat_rooms_version(pauline->lc), version, unsigned int, "%u");
+
+	// Empty chat rooms are hidden, but the list changed anyway.
+	LinphoneChatRoom *chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	BC_ASSERT_NOT_EQUAL(linphone_core_get_chat_rooms_version(pauline->lc), version, unsigned int, "%u");
+	BC_ASSERT_EQUAL((int)bctbx_list_size(linphone_core_get_chat_rooms(pauline->lc)), 0, int, "%d");
+	version = linphone_core_get_chat_rooms_version(pauline->lc);
+
+	LinphoneChatMessage *chat_msg = linphone_chat_room_create_message_from_utf8(chat_room, "Bla bla bla bla");
+	linphone_chat_message_send(chat_msg);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDelivered, 1));
+	BC_ASSERT_NOT_EQUAL(linphone_core_get_chat_rooms_version(pauline->lc), version, unsigned int, "%u");
+	const bctbx_list_t *chat_rooms = linphone_core_get_chat_rooms(pauline->lc);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(chat_rooms), 1, int, "%d");
+	if (chat_rooms) BC_ASSERT_PTR_EQUAL(chat_rooms->data, chat_room);
+	version = linphone_core_get_chat_rooms_version(pauline->lc);
+	BC_ASSERT_PTR_EQUAL(linphone_core_get_chat_rooms(pauline->lc), chat_rooms);
+	BC_ASSERT_EQUAL(linphone_core_get_chat_rooms_version(pauline->lc), version, unsigned int, "%u");
+	linphone_chat_message_unref(chat_msg);
+
+	linphone_core_delete_chat_room(pauline->lc, chat_room);
+	BC_ASSERT_NOT_EQUAL(linphone_core_get_chat_rooms_version(pauline->lc), version, unsigned int, "%u");
+	BC_ASSERT_EQUAL((int)bctbx_list_size(linphone_core_get_chat_rooms(pauline->lc)), 0, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 static void received_messages_with_aggregation_enabled(void) {
 	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
 	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
@@ -4941,7 +4976,8 @@ static test_t message_tests[] = {
     TEST_NO_TAG("Crash during file transfer", crash_during_file_transfer),
     TEST_NO_TAG("Text status after destroying chat room", text_status_after_destroying_chat_room),
     TEST_NO_TAG("Transfer success after destroying chatroom", file_transfer_success_after_destroying_chatroom),
-    TEST_NO_TAG("Migration from messages db", migration_from_messages_db)};
+    TEST_NO_TAG("Migration from messages db", migration_from_messages_db),
+    TEST_NO_TAG("Chat room list version", chat_room_list_version)};
 
 static test_t rtt_message_tests[] = {
     TEST_ONE_TAG("Real Time Text message", real_time_text_message, "RTT"),
@@ -455,6 +455,160 @@ static void simple_subscribe_with_friend_from_rc(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+typedef struct _ResourceListPresenceStats {
+	int presence_received_count;
+	int friends_count;
+} ResourceListPresenceStats;
+
+static void resource_list_presence_received(LinphoneFriendList *list, const bctbx_list_t *friends) {
+	LinphoneFriendListCbs *cbs = linphone_friend_list_get_current_callbacks(list);
+	ResourceListPresenceStats *stats = (ResourceListPresenceStats *)linphone_friend_list_cbs_get_user_data(cbs);
+	stats->presence_received_count++;
+	stats->friends_count += (int)bctbx_list_size(friends);
+}
+
+static char *resource_list_presence_part(char *body, const char *boundary, const char *uri, int index) {
+	return ms_strcat_printf(
+	    body,
+	    "--%s\r\n"
+	    "Content-Type: application/pidf+xml;charset=\"UTF-8\"\r\n"
+	    "Content-Id: part%d@sip.example.org\r\n\r\n"
+	    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>"
+	    "<presence xmlns=\"urn:ietf:params:xml:ns:pidf\" entity=\"%s\" "
+	    "xmlns:p1=\"urn:ietf:params:xml:ns:pidf:data-model\">"
+	    "<tuple id=\"t%d\"><status><basic>open</basic></status><contact>%s</contact></tuple>"
+	    "<p1:person id=\"p%d\" xmlns:p2=\"urn:ietf:params:xml:ns:pidf:rpid\">"
+	    "<p2:activities>%s</p2:activities>"
+	    "</p1:person>"
+	    "</presence>\r\n",
+	    boundary, index, uri, index, uri, index, (index % 2) ? "<p2:away/>" : "");
+}
+
+static void presence_of_large_resource_list(void) {
+	const int nb_friends = 300;
+	const char *boundary = "resourceListBoundary";
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneFriendList *list = linphone_core_create_friend_list(marie->lc);
+	LinphoneFriendListCbs *cbs = linphone_factory_create_friend_list_cbs(linphone_factory_get());
+	ResourceListPresenceStats stats = {0};
+	char *rlmi = NULL;
+	char *parts = NULL;
+	char *body;
+	LinphoneContent *content;
+	int i;
+
+	linphone_friend_list_enable_subscriptions(list, FALSE);
+	linphone_friend_list_cbs_set_presence_received(cbs, resource_list_presence_received);
+	linphone_friend_list_cbs_set_user_data(cbs, &stats);
+	linphone_friend_list_add_callbacks(list, cbs);
+	linphone_friend_list_cbs_unref(cbs);
+
+	rlmi = ms_strdup_printf("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>"
+	                        "<list xmlns=\"urn:ietf:params:xml:ns:rlmi\" fullState=\"true\" "
+	                        "uri=\"sip:rls@sip.example.org\" version=\"0\">");
+	for (i = 0; i < nb_friends; i++) {
+		char *uri = ms_strdup_printf("sip:friend%d@sip.example.org", i);
+		LinphoneFriend *lf = linphone_core_create_friend(marie->lc);
+		LinphoneAddress *addr = linphone_address_new(uri);
+		linphone_friend_edit(lf);
+		linphone_friend_add_address(lf, addr);
+		if (i == 0) {
+			/* Two resources of the list are addresses of the same friend. */
+			LinphoneAddress *other_addr = linphone_address_new("sip:friend0-other@sip.example.org");
+			linphone_friend_add_address(lf, other_addr);
+			linphone_address_unref(other_addr);
+		}
+		linphone_friend_enable_subscribes(lf, FALSE);
+		linphone_friend_done(lf);
+		linphone_friend_list_add_friend(list, lf);
+		linphone_friend_unref(lf);
+		linphone_address_unref(addr);
+
+		rlmi = ms_strcat_printf(rlmi,
+		                        "<resource uri=\"%s\">%s<instance id=\"1\" state=\"active\" "
+		                        "cid=\"part%d@sip.example.org\"/></resource>",
+		                        uri, (i == 1) ? "<name>Friend one</name>" : "", i);
+		parts = resource_list_presence_part(parts, boundary, uri, i);
+		ms_free(uri);
+	}
+	rlmi = ms_strcat_printf(rlmi,
+	                        "<resource uri=\"sip:friend0-other@sip.example.org\">"
+	                        "<instance id=\"1\" state=\"active\" cid=\"part%d@sip.example.org\"/></resource>"
+	                        "<resource uri=\"sip:friend1@sip.example.org\">"
+	                        "<instance id=\"1\" state=\"active\" cid=\"unknown@sip.example.org\"/></resource>"
+	                        "</list>",
+	                        nb_friends);
+	parts = resource_list_presence_part(parts, boundary, "sip:friend0-other@sip.example.org", nb_friends);
+	body = ms_strdup_printf("--%s\r\n"
+	                        "Content-Type: application/rlmi+xml;charset=\"UTF-8\"\r\n"
+	                        "Content-Id: list@sip.example.org\r\n\r\n"
+	                        "%s\r\n"
+	                        "%s"
+	                        "--%s--\r\n",
+	                        boundary, rlmi, parts, boundary);
+
+	content = linphone_core_create_content(marie->lc);
+	linphone_content_set_type(content, "multipart");
+	linphone_content_set_subtype(content, "related");
+	linphone_content_add_content_type_parameter(content, "boundary", boundary);
+	linphone_content_set_buffer(content, (const uint8_t *)body, strlen(body));
+	linphone_friend_list_notify_presence_received(list, NULL, content);
+
+	/* The list and each friend are notified once, the core for each presence document. */
+	BC_ASSERT_EQUAL(stats.presence_received_count, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats.friends_count, nb_friends, int, "%d");
+	BC_ASSERT_EQUAL(marie->stat.number_of_NotifyPresenceReceived, nb_friends, int, "%d");
+	BC_ASSERT_EQUAL(marie->stat.number_of_NotifyPresenceReceivedForUriOrTel, nb_friends + 1, int, "%d");
+
+	for (i = 0; i < nb_friends; i++) {
+		char *uri = ms_strdup_printf("sip:friend%d@sip.example.org", i);
+		LinphoneFriend *lf = linphone_friend_list_find_friend_by_uri(list, uri);
+		BC_ASSERT_PTR_NOT_NULL(lf);
+		if (lf) {
+			const LinphonePresenceModel *model = linphone_friend_get_presence_model(lf);
+			BC_ASSERT_PTR_NOT_NULL(model);
+			if (model) {
+				BC_ASSERT_EQUAL(linphone_presence_model_get_basic_status(model), LinphonePresenceBasicStatusOpen, int,
+				                "%d");
+				BC_ASSERT_EQUAL(linphone_presence_model_get_consolidated_presence(model),
+				                (i % 2) ? LinphoneConsolidatedPresenceBusy : LinphoneConsolidatedPresenceOnline, int,
+				                "%d");
+			}
+			if (i == 1) BC_ASSERT_STRING_EQUAL(linphone_friend_get_name(lf), "Friend one");
+		}
+		ms_free(uri);
+	}
+
+	/* A truncated full state notification is ignored as a whole, the presence of the friends is kept. */
+	ms_free(body);
+	body = ms_strdup_printf("--%s\r\n"
+	                        "Content-Type: application/rlmi+xml;charset=\"UTF-8\"\r\n"
+	                        "Content-Id: list@sip.example.org\r\n\r\n"
+	                        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>"
+	                        "<list xmlns=\"urn:ietf:params:xml:ns:rlmi\" fullState=\"true\" "
+	                        "uri=\"sip:rls@sip.example.org\" version=\"1\">"
+	                        "<resource uri=\"sip:friend0@sip.example.org\">"
+	                        "<instance id=\"1\" state=\"active\" cid=\"part0@sip.example.org\"/></resource>\r\n"
+	                        "--%s--\r\n",
+	                        boundary, boundary);
+	linphone_content_set_buffer(content, (const uint8_t *)body, strlen(body));
+	linphone_friend_list_notify_presence_received(list, NULL, content);
+	BC_ASSERT_EQUAL(stats.presence_received_count, 1, int, "%d");
+	for (i = 0; i < nb_friends; i++) {
+		char *uri = ms_strdup_printf("sip:friend%d@sip.example.org", i);
+		LinphoneFriend *lf = linphone_friend_list_find_friend_by_uri(list, uri);
+		if (lf) BC_ASSERT_PTR_NOT_NULL(linphone_friend_get_presence_model(lf));
+		ms_free(uri);
+	}
+
+	linphone_content_unref(content);
+	ms_free(body);
+	ms_free(parts);
+	ms_free(rlmi);
+	linphone_friend_list_unref(list);
+	linphone_core_manager_destroy(marie);
+}
+
 static test_t presence_tests[] = {
     TEST_ONE_TAG("Simple Subscribe", simple_subscribe, "presence"),
     TEST_ONE_TAG("Simple Subscribe with early NOTIFY", simple_subscribe_with_early_notify, "presence"),
@@ -465,6 +619,7 @@ static test_t presence_tests[] = {
     TEST_ONE_TAG("App managed presence failure", subscribe_failure_handle_by_app, "presence"),
     TEST_NO_TAG("Presence SUBSCRIBE forked", subscribe_presence_forked),
     TEST_NO_TAG("Presence SUBSCRIBE expired", subscribe_presence_expired),
+    TEST_NO_TAG("Presence of a large resource list", presence_of_large_resource_list),
 };
 
 test_suite_t presence_test_suite = {"Presence",
@@ -410,6 +410,55 @@ static void core_init_stop_start_test(void) {
 	}
 }
 
+static void *core_wake_up_thread(void *data) {
+	bctbx_sleep_ms(200);
+	linphone_core_wake_up((LinphoneCore *)data);
+	return NULL;
+}
+
+static void core_wait_and_run_test(void) {
+	LinphoneCore *lc;
+	lc =
+	    linphone_factory_create_core_3(linphone_factory_get(), NULL, liblinphone_tester_get_empty_rc(), system_context);
+
+	if (BC_ASSERT_PTR_NOT_NULL(lc)) {
+		linphone_config_set_int(linphone_core_get_config(lc), "lime", "enabled", 0);
+		linphone_core_start(lc);
+		BC_ASSERT_EQUAL(linphone_core_get_global_state(lc), LinphoneGlobalOn, int, "%i");
+		linphone_core_iterate(lc);
+
+		/* An idle core doesn't need to be iterated at the active rate. */
+		int delay = linphone_core_get_next_iterate_delay(lc);
+		BC_ASSERT_GREATER(delay, 0, int, "%i");
+		BC_ASSERT_LOWER(delay, 1000, int, "%i");
+
+		uint64_t start = bctbx_get_cur_time_ms();
+		linphone_core_wait(lc, 100);
+		BC_ASSERT_GREATER((int)(bctbx_get_cur_time_ms() - start), 90, int, "%i");
+
+		/* A wake up ends the wait, even when requested before it. */
+		start = bctbx_get_cur_time_ms();
+		linphone_core_wake_up(lc);
+		linphone_core_wait(lc, 10000);
+		BC_ASSERT_LOWER((int)(bctbx_get_cur_time_ms() - start), 5000, int, "%i");
+
+		/* A wake up from another thread ends a wait already blocked on the sockets. */
+		bctbx_thread_t thread;
+		start = bctbx_get_cur_time_ms();
+		if (BC_ASSERT_EQUAL(bctbx_thread_create(&thread, NULL, core_wake_up_thread, lc), 0, int, "%i")) {
+			linphone_core_wait(lc, 10000);
+			BC_ASSERT_LOWER((int)(bctbx_get_cur_time_ms() - start), 5000, int, "%i");
+			bctbx_thread_join(thread, NULL);
+		}
+
+		/* The run loop returns once the asynchronous stop is done. */
+		linphone_core_stop_async(lc);
+		linphone_core_run(lc);
+		BC_ASSERT_EQUAL(linphone_core_get_global_state(lc), LinphoneGlobalOff, int, "%i");
+		linphone_core_unref(lc);
+	}
+}
+
 static void core_set_user_agent(void) {
 	LinphoneCore *lc = linphone_factory_create_core_3(linphone_factory_get(), NULL, NULL, system_context);
 
@@ -701,6 +750,59 @@ static void linphone_lpconfig_from_file_zerolen_value(void) {
 	linphone_config_destroy(conf);
 }
 
+static void linphone_lpconfig_lookup_benchmark(void) {
+	/* The rc file of a test account, along with as many friends and accounts as a large address book holds. */
+	char *rc_path = bc_tester_res("rcfiles/marie_rc");
+	LpConfig *conf = linphone_config_new(NULL);
+	BC_ASSERT_EQUAL(linphone_config_read_file(conf, rc_path), 0, int, "%d");
+	for (int i = 0; i < 500; i++) {
+		char section[32];
+		char url[64];
+		snprintf(section, sizeof(section), "friend_%i", i);
+		snprintf(url, sizeof(url), "<sip:friend%i@sip.example.org>", i);
+		linphone_config_set_string(conf, section, "url", url);
+		linphone_config_set_string(conf, section, "pol", "accept");
+		linphone_config_set_int(conf, section, "subscribe", i % 2);
+	}
+	for (int i = 1; i < 20; i++) {
+		char section[32];
+		snprintf(section, sizeof(section), "proxy_%i", i);
+		linphone_config_set_string(conf, section, "reg_proxy", "<sip:sip.example.org;transport=tcp>");
+		linphone_config_set_int(conf, section, "reg_expires", 3600);
+		linphone_config_set_int(conf, section, "publish", 0);
+	}
+
+	/* The settings read again and again while messages are sent and received. */
+	const int iterations = 100000;
+	int checksum = 0;
+	uint64_t start = bctbx_get_cur_time_ms();
+	for (int i = 0; i < iterations; i++) {
+		checksum += linphone_config_get_int(conf, "sip", "composing_idle_timeout", 0);
+		checksum += linphone_config_get_bool(conf, "misc", "enable_simple_group_chat_message_state", FALSE);
+		checksum += linphone_config_get_int(conf, "proxy_19", "reg_expires", 0) == 3600;
+		checksum += linphone_config_get_int(conf, "friend_499", "subscribe", 0);
+		checksum += linphone_config_get_string(conf, "net", "stun_server", NULL) != NULL;
+	}
+	uint64_t elapsed = bctbx_get_cur_time_ms() - start;
+	ms_message("[LPConfig benchmark] %i lookups in %llu ms", 5 * iterations, (unsigned long long)elapsed);
+	BC_ASSERT_EQUAL(checksum, 4 * iterations, int, "%d");
+
+	/* Parsed values must follow the changes of the string ones. */
+	linphone_config_set_int(conf, "friend_499", "subscribe", 0);
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "friend_499", "subscribe", -1), 0, int, "%d");
+	BC_ASSERT_FALSE(linphone_config_get_bool(conf, "friend_499", "subscribe", TRUE));
+	linphone_config_set_string(conf, "friend_499", "subscribe", "0x10");
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "friend_499", "subscribe", -1), 16, int, "%d");
+	linphone_config_clean_entry(conf, "friend_499", "subscribe");
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "friend_499", "subscribe", -1), -1, int, "%d");
+	linphone_config_clean_section(conf, "friend_499");
+	BC_ASSERT_FALSE(linphone_config_has_section(conf, "friend_499"));
+	BC_ASSERT_STRING_EQUAL(linphone_config_get_string(conf, "friend_498", "pol", NULL), "accept");
+
+	linphone_config_destroy(conf);
+	bc_free(rc_path);
+}
+
 void linphone_lpconfig_invalid_friend(void) {
 	LinphoneCoreManager *mgr = linphone_core_manager_new_with_proxies_check("invalid_friends_rc", FALSE);
 	LinphoneFriendList *friendList = linphone_core_get_default_friend_list(mgr->lc);
@@ -1661,7 +1763,17 @@ static void search_friend_with_phone_number_2(void) {
 	lf = linphone_friend_list_find_friend_by_phone_number(lfl, "+ (33) 6 12 13 14 15");
 	BC_ASSERT_PTR_NULL(lf);
 
+	// Editing the phone numbers of a friend is taken into account
+	linphone_friend_remove_phone_number(stephanieFriend, stephaniePhoneNumber);
+	linphone_friend_add_phone_number(stephanieFriend, "0612131415");
+	lf = linphone_friend_list_find_friend_by_phone_number(lfl, "0633889977");
+	BC_ASSERT_PTR_NULL(lf);
+	lf = linphone_friend_list_find_friend_by_phone_number(lfl, "+33612131415");
+	BC_ASSERT_PTR_EQUAL(lf, stephanieFriend);
+
 	linphone_friend_list_remove_friend(lfl, stephanieFriend);
+	lf = linphone_friend_list_find_friend_by_phone_number(lfl, "+33612131415");
+	BC_ASSERT_PTR_NULL(lf);
 	if (stephanieFriend) linphone_friend_unref(stephanieFriend);
 	if (stephanieVcard) linphone_vcard_unref(stephanieVcard);
 
@@ -2205,6 +2317,79 @@ static void search_friend_with_name_with_uppercase(void) {
 	linphone_core_manager_destroy(manager);
 }
 
+static void search_friend_after_friend_edition(void) {
+	LinphoneMagicSearch *magicSearch = NULL;
+	bctbx_list_t *resultList = NULL;
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	const char *aliceSipUri = {"sip:alice@sip.example.org"};
+	const char *bobSipUri = {"sip:bob@sip.example.org"};
+	LinphoneFriend *aliceFriend = linphone_core_create_friend_with_address(manager->lc, aliceSipUri);
+	LinphoneFriend *bobFriend = linphone_core_create_friend_with_address(manager->lc, bobSipUri);
+
+	_create_friends_from_tab(manager->lc, lfl, sFriends, sSizeFriend);
+
+	linphone_friend_set_name(aliceFriend, "Alice Wonderland");
+	linphone_core_add_friend(manager->lc, aliceFriend);
+
+	magicSearch = linphone_magic_search_new(manager->lc);
+
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "wonder", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	if (BC_ASSERT_PTR_NOT_NULL(resultList)) {
+		BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+		_check_friend_result_list(manager->lc, resultList, 0, aliceSipUri, NULL);
+		bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	}
+
+	// Words must be found in the same order.
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "ali WON", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "won ali", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_PTR_NULL(resultList);
+
+	// Editing and adding friends must be taken into account by the next searches.
+	linphone_friend_edit(aliceFriend);
+	linphone_friend_set_name(aliceFriend, "Alice Liddell");
+	linphone_friend_done(aliceFriend);
+	linphone_friend_set_name(bobFriend, "Bob Wonder");
+	linphone_core_add_friend(manager->lc, bobFriend);
+
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "wonder", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	if (BC_ASSERT_PTR_NOT_NULL(resultList)) {
+		BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+		_check_friend_result_list(manager->lc, resultList, 0, bobSipUri, NULL);
+		bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	}
+
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "liddell", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	if (BC_ASSERT_PTR_NOT_NULL(resultList)) {
+		BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+		_check_friend_result_list(manager->lc, resultList, 0, aliceSipUri, NULL);
+		bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	}
+
+	linphone_friend_list_remove_friend(lfl, bobFriend);
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "wonder", "", LinphoneMagicSearchSourceFriends,
+	                                                     LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_PTR_NULL(resultList);
+
+	linphone_magic_search_reset_search_cache(magicSearch);
+
+	_remove_friends_from_list(lfl, sFriends, sSizeFriend);
+	linphone_friend_list_remove_friend(lfl, aliceFriend);
+	linphone_friend_unref(aliceFriend);
+	linphone_friend_unref(bobFriend);
+
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
 static void search_friend_with_multiple_sip_address(void) {
 	LinphoneMagicSearch *magicSearch = NULL;
 	bctbx_list_t *resultList = NULL;
@@ -4033,6 +4218,7 @@ test_t setup_tests[] = {
     TEST_NO_TAG("Linphone core init/stop/uninit", core_init_stop_test),
     TEST_NO_TAG("Linphone core init/unref", core_init_unref_test),
     TEST_NO_TAG("Linphone core init/stop/start/uninit", core_init_stop_start_test),
+    TEST_NO_TAG("Linphone core wait and run", core_wait_and_run_test),
     TEST_NO_TAG("Linphone core set user agent", core_set_user_agent),
     TEST_NO_TAG("Linphone random transport port", core_sip_transport_test),
     TEST_NO_TAG("Linphone interpret url", linphone_interpret_url_test),
@@ -4041,6 +4227,7 @@ test_t setup_tests[] = {
     TEST_NO_TAG("LPConfig zero_len value from buffer", linphone_lpconfig_from_buffer_zerolen_value),
     TEST_NO_TAG("LPConfig zero_len value from file", linphone_lpconfig_from_file_zerolen_value),
     TEST_NO_TAG("LPConfig zero_len value from XML", linphone_lpconfig_from_xml_zerolen_value),
+    TEST_NO_TAG("LPConfig lookup benchmark", linphone_lpconfig_lookup_benchmark),
     TEST_NO_TAG("LPConfig invalid friend", linphone_lpconfig_invalid_friend),
     TEST_NO_TAG("LPConfig invalid friend remote provisoning", linphone_lpconfig_invalid_friend_remote_provisioning),
     TEST_NO_TAG("Chat room", chat_room_test),
@@ -4071,6 +4258,7 @@ test_t setup_tests[] = {
     TEST_ONE_TAG("Search friend in excluded cache friend list", search_friend_in_app_cache, "MagicSearch"),
     TEST_ONE_TAG("Search friend with aggregation", search_friend_with_aggregation, "MagicSearch"),
     TEST_ONE_TAG("Search friend with uppercase name", search_friend_with_name_with_uppercase, "MagicSearch"),
+    TEST_ONE_TAG("Search friend after friend edition", search_friend_after_friend_edition, "MagicSearch"),
     TEST_ONE_TAG("Search friend with multiple sip address", search_friend_with_multiple_sip_address, "MagicSearch"),
     TEST_ONE_TAG("Search friend with same address", search_friend_with_same_address, "MagicSearch"),
     TEST_ONE_TAG("Search friend in large friends database", search_friend_large_database, "MagicSearch"),
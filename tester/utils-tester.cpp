@@ -21,7 +21,9 @@
 #include "bctoolbox/utils.hh"
 
 #include "address/address.h"
+#include "chat/notification/imdn.h"
 #include "conference/conference-id.h"
+#include "containers/lru-cache.h"
 #include "liblinphone_tester.h"
 #include "linphone/utils/utils.h"
 #include "tester_utils.h"
@@ -190,6 +192,62 @@ static void address_serialization() {
 	BC_ASSERT_STRING_EQUAL(result.c_str(), "sip:toto@sip.example.org;a=dada;b=dede;c=didi;d=dodo");
 }
 
+static void lru_cache_eviction() {
+	LruCache<int, int> cache(LruCache<int, int>::MinCapacity);
+	for (int i = 0; i < cache.getCapacity(); i++)
+		cache.insert(i, i);
+
+	// Looking up the oldest entry must save it from the next eviction.
+	BC_ASSERT_PTR_NOT_NULL(cache[0]);
+	cache.insert(cache.getCapacity(), 0);
+	BC_ASSERT_EQUAL(cache.getSize(), cache.getCapacity(), int, "%d");
+	BC_ASSERT_PTR_NOT_NULL(cache[0]);
+	BC_ASSERT_PTR_NULL(cache[1]);
+	BC_ASSERT_EQUAL((int)cache.getEvictions(), 1, int, "%d");
+	BC_ASSERT_EQUAL((int)cache.getHits(), 2, int, "%d");
+	BC_ASSERT_EQUAL((int)cache.getMisses(), 1, int, "%d");
+
+	BC_ASSERT_TRUE(cache.erase(0));
+	BC_ASSERT_FALSE(cache.erase(0));
+	BC_ASSERT_EQUAL(cache.getSize(), cache.getCapacity() - 1, int, "%d");
+}
+
+static void address_cache() {
+	Address::clearSipAddressesCache();
+
+	Address a1("sip:toto@sip.example.org");
+	Address a2("sip:toto@sip.example.org");
+	BC_ASSERT_TRUE(a1.isValid());
+	BC_ASSERT_TRUE(a1 == a2);
+	auto stats = Address::getSipAddressesCacheStats();
+	BC_ASSERT_EQUAL(stats.size, 1, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.hits, 1, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.misses, 1, int, "%d");
+
+	// Invalid strings are remembered as such instead of being parsed again.
+	Address b1("<sip:toto@sip.example.org", false, false);
+	Address b2("<sip:toto@sip.example.org", false, false);
+	BC_ASSERT_FALSE(b1.isValid());
+	BC_ASSERT_FALSE(b2.isValid());
+	stats = Address::getSipAddressesCacheStats();
+	BC_ASSERT_EQUAL(stats.size, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats.negativeSize, 1, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.negativeHits, 1, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.misses, 2, int, "%d");
+
+	// The cache is bounded.
+	for (int i = 0; i <= stats.capacity; i++)
+		Address("sip:user" + to_string(i) + "@sip.example.org");
+	stats = Address::getSipAddressesCacheStats();
+	BC_ASSERT_EQUAL(stats.size, stats.capacity, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.evictions, 2, int, "%d");
+
+	Address::clearSipAddressesCache();
+	stats = Address::getSipAddressesCacheStats();
+	BC_ASSERT_EQUAL(stats.size, 0, int, "%d");
+	BC_ASSERT_EQUAL(stats.negativeSize, 0, int, "%d");
+}
+
 static void conferenceId_comparisons() {
 	std::shared_ptr<Address> a1 = Address::create("sip:toto@sip.example.org;a=dada;b=dede;c=didi;d=dodo");
 	std::shared_ptr<Address> a2 = Address::create("sip:toto@sip.example.org;b=dede;a=dada;d=dodo;c=didi");
@@ -231,6 +289,45 @@ static void parse_capabilities(void) {
 	BC_ASSERT_TRUE(caps["ephemeral"] == Version(1, 0));
 }
 
+static void imdn_parsing(void) {
+	Imdn::ParsedImdn imdn;
+	const string delivered = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+	                         "<imdn xmlns=\"urn:ietf:params:xml:ns:imdn\"><message-id> abc-123 </message-id>"
+	                         "<datetime>2025-01-01T00:00:00Z</datetime>"
+	                         "<delivery-notification><status><delivered/></status></delivery-notification></imdn>";
+	BC_ASSERT_TRUE(Imdn::parseXml(delivered, imdn));
+	BC_ASSERT_STRING_EQUAL(imdn.messageId.c_str(), "abc-123");
+	BC_ASSERT_TRUE(imdn.isDeliveryNotification);
+	BC_ASSERT_FALSE(imdn.isDisplayNotification);
+	BC_ASSERT_TRUE(imdn.delivered);
+	BC_ASSERT_FALSE(imdn.failed);
+
+	const string failed = "<imdn xmlns=\"urn:ietf:params:xml:ns:imdn\""
+	                      " xmlns:imdn=\"http://www.linphone.org/xsds/imdn.xsd\"><message-id>def</message-id>"
+	                      "<!-- comment --><delivery-notification><status><failed/>"
+	                      "<imdn:reason code=\"488\">Not acceptable here</imdn:reason></status></delivery-notification>"
+	                      "</imdn>";
+	BC_ASSERT_TRUE(Imdn::parseXml(failed, imdn));
+	BC_ASSERT_STRING_EQUAL(imdn.messageId.c_str(), "def");
+	BC_ASSERT_TRUE(imdn.failed);
+	BC_ASSERT_FALSE(imdn.delivered);
+	BC_ASSERT_TRUE(imdn.hasReason);
+	BC_ASSERT_EQUAL(imdn.reasonCode, 488, int, "%d");
+
+	const string displayed = "<i:imdn xmlns:i=\"urn:ietf:params:xml:ns:imdn\"><i:message-id>ghi</i:message-id>"
+	                         "<i:display-notification><i:status><i:displayed/></i:status></i:display-notification>"
+	                         "</i:imdn>";
+	BC_ASSERT_TRUE(Imdn::parseXml(displayed, imdn));
+	BC_ASSERT_STRING_EQUAL(imdn.messageId.c_str(), "ghi");
+	BC_ASSERT_TRUE(imdn.isDisplayNotification);
+	BC_ASSERT_TRUE(imdn.displayed);
+	BC_ASSERT_FALSE(imdn.hasReason);
+
+	BC_ASSERT_FALSE(Imdn::parseXml("", imdn));
+	BC_ASSERT_FALSE(Imdn::parseXml("<imdn><message-id>jkl</message-id>", imdn));
+	BC_ASSERT_FALSE(Imdn::parseXml("<other><message-id>jkl</message-id></other>", imdn));
+}
+
 // clang-format off
 static test_t utils_tests[] = {
     TEST_NO_TAG("split", split),
@@ -239,8 +336,11 @@ static test_t utils_tests[] = {
     TEST_NO_TAG("Version comparisons", version_comparisons),
     TEST_NO_TAG("Address comparisons", address_comparisons),
     TEST_NO_TAG("Address serialization", address_serialization),
+    TEST_NO_TAG("LRU cache eviction", lru_cache_eviction),
+    TEST_NO_TAG("Address cache", address_cache),
     TEST_NO_TAG("Conference ID comparisons", conferenceId_comparisons),
-    TEST_NO_TAG("Parse capabilities", parse_capabilities)
+    TEST_NO_TAG("Parse capabilities", parse_capabilities),
+    TEST_NO_TAG("IMDN parsing", imdn_parsing)
 };
 // clang-format on
 
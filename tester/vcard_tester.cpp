@@ -31,6 +31,7 @@
 #include "linphone/core.h"
 #include "tester_utils.h"
 #include "vcard/carddav-context.h"
+#include "vcard/carddav-response.h"
 
 #define CARDDAV_SERVER "http://dav.example.org/baikal/html/card.php"
 #define CARDDAV_SERVER_WITH_PORT "http://dav.example.org:80/baikal/html/card.php"
@@ -140,6 +141,34 @@ static void linphone_vcard_import_a_lot_of_friends_test(void) {
 	linphone_core_manager_destroy(manager);
 }
 
+static void linphone_vcard_import_a_lot_of_friends_in_db_test(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	char *import_filepath = bc_tester_res("vcards/thousand_vcards.vcf");
+	char *friends_db = bc_tester_file(vcard_friends_db_file);
+	bctbx_list_t *friends_from_db = NULL;
+	clock_t start, end;
+	int imported;
+
+	unlink(friends_db);
+	linphone_core_set_friends_database_path(manager->lc, friends_db);
+
+	start = clock();
+	imported = linphone_friend_list_import_friends_from_vcard4_file(lfl, import_filepath);
+	end = clock();
+	BC_ASSERT_EQUAL(imported, 1000, int, "%d");
+	ms_message("Imported a thousand of vCards in database in %f seconds", (double)(end - start) / CLOCKS_PER_SEC);
+
+	friends_from_db = linphone_core_fetch_friends_from_db(manager->lc, lfl);
+	BC_ASSERT_EQUAL((unsigned int)bctbx_list_size(friends_from_db), 1000, unsigned int, "%u");
+	friends_from_db = bctbx_list_free_with_data(friends_from_db, (void (*)(void *))linphone_friend_unref);
+
+	linphone_core_manager_destroy(manager);
+	unlink(friends_db);
+	bc_free(friends_db);
+	bc_free(import_filepath);
+}
+
 static void linphone_vcard_update_existing_friends_test(void) {
 	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
 	LinphoneFriend *lf = linphone_core_create_friend_with_address(manager->lc, "sip:oldfriend@sip.linphone.org");
@@ -984,6 +1013,200 @@ static void carddav_multiple_sync(void) {
 	linphone_core_manager_destroy(manager);
 }
 
+static LinphoneFriendList *create_carddav_friend_list(LinphoneCore *lc, LinphoneCardDAVStats *stats) {
+	LinphoneFriendList *lfl = linphone_core_create_friend_list(lc);
+	LinphoneFriendListCbs *cbs = linphone_factory_create_friend_list_cbs(linphone_factory_get());
+	linphone_friend_list_cbs_set_user_data(cbs, stats);
+	linphone_friend_list_cbs_set_contact_created(cbs, carddav_contact_created);
+	linphone_friend_list_cbs_set_contact_deleted(cbs, carddav_contact_deleted);
+	linphone_friend_list_cbs_set_contact_updated(cbs, carddav_contact_updated);
+	linphone_friend_list_cbs_set_sync_status_changed(cbs, carddav_sync_status_changed);
+	linphone_friend_list_add_callbacks(lfl, cbs);
+	linphone_friend_list_cbs_unref(cbs);
+	linphone_core_add_friend_list(lc, lfl);
+	linphone_friend_list_set_uri(lfl, CARDDAV_SERVER);
+	linphone_friend_list_set_type(lfl, LinphoneFriendListTypeCardDAV);
+	return lfl;
+}
+
+class CardDAVContextTester {
+public:
+	static void pullVcards(LinphoneFriendList *lfl, const std::list<CardDAVResponse> &vCards) {
+		auto friendList = FriendList::toCpp(lfl)->getSharedFromThis();
+		auto context = std::make_shared<CardDAVContext>(friendList->getCore());
+		context->setFriendList(friendList);
+		context->mSyncUri = CARDDAV_SERVER;
+		context->vcardsPulled(vCards);
+	}
+
+	static std::list<CardDAVResponse>
+	parseVcardsChanges(LinphoneCore *lc, const std::string &body, std::string &syncToken, bool &truncated) {
+		auto context = std::make_shared<CardDAVContext>(L_GET_CPP_PTR_FROM_C_OBJECT(lc));
+		return context->parseVcardsChangesFromXmlResponse(body, syncToken, truncated);
+	}
+};
+
+static CardDAVResponse create_carddav_response(const std::string &name, const std::string &etag) {
+	CardDAVResponse response;
+	response.mUrl = "/baikal/html/card.php/addressbooks/tester/default/" + name + ".vcf";
+	response.mEtag = etag;
+	response.mVcard = "BEGIN:VCARD\r\nVERSION:4.0\r\nUID:urn:uuid:" + name + "\r\nFN:" + etag +
+	                  "\r\nIMPP;TYPE=work:sip:" + name + "@sip.example.org\r\nEND:VCARD\r\n";
+	return response;
+}
+
+static void carddav_pull_same_new_contact_twice(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneCardDAVStats *stats = (LinphoneCardDAVStats *)ms_new0(LinphoneCardDAVStats, 1);
+	LinphoneFriendList *lfl = create_carddav_friend_list(manager->lc, stats);
+
+	// The second vCard of the new contact replaces the first one instead of creating another friend
+	CardDAVContextTester::pullVcards(lfl, {create_carddav_response("margaux", "first"),
+	                                       create_carddav_response("margaux", "second")});
+	BC_ASSERT_EQUAL(stats->sync_done_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats->new_contact_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats->updated_contact_count, 0, int, "%i");
+	const bctbx_list_t *friends = linphone_friend_list_get_friends(lfl);
+	BC_ASSERT_EQUAL((unsigned int)bctbx_list_size(friends), 1, unsigned int, "%u");
+	if (friends) {
+		LinphoneVcard *lvc = linphone_friend_get_vcard((LinphoneFriend *)bctbx_list_get_data(friends));
+		BC_ASSERT_STRING_EQUAL(linphone_vcard_get_etag(lvc), "second");
+	}
+
+	// Pulled again, the contact is updated
+	CardDAVContextTester::pullVcards(lfl, {create_carddav_response("margaux", "second")});
+	BC_ASSERT_EQUAL(stats->sync_done_count, 2, int, "%i");
+	BC_ASSERT_EQUAL(stats->new_contact_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats->updated_contact_count, 1, int, "%i");
+	BC_ASSERT_EQUAL((unsigned int)bctbx_list_size(linphone_friend_list_get_friends(lfl)), 1, unsigned int, "%u");
+
+	linphone_friend_list_unref(lfl);
+	linphone_core_manager_destroy(manager);
+	ms_free(stats);
+}
+
+static void carddav_parse_sync_collection_response(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	const std::string body =
+	    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+	    "<d:multistatus xmlns:d=\"DAV:\">\n"
+	    "  <d:response>\n"
+	    "    <d:href>/addressbooks/tester/default/changed.vcf</d:href>\n"
+	    "    <d:propstat>\n"
+	    "      <d:prop><d:getetag>\"etag-1\"</d:getetag></d:prop>\n"
+	    "      <d:status>HTTP/1.1 200 OK</d:status>\n"
+	    "    </d:propstat>\n"
+	    "  </d:response>\n"
+	    "  <d:response>\n"
+	    "    <d:href>/addressbooks/tester/default/removed.vcf</d:href>\n"
+	    "    <d:status>HTTP/1.1 404 Not Found</d:status>\n"
+	    "  </d:response>\n"
+	    "  <d:response>\n"
+	    "    <d:href>/addressbooks/tester/default/</d:href>\n"
+	    "    <d:status>HTTP/1.1 507 Insufficient Storage</d:status>\n"
+	    "  </d:response>\n"
+	    "  <d:sync-token>http://example.org/ns/sync/43</d:sync-token>\n"
+	    "</d:multistatus>\n";
+	std::string syncToken;
+	bool truncated = false;
+	std::list<CardDAVResponse> changes =
+	    CardDAVContextTester::parseVcardsChanges(manager->lc, body, syncToken, truncated);
+	BC_ASSERT_STRING_EQUAL(syncToken.c_str(), "http://example.org/ns/sync/43");
+	BC_ASSERT_TRUE(truncated);
+	BC_ASSERT_EQUAL((unsigned int)changes.size(), 2, unsigned int, "%u");
+	if (changes.size() == 2) {
+		const CardDAVResponse &changed = changes.front();
+		BC_ASSERT_STRING_EQUAL(changed.mUrl.c_str(), "/addressbooks/tester/default/changed.vcf");
+		BC_ASSERT_STRING_EQUAL(changed.mEtag.c_str(), "\"etag-1\"");
+		BC_ASSERT_FALSE(changed.mDeleted);
+		const CardDAVResponse &removed = changes.back();
+		BC_ASSERT_STRING_EQUAL(removed.mUrl.c_str(), "/addressbooks/tester/default/removed.vcf");
+		BC_ASSERT_TRUE(removed.mDeleted);
+	}
+
+	// Without a sync token, or with a body that can't be parsed, the changes are ignored and all vCards are listed
+	syncToken.clear();
+	truncated = false;
+	CardDAVContextTester::parseVcardsChanges(manager->lc, "<d:multistatus xmlns:d=\"DAV:\"></d:multistatus>",
+	                                         syncToken, truncated);
+	BC_ASSERT_TRUE(syncToken.empty());
+	BC_ASSERT_FALSE(truncated);
+	CardDAVContextTester::parseVcardsChanges(manager->lc, "<d:multistatus", syncToken, truncated);
+	BC_ASSERT_TRUE(syncToken.empty());
+
+	linphone_core_manager_destroy(manager);
+}
+
+static void carddav_incremental_sync(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("carddav_rc", FALSE);
+	LinphoneCardDAVStats *stats = (LinphoneCardDAVStats *)ms_new0(LinphoneCardDAVStats, 1);
+	LinphoneCardDAVStats *editor_stats = (LinphoneCardDAVStats *)ms_new0(LinphoneCardDAVStats, 1);
+	LinphoneFriendList *lfl = create_carddav_friend_list(manager->lc, stats);
+	// A second list of the same address book, to change it behind the back of the first one.
+	LinphoneFriendList *editor_lfl = create_carddav_friend_list(manager->lc, editor_stats);
+	LinphoneVcard *lvc = NULL;
+	LinphoneFriend *lf = NULL;
+	char *sync_token = NULL;
+
+	linphone_friend_list_synchronize_friends_from_server(lfl);
+	wait_for_until(manager->lc, NULL, &stats->sync_done_count, 1, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->sync_done_count, 1, int, "%i");
+	BC_ASSERT_STRING_NOT_EQUAL(linphone_friend_list_get_sync_token(lfl), "");
+	sync_token = ms_strdup(linphone_friend_list_get_sync_token(lfl));
+
+	// Nothing changed, no vCard is fetched
+	stats->new_contact_count = 0;
+	stats->updated_contact_count = 0;
+	stats->removed_contact_count = 0;
+	linphone_friend_list_synchronize_friends_from_server(lfl);
+	wait_for_until(manager->lc, NULL, &stats->sync_done_count, 2, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->sync_done_count, 2, int, "%i");
+	BC_ASSERT_STRING_EQUAL(linphone_friend_list_get_sync_token(lfl), sync_token);
+	BC_ASSERT_EQUAL(stats->new_contact_count, 0, int, "%i");
+	BC_ASSERT_EQUAL(stats->updated_contact_count, 0, int, "%i");
+	BC_ASSERT_EQUAL(stats->removed_contact_count, 0, int, "%i");
+
+	linphone_friend_list_synchronize_friends_from_server(editor_lfl);
+	wait_for_until(manager->lc, NULL, &editor_stats->sync_done_count, 1, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(editor_stats->sync_done_count, 1, int, "%i");
+	lvc = linphone_vcard_context_get_vcard_from_buffer(
+	    linphone_core_get_vcard_context(manager->lc),
+	    "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:Margaux "
+	    "Clerc\r\nIMPP;TYPE=work:sip:margaux@sip.linphone.org\r\nEND:VCARD\r\n");
+	lf = linphone_core_create_friend_from_vcard(manager->lc, lvc);
+	linphone_vcard_unref(lvc);
+	linphone_friend_list_add_friend(editor_lfl, lf);
+	wait_for_until(manager->lc, NULL, &editor_stats->sync_done_count, 2, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(editor_stats->sync_done_count, 2, int, "%i");
+
+	// Only the added vCard is reported
+	linphone_friend_list_synchronize_friends_from_server(lfl);
+	wait_for_until(manager->lc, NULL, &stats->sync_done_count, 3, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->sync_done_count, 3, int, "%i");
+	BC_ASSERT_STRING_NOT_EQUAL(linphone_friend_list_get_sync_token(lfl), sync_token);
+	BC_ASSERT_EQUAL(stats->new_contact_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats->updated_contact_count, 0, int, "%i");
+	BC_ASSERT_EQUAL(stats->removed_contact_count, 0, int, "%i");
+
+	// And then its removal
+	linphone_friend_list_remove_friend(editor_lfl, lf);
+	linphone_friend_unref(lf);
+	wait_for_until(manager->lc, NULL, &editor_stats->sync_done_count, 3, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(editor_stats->sync_done_count, 3, int, "%i");
+	linphone_friend_list_synchronize_friends_from_server(lfl);
+	wait_for_until(manager->lc, NULL, &stats->sync_done_count, 4, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->sync_done_count, 4, int, "%i");
+	BC_ASSERT_EQUAL(stats->new_contact_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats->removed_contact_count, 1, int, "%i");
+
+	ms_free(sync_token);
+	linphone_friend_list_unref(lfl);
+	linphone_friend_list_unref(editor_lfl);
+	linphone_core_manager_destroy(manager);
+	ms_free(stats);
+	ms_free(editor_stats);
+}
+
 static void carddav_server_to_client_and_client_to_sever_sync(void) {
 	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("carddav_rc", FALSE);
 	LinphoneFriendList *lfl = linphone_core_create_friend_list(manager->lc);
@@ -1262,6 +1485,7 @@ end:
 test_t vcard_tests[] = {
     TEST_NO_TAG("Import / Export friends from vCards", linphone_vcard_import_export_friends_test),
     TEST_NO_TAG("Import a lot of friends from vCards", linphone_vcard_import_a_lot_of_friends_test),
+    TEST_NO_TAG("Import a lot of friends from vCards in database", linphone_vcard_import_a_lot_of_friends_in_db_test),
     TEST_NO_TAG("vCard creation for existing friends", linphone_vcard_update_existing_friends_test),
     TEST_NO_TAG("vCard phone numbers and SIP addresses", linphone_vcard_phone_numbers_and_sip_addresses),
     TEST_NO_TAG("vCard with local photo file to base64", linphone_vcard_local_photo_to_base_64),
@@ -1276,6 +1500,9 @@ test_t vcard_tests[] = {
                   "CardDAV",
                   "MagicSearch"),
     TEST_ONE_TAG("CardDAV multiple synchronizations", carddav_multiple_sync, "CardDAV"),
+    TEST_ONE_TAG("CardDAV incremental synchronization", carddav_incremental_sync, "CardDAV"),
+    TEST_NO_TAG("CardDAV pull of the same new contact twice", carddav_pull_same_new_contact_twice),
+    TEST_NO_TAG("CardDAV sync collection response parsing", carddav_parse_sync_collection_response),
     TEST_ONE_TAG("CardDAV client to server and server to client sync",
                  carddav_server_to_client_and_client_to_sever_sync,
                  "CardDAV"),